@@ -6,6 +6,8 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 
 #include "GUI/GUI.h"
 #include "GUI/assembly_data.h"
+#include "uvd/core/analyzer.h"
+#include "uvd/core/line_index.h"
 #include "uvd/string/engine.h"
 #include "uvd/util/debug.h"
 
@@ -84,16 +86,39 @@ uv_err_t UVDGUIAssemblyData::iterator_impl::next()
 
 uv_err_t UVDGUIAssemblyData::iterator_impl::changePositionByLineDelta(int delta)
 {
+	UVD *uvd = m_dataImpl->getUVD();
+	UVDPrintLineIndex *lineIndex = NULL;
+	UVDPrintIterator limit;
+	uv_err_t rc = UV_ERR_GENERAL;
+	
+	if( !uvd || delta == 0 )
+	{
+		return UV_ERR_OK;
+	}
+	
+	//Seek straight to the line instead of printing every line in between
+	uv_assert_ret(uvd->m_analyzer);
+	uv_assert_err_ret(uvd->m_analyzer->getLineIndex(&lineIndex));
+	rc = lineIndex->seekDelta(m_iter, delta);
+	if( rc != UV_ERR_NOTSUPPORTED )
+	{
+		uv_assert_err_ret(rc);
+		return UV_ERR_OK;
+	}
+	
+	//Not in the indexed address space, step a line at a time
 	if( delta > 0 )
 	{
-		for( int i = 0; i < delta && m_iter != m_dataImpl->getUVD()->end(); ++i )
+		uv_assert_err_ret(uvd->end(limit));
+		for( int i = 0; i < delta && m_iter != limit; ++i )
 		{
 			uv_assert_err_ret(m_iter.next());
 		}
 	}
 	else
 	{
-		for( int i = delta; delta > 0 && m_iter != m_dataImpl->getUVD()->begin(); --i )
+		uv_assert_err_ret(uvd->begin(limit));
+		for( int i = delta; i < 0 && m_iter != limit; ++i )
 		{
 			uv_assert_err_ret(m_iter.previous());
 		}
@@ -130,6 +130,9 @@ else
 LIBS += -lboost_system -lboost_filesystem
 endif
 
+# UVDThreadPool
+LIBS += -lpthread
+
 
 ifeq ($(USING_LIBZ),Y)
 ifeq ($(LINKAGE),static)
@@ -16,6 +16,7 @@ UVDArchitecture::UVDArchitecture()
 	m_uvd = NULL;
 	m_instructionIteratorFactory = NULL;
 	m_printIteratorFactory = NULL;
+	m_cacheInstructions = false;
 }
 
 UVDArchitecture::~UVDArchitecture()
@@ -30,13 +31,31 @@ uv_err_t UVDArchitecture::init()
 
 uv_err_t UVDArchitecture::doInit() {
 	uv_assert_err_ret(getInstructionIteratorFactory(&m_instructionIteratorFactory));
+	uv_assert_ret(m_instructionIteratorFactory);
+	m_instructionIteratorFactory->m_uvd = m_uvd;
 	uv_assert_err_ret(getPrintIteratorFactory(&m_printIteratorFactory));
+	uv_assert_ret(m_printIteratorFactory);
+	m_printIteratorFactory->m_uvd = m_uvd;
 
 	uv_assert_err_ret(init());
 	
 	return UV_ERR_OK;
 }
 
+uv_err_t UVDArchitecture::setUVD(UVD *uvd) {
+	m_uvd = uvd;
+	if( m_instructionIteratorFactory )
+	{
+		m_instructionIteratorFactory->m_uvd = uvd;
+	}
+	if( m_printIteratorFactory )
+	{
+		m_printIteratorFactory->m_uvd = uvd;
+	}
+	
+	return UV_ERR_OK;
+}
+
 uv_err_t UVDArchitecture::deinit()
 {
 	for( std::vector<UVDCPUVector *>::iterator iter = m_vectors.begin();
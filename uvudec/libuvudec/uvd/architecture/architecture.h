@@ -17,6 +17,7 @@ class UVDInstructionIterator;
 class UVDAbstractInstructionIterator;
 class UVDAbstractPrintIterator;
 class UVDASInstructionIterator;
+class UVD;
 class UVDInstructionIteratorFactory {
 public:
 	UVDInstructionIteratorFactory();
@@ -40,6 +41,10 @@ public:
 	//End of an architecture specific address space
 	uv_err_t instructionIteratorEndByAddressSpace( UVDInstructionIterator *out, UVDAddressSpace *addressSpace );	
 	virtual uv_err_t abstractInstructionIteratorEndByAddressSpace(UVDAbstractInstructionIterator **out, UVDAddressSpace *addressSpace) = 0;
+
+public:
+	//Engine iterators are created on, set by UVDArchitecture::doInit()
+	UVD *m_uvd;
 };
 
 class UVDPrintIteratorFactory {
@@ -62,6 +67,10 @@ public:
 	//End of an architecture specific address space
 	uv_err_t printIteratorEndByAddressSpace( UVDPrintIterator *out, UVDAddressSpace *addressSpace );	
 	virtual uv_err_t abstractPrintIteratorEndByAddressSpace(UVDAbstractPrintIterator **out, UVDAddressSpace *addressSpace) = 0;
+
+public:
+	//Engine iterators are created on, set by UVDArchitecture::doInit()
+	UVD *m_uvd;
 };
 
 
@@ -127,6 +136,8 @@ public:
 	virtual uv_err_t fixupDefaults();
 
 	uv_err_t doInit();
+	//Bind to the engine this architecture is used by, iterator factories included
+	uv_err_t setUVD(UVD *uvd);
 	
 	//vector is still owned by this architecture object
 	//return UV_ERR_NOTFOUND if doesn't exist and out will be set to NULL
@@ -144,6 +155,12 @@ public:
 
 	UVDInstructionIteratorFactory *m_instructionIteratorFactory;
 	UVDPrintIteratorFactory *m_printIteratorFactory;
+	/*
+	Set if parseCurrentInstruction() returns a newly allocated instruction each time
+	Lets UVDAnalyzer::m_instructionCache keep them instead of decoding again
+	Must stay false for architectures that reuse the iterator's instruction object
+	*/
+	uvd_bool_t m_cacheInstructions;
 };
 
 #endif
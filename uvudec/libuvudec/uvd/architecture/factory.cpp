@@ -14,6 +14,7 @@ UVDInstructionIteratorFactory
 */
 
 UVDInstructionIteratorFactory::UVDInstructionIteratorFactory() {
+	m_uvd = NULL;
 }
 
 UVDInstructionIteratorFactory::~UVDInstructionIteratorFactory() {
@@ -34,9 +35,9 @@ uv_err_t UVDInstructionIteratorFactory::abstractInstructionIteratorBegin( UVDAbs
 	UVDRuntime *runtime = NULL;
 	
 	//Find the lowest address and address space
-	runtime = g_uvd->m_runtime;
-		
-	uv_assert_err_ret(g_uvd->m_runtime->getPrimaryExecutableAddressSpace(&address.m_space));
+	uv_assert_ret(m_uvd);
+	runtime = m_uvd->m_runtime;
+	uv_assert_err_ret(runtime->getPrimaryExecutableAddressSpace(&address.m_space));
 	uv_assert_err_ret(address.m_space->getMinValidAddress(&address.m_addr));
 	uv_assert_err_ret(abstractInstructionIteratorBeginByAddress(out, address));
 	
@@ -65,7 +66,8 @@ uv_err_t UVDInstructionIteratorFactory::instructionIteratorEnd( UVDInstructionIt
 uv_err_t UVDInstructionIteratorFactory::abstractInstructionIteratorEnd(UVDAbstractInstructionIterator **out) {
 	UVDAddressSpace *addressSpace = NULL;
 	
-	uv_assert_err_ret(g_uvd->m_runtime->getPrimaryExecutableAddressSpace(&addressSpace));
+	uv_assert_ret(m_uvd);
+	uv_assert_err_ret(m_uvd->m_runtime->getPrimaryExecutableAddressSpace(&addressSpace));
 		
 	return UV_DEBUG(abstractInstructionIteratorEndByAddressSpace(out, addressSpace));
 }
@@ -84,6 +86,7 @@ UVDPrintIteratorFactory
 */
 
 UVDPrintIteratorFactory::UVDPrintIteratorFactory() {
+	m_uvd = NULL;
 }
 
 UVDPrintIteratorFactory::~UVDPrintIteratorFactory() {
@@ -114,7 +117,8 @@ uv_err_t UVDPrintIteratorFactory::abstractPrintIteratorBegin( UVDAbstractPrintIt
 	UVDRuntime *runtime = NULL;
 		
 	//Find the lowest address and address space
-	runtime = g_uvd->m_runtime;
+	uv_assert_ret(m_uvd);
+	runtime = m_uvd->m_runtime;
 	uv_assert_err_ret(runtime->getPrimaryExecutableAddressSpace(&address.m_space));
 	uv_assert_err_ret(address.m_space->getMinValidAddress(&address.m_addr));
 	uv_assert_err_ret(abstractPrintIteratorBeginByAddress(out, address));
@@ -142,8 +146,9 @@ uv_err_t UVDPrintIteratorFactory::abstractPrintIteratorEnd(UVDAbstractPrintItera
 	UVDStdPrintIterator *iter = NULL;
 	UVDAddressSpace *addressSpace = NULL;
 	
-	uv_assert_err_ret(g_uvd->m_runtime->getPrimaryExecutableAddressSpace(&addressSpace));
-	uv_assert_err_ret(UVDStdPrintIterator::getEnd(g_uvd, addressSpace, &iter));
+	uv_assert_ret(m_uvd);
+	uv_assert_err_ret(m_uvd->m_runtime->getPrimaryExecutableAddressSpace(&addressSpace));
+	uv_assert_err_ret(UVDStdPrintIterator::getEnd(m_uvd, addressSpace, &iter));
 	uv_assert_ret(iter);
 	//Should be at the end of a particular address space, not some special state
 	uv_assert_ret(iter->m_iter.m_iter);
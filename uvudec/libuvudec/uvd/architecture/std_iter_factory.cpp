@@ -26,7 +26,7 @@ uv_err_t UVDStdInstructionIteratorFactory::abstractInstructionIteratorBeginByAdd
 	iter = new UVDStdInstructionIterator();
 	uv_assert_ret(iter);
 	uv_assert_ret(address.m_space);
-	uv_assert_err_ret(iter->init(g_uvd, address));
+	uv_assert_err_ret(iter->init(m_uvd, address));
 	uv_assert_err_ret(iter->check());
 	uv_assert_ret(out);
 	*out = iter;
@@ -35,7 +35,7 @@ uv_err_t UVDStdInstructionIteratorFactory::abstractInstructionIteratorBeginByAdd
 }
 
 uv_err_t UVDStdInstructionIteratorFactory::abstractInstructionIteratorEndByAddressSpace(UVDAbstractInstructionIterator **out, UVDAddressSpace *addressSpace) {
-	return UV_DEBUG(UVDStdInstructionIterator::getEnd(g_uvd, addressSpace, (UVDStdInstructionIterator **)out));
+	return UV_DEBUG(UVDStdInstructionIterator::getEnd(m_uvd, addressSpace, (UVDStdInstructionIterator **)out));
 }
 
 /*
@@ -53,7 +53,7 @@ uv_err_t UVDStdPrintIteratorFactory::abstractPrintIteratorBeginByAddress( UVDAbs
 	
 	iter = new UVDStdPrintIterator();
 	uv_assert_ret(iter);
-	uv_assert_err_ret(iter->init(g_uvd, address, 0));
+	uv_assert_err_ret(iter->init(m_uvd, address, 0));
 	uv_assert_err_ret(iter->check());
 	uv_assert_ret(out);
 	*out = iter;
@@ -62,6 +62,6 @@ uv_err_t UVDStdPrintIteratorFactory::abstractPrintIteratorBeginByAddress( UVDAbs
 }
 
 uv_err_t UVDStdPrintIteratorFactory::abstractPrintIteratorEndByAddressSpace(UVDAbstractPrintIterator **out, UVDAddressSpace *addressSpace) {
-	return UV_DEBUG(UVDStdPrintIterator::getEnd(g_uvd, addressSpace, (UVDStdPrintIterator **)out));
+	return UV_DEBUG(UVDStdPrintIterator::getEnd(m_uvd, addressSpace, (UVDStdPrintIterator **)out));
 }
 
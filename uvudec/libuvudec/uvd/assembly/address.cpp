@@ -5,6 +5,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 */
 
 #include "uvd/assembly/address.h"
+#include "uvd/config/config.h"
 #include "uvd/core/uvd.h"
 
 /*
@@ -235,7 +236,9 @@ uv_err_t UVDAddressSpace::getNumberAnalyzedBytes(uint32_t *analyzedBytesOut)
 uv_err_t UVDAddressSpace::getMinValidAddress(uv_addr_t *out)
 {
 	//Since we assume for now that the executable is 0 to size - 1, min address here is the min address
-	return UV_DEBUG(g_uvd->m_config->getAddressMin(out));
+	//Address limits are process wide config, shared by all engines
+	uv_assert_ret(g_config);
+	return UV_DEBUG(g_config->getAddressMin(out));
 }
 
 uv_err_t UVDAddressSpace::getMinAddress(uv_addr_t *out) {
@@ -253,9 +256,8 @@ uv_err_t UVDAddressSpace::getMaxValidAddress(uv_addr_t *out)
 	uv_addr_t maxConfigAddress = 0;
 	uv_addr_t maxPhysicalAddress = 0;
 	
-	uv_assert_ret(g_uvd);
-	uv_assert_ret(g_uvd->m_config);
-	uv_assert_err_ret(g_uvd->m_config->getAddressMax(&maxConfigAddress));
+	uv_assert_ret(g_config);
+	uv_assert_err_ret(g_config->getAddressMax(&maxConfigAddress));
 	/*
 	uv_assert_ret(m_data);
 	uv_assert_err_ret(m_data->size(&maxPhysicalAddress));
@@ -283,7 +285,8 @@ uv_err_t UVDAddressSpace::nextValidAddress(uv_addr_t start, uv_addr_t *ret)
 	uv_addr_t addressMax = 0;
 	uv_err_t rc = UV_ERR_GENERAL;
 
-	rc = g_uvd->m_config->nextValidAddress(start, &configRet);
+	uv_assert_ret(g_config);
+	rc = g_config->nextValidAddress(start, &configRet);
 	uv_assert_err_ret(rc);
 	
 	//No more valid addresses based on config?
@@ -307,41 +310,34 @@ uv_err_t UVDAddressSpace::nextValidAddress(uv_addr_t start, uv_addr_t *ret)
 
 uv_err_t UVDAddressSpace::nextCodingAddress(uv_addr_t start, uint32_t *ret)
 {
-	uint32_t cur = start;
+	/*
+	Nothing records non-coding addresses (strings, tables) yet
+	String analysis is heuristic and a false hit inside real code would hide it from flow analysis
+	*/
+	uv_assert_ret(ret);
+	*ret = start;
 	
-	for( ;; )
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDAddressSpace::getExecutableRunEnd(uv_addr_t address, uv_addr_t *ret)
+{
+	UVDRangePair validRun;
+	uv_addr_t addressMax = 0;
+	
+	uv_assert_ret(g_config);
+	uv_assert_ret(ret);
+	if( g_config->m_validAddresses.find(address, &validRun) == UV_ERR_NOTFOUND )
 	{
-		uint32_t last = cur;
-		
-#if 0
-		for( std::vector<UVDAddressRange>::iterator iter = m_uvd->m_noncodingAddresses.begin();
-				iter != m_uvd->m_noncodingAddresses.end(); ++iter )
-		{
-			UVDAddressRange mem = *iter;
-			
-			if( mem.intersects(UVDAddressRange(cur)) )
-			{
-				//Are we out of addresses?
-				if( mem.m_max_addr == UVD_ADDR_MAX )
-				{
-					return UV_ERR_DONE;
-				}
-				
-				//We will keep intersecting until the end of this block, advance past
-				cur = mem.m_max_addr + 1;
-				break;
-			}
-		}
-#endif
-		
-		//Done if we stopped hitting non-coding addresses
-		if( last == cur )
-		{
-			break;
-		}
+		return UV_ERR_NOTFOUND;
+	}
+	uv_assert_err_ret(getMaxValidAddress(&addressMax));
+	if( address > addressMax )
+	{
+		return UV_ERR_NOTFOUND;
 	}
 	
-	*ret = cur;
+	*ret = validRun.m_max < addressMax ? validRun.m_max : addressMax;
 	
 	return UV_ERR_OK;
 }
@@ -350,8 +346,7 @@ uv_err_t UVDAddressSpace::nextValidExecutableAddress(uv_addr_t start, uint32_t *
 {
 	uv_addr_t cur = start;
 	
-	//Number of non-coding addresses is expected to be small at this point
-	//Better algorithm later if necessary
+	//Each step is a binary search over the config's valid runs, non-coding regions aren't recorded yet
 	for( ;; )
 	{
 		//Keep iterating as long as another memory region matches
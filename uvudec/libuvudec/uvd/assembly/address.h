@@ -97,6 +97,13 @@ public:
 	//Only based on coding list, not any other validity
 	//Used internally by nextValidExecutionAddress()
 	uv_err_t nextCodingAddress(uv_addr_t start, uv_addr_t *ret);
+	/*
+	Last address of the valid executable addresses continuing from address
+	Every address in [address, *ret] can be decoded without further checks
+	Returns UV_ERR_NOTFOUND if address itself isn't a valid executable address
+	Only config validity is indexed, nothing marks addresses non-coding yet (see nextCodingAddress())
+	*/
+	uv_err_t getExecutableRunEnd(uv_addr_t address, uv_addr_t *ret);
 
 	//How many bytes we have to analyze in total
 	//Based on size of program and analysis exclusions
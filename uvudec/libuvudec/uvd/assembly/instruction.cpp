@@ -19,6 +19,7 @@ UVDInstructionAnalysis::UVDInstructionAnalysis()
 	m_callTarget = 0;
 	
 	m_isConditional = 0;
+	m_isReturn = 0;
 }
 
 UVDInstructionAnalysis::~UVDInstructionAnalysis()
@@ -74,3 +75,8 @@ uv_err_t UVDInstruction::deinit()
 	return UV_ERR_OK;
 }
 
+void UVDInstruction::release()
+{
+	delete this;
+}
+
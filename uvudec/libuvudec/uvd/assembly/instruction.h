@@ -41,7 +41,8 @@ class UVDOperandShared
 {
 public:
 	UVDOperandShared();
-	~UVDOperandShared();
+	//Architectures delete their operand subclasses through this
+	virtual ~UVDOperandShared();
 	virtual uv_err_t init();
 	virtual uv_err_t deinit();
 
@@ -128,6 +129,8 @@ public:
 	uv_addr_t m_callTarget;
 	
 	uvd_bool_t m_isConditional;
+	//Execution does not continue to the next instruction (RET and such)
+	uvd_bool_t m_isReturn;
 	
 	//Should put this as a fallback case?
 	//std::map<std::string, std::string> m_misc;
@@ -152,6 +155,11 @@ public:
 	//Give as many hints to our analyzer as possible based on what this instruction does
 	//If out is given, also fill in details to returned structure
 	virtual uv_err_t analyzeControlFlow(UVDInstructionAnalysis *out = NULL) = 0;
+	/*
+	Called by whoever owns us (ex: the instruction cache) when done with us
+	Architectures that recycle instruction objects override this, default deletes
+	*/
+	virtual void release();
 
 public:
 	/* Shared information for the primary instruction part such as a general description */
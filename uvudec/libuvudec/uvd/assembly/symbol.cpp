@@ -395,9 +395,16 @@ UVDBinarySymbolManager::~UVDBinarySymbolManager()
 
 uv_err_t UVDBinarySymbolManager::deinit()
 {
+	//A symbol is keyed once per name, don't free aliases twice
+	std::set<UVDBinarySymbol *> symbols;
+	
 	for( std::map<std::string, UVDBinarySymbol *>::iterator iter = m_symbols.begin(); iter != m_symbols.end(); ++iter )
 	{
-		delete (*iter).second;
+		symbols.insert((*iter).second);
+	}
+	for( std::set<UVDBinarySymbol *>::iterator iter = symbols.begin(); iter != symbols.end(); ++iter )
+	{
+		delete *iter;
 	}
 	m_symbols.clear();
 	m_symbolsByAddress.clear();
@@ -491,36 +498,66 @@ uv_err_t UVDBinarySymbolManager::addSymbol(UVDBinarySymbol *symbol)
 	return UV_ERR_OK;
 }
 
+uv_err_t UVDBinarySymbolManager::setSymbolName(UVDBinarySymbol *symbol, const std::string &name)
+{
+	std::map<std::string, UVDBinarySymbol *>::iterator iter;
+
+	uv_assert_ret(symbol);
+	uv_assert_ret(!name.empty());
+	
+	iter = m_symbols.find(name);
+	if( iter != m_symbols.end() && (*iter).second != symbol )
+	{
+		return UV_ERR_DUPLICATE;
+	}
+	symbol->setSymbolName(name);
+	m_symbols[name] = symbol;
+
+	return UV_ERR_OK;
+}
+
 uv_err_t UVDBinarySymbolManager::collectRelocations(UVDBinaryFunction *function)
 {
-	uint32_t functionAddress = 0;
+	std::vector<UVDBinarySymbol *> usedSymbols;
 
-	uv_assert_ret(function);
+	uv_assert_err_ret(getUsedSymbols(usedSymbols));
+	return UV_DEBUG(collectRelocations(function, usedSymbols));
+}
 
-	uv_assert_err_ret(function->getSymbolAddress(&functionAddress));
+uv_err_t UVDBinarySymbolManager::collectRelocations(UVDBinaryFunction *function, const std::vector<UVDBinarySymbol *> &usedSymbols)
+{
+	uv_assert_ret(function);
 
 	/*
 	For each symbol, we must add all occurences contained in this symbol
 	This is O(n**2) which could take a while, it probably can be made O(n) with some work
 	*/
-	for( std::map<std::string, UVDBinarySymbol *>::iterator iter = m_symbols.begin(); iter != m_symbols.end(); ++iter )
+	for( std::vector<UVDBinarySymbol *>::const_iterator iter = usedSymbols.begin(); iter != usedSymbols.end(); ++iter )
 	{
-		UVDBinarySymbol *binarySymbol = (*iter).second;
+		UVDBinarySymbol *binarySymbol = *iter;
+		
 		uv_assert_ret(binarySymbol);
-		/*
-		uint32_t curSymbolAddress = 0;
+		uv_assert_err_ret(doCollectRelocations(function, binarySymbol));
+	}
 
-		uv_assert_err_ret(binarySymbol->getSymbolAddress(&curSymbolAddress));
+	return UV_ERR_OK;
+}
 
-		//Is this the matching symbol we are looking for?
-		if( functionAddress == curSymbolAddress )
+uv_err_t UVDBinarySymbolManager::getUsedSymbols(std::vector<UVDBinarySymbol *> &out)
+{
+	std::set<UVDBinarySymbol *> seen;
+
+	out.clear();
+	//Keyed once per name, only visit each symbol once
+	for( std::map<std::string, UVDBinarySymbol *>::iterator iter = m_symbols.begin(); iter != m_symbols.end(); ++iter )
+	{
+		UVDBinarySymbol *binarySymbol = (*iter).second;
+		
+		uv_assert_ret(binarySymbol);
+		if( !binarySymbol->m_symbolUsageLocations.empty() && seen.insert(binarySymbol).second )
 		{
-		*/
-			uv_assert_err_ret(doCollectRelocations(function, binarySymbol));
-		/*
-			break;
+			out.push_back(binarySymbol);
 		}
-		*/
 	}
 
 	return UV_ERR_OK;
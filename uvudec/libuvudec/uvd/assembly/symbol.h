@@ -236,6 +236,12 @@ public:
 	uv_err_t findAnalyzedSymbol(const std::string &name, UVDAnalyzedBinarySymbol **symbol);
 	uv_err_t findAnalyzedSymbolByAddress(uv_addr_t address, UVDAnalyzedBinarySymbol **symbol);
 	uv_err_t addSymbol(UVDBinarySymbol *symbol);
+	/*
+	Make name the primary name of symbol and index it
+	Old names are kept so existing lookups still work
+	Returns UV_ERR_DUPLICATE if a different symbol already has this name
+	*/
+	uv_err_t setSymbolName(UVDBinarySymbol *symbol, const std::string &name);
 	//Shortcuts for now
 	//These will create the function/label if necessary
 	/*
@@ -268,6 +274,10 @@ public:
 
 	//Find the function symbol passed in and add all relocations, if any
 	uv_err_t collectRelocations(UVDBinaryFunction *function);
+	//Same, but only looking at usedSymbols from getUsedSymbols() so it can be shared between calls
+	uv_err_t collectRelocations(UVDBinaryFunction *function, const std::vector<UVDBinarySymbol *> &usedSymbols);
+	//Symbols used somewhere, the only ones that can contribute relocations
+	uv_err_t getUsedSymbols(std::vector<UVDBinarySymbol *> &out);
 
 	uv_err_t analyzedSymbolName(uv_addr_t functionAddress, int symbolType, std::string &out);
 	//This should get moved to util
@@ -14,6 +14,7 @@ FIXME: naked arg stuff added a number of quick hacks and we should rewrite using
 #include "uvd/config/config.h"
 #include "uvd/language/language.h"
 #include "uvd/util/debug.h"
+#include "uvd/util/profile.h"
 #include "uvd/util/types.h"
 #include "uvd/util/util.h"
 #include "uvd/util/version.h"
@@ -437,6 +438,23 @@ uv_err_t UVDConfig::initArgConfig()
 				"\ttrace (recursive descent): start at all vectors, analyze all segments called/branched recursivly\n"
 				,	
 			1, argParser, false));
+	uv_assert_err_ret(registerArgument(UVD_PROP_ANALYSIS_INSTRUCTION_CACHE, 0, "instruction-cache",
+			"max decoded instructions to keep for reuse after analysis, 0 to disable",
+			1, argParser, true));
+	uv_assert_err_ret(registerArgument(UVD_PROP_ANALYSIS_THREADS, 0, "analysis-threads",
+			"threads to use for per function analysis, 0 (default) for one per CPU",
+			1, argParser, true));
+
+	//Profiling
+	uv_assert_err_ret(registerArgument(UVD_PROP_PROFILE_FILE, 0, "profile",
+			"time passes and count work done, written to given file on exit",
+			1, argParser, false));
+	uv_assert_err_ret(registerArgument(UVD_PROP_PROFILE_FORMAT, 0, "profile-format",
+			"profile output format",
+				"\tjson: scope tree with totals and counters (default)\n"
+				"\tchrome: trace events for chrome://tracing or Perfetto\n"
+				,
+			1, argParser, false));
 
 	//Output
 	uv_assert_err_ret(registerArgument(UVD_PROP_OUTPUT_OPCODE_USAGE, 0, "opcode-usage", "opcode usage count table", 1, argParser, true));
@@ -548,6 +566,30 @@ uv_err_t argParser(const UVDArgConfig *argConfig, std::vector<std::string> argum
 			return UV_DEBUG(UV_ERR_GENERAL);
 		}
 	}
+	else if( argConfig->m_propertyForm == UVD_PROP_ANALYSIS_INSTRUCTION_CACHE )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		config->m_instructionCacheSize = firstArgNum;
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_ANALYSIS_THREADS )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		config->m_analysisThreads = firstArgNum;
+	}
+	/*
+	Profile
+	*/
+	else if( argConfig->m_propertyForm == UVD_PROP_PROFILE_FILE )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		config->m_profileFile = firstArg;
+		g_profiler.enable();
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_PROFILE_FORMAT )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		uv_assert_err_ret(UVDProfiler::parseFormat(firstArg, &config->m_profileFormat));
+	}
 	/*
 	Output
 	*/
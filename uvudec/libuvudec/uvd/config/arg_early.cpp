@@ -60,11 +60,11 @@ static uv_err_t argParser(const UVDArgConfig *argConfig, std::vector<std::string
 		//Did we specify or want default?
 		if( argumentArguments.empty() )
 		{
-			config->m_debugLevel = UVD_DEBUG_VERBOSE;
+			uv_assert_err_ret(config->setDebugLevel(UVD_DEBUG_VERBOSE));
 		}
 		else
 		{
-			config->m_debugLevel = firstArgNum;
+			uv_assert_err_ret(config->setDebugLevel(firstArgNum));
 		}
 	}
 	/*
@@ -25,6 +25,9 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #define UVD_PROP_DEBUG_FILE						"debug.file"
 #define UVD_PROP_DEBUG_CURSE					"debug.curse"
 #define UVD_PROP_DEBUG_CURSE_DEFAULT			false
+//Profile
+#define UVD_PROP_PROFILE_FILE					"profile.file"
+#define UVD_PROP_PROFILE_FORMAT					"profile.format"
 //Config
 #define UVD_PROP_CONFIG_LANGUAGE				"config.language"
 #define UVD_PROP_CONFIG_LANGUAGE_INTERFACE		"config.language_interface"
@@ -40,6 +43,11 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #define UVD_PROP_ANALYSIS_ONLY					"analysis.only"
 //Recursive descent, linear sweep, etc
 #define UVD_PROP_ANALYSIS_FLOW_TECHNIQUE		"analysis.flow_technique"
+//Max decoded instructions kept between analysis and printing
+#define UVD_PROP_ANALYSIS_INSTRUCTION_CACHE		"analysis.instruction_cache"
+#define UVD_PROP_ANALYSIS_INSTRUCTION_CACHE_DEFAULT	0x40000
+//Threads for per function analysis, 0 for one per CPU
+#define UVD_PROP_ANALYSIS_THREADS				"analysis.threads"
 //Output
 #define UVD_PROP_OUTPUT_OPCODE_USAGE			"output.opcode_usage"
 #define UVD_PROP_OUTPUT_JUMPED_ADDRESSES		"output.jumped_addresses"
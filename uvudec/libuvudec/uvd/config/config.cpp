@@ -9,6 +9,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvd/config/arg_property.h"
 #include "uvd/config/config.h"
 #include "uvd/util/debug.h"
+#include "uvd/util/profile.h"
 #include "uvd/language/language.h"
 #include "uvd/util/util.h"
 #include "uvd/core/analysis.h"
@@ -46,9 +47,12 @@ UVDConfig::UVDConfig()
 	m_targetFileName = DEFAULT_DECOMPILE_FILE;
 	m_sDebugFile = UVD_OPTION_FILE_STDOUT;
 	//m_pDebugFile = NULL;
+	m_profileFormat = UVD_PROFILE_FORMAT_JSON;
 
 	m_analysisOnly = false;
 	m_flowAnalysisTechnique = UVD__FLOW_ANALYSIS__LINEAR;
+	m_instructionCacheSize = UVD_PROP_ANALYSIS_INSTRUCTION_CACHE_DEFAULT;
+	m_analysisThreads = 0;
 
 	m_rawFileSuffix = "_raw.bin";
 	m_relocatableFileSuffix = "_rel.bin";
@@ -66,6 +70,7 @@ UVDConfig::UVDConfig()
 	m_ignoreErrors = UVD_PROP_DEBUG_IGNORE_ERRORS_DEFAULT;
 	m_suppressErrors = UVD_PROP_DEBUG_SUPPRESS_ERRORS_DEFAULT;
 	m_debugLevel = UVD_DEBUG_NONE;
+	UVDSetDebugLevel(m_debugLevel);
 	clearVerboseAll();
 
 	m_hex_addr_print_width = 4;
@@ -101,8 +106,14 @@ UVDConfig::~UVDConfig()
 
 uv_err_t UVDConfig::ensureDebugLevel(uint32_t level)
 {
-	m_debugLevel = uvd_max(level, m_debugLevel);
-	return UV_ERR_OK;
+	return UV_DEBUG(setDebugLevel(uvd_max(level, m_debugLevel)));
+}
+
+uv_err_t UVDConfig::setDebugLevel(uint32_t level)
+{
+	m_debugLevel = level;
+	//Debug macros check a cached copy
+	return UV_DEBUG(UVDSetDebugLevel(level));
 }
 
 static uv_err_t setupInstallDir()
@@ -129,7 +140,7 @@ uv_err_t UVDConfig::parseMain(int argc, char *const *argv, char *const *envp)
 		{
 			printf_error("***__verbose activated***\n");
 			UVDSetDebugFlag(UVD_DEBUG_TYPE_ALL, true);
-			m_debugLevel = UVD_DEBUG_VERBOSE;
+			setDebugLevel(UVD_DEBUG_VERBOSE);
 			m_verbose = true;
 			break;
 		}
@@ -227,6 +238,7 @@ uv_err_t UVDConfig::init()
 {
 	//By default assume all addresses are potential analysis areas
 	m_addressRangeValidity.m_default = UVD_ADDRESS_ANALYSIS_INCLUDE;
+	uv_assert_err_ret(rebuildValidAddresses());
 	
 	uv_assert_err_ret(m_symbols.init());
 	
@@ -262,7 +274,7 @@ uv_err_t UVDConfig::addAddressInclusion(uint32_t low, uint32_t high)
 		m_addressRangeValidity.m_default = UVD_ADDRESS_ANALYSIS_EXCLUDE;
 	}
 	m_addressRangeValidity.add(low, high, UVD_ADDRESS_ANALYSIS_INCLUDE);
-	return UV_ERR_OK;
+	return UV_DEBUG(rebuildValidAddresses());
 }
 
 uv_err_t UVDConfig::addAddressExclusion(uint32_t low, uint32_t high)
@@ -273,18 +285,24 @@ uv_err_t UVDConfig::addAddressExclusion(uint32_t low, uint32_t high)
 		m_addressRangeValidity.m_default = UVD_ADDRESS_ANALYSIS_INCLUDE;
 	}
 	m_addressRangeValidity.add(low, high, UVD_ADDRESS_ANALYSIS_EXCLUDE);
-	return UV_ERR_OK;
+	return UV_DEBUG(rebuildValidAddresses());
 }
 
 uv_err_t UVDConfig::getValidAddressRanges(std::vector<UVDRangePair> &ranges)
+{
+	ranges = m_validAddresses.m_runs;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDConfig::rebuildValidAddresses()
 {
 	uv_err_t rc = UV_ERR_GENERAL;
 	UVDRangePair cur;
 
-	ranges.clear();
+	m_validAddresses.clear();
 	
 	//Seed it
-	rc = nextValidAddress(0, &cur.m_min);
+	rc = nextAddressState(0, &cur.m_min, UVD_ADDRESS_ANALYSIS_INCLUDE);
 	uv_assert_err_ret(rc);
 	//No valid ranges?
 	if( rc == UV_ERR_DONE )
@@ -296,7 +314,7 @@ uv_err_t UVDConfig::getValidAddressRanges(std::vector<UVDRangePair> &ranges)
 	for( ;; )
 	{
 		//Find the end range
-		rc = nextInvalidAddress(cur.m_min, &cur.m_max);
+		rc = nextAddressState(cur.m_min, &cur.m_max, UVD_ADDRESS_ANALYSIS_EXCLUDE);
 		uv_assert_err_ret(rc);
 		//Fill max range if no more and we are on a valid range till end
 		if( rc == UV_ERR_DONE )
@@ -309,7 +327,7 @@ uv_err_t UVDConfig::getValidAddressRanges(std::vector<UVDRangePair> &ranges)
 			--cur.m_max;
 		}
 		//Add the range
-		ranges.push_back(cur);
+		m_validAddresses.add(cur.m_min, cur.m_max);
 
 		//Done if we just processed the last valid range
 		if( rc == UV_ERR_DONE )
@@ -319,7 +337,7 @@ uv_err_t UVDConfig::getValidAddressRanges(std::vector<UVDRangePair> &ranges)
 		
 		//Shift
 		//We are garaunteed at least one more address since we are not at end (indicated by UV_ERR_DONE)
-		rc = nextValidAddress(cur.m_max + 1, &cur.m_min);
+		rc = nextAddressState(cur.m_max + 1, &cur.m_min, UVD_ADDRESS_ANALYSIS_INCLUDE);
 		uv_assert_err_ret(rc);
 		//No more valid addresses?
 		if( rc == UV_ERR_DONE )
@@ -357,22 +375,71 @@ uv_err_t UVDConfig::getAddressMax(uint32_t *addr)
 
 uv_err_t UVDConfig::nextValidAddress(uint32_t start, uint32_t *ret)
 {
-	return UV_DEBUG(nextAddressState(start, ret, UVD_ADDRESS_ANALYSIS_INCLUDE));
+	UVDRangePair run;
+	uv_err_t rc = UV_ERR_GENERAL;
+	
+	rc = m_validAddresses.next(start, &run);
+	uv_assert_err_ret(rc);
+	if( rc == UV_ERR_DONE )
+	{
+		return UV_ERR_DONE;
+	}
+	uv_assert_ret(ret);
+	*ret = run.m_min > start ? run.m_min : start;
+	return UV_ERR_OK;
 }
 
 uv_err_t UVDConfig::nextInvalidAddress(uint32_t start, uint32_t *ret)
 {
-	return UV_DEBUG(nextAddressState(start, ret, UVD_ADDRESS_ANALYSIS_EXCLUDE));
+	UVDRangePair run;
+	
+	uv_assert_ret(ret);
+	if( m_validAddresses.find(start, &run) == UV_ERR_NOTFOUND )
+	{
+		*ret = start;
+		return UV_ERR_OK;
+	}
+	//Runs never touch so the address after one is invalid
+	if( run.m_max == UVD_ADDR_MAX )
+	{
+		return UV_ERR_DONE;
+	}
+	*ret = run.m_max + 1;
+	return UV_ERR_OK;
 }
 
 uv_err_t UVDConfig::lastValidAddress(uint32_t start, uint32_t *ret)
 {
-	return UV_DEBUG(lastAddressState(start, ret, UVD_ADDRESS_ANALYSIS_INCLUDE));
+	UVDRangePair run;
+	uv_err_t rc = UV_ERR_GENERAL;
+	
+	rc = m_validAddresses.last(start, &run);
+	uv_assert_err_ret(rc);
+	if( rc == UV_ERR_DONE )
+	{
+		return UV_ERR_DONE;
+	}
+	uv_assert_ret(ret);
+	*ret = run.m_max < start ? run.m_max : start;
+	return UV_ERR_OK;
 }
 
 uv_err_t UVDConfig::lastInvalidAddress(uint32_t start, uint32_t *ret)
 {
-	return UV_DEBUG(lastAddressState(start, ret, UVD_ADDRESS_ANALYSIS_EXCLUDE));
+	UVDRangePair run;
+	
+	uv_assert_ret(ret);
+	if( m_validAddresses.find(start, &run) == UV_ERR_NOTFOUND )
+	{
+		*ret = start;
+		return UV_ERR_OK;
+	}
+	if( run.m_min == 0 )
+	{
+		return UV_ERR_DONE;
+	}
+	*ret = run.m_min - 1;
+	return UV_ERR_OK;
 }
 
 uv_err_t UVDConfig::nextAddressState(uint32_t start, uint32_t *ret, uint32_t targetState)
@@ -14,7 +14,9 @@ Things such as interpreting results and converting to generic structures
 #include "uvd/core/block.h"
 #include "uvd/architecture/architecture.h"
 #include "uvd/assembly/cpu_vector.h"
+#include "uvd/assembly/function.h"
 #include "uvd/util/benchmark.h"
+#include "uvd/util/profile.h"
 #include "uvd/util/util.h"
 #include "uvd/core/runtime.h"
 
@@ -83,8 +85,68 @@ uv_err_t UVD::mapSymbols()
 	return UV_ERR_OK;
 }
 
+uv_err_t UVD::constructFunctions()
+{
+	/*
+	Call targets are the only function entry points we know of
+	Like linear analysis, a function takes everything up to the next one
+	*/
+	UVDProfileScope profileScope("construct_functions");
+	UVDAddressSpace *space = NULL;
+	UVDAnalyzedMemoryRanges::const_iterator calledBegin;
+	UVDAnalyzedMemoryRanges::const_iterator calledEnd;
+	uint32_t dataSize = 0;
+
+	uv_assert_ret(m_analyzer);
+	uv_assert_err_ret(m_runtime->getPrimaryExecutableAddressSpace(&space));
+	uv_assert_ret(space);
+	uv_assert_ret(space->m_data);
+	uv_assert_err_ret(space->m_data->size(&dataSize));
+	if( dataSize == 0 )
+	{
+		return UV_ERR_OK;
+	}
+	uv_assert_err_ret(m_analyzer->getReferencedAddressRange(0, dataSize - 1, UVD_MEMORY_REFERENCE_CALL_DEST, &calledBegin, &calledEnd));
+
+	for( UVDAnalyzedMemoryRanges::const_iterator iter = calledBegin; iter != calledEnd; ++iter )
+	{
+		uv_addr_t functionStart = (*iter)->m_min_addr;
+		uv_addr_t functionEnd = dataSize;
+		UVDBinarySymbol *existing = NULL;
+		UVDBinaryFunction *function = NULL;
+		UVDDataChunk *dataChunk = NULL;
+		std::string symbolName;
+
+		if( iter + 1 != calledEnd )
+		{
+			functionEnd = (*(iter + 1))->m_min_addr;
+		}
+		//Already built by an earlier analyze() or claimed by another kind of symbol
+		if( UV_SUCCEEDED(m_analyzer->m_symbolManager.findSymbolByAddress(functionStart, &existing)) )
+		{
+			continue;
+		}
+
+		dataChunk = new UVDDataChunk();
+		uv_assert_ret(dataChunk);
+		uv_assert_err_ret(dataChunk->init(space->m_data, functionStart, functionEnd));
+
+		uv_assert_err_ret(UVDBinaryFunction::getUVDBinaryFunctionInstance(&function));
+		uv_assert_ret(function);
+		uv_assert_err_ret(function->setSymbolAddress(functionStart));
+		uv_assert_err_ret(m_analyzer->m_symbolManager.analyzedSymbolName(functionStart, UVD__SYMBOL_TYPE__FUNCTION, symbolName));
+		function->setSymbolName(symbolName);
+		uv_assert_err_ret(function->transferData(dataChunk));
+		uv_assert_err_ret(m_analyzer->loadFunction(function));
+	}
+	printf_debug_level(UVD_DEBUG_PASSES, "constructed %d functions\n", m_analyzer->m_functions.size());
+
+	return UV_ERR_OK;
+}
+
 uv_err_t UVD::analyzeControlFlow()
 {
+	UVDProfileScope profileScope("control_flow");
 	UVDBenchmark controlStructureAnalysisBenchmark;
 
 	printf_debug_level(UVD_DEBUG_PASSES, "uvd: control flow analysis...\n");
@@ -160,6 +222,7 @@ uv_err_t UVD::analyzeControlFlowLinear()
 		
 		if( instruction ) {
 			//printf("\n\nAnalysis at: 0x%.8X\n", startPos);		
+			uv_assert_err_ret(m_analyzer->m_instructionBoundaries.set(startPos));
 			uv_assert_err_ret(instruction->analyzeControlFlow());
 		}
 
@@ -177,130 +240,216 @@ uv_err_t UVD::suspectValidInstruction(uint32_t address, int *isValid)
 	Oftentimes these will be 0xFF or 0x00 when unused
 	Also consider if address is in a string table or other blacklisted area
 	*/
+	uint32_t nextValid = 0;
+	uv_err_t rcTemp = UV_ERR_GENERAL;
+
 	uv_assert_ret(isValid);
+	uv_assert_ret(m_config);
+	
+	//At least must be in a range we were told to analyze
+	rcTemp = m_config->nextValidAddress(address, &nextValid);
+	uv_assert_err_ret(rcTemp);
+	*isValid = rcTemp != UV_ERR_DONE && nextValid == address;
 	
-	//FIXME: do check
-	*isValid = true;
+	return UV_ERR_OK;
+}
+
+/*
+Called when the trace reaches an address something else already decoded
+If its an instruction boundary inside of a block, split the block so that address starts one
+Otherwise we are misaligned with earlier decoding and the address is ignored
+*/
+static uv_err_t traceJoinBlock(UVDBlockGroup *blocks, const UVDInstructionBoundaries &instructionAddresses,
+		const UVDAddress &address, const UVDBasicBlockSet &existing)
+{
+	UVDBasicBlock *block = NULL;
+
+	//Blocks created by the trace never overlap
+	uv_assert_ret(existing.size() == 1);
+	block = *existing.begin();
+	uv_assert_ret(block);
 	
+	if( !instructionAddresses.isSet(address) )
+	{
+		printf_warn("trace: 0x%08X is inside of an instruction already decoded, ignoring\n", address.m_addr);
+		return UV_ERR_OK;
+	}
+	if( block->min() != address.m_addr )
+	{
+		uv_assert_err_ret(blocks->split(block, address.m_addr, NULL));
+	}
 	return UV_ERR_OK;
 }
 
 uv_err_t UVD::analyzeControlFlowTrace()
 {
-	printf_debug_level(UVD_DEBUG_PASSES, "control flow analysis trace / recursive descent\n");
-	//For now only try to find where code is, so it doesn't matter how we arrived
-	std::set<uint32_t> openSet;
-	std::set<uint32_t> closedSet;
+	/*
+	Recursive descent
+	Start at each vector and decode until control flow can't continue to the next instruction
+	Resolved call and jump targets are added to a worklist and traced the same way
+	Each block of straight line code is recorded as a basic block
+	Anything a block already covers is not decoded again
+	*/
 	
-	//Probably need full ranges, do only start for now
-	std::set<uint32_t> calls;
-	std::set<uint32_t> jumps;
-	//uv_addr_t numberAnalyzedBytes = 0;
+	//Block start addresses that haven't been traced yet
+	std::vector<uv_addr_t> worklist;
+	//Block start addresses we have already tried
+	std::set<uv_addr_t> closedSet;
+	//Start of every decoded instruction so we can tell if a branch target is aligned
+	//Kept by the analyzer afterwards for going backwards
+	UVDInstructionBoundaries *instructionAddresses = NULL;
+	UVDBlockGroup *blocks = NULL;
+	UVDAddressSpace *addressSpace = NULL;
+	UVDInstructionIterator end;
+	uv_addr_t decodedBytes = 0;
+	
+	printf_debug_level(UVD_DEBUG_PASSES, "control flow analysis trace / recursive descent\n");
 	
 	uv_assert_ret(m_runtime->m_architecture);
 	uv_assert_ret(m_config);
-	//uv_assert_err_ret(m_analyzer->getNumberAnalyzedBytes(&numberAnalyzedBytes));
+	uv_assert_ret(m_analyzer);
+
+	uv_assert_err_ret(m_runtime->getPrimaryExecutableAddressSpace(&addressSpace));
+	uv_assert_ret(addressSpace);
+	blocks = &m_analyzer->m_basicBlocks;
+	uv_assert_err_ret(blocks->deinit());
+	uv_assert_err_ret(blocks->init(addressSpace));
+	instructionAddresses = &m_analyzer->m_instructionBoundaries;
+	instructionAddresses->clear(addressSpace);
 
 	//Another way to do with would be to do "START" and then all other vectors
-	for( std::vector<UVDCPUVector *>::iterator iter = m_runtime->m_architecture->m_vectors.begin();
-			iter != m_runtime->m_architecture->m_vectors.end(); ++iter )
+	//Push in reverse so that vectors are traced in the order they were given
+	for( std::vector<UVDCPUVector *>::reverse_iterator iter = m_runtime->m_architecture->m_vectors.rbegin();
+			iter != m_runtime->m_architecture->m_vectors.rend(); ++iter )
 	{
 		UVDCPUVector *vector = *iter;
 		
 		uv_assert_ret(vector);
-		openSet.insert(vector->m_offset);
+		worklist.push_back(vector->m_offset);
 	}
 	
-	UVDInstructionIterator end;
 	uv_assert_err_ret(instructionEnd(end));
 	
-	while( !openSet.empty() )
+	while( !worklist.empty() )
 	{
-		uint32_t nextStartAddress = *openSet.begin();
+		uv_addr_t blockStart = worklist.back();
+		uv_addr_t blockEnd = 0;
+		bool decodedAny = false;
 		UVDInstructionIterator iter;
+		UVDBasicBlockSet existing;
 		int isVectorValid = 0;
 
-		openSet.erase(openSet.begin());
+		worklist.pop_back();
 		//Did we already try to process it?
-		if( closedSet.find(nextStartAddress) != closedSet.end() )
+		if( closedSet.find(blockStart) != closedSet.end() )
 		{
 			continue;
 		}
-		closedSet.insert(nextStartAddress);
+		closedSet.insert(blockStart);
 	
-		//Make sure it seems reasonable
-		uv_assert_err_ret(suspectValidInstruction(nextStartAddress, &isVectorValid));
+		//Branch into something we already decoded?
+		uv_assert_err_ret(blocks->getAtAddress(blockStart, &existing));
+		if( !existing.empty() )
 		{
+			uv_assert_err_ret(traceJoinBlock(blocks, *instructionAddresses, UVDAddress(blockStart, addressSpace), existing));
+			continue;
+		}
+	
+		//Make sure it seems reasonable
+		uv_assert_err_ret(suspectValidInstruction(blockStart, &isVectorValid));
 		if( !isVectorValid )
-			printf_warn("ignoring address: 0x%08X\n", nextStartAddress);
+		{
+			printf_warn("ignoring address: 0x%08X\n", blockStart);
 			continue;
 		}
 
 		//Keep going until we hit a branch point
-
-		//uint32_t printPercentage = 1;
-		//uint32_t printNext = printPercentage;
-
-		uv_assert_err_ret(instructionBeginByAddress(nextStartAddress, iter));
+		uv_assert_err_ret(instructionBeginByAddress(UVDAddress(blockStart, addressSpace), iter));
 		for( ;; )
 		{
 			UVDInstructionAnalysis instructionAnalysis;
-			//std::string action;
-			//uint32_t startPos = iter.getPosition();
-			//uint32_t endPos = 0;
+			UVDInstruction *instruction = NULL;
+			UVDAddress address;
+			uv_addr_t followingAddress = 0;
+
+			if( iter == end )
+			{
+				printf_debug("trace: end of address space\n");
+				break;
+			}
+			uv_assert_err_ret(iter.getAddress(&address));
 			
-			/*
-			if( numberAnalyzedBytes )
+			//Fell through into code found earlier
+			if( decodedAny )
 			{
-				uint32_t curPercent = 100 * startPos / numberAnalyzedBytes;
-				if( curPercent >= printNext )
+				existing.clear();
+				uv_assert_err_ret(blocks->getAtAddress(address.m_addr, &existing));
+				if( !existing.empty() )
 				{
-					printf_debug_level(UVD_DEBUG_SUMMARY, "uvd: raw control structure analysis: %d %%\n", curPercent);
-					printNext += printPercentage;
+					uv_assert_err_ret(traceJoinBlock(blocks, *instructionAddresses, address, existing));
+					break;
 				}
 			}
-			*/
-
-			UVDInstruction *instruction = NULL;
-
-			//printf_debug("\n\nAnalysis at: 0x%.8X\n", startPos);
 
-			//XXX is this really correct?  what if we jumped towards the end
-			//should be more of a continue
-			if( iter == end )
+			uv_assert_err_ret(iter.get(&instruction));
+			uv_assert_ret(instruction);
+			//Don't let a block run over the start of another
+			followingAddress = address.m_addr + instruction->m_inst_size;
+			if( instruction->m_inst_size > 1 )
 			{
-				printf_debug("disassemble: end");
-				break;
+				existing.clear();
+				uv_assert_err_ret(blocks->getAtAddresses(UVDAddressRange(address.m_addr + 1, followingAddress - 1), &existing));
+				if( !existing.empty() )
+				{
+					printf_warn("trace: instruction at 0x%08X overlaps earlier decoding, stopping\n", address.m_addr);
+					break;
+				}
 			}
-			uv_assert_err_ret(iter.get(&instruction));
-			//endPos = iter.getPosition();
 			
-			//action = instruction.m_shared->m_action;
-
-			//printf_debug("Next instruction (start: 0x%.8X, end: 0x%.8X): %s\n", startPos, endPos, instruction.m_shared->m_memoric.c_str());
+			uv_assert_err_ret(instructionAddresses->set(address));
+			blockEnd = followingAddress - 1;
+			decodedAny = true;
+			decodedBytes += instruction->m_inst_size;
 
-			//printf_debug("Action: %s, type: %d\n", action.c_str(), instruction.m_shared->m_inst_class);
 			uv_assert_err_ret(instruction->analyzeControlFlow(&instructionAnalysis));
 			//Only care about resolved targets
-			if( instructionAnalysis.m_isJump == UVD_TRI_TRUE || instructionAnalysis.m_isCall == UVD_TRI_TRUE )
+			if( instructionAnalysis.m_isCall == UVD_TRI_TRUE )
 			{
-				openSet.insert(nextStartAddress);
+				worklist.push_back(instructionAnalysis.m_callTarget);
+			}
+			if( instructionAnalysis.m_isJump == UVD_TRI_TRUE )
+			{
+				worklist.push_back(instructionAnalysis.m_jumpTarget);
+				//Conditional branches end the block but may also fall through
+				if( instructionAnalysis.m_isConditional )
+				{
+					worklist.push_back(followingAddress);
+				}
+				break;
 			}
-			//Unconditional jumps mean end of sweep
 			//TODO: also consider adding something for noreturn type functions?
 			//rare on embedded platforms?
-			if( instructionAnalysis.m_isJump == UVD_TRI_TRUE && !instructionAnalysis.m_isConditional )
+			if( instructionAnalysis.m_isReturn )
 			{
-				//Straight JMP style instruction
 				break;
 			}
 
 			//If we aren't at end, there should be more data
 			uv_assert_err_ret(iter.next());
 		}
+		
+		if( decodedAny )
+		{
+			UVDBasicBlock *block = new UVDBasicBlock(UVDAddressRange(blockStart, blockEnd, addressSpace));
+			
+			uv_assert_ret(block);
+			uv_assert_err_ret(blocks->add(block));
+		}
 	}
 	
-	return UV_DEBUG(UV_ERR_GENERAL);
+	printf_debug_level(UVD_DEBUG_SUMMARY, "trace: %d basic blocks, 0x%08X bytes decoded\n", blocks->size(), decodedBytes);
+	
+	return UV_ERR_OK;
 }
 
 uv_err_t UVD::analyzeConstData()
@@ -311,6 +460,7 @@ uv_err_t UVD::analyzeConstData()
 
 uv_err_t UVD::analyze()
 {
+	UVDProfileScope profileScope("analyze");
 	uv_err_t rc = UV_ERR_GENERAL;
 	int verbose_pre = 0;
 	
@@ -320,10 +470,19 @@ uv_err_t UVD::analyze()
 	
 	m_config->m_verbose = m_config->m_verbose_analysis;	
 	
+	//Anything decoded before is from an old configuration
+	uv_assert_ret(m_analyzer);
+	m_analyzer->invalidateInstructionCache();
+	m_analyzer->m_instructionBoundaries.clear();
+	m_analyzer->invalidateLineIndex();
+	
 	//Strings must be found first to find ROM data to exclude from disassembly
 	uv_assert_err(analyzeConstData());
 	//Then find constrol flow
 	uv_assert_err(analyzeControlFlow());
+	//Once call targets are known, functions and their symbols
+	uv_assert_err(constructFunctions());
+	uv_assert_err(mapSymbols());
 	
 	//Now that instructions have undergone basic processing,
 	//turn code into blocks using the control flow
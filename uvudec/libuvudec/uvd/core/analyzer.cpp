@@ -14,6 +14,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvd/event/engine.h"
 #include "uvd/string/engine.h"
 #include "uvd/util/benchmark.h"
+#include "uvd/util/profile.h"
 #include <algorithm>
 #include <stdio.h>
 
@@ -188,34 +189,67 @@ uv_err_t UVDAnalyzer::init(UVD *uvd)
 	m_stringEngine = new UVDStringEngine();
 	uv_assert_err_ret(m_stringEngine->init(m_uvd));
 	
+	uv_assert_ret(m_uvd->m_config);
+	uv_assert_err_ret(m_instructionCache.init(m_uvd->m_config->m_instructionCacheSize));
+	uv_assert_err_ret(m_lineIndex.init(m_uvd));
+	
 	return UV_ERR_OK;
 }
 
+void UVDAnalyzer::invalidateInstructionCache()
+{
+	m_instructionCache.invalidate();
+}
+
+uv_err_t UVDAnalyzer::getThreadPool(UVDThreadPool **out)
+{
+	uv_assert_ret(out);
+	if( !m_threadPool.isInitialized() )
+	{
+		uv_assert_ret(m_uvd);
+		uv_assert_ret(m_uvd->m_config);
+		uv_assert_err_ret(m_threadPool.init(m_uvd->m_config->m_analysisThreads));
+	}
+	*out = &m_threadPool;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDAnalyzer::getLineIndex(UVDPrintLineIndex **out)
+{
+	uv_assert_ret(out);
+	*out = &m_lineIndex;
+	return UV_ERR_OK;
+}
+
+void UVDAnalyzer::invalidateLineIndex()
+{
+	m_lineIndex.invalidate();
+}
+
 uv_err_t UVDAnalyzer::deinit()
 {
 	//delete m_block;
 	//m_block = NULL;
 
-	for( std::set<UVDBinaryFunction *>::iterator iter = m_functions.begin(); iter != m_functions.end(); ++iter )
-	{
-		UVDBinaryFunction *binaryFunction = *iter;
-		
-		uv_assert_ret(binaryFunction);
-		//This is only stored here since its from current analysis and not in a central DB
-		//delete binaryFunction->m_shared;
-		//binaryFunction->m_shared = NULL;
-		
-		delete binaryFunction;
-	}
+	//Functions are registered symbols, freed with the rest of them
 	m_functions.clear();
+	uv_assert_err_ret(m_symbolManager.deinit());
 
 	for( UVDAnalyzedMemorySpace::iterator iter = m_referencedAddresses.begin(); iter != m_referencedAddresses.end(); ++iter )
 	{
 		delete (*iter).second;
 	}
 	m_referencedAddresses.clear();
+	m_referenceIndexes.clear();
 	
+	m_instructionCache.deinit();
+	m_instructionBoundaries.deinit();
+	m_lineIndex.deinit();
+	m_basicBlocks.deinit();
+	m_threadPool.deinit();
+
 	delete m_stringEngine;
+	m_stringEngine = NULL;
 
 	m_uvd = NULL;
 
@@ -229,6 +263,11 @@ uv_err_t UVDAnalyzer::insertReference(uint32_t targetAddress, uint32_t from, uin
 
 	printf_debug("UVDAnalyzer: inserting reference to 0x%.8X from 0x%.8X of type %d\n", targetAddress, from, type);
 
+	//Types may have changed, rebuild on next query
+	m_referenceIndexes.clear();
+	//References are printed as comments
+	m_lineIndex.invalidate();
+
 	//Ensure analyzed location existance
 	if( m_referencedAddresses.find(targetAddress) == m_referencedAddresses.end() )
 	{
@@ -341,12 +380,90 @@ uv_err_t UVDAnalyzer::getJumpedAddresses(UVDAnalyzedMemorySpace &jumpedAddresses
 	return UV_DEBUG(getAddresses(jumpedAddresses, UVD_MEMORY_REFERENCE_JUMP_DEST));
 }
 
+//For binary searching the reference indexes
+static bool referencedAddressLess(const UVDAnalyzedMemoryRange *l, uv_addr_t r)
+{
+	return l->m_min_addr < r;
+}
+
+static bool referencedAddressGreater(uv_addr_t l, const UVDAnalyzedMemoryRange *r)
+{
+	return l < r->m_min_addr;
+}
+
+uv_err_t UVDAnalyzer::getReferenceIndex(uint32_t type, const UVDAnalyzedMemoryRanges **out)
+{
+	std::map<uint32_t, UVDAnalyzedMemoryRanges>::iterator indexIter;
+	
+	uv_assert_ret(out);
+	
+	indexIter = m_referenceIndexes.find(type);
+	if( indexIter == m_referenceIndexes.end() )
+	{
+		UVDAnalyzedMemoryRanges &index = m_referenceIndexes[type];
+		
+		//Map is keyed by address so this comes out sorted
+		for( UVDAnalyzedMemorySpace::iterator iter = m_referencedAddresses.begin(); iter != m_referencedAddresses.end(); ++iter )
+		{
+			UVDAnalyzedMemoryRange *memoryLocation = (*iter).second;
+			
+			uv_assert_ret(memoryLocation);
+			if( type == UVD_MEMORY_REFERENCE_NONE || memoryLocation->getReferenceTypes() & type )
+			{
+				index.push_back(memoryLocation);
+			}
+		}
+		*out = &index;
+	}
+	else
+	{
+		*out = &(*indexIter).second;
+	}
+	
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDAnalyzer::getReferencedAddress(uv_addr_t address, uint32_t type, UVDAnalyzedMemoryRange **out)
+{
+	const UVDAnalyzedMemoryRanges *index = NULL;
+	UVDAnalyzedMemoryRanges::const_iterator iter;
+	
+	uv_assert_ret(out);
+	uv_assert_err_ret(getReferenceIndex(type, &index));
+	
+	iter = std::lower_bound(index->begin(), index->end(), address, referencedAddressLess);
+	if( iter == index->end() || (*iter)->m_min_addr != address )
+	{
+		return UV_ERR_NOTFOUND;
+	}
+	*out = *iter;
+	
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDAnalyzer::getReferencedAddressRange(uv_addr_t minAddress, uv_addr_t maxAddress, uint32_t type,
+		UVDAnalyzedMemoryRanges::const_iterator *begin, UVDAnalyzedMemoryRanges::const_iterator *end)
+{
+	const UVDAnalyzedMemoryRanges *index = NULL;
+	
+	uv_assert_ret(begin);
+	uv_assert_ret(end);
+	uv_assert_ret(minAddress <= maxAddress);
+	uv_assert_err_ret(getReferenceIndex(type, &index));
+	
+	*begin = std::lower_bound(index->begin(), index->end(), minAddress, referencedAddressLess);
+	*end = std::upper_bound(*begin, index->end(), maxAddress, referencedAddressGreater);
+	
+	return UV_ERR_OK;
+}
+
 uv_err_t UVDAnalyzer::loadFunction(UVDBinaryFunction *function)
 {
 	uv_assert_ret(function);
 	uv_assert_ret(function->m_relocatableData.getData());
 
 	//Register it as a found function
+	uv_assert_err_ret(m_symbolManager.addSymbol(function));
 	m_functions.insert(function);
 	
 	//Tell the world
@@ -358,29 +475,123 @@ uv_err_t UVDAnalyzer::loadFunction(UVDBinaryFunction *function)
 	return UV_ERR_OK;
 }
 
+static bool functionAddressLess(UVDBinaryFunction *a, UVDBinaryFunction *b)
+{
+	uv_addr_t aAddress = 0;
+	uv_addr_t bAddress = 0;
+
+	a->getSymbolAddress(&aAddress);
+	b->getSymbolAddress(&bAddress);
+	return aAddress < bAddress;
+}
+
+uv_err_t UVDAnalyzer::getFunctionsByAddress(std::vector<UVDBinaryFunction *> &out)
+{
+	out.assign(m_functions.begin(), m_functions.end());
+	std::sort(out.begin(), out.end(), functionAddressLess);
+	return UV_ERR_OK;
+}
+
+/*
+mapSymbols() work shared between the pool threads
+Each index only touches its own function and its own m_links slot
+*/
+class UVDMapSymbolsJob
+{
+public:
+	UVDAnalyzer *m_analyzer;
+	std::vector<UVDBinaryFunction *> m_functions;
+	//Symbols that have uses to collect, only these can add relocations to a function
+	std::vector<UVDBinarySymbol *> m_usedSymbols;
+	//Indexed same as m_functions
+	std::vector<UVDSymbolLinks> m_links;
+};
+
+static uv_err_t mapSymbolsFunction(uint32_t index, uint32_t, void *user)
+{
+	UVDMapSymbolsJob *job = (UVDMapSymbolsJob *)user;
+	UVDBinaryFunction *function = NULL;
+	
+	uv_assert_ret(job);
+	uv_assert_ret(index < job->m_functions.size());
+	function = job->m_functions[index];
+	uv_assert_ret(function);
+
+	//Get all the relocations for this particular function and register the fixups
+	uv_assert_err_ret(job->m_analyzer->m_symbolManager.collectRelocations(function, job->m_usedSymbols));
+	//Figure out default symbol names, but leave linking to the merge
+	uv_assert_err_ret(job->m_analyzer->resolveDefaultSymbolNames(function, &job->m_links[index]));
+	
+	return UV_ERR_OK;
+}
+
 uv_err_t UVDAnalyzer::mapSymbols()
 {
-	//For each function, find its associated symbols
-	//This algorithm can be made linear for some extra interaction
-	for( std::set<UVDBinaryFunction *>::iterator iter = m_functions.begin(); iter != m_functions.end(); ++iter )
-	{
-		UVDBinaryFunction *function = *iter;
-		uv_assert_ret(function);
+	UVDProfileScope profileScope("map_symbols");
+	UVDMapSymbolsJob job;
+	UVDThreadPool *threadPool = NULL;
+	UVDBenchmark benchmark;
 
-		//Get all the relocations for this particular function and register the fixups
-		uv_assert_err_ret(m_symbolManager.collectRelocations(function));
-	}
+	/*
+	For each function, find its associated symbols
+	This algorithm can be made linear for some extra interaction
+	
+	Functions only read the symbol tables here so they are sharded across the pool
+	Results are merged in address order so output doesn't depend on thread count or heap layout
+	*/
+	benchmark.start();
+	job.m_analyzer = this;
+	uv_assert_err_ret(getFunctionsByAddress(job.m_functions));
+	uv_assert_err_ret(m_symbolManager.getUsedSymbols(job.m_usedSymbols));
+	job.m_links.resize(job.m_functions.size());
+	
+	uv_assert_err_ret(getThreadPool(&threadPool));
+	uv_assert_err_ret(threadPool->run(job.m_functions.size(), mapSymbolsFunction, &job));
 
-	//Assign default symbol names
-	uv_assert_err_ret(assignDefaultSymbolNames());
+	for( std::vector<UVDSymbolLinks>::iterator iter = job.m_links.begin(); iter != job.m_links.end(); ++iter )
+	{
+		uv_assert_err_ret(applySymbolLinks(*iter));
+	}
+	benchmark.stop();
+	printf_debug_level(UVD_DEBUG_PASSES, "symbol mapping: %d functions on %d threads, time: %s\n",
+			job.m_functions.size(), threadPool->getThreadCount(), benchmark.toString().c_str());
 		
 	//Use object file database to identify previously known functions
-	identifyKnownFunctions();
+	uv_assert_err_ret(identifyKnownFunctions());
 	
 	return UV_ERR_OK;
 }
 
 uv_err_t UVDAnalyzer::assignDefaultSymbolNames()
+{
+	/*
+	Loop through all functions
+	*/
+	//printf("Functions: %d\n", m_functions.size());
+	for( std::set<UVDBinaryFunction *>::iterator iterFunctions = m_functions.begin();
+			iterFunctions != m_functions.end(); ++iterFunctions )
+	{
+		UVDSymbolLinks links;
+		
+		uv_assert_err_ret(resolveDefaultSymbolNames(*iterFunctions, &links));
+		uv_assert_err_ret(applySymbolLinks(links));
+	}
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDAnalyzer::applySymbolLinks(const UVDSymbolLinks &links)
+{
+	for( UVDSymbolLinks::const_iterator iter = links.begin(); iter != links.end(); ++iter )
+	{
+		uv_assert_ret((*iter).first);
+		(*iter).first->m_binarySymbol = (*iter).second;
+	}
+	
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDAnalyzer::resolveDefaultSymbolNames(UVDBinaryFunction *function, UVDSymbolLinks *out)
 {
 	/*
 	Although the UVDBinarySymbol objects already have names,
@@ -390,103 +601,93 @@ uv_err_t UVDAnalyzer::assignDefaultSymbolNames()
 	This is done by doing address lookups
 	*/
 	
-	//printf("Default sym names\n");
-
+	UVDBinaryFunction *functionInstance = NULL;
+	
+	uv_assert_ret(out);
+	uv_assert_ret(function);
+	functionInstance = function;
+	uv_assert_ret(functionInstance);
 	/*
-	Loop through all functions
+	{
+		std::string name;
+		uint32_t size = 0;
+		uv_assert_err_ret(functionInstance->getSymbolName(name));
+		uv_assert_err_ret(functionInstance->getSymbolSize(&size));
+		printf("Function: %s, size: 0x%.4X\n", name.c_str(), size);
+	}
 	*/
-	//printf("Functions: %d\n", m_functions.size());
-	for( std::set<UVDBinaryFunction *>::iterator iterFunctions = m_functions.begin();
-			iterFunctions != m_functions.end(); ++iterFunctions )
+	/*
+	For all of the places we have to patch this symbol, 
+	make sure each of those symbols we must resolve will have a name associated with them
+	*/
+	for( std::set<UVDRelocationFixup *>::iterator iter = functionInstance->m_relocatableData.m_fixups.begin();
+			iter != functionInstance->m_relocatableData.m_fixups.end(); ++iter )
 	{
-		UVDBinaryFunction *function = *iterFunctions;
-		UVDBinaryFunction *functionInstance = NULL;
+		UVDRelocationFixup *fixup = *iter;
+		UVDRelocatableElement *relocatableElement = NULL;
+		UVDBinarySymbolElement *binarySymbolElement = NULL;
+		UVDBinarySymbol *relocationsSymbol = NULL;
+		uint32_t symbolAddress = 0;
+		
+		uv_assert_ret(fixup);		
+		relocatableElement = fixup->m_symbol;
+		uv_assert_ret(relocatableElement);
 		
-		uv_assert_ret(function);			
-		functionInstance = function;
-		uv_assert_ret(functionInstance);
-		/*
+		//Relocations from analysis should be of this type
+		binarySymbolElement = dynamic_cast<UVDBinarySymbolElement *>(relocatableElement);
+		uv_assert_ret(binarySymbolElement);
+		
+		//What was the recorded address of this symbol?
+		uv_assert_err_ret(binarySymbolElement->getDynamicValue(&symbolAddress));
+		//Fetch the associated UVDBinarySYmbol
+		uv_assert_err_ret(m_symbolManager.findSymbolByAddress(symbolAddress, &relocationsSymbol));
+		uv_assert_ret(relocationsSymbol);
 		{
-			std::string name;
-			uint32_t size = 0;
-			uv_assert_err_ret(functionInstance->getSymbolName(name));
-			uv_assert_err_ret(functionInstance->getSymbolSize(&size));
-			printf("Function: %s, size: 0x%.4X\n", name.c_str(), size);
+			std::string s;
+			//uint32_t size = 0;
+			uv_assert_err_ret(relocationsSymbol->getSymbolName(s));
+			//uv_assert_err_ret(relocationsSymbol->getSymbolSize(size));
+			uv_assert_ret(!s.empty());
+			//printf("\tfixup %s @ 0x%.4X\n", s.c_str(), fixup->m_offset);
 		}
-		*/
-		/*
-		For all of the places we have to patch this symbol, 
-		make sure each of those symbols we must resolve will have a name associated with them
-		*/
-		for( std::set<UVDRelocationFixup *>::iterator iter = functionInstance->m_relocatableData.m_fixups.begin();
-				iter != functionInstance->m_relocatableData.m_fixups.end(); ++iter )
+		//early sanity check
 		{
-			UVDRelocationFixup *fixup = *iter;
-			UVDRelocatableElement *relocatableElement = NULL;
-			UVDBinarySymbolElement *binarySymbolElement = NULL;
-			UVDBinarySymbol *relocationsSymbol = NULL;
-			uint32_t symbolAddress = 0;
-			
-			uv_assert_ret(fixup);		
-			relocatableElement = fixup->m_symbol;
-			uv_assert_ret(relocatableElement);
-			
-			//Relocations from analysis should be of this type
-			binarySymbolElement = dynamic_cast<UVDBinarySymbolElement *>(relocatableElement);
-			uv_assert_ret(binarySymbolElement);
-			
-			//What was the recorded address of this symbol?
-			uv_assert_err_ret(binarySymbolElement->getDynamicValue(&symbolAddress));
-			//Fetch the associated UVDBinarySYmbol
-			uv_assert_err_ret(m_symbolManager.findSymbolByAddress(symbolAddress, &relocationsSymbol));
-			uv_assert_ret(relocationsSymbol);
-			{
-				std::string s;
-				//uint32_t size = 0;
-				uv_assert_err_ret(relocationsSymbol->getSymbolName(s));
-				//uv_assert_err_ret(relocationsSymbol->getSymbolSize(size));
-				uv_assert_ret(!s.empty());
-				//printf("\tfixup %s @ 0x%.4X\n", s.c_str(), fixup->m_offset);
-			}
-			//early sanity check
-			{
-				uint32_t size = 0;
-				uv_assert_err_ret(functionInstance->getSymbolSize(&size));
-				uv_assert_ret(fixup->m_offset < size);
-			}
-			//And link them
-			binarySymbolElement->m_binarySymbol = relocationsSymbol;
+			uint32_t size = 0;
+			uv_assert_err_ret(functionInstance->getSymbolSize(&size));
+			uv_assert_ret(fixup->m_offset < size);
 		}
+		//And link them
+		out->push_back(std::make_pair(binarySymbolElement, relocationsSymbol));
+	}
 
-		/*
-		These are all of the locations this symbol is used
-		This is not really used here it seems
-		*/
-		for( std::set<UVDRelocationFixup *>::iterator iterUsage = functionInstance->m_symbolUsageLocations.begin();
-				iterUsage != functionInstance->m_symbolUsageLocations.end(); ++iterUsage )
-		{
-			UVDRelocationFixup *fixup = *iterUsage;
-			UVDRelocatableElement *relocatableElement = NULL;
-			UVDBinarySymbolElement *binarySymbolElement = NULL;
-			UVDBinarySymbol *relocationsSymbol = NULL;
-			uint32_t symbolAddress = 0;
-
-			uv_assert_ret(fixup);
-			relocatableElement = fixup->m_symbol;
-			uv_assert_ret(relocatableElement);
-			
-			//Relocations from analysis should be of this type
-			binarySymbolElement = dynamic_cast<UVDBinarySymbolElement *>(relocatableElement);
-			uv_assert_ret(binarySymbolElement);
-			
-			//What was the recorded address of this symbol?
-			uv_assert_err_ret(binarySymbolElement->getDynamicValue(&symbolAddress));
-			//Fetch the associated UVDBinarySYmbol
-			uv_assert_err_ret(m_symbolManager.findSymbolByAddress(symbolAddress, &relocationsSymbol));
-			uv_assert_ret(relocationsSymbol);
-			//And link them
-			binarySymbolElement->m_binarySymbol = relocationsSymbol;
-		}
+	/*
+	These are all of the locations this symbol is used
+	This is not really used here it seems
+	*/
+	for( std::set<UVDRelocationFixup *>::iterator iterUsage = functionInstance->m_symbolUsageLocations.begin();
+			iterUsage != functionInstance->m_symbolUsageLocations.end(); ++iterUsage )
+	{
+		UVDRelocationFixup *fixup = *iterUsage;
+		UVDRelocatableElement *relocatableElement = NULL;
+		UVDBinarySymbolElement *binarySymbolElement = NULL;
+		UVDBinarySymbol *relocationsSymbol = NULL;
+		uint32_t symbolAddress = 0;
+
+		uv_assert_ret(fixup);
+		relocatableElement = fixup->m_symbol;
+		uv_assert_ret(relocatableElement);
+		
+		//Relocations from analysis should be of this type
+		binarySymbolElement = dynamic_cast<UVDBinarySymbolElement *>(relocatableElement);
+		uv_assert_ret(binarySymbolElement);
+		
+		//What was the recorded address of this symbol?
+		uv_assert_err_ret(binarySymbolElement->getDynamicValue(&symbolAddress));
+		//Fetch the associated UVDBinarySYmbol
+		uv_assert_err_ret(m_symbolManager.findSymbolByAddress(symbolAddress, &relocationsSymbol));
+		uv_assert_ret(relocationsSymbol);
+		//And link them
+		out->push_back(std::make_pair(binarySymbolElement, relocationsSymbol));
 	}
 
 	return UV_ERR_OK;
@@ -494,7 +695,21 @@ uv_err_t UVDAnalyzer::assignDefaultSymbolNames()
 	
 uv_err_t UVDAnalyzer::identifyKnownFunctions()
 {
-	//TODO: compare symbols with database
+	/*
+	We don't have any function databases in the core
+	Let plugins (FLIRT, etc) compare the functions against theirs and rename them
+	*/
+	UVDProfileScope profileScope("identify_functions");
+	UVDEventIdentifyFunctions identifyEvent;
+	UVDBenchmark benchmark;
+	
+	benchmark.start();
+	identifyEvent.m_analyzer = this;
+	uv_assert_err_ret(m_uvd->m_eventEngine->emitEvent(&identifyEvent));
+	benchmark.stop();
+	printf_debug_level(UVD_DEBUG_PASSES, "known function identification: %d functions, time: %s\n",
+			m_functions.size(), benchmark.toString().c_str());
+	
 	return UV_ERR_OK;
 }
 
@@ -502,15 +717,21 @@ uv_err_t UVDAnalyzer::getPreviousKnownInstructionAddress(const UVDAddress &addre
 {
 	/*
 	Find the first function address or vector before given address
-	
-	This is very inefficient...
-	Need to fix the UVDAnalyzedMemorySpace legacy C stuff instead using templates
-	Then can use a std::set and have it sorted by address
 	*/
 	
-	UVDAnalyzedMemorySpace calledAddresses;
+	UVDAnalyzedMemoryRanges::const_iterator calledBegin;
+	UVDAnalyzedMemoryRanges::const_iterator calledEnd;
 	uv_addr_t bestAddress = 0;
 	bool anyFound = false;
+	uv_err_t rc = UV_ERR_GENERAL;
+	
+	uv_assert_ret(out);
+	//Usually the instruction right before us if analysis decoded this area
+	rc = m_instructionBoundaries.getPrevious(address, out);
+	if( rc != UV_ERR_NOTFOUND )
+	{
+		return UV_DEBUG(rc);
+	}
 	
 	//Check vectors
 	for( std::vector<UVDCPUVector *>::iterator iter = m_uvd->m_runtime->m_architecture->m_vectors.begin();
@@ -526,18 +747,19 @@ uv_err_t UVDAnalyzer::getPreviousKnownInstructionAddress(const UVDAddress &addre
 		}
 	}
 	
-	//Check functions
-	uv_assert_err_ret(getCalledAddresses(calledAddresses));
-	//printf("n called addresses: %d, address: 0x%08X\n", calledAddresses.size(), address.m_addr);
-	for( UVDAnalyzedMemorySpace::iterator iter = calledAddresses.begin();
-			iter != calledAddresses.end(); ++iter )
+	//Check functions, only the closest one before us matters
+	if( address.m_addr > 0 )
 	{
-		uv_addr_t currentAddress = (*iter).first;
-		
-		if( currentAddress < address.m_addr && (!anyFound || currentAddress > bestAddress) )
+		uv_assert_err_ret(getReferencedAddressRange(0, address.m_addr - 1, UVD_MEMORY_REFERENCE_CALL_DEST, &calledBegin, &calledEnd));
+		if( calledBegin != calledEnd )
 		{
-			anyFound = true;
-			bestAddress = currentAddress;
+			uv_addr_t currentAddress = (*(calledEnd - 1))->m_min_addr;
+			
+			if( !anyFound || currentAddress > bestAddress )
+			{
+				anyFound = true;
+				bestAddress = currentAddress;
+			}
 		}
 	}
 	
@@ -13,6 +13,11 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvd/assembly/address.h"
 #include "uvd/data/data.h"
 #include "uvd/assembly/symbol.h"
+#include "uvd/core/block.h"
+#include "uvd/core/instruction_boundaries.h"
+#include "uvd/core/instruction_cache.h"
+#include "uvd/core/line_index.h"
+#include "uvd/util/thread.h"
 
 /*
 Ways that memory locations are used (referenced)
@@ -121,6 +126,8 @@ public:
 //TODO: make a compare method to key to UVDAddressRange instead 
 typedef std::map<uint32_t, UVDAnalyzedMemoryRange *> UVDAnalyzedMemorySpace;
 typedef std::vector<UVDAnalyzedMemoryRange *> UVDAnalyzedMemoryRanges;
+//Relocation element and the symbol it should be linked to, see UVDAnalyzer::resolveDefaultSymbolNames()
+typedef std::vector<std::pair<UVDBinarySymbolElement *, UVDBinarySymbol *> > UVDSymbolLinks;
 class UVDBinaryFunctionShared;
 class UVDStringEngine;
 class UVDBinaryFunctionInstance;
@@ -147,11 +154,24 @@ public:
 	//For destinations, not sources
 	uv_err_t getCalledAddresses(UVDAnalyzedMemorySpace &calledAddresses);
 	uv_err_t getJumpedAddresses(UVDAnalyzedMemorySpace &calledAddresses);
+
+	/*
+	Indexed versions of the above that don't copy anything
+	Intended for per instruction queries such as while printing
+	*/
+	//Returns UV_ERR_NOTFOUND if address has no reference of given type
+	uv_err_t getReferencedAddress(uv_addr_t address, uint32_t type, UVDAnalyzedMemoryRange **out);
+	//All locations in [minAddress, maxAddress] with given type, sorted by address
+	//Iterators are valid until the next insertReference()
+	uv_err_t getReferencedAddressRange(uv_addr_t minAddress, uv_addr_t maxAddress, uint32_t type,
+			UVDAnalyzedMemoryRanges::const_iterator *begin, UVDAnalyzedMemoryRanges::const_iterator *end);
 	
 	//Register a newly analyzed function
 	//Will reflect the analyzedProgramDB to reflect the newly found function instance
-	//Note that the function's shared data will be from current analysis and must be free'd here
+	//The function is added to m_symbolManager, which owns it from then on
 	uv_err_t loadFunction(UVDBinaryFunction *function);
+	//m_functions sorted by address, for passes whose results must not depend on heap layout
+	uv_err_t getFunctionsByAddress(std::vector<UVDBinaryFunction *> &out);
 
 	uv_err_t mapSymbols();
 
@@ -160,21 +180,44 @@ public:
 	//uv_err_t analyzeJump(UVDInstruction *instruction, uint32_t startPos, const UVDVariableMap &attributes);
 
 	uv_err_t assignDefaultSymbolNames();
+	/*
+	Find what assignDefaultSymbolNames() would link for a single function without modifying anything shared
+	Relocation elements can be shared between functions, so this is safe to run on several functions at once
+	*/
+	uv_err_t resolveDefaultSymbolNames(UVDBinaryFunction *function, UVDSymbolLinks *out);
+	static uv_err_t applySymbolLinks(const UVDSymbolLinks &links);
 	uv_err_t identifyKnownFunctions();
 	
 	/*
+	Closest instruction start analysis recorded before address, otherwise the closest vector or called address
 	Returns UV_ERR_NOTFOUND if there are no known executable starting points before this
 	Hopefully this only happens if only data, nothing, etc precedes us
 	This can happen even if there is code for example if there are unknown virtual function entry points
 	*/
 	uv_err_t getPreviousKnownInstructionAddress(const UVDAddress &m_address, UVDAddress *out);
 
+private:
+	//Sorted m_referencedAddresses entries matching type, built on demand
+	uv_err_t getReferenceIndex(uint32_t type, const UVDAnalyzedMemoryRanges **out);
+
+public:
+
+	//Drop decoded instructions, such as when re-analyzing after config change
+	void invalidateInstructionCache();
+	//Started on first use with m_config->m_analysisThreads threads
+	uv_err_t getThreadPool(UVDThreadPool **out);
+	//Anything that changes printed output should invalidate this
+	uv_err_t getLineIndex(UVDPrintLineIndex **out);
+	void invalidateLineIndex();
+
 public:
 	//Superblock for block representation of program
 	//UVDAnalyzedBlock *m_block;
 
 	//Keeps track of jumped to and called addresses
 	UVDAnalyzedMemorySpace m_referencedAddresses;
+	//Reference type to sorted subset of m_referencedAddresses, cleared on any insert
+	std::map<uint32_t, UVDAnalyzedMemoryRanges> m_referenceIndexes;
 	
 	//A location where any change in code flow can occur
 	//Branch target/source, call target/source
@@ -186,6 +229,7 @@ public:
 	
 	//List of functions found during analysis
 	//XXX: should this get replaced by the symbol DB?
+	//Owned by m_symbolManager
 	std::set<UVDBinaryFunction *> m_functions;
 	//All of the symbols discovered during this analysis
 	//m_functions should be contained in this as well
@@ -193,6 +237,20 @@ public:
 	
 	UVDStringEngine *m_stringEngine;
 
+	//Filled by control flow analysis, reused by printing
+	UVDInstructionCache m_instructionCache;
+	//Every instruction start control flow analysis decoded, for going backwards
+	UVDInstructionBoundaries m_instructionBoundaries;
+	
+	//Basic blocks found by trace (recursive descent) flow analysis
+	UVDBlockGroup m_basicBlocks;
+	
+	//For analysis passes that are independent per function
+	UVDThreadPool m_threadPool;
+	
+	//Print line positions for seeking output
+	UVDPrintLineIndex m_lineIndex;
+
 	UVD *m_uvd;
 };
 
@@ -22,17 +22,64 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvd/util/benchmark.h"
 #include "uvd/util/debug.h"
 #include "uvd/util/error.h"
+#include "uvd/util/profile.h"
 #include "uvd/util/types.h"
 #include "uvd/util/util.h"
 
 UVDASInstructionIterator::UVDASInstructionIterator()
 {
 	m_instruction = NULL;
+	m_ownsInstruction = false;
+	m_pinnedInstruction = false;
 	m_uvd = NULL;
 	//m_addressSpace = NULL;
 	//m_curPosition = 0;
 	//m_isEnd = FALSE;
 	m_currentSize = 0;
+	m_objectUser = NULL;
+	m_architectureUser = NULL;
+}
+
+UVDASInstructionIterator::UVDASInstructionIterator(const UVDASInstructionIterator &other)
+{
+	m_instruction = NULL;
+	m_ownsInstruction = false;
+	m_pinnedInstruction = false;
+	*this = other;
+}
+
+UVDASInstructionIterator &UVDASInstructionIterator::operator=(const UVDASInstructionIterator &other)
+{
+	if( this == &other )
+	{
+		return *this;
+	}
+	releaseInstruction();
+	
+	m_address = other.m_address;
+	m_executableRun = other.m_executableRun;
+	m_currentSize = other.m_currentSize;
+	m_instruction = other.m_instruction;
+	m_uvd = other.m_uvd;
+	m_objectUser = other.m_objectUser;
+	m_architectureUser = other.m_architectureUser;
+	
+	//other releases its own when it moves on, decode ours again (or get it from the cache)
+	if( other.m_ownsInstruction )
+	{
+		m_instruction = NULL;
+		if( m_address.m_addr != UINT_MAX )
+		{
+			UV_DEBUG(parseCurrentInstruction());
+		}
+	}
+	//Shared with other, but each of us has to keep it from being evicted
+	else if( other.m_pinnedInstruction && m_instruction && m_uvd && m_uvd->m_analyzer )
+	{
+		m_uvd->m_analyzer->m_instructionCache.pin(m_instruction);
+		m_pinnedInstruction = true;
+	}
+	return *this;
 }
 
 /*
@@ -112,11 +159,28 @@ uv_err_t UVDASInstructionIterator::prime()
 
 uv_err_t UVDASInstructionIterator::deinit()
 {
+	releaseInstruction();
 	//m_addressSpace = NULL;
 	m_uvd = NULL;
 	return UV_ERR_OK;
 }
 
+void UVDASInstructionIterator::releaseInstruction()
+{
+	if( m_ownsInstruction && m_instruction )
+	{
+		m_instruction->release();
+		m_instruction = NULL;
+	}
+	if( m_pinnedInstruction && m_instruction && m_uvd && m_uvd->m_analyzer )
+	{
+		m_uvd->m_analyzer->m_instructionCache.unpin(m_instruction);
+		m_instruction = NULL;
+	}
+	m_ownsInstruction = false;
+	m_pinnedInstruction = false;
+}
+
 uv_err_t UVDASInstructionIterator::makeEnd()
 {
 	//Seems reasonable enough for now
@@ -159,6 +223,7 @@ uv_err_t UVDASInstructionIterator::previous()
 	
 	//Return UV_ERR_DONE if there are none, but guess its an error if we get this
 	//Looping to end() seems like a bad idea
+	//Analysis records instruction starts, so in analyzed code this is the previous instruction and the loop below runs once
 	rcTemp = m_uvd->m_analyzer->getPreviousKnownInstructionAddress(m_address, &previousKnownAddress);
 	uv_assert_err_ret(rcTemp);
 	uv_assert_ret(previousKnownAddress.m_addr < m_address.m_addr);
@@ -208,7 +273,6 @@ uv_err_t UVDASInstructionIterator::next()
 	UVD *uvd = NULL;
 	UVDAnalyzer *analyzer = NULL;
 	UVDFormat *format = NULL;
-	//UVDBenchmark nextInstructionBenchmark;
 	uv_err_t rcTemp = UV_ERR_GENERAL;
 			
 	uvd = m_uvd;
@@ -240,7 +304,7 @@ static int count = 0;
 		return UV_ERR_DONE;
 	}
 	
-	//nextInstructionBenchmark.start();
+	//Timing every instruction costs more than decoding it, see g_profileInstructionsDecoded instead
 	//Currently it seems we do not need to store if the instruction was properly decoded or not
 	//this can be caused in a multitude of ways by a multibyte instruction
 	if( UV_FAILED(parseCurrentInstruction()) )
@@ -248,8 +312,6 @@ static int count = 0;
 		printf_debug("Failed to get next instruction\n");
 		return UV_DEBUG(UV_ERR_GENERAL);
 	}	
-	//nextInstructionBenchmark.stop();
-	//printf_debug_level(UVD_DEBUG_SUMMARY, "nextInstruction() time: %s\n", nextInstructionBenchmark.toString().c_str());
 
 	return UV_ERR_OK;
 }
@@ -279,12 +341,19 @@ uv_err_t UVDASInstructionIterator::nextValidExecutableAddressIncludingCurrent()
 		//uv_assert_err_ret(makeEnd());
 		return UV_ERR_DONE;
 	}
+	
+	m_executableRun.m_space = m_address.m_space;
+	m_executableRun.m_min_addr = m_address.m_addr;
+	uv_assert_err_ret(m_address.m_space->getExecutableRunEnd(m_address.m_addr, &m_executableRun.m_max_addr));
 
 	return UV_ERR_OK;
 }
 
 uv_err_t UVDASInstructionIterator::consumeCurrentExecutableAddress(uint8_t *out)
 {
+	const UVDData *data = NULL;
+	const uint8_t *buffer = NULL;
+	
 	//Current address should always be valid unless we are at end()
 	//This is not a hard error because it can happen from malformed opcodes in the input
 	if( isEnd() )
@@ -292,8 +361,25 @@ uv_err_t UVDASInstructionIterator::consumeCurrentExecutableAddress(uint8_t *out)
 		return UV_ERR_DONE;
 	}
 
-	uv_assert_err_ret(m_address.m_space->m_data->readData(m_address.m_addr, (char *)out));	
+	data = m_address.m_space->m_data;
+	//Skip the generic read path if we can see the data directly
+	buffer = data->getBuffer(m_address.m_addr, 1);
+	if( buffer )
+	{
+		*out = *buffer;
+	}
+	else
+	{
+		uv_assert_err_ret(data->readData(m_address.m_addr, (char *)out));
+	}
 	++m_currentSize;
+	//Next address is known valid without asking the address space
+	if( m_executableRun.m_space == m_address.m_space
+			&& m_address.m_addr >= m_executableRun.m_min_addr && m_address.m_addr < m_executableRun.m_max_addr )
+	{
+		++m_address.m_addr;
+		return UV_ERR_OK;
+	}
 	//We don't care if next address leads to end
 	//Current address was valid and it is up to next call to return done if required
 	uv_assert_err_ret(nextValidExecutableAddress());
@@ -312,13 +398,57 @@ uv_err_t UVDASInstructionIterator::parseCurrentInstruction()
 	//return UV_DEBUG(m_uvd->m_runtime->m_architecture->parseCurrentInstruction(*this));
 	//See if arch supports parsing
 	uv_err_t rc = UV_ERR_GENERAL;
+	UVDArchitecture *architecture = NULL;
+	UVDInstructionCache *cache = NULL;
 	
 	//printf("UVDASInstructionIterator::parseCurrentInstruction()\n");
 	uv_assert_ret(m_uvd);
 	uv_assert_ret(m_uvd->m_runtime);
-	uv_assert_ret(m_uvd->m_runtime->m_architecture);
-	rc = m_uvd->m_runtime->m_architecture->parseCurrentInstruction(*this);
+	architecture = m_uvd->m_runtime->m_architecture;
+	uv_assert_ret(architecture);
+	
+	if( architecture->m_cacheInstructions )
+	{
+		//Otherwise every uncached instruction would be a new one, this lets the architecture hand the same one back
+		releaseInstruction();
+		m_instruction = NULL;
+	}
+	if( architecture->m_cacheInstructions && m_uvd->m_analyzer )
+	{
+		UVDInstruction *instruction = NULL;
+		
+		cache = &m_uvd->m_analyzer->m_instructionCache;
+		if( UV_SUCCEEDED(cache->get(m_address, &instruction)) )
+		{
+			//Same state the architecture would have left us in
+			m_instruction = instruction;
+			m_pinnedInstruction = true;
+			m_currentSize = instruction->m_inst_size;
+			g_profileInstructionCacheHits.increment();
+			return UV_ERR_OK;
+		}
+		g_profileInstructionCacheMisses.increment();
+	}
+	
+	rc = architecture->parseCurrentInstruction(*this);
+	//Even if it failed, its still ours to give back
+	m_ownsInstruction = architecture->m_cacheInstructions && m_instruction;
 	uv_assert_err_ret(rc);
+	g_profileInstructionsDecoded.increment();
+	
+	//Only keep fully decoded instructions, undefined and truncated ones are cheap to redo
+	if( cache && rc == UV_ERR_OK && m_instruction && m_instruction->m_shared && m_instruction->m_inst_size
+			&& m_instruction->m_offset == m_address.m_addr )
+	{
+		uv_err_t rcAdd = cache->add(m_address, m_instruction);
+		
+		uv_assert_err_ret(rcAdd);
+		if( rcAdd == UV_ERR_OK )
+		{
+			m_ownsInstruction = false;
+			m_pinnedInstruction = true;
+		}
+	}
 	return rc;
 }
 
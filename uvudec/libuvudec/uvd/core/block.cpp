@@ -307,6 +307,7 @@ UVDBlockGroup::UVDBlockGroup() {
 }
 
 UVDBlockGroup::~UVDBlockGroup() {
+	deinit();
 }
 
 uv_err_t UVDBlockGroup::init(UVDAddressSpace *addressSpace) {
@@ -315,6 +316,16 @@ uv_err_t UVDBlockGroup::init(UVDAddressSpace *addressSpace) {
 	return UV_ERR_OK;
 }
 
+uv_err_t UVDBlockGroup::deinit() {
+	for (BBS::iterator iter = m_unique.begin(); iter != m_unique.end(); ++iter) {
+		delete *iter;
+	}
+	m_unique.clear();
+	m_map.clear();
+	m_addressSpace = NULL;
+	return UV_ERR_OK;
+}
+
 uv_err_t UVDBlockGroup::add(UVDBasicBlock *block) {
 	//printf("1\n");
 	uv_assert_ret(block);
@@ -340,17 +351,35 @@ uv_err_t UVDBlockGroup::add(UVDBasicBlock *block) {
 	return UV_ERR_OK;
 }
 
-#if 0
+uv_err_t UVDBlockGroup::split(UVDBasicBlock *block, uv_addr_t address, UVDBasicBlock **out) {
+	UVDBasicBlock *upper = NULL;
+	
+	uv_assert_ret(block);
+	uv_assert_ret(address > block->min() && address <= block->max());
+	
+	uv_assert_err_ret(remove(block));
+	upper = new UVDBasicBlock(UVDAddressRange(address, block->max(), block->m_addressRange.m_space));
+	uv_assert_ret(upper);
+	block->m_addressRange.m_max_addr = address - 1;
+	uv_assert_err_ret(add(block));
+	uv_assert_err_ret(add(upper));
+	
+	if (out) {
+		*out = upper;
+	}
+	return UV_ERR_OK;
+}
+
 UVDBlockGroup::interval_t UVDBlockGroup::interval(uv_addr_t startend) {
 	return interval(startend, startend);
 }
 
 UVDBlockGroup::interval_t UVDBlockGroup::interval(UVDBasicBlock *block) {
-	return interval(block->min(), block->max()), singleton_set(block));
+	return interval(block->min(), block->max());
 }
 
 UVDBlockGroup::interval_t UVDBlockGroup::interval(uv_addr_t start, uv_addr_t end) {
-	return interval_t::closed(start, end);
+	return boost::icl::interval<uv_addr_t>::closed(start, end);
 }
 
 uv_err_t UVDBlockGroup::removeCore(UVDBasicBlock *block, bool del) {
@@ -360,10 +389,10 @@ uv_err_t UVDBlockGroup::removeCore(UVDBasicBlock *block, bool del) {
 		return UV_ERR_NOTFOUND;
 	}
 	m_unique.erase(iterUnique);
-	//Not that it should matter, but it should be safe if already erased
+	//Subtract only this block so that overlapping blocks keep their segments
 	//The biggest danger for corruption is if its range had changed meaning we didn't
 	//erase it and could return a bad pointer
-	m_map.erase(interval(block));
+	m_map -= std::make_pair(interval(block), singleton_set(block));
 	
 	if (del) {
 		delete block;
@@ -386,7 +415,14 @@ uv_err_t UVDBlockGroup::del(UVDBasicBlock *block) {
 }
 
 uv_err_t UVDBlockGroup::getAtAddress( uv_addr_t address, UVDBasicBlockSet *out ) {
-	return UV_DEBUG(getAtAddresses(UVDAddressRange(address, address), out));
+	//Single segment lookup, this is hit per instruction during tracing
+	Map::const_iterator iter = m_map.find(address);
+	
+	uv_assert_ret(out);
+	if (iter != m_map.end()) {
+		out->insert(iter->second.begin(), iter->second.end());
+	}
+	return UV_ERR_OK;
 }
 
 uv_err_t UVDBlockGroup::getAtAddresses( UVDAddressRange addressRange, UVDBasicBlockSet *out ) {
@@ -421,5 +457,4 @@ uv_err_t UVDBlockGroup::removeNotifier(Notifier notifier, void *user) {
 		return UV_ERR_OK;
 	}
 }
-#endif
 
@@ -210,12 +210,14 @@ public:
 	//Stores the user defined parameter with the notifier
 	typedef std::pair<Notifier, void *> Notification;
 	
-	typedef boost::icl::interval<uv_addr_t> interval_t;
+	typedef Map::interval_type interval_t;
 
 public:
 	UVDBlockGroup();
 	~UVDBlockGroup();
 	uv_err_t init(UVDAddressSpace *addressSpace);
+	//Deletes all blocks
+	uv_err_t deinit();
 	
 	//Add
 	//We now own this and it will be deleted at object destruction
@@ -224,6 +226,12 @@ public:
 	uv_err_t remove(UVDBasicBlock *block);
 	//Remove and delete
 	uv_err_t del(UVDBasicBlock *block);
+	/*
+	Shrink block to end right before address and add a new block for [address, old max]
+	Used when something branches into the middle of a known block
+	*/
+	uv_err_t split(UVDBasicBlock *block, uv_addr_t address, UVDBasicBlock **out);
+	inline unsigned int size() const { return m_unique.size(); }
 	
 	uv_err_t getAtAddress( uv_addr_t address, UVDBasicBlockSet *out );
 	//Intended primarily to get all of the blocks associated with a function but many other uses possible4444dw
@@ -26,3 +26,14 @@ UVDEventFunctionChanged::~UVDEventFunctionChanged()
 {
 }
 
+
+UVDEventIdentifyFunctions::UVDEventIdentifyFunctions()
+{
+	m_analyzer = NULL;
+	m_type = UVD_EVENT_IDENTIFY_FUNCTIONS;
+}
+
+UVDEventIdentifyFunctions::~UVDEventIdentifyFunctions()
+{
+}
+
@@ -35,6 +35,22 @@ public:
 	uint32_t m_isDefined;
 };
 
+/*
+UVD_EVENT_IDENTIFY_FUNCTIONS
+Issued after symbol mapping so that plugins can give known functions their real names
+Handlers should rename through m_analyzer->m_symbolManager
+*/
+class UVDAnalyzer;
+class UVDEventIdentifyFunctions : public UVDEvent
+{
+public:
+	UVDEventIdentifyFunctions();
+	~UVDEventIdentifyFunctions();
+public:
+	//Don't own this
+	UVDAnalyzer *m_analyzer;
+};
+
 #if 0
 /*
 UVD_EVENT_FUNCTION_NEW
@@ -15,6 +15,7 @@ Do something instead like create a list of optional and required members, with p
 #include "uvd/event/engine.h"
 #include "uvd/object/object.h"
 #include "uvd/util/benchmark.h"
+#include "uvd/util/profile.h"
 
 uv_err_t UVDInit()
 {
@@ -63,6 +64,10 @@ uv_err_t UVDDeinit()
 	//This won't get deleted by prev if it was global instance
 	if( g_config )
 	{
+		if( !g_config->m_profileFile.empty() )
+		{
+			uv_assert_err_ret(g_profiler.writeFile(g_config->m_profileFile, g_config->m_profileFormat));
+		}
 		delete g_config;
 		g_config = NULL;
 	}
@@ -301,6 +306,8 @@ uv_err_t UVD::initArchitecture(UVDObject *object, const UVDRuntimeHints &hints,
 		return UV_ERR_NOTFOUND;
 	}
 	
+	//Architecture init may need to know its engine (ex: to read the object)
+	uv_assert_err_ret(architecture->setUVD(this));
 	uv_assert_err_ret(architecture->doInit());
 	uv_assert_err_ret(architecture->fixupDefaults());
 
@@ -333,6 +340,7 @@ uv_err_t UVD::initEarly()
 //int init_count = 0;
 uv_err_t UVD::init(UVDObject *object, UVDArchitecture *architecture)
 {
+	UVDProfileScope profileScope("init");
 	UVDBenchmark engineInitBenchmark;
 
 	if( !m_config->m_argv )
@@ -343,6 +351,9 @@ uv_err_t UVD::init(UVDObject *object, UVDArchitecture *architecture)
 
 	printf_debug_level(UVD_DEBUG_PASSES, "UVD::init(): initializing runtime...\n");
 	//We might want to make this more dynamic just in case
+	//Architecture may have been created outside of initArchitecture()
+	uv_assert(architecture);
+	uv_assert_err(architecture->setUVD(this));
 	m_runtime = new UVDRuntime();
 	uv_assert(m_runtime);
 	uv_assert_err(m_runtime->init(object, architecture));
@@ -0,0 +1,146 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include "uvd/core/instruction_boundaries.h"
+#include "uvd/util/debug.h"
+#include "uvd/util/error.h"
+
+/*
+UVDInstructionBoundaries::Space
+*/
+
+UVDInstructionBoundaries::Space::Space()
+{
+	m_base = 0;
+}
+
+/*
+UVDInstructionBoundaries
+*/
+
+UVDInstructionBoundaries::UVDInstructionBoundaries()
+{
+}
+
+UVDInstructionBoundaries::~UVDInstructionBoundaries()
+{
+	deinit();
+}
+
+uv_err_t UVDInstructionBoundaries::deinit()
+{
+	clear();
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDInstructionBoundaries::set(const UVDAddress &address)
+{
+	Space *space = NULL;
+	uv_addr_t wordAddress = address.m_addr & ~(uv_addr_t)63;
+	uint32_t wordIndex = 0;
+	
+	uv_assert_ret(address.m_space);
+	space = &m_spaces[address.m_space];
+	
+	//Grow to cover address, analysis usually starts low and works up so front inserts are rare
+	if( space->m_words.empty() )
+	{
+		space->m_base = wordAddress;
+	}
+	else if( wordAddress < space->m_base )
+	{
+		space->m_words.insert(space->m_words.begin(), (space->m_base - wordAddress) / 64, 0);
+		space->m_base = wordAddress;
+	}
+	wordIndex = (wordAddress - space->m_base) / 64;
+	if( wordIndex >= space->m_words.size() )
+	{
+		space->m_words.resize(wordIndex + 1, 0);
+	}
+	
+	space->m_words[wordIndex] |= (uint64_t)1 << (address.m_addr & 63);
+	return UV_ERR_OK;
+}
+
+bool UVDInstructionBoundaries::isSet(const UVDAddress &address) const
+{
+	std::map<UVDAddressSpace *, Space>::const_iterator spaceIter;
+	uint32_t wordIndex = 0;
+	
+	spaceIter = m_spaces.find(address.m_space);
+	if( spaceIter == m_spaces.end() )
+	{
+		return false;
+	}
+	const Space &space = (*spaceIter).second;
+	if( address.m_addr < space.m_base )
+	{
+		return false;
+	}
+	wordIndex = (address.m_addr - space.m_base) / 64;
+	if( wordIndex >= space.m_words.size() )
+	{
+		return false;
+	}
+	return (space.m_words[wordIndex] >> (address.m_addr & 63)) & 1;
+}
+
+uv_err_t UVDInstructionBoundaries::getPrevious(const UVDAddress &address, UVDAddress *out) const
+{
+	std::map<UVDAddressSpace *, Space>::const_iterator spaceIter;
+	uint32_t wordIndex = 0;
+	uint64_t word = 0;
+	
+	uv_assert_ret(out);
+	spaceIter = m_spaces.find(address.m_space);
+	if( spaceIter == m_spaces.end() )
+	{
+		return UV_ERR_NOTFOUND;
+	}
+	const Space &space = (*spaceIter).second;
+	if( address.m_addr <= space.m_base || space.m_words.empty() )
+	{
+		return UV_ERR_NOTFOUND;
+	}
+	
+	//Bits strictly below address in its own word, or the whole last word if address is past the end
+	wordIndex = (address.m_addr - space.m_base) / 64;
+	if( wordIndex >= space.m_words.size() )
+	{
+		wordIndex = space.m_words.size() - 1;
+		word = space.m_words[wordIndex];
+	}
+	else
+	{
+		word = space.m_words[wordIndex] & (((uint64_t)1 << (address.m_addr & 63)) - 1);
+	}
+	
+	for( ;; )
+	{
+		if( word )
+		{
+			out->m_space = address.m_space;
+			out->m_addr = space.m_base + wordIndex * 64 + 63 - __builtin_clzll(word);
+			return UV_ERR_OK;
+		}
+		if( wordIndex == 0 )
+		{
+			return UV_ERR_NOTFOUND;
+		}
+		--wordIndex;
+		word = space.m_words[wordIndex];
+	}
+}
+
+void UVDInstructionBoundaries::clear()
+{
+	m_spaces.clear();
+}
+
+void UVDInstructionBoundaries::clear(UVDAddressSpace *space)
+{
+	m_spaces.erase(space);
+}
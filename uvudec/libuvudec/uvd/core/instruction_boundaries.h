@@ -0,0 +1,54 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVD_INSTRUCTION_BOUNDARIES_H
+#define UVD_INSTRUCTION_BOUNDARIES_H
+
+#include <map>
+#include <vector>
+#include "uvd/assembly/address.h"
+#include "uvd/util/types.h"
+
+/*
+Start addresses of instructions found by analysis, one bit per address
+Going backwards on a variable length instruction set otherwise means decoding forward from some known point
+With this the previous instruction is a backward bit scan away
+Only addresses analysis decoded are set, so regions it skipped (data, unreached code) have no bits
+*/
+class UVDInstructionBoundaries
+{
+public:
+	//Bits for a single address space
+	class Space
+	{
+	public:
+		Space();
+	
+	public:
+		//Address of bit 0 of m_words[0], a multiple of 64
+		uv_addr_t m_base;
+		std::vector<uint64_t> m_words;
+	};
+
+public:
+	UVDInstructionBoundaries();
+	~UVDInstructionBoundaries();
+	uv_err_t deinit();
+
+	uv_err_t set(const UVDAddress &address);
+	bool isSet(const UVDAddress &address) const;
+	//Closest instruction start before address, UV_ERR_NOTFOUND if none
+	uv_err_t getPrevious(const UVDAddress &address, UVDAddress *out) const;
+
+	//Forget everything, such as when re-analyzing
+	void clear();
+	void clear(UVDAddressSpace *space);
+
+public:
+	std::map<UVDAddressSpace *, Space> m_spaces;
+};
+
+#endif
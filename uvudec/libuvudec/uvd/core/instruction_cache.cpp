@@ -0,0 +1,273 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include "uvd/assembly/instruction.h"
+#include "uvd/core/instruction_cache.h"
+#include "uvd/util/debug.h"
+#include "uvd/util/error.h"
+#include "uvd/util/profile.h"
+
+/*
+UVDInstructionCache::Space
+*/
+
+UVDInstructionCache::Space::Space()
+{
+	m_data = NULL;
+}
+
+/*
+UVDInstructionCache
+*/
+
+UVDInstructionCache::UVDInstructionCache()
+{
+	m_size = 0;
+	m_maxInstructions = 0;
+	m_hits = 0;
+	m_misses = 0;
+	m_evictions = 0;
+}
+
+UVDInstructionCache::~UVDInstructionCache()
+{
+	deinit();
+}
+
+uv_err_t UVDInstructionCache::init(uint32_t maxInstructions)
+{
+	m_maxInstructions = maxInstructions;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDInstructionCache::deinit()
+{
+	if( m_hits || m_misses )
+	{
+		printf_debug_level(UVD_DEBUG_SUMMARY, "instruction cache: %d hits, %d misses, %d evictions, %d entries\n",
+				m_hits, m_misses, m_evictions, m_size);
+	}
+	invalidate();
+	//Anyone still holding these is about to lose the engine too
+	if( !m_detached.empty() )
+	{
+		printf_debug_level(UVD_DEBUG_SUMMARY, "instruction cache: releasing %d instructions still pinned\n", m_detached.size());
+	}
+	for( std::set<UVDInstruction *>::iterator iter = m_detached.begin(); iter != m_detached.end(); ++iter )
+	{
+		(*iter)->release();
+	}
+	m_detached.clear();
+	m_pins.clear();
+	m_hits = 0;
+	m_misses = 0;
+	m_evictions = 0;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDInstructionCache::get(const UVDAddress &address, UVDInstruction **out)
+{
+	std::map<UVDAddressSpace *, Space>::iterator spaceIter;
+	std::map<uv_addr_t, UVDInstruction *>::iterator iter;
+	
+	uv_assert_ret(out);
+	uv_assert_ret(address.m_space);
+	
+	spaceIter = m_spaces.find(address.m_space);
+	if( spaceIter == m_spaces.end() )
+	{
+		++m_misses;
+		return UV_ERR_NOTFOUND;
+	}
+	//Space was remapped since we decoded
+	if( (*spaceIter).second.m_data != address.m_space->m_data )
+	{
+		invalidate(address.m_space);
+		++m_misses;
+		return UV_ERR_NOTFOUND;
+	}
+	
+	iter = (*spaceIter).second.m_instructions.find(address.m_addr);
+	if( iter == (*spaceIter).second.m_instructions.end() )
+	{
+		++m_misses;
+		return UV_ERR_NOTFOUND;
+	}
+	
+	++m_hits;
+	*out = (*iter).second;
+	pin(*out);
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDInstructionCache::add(const UVDAddress &address, UVDInstruction *instruction)
+{
+	Space *space = NULL;
+	
+	uv_assert_ret(instruction);
+	uv_assert_ret(address.m_space);
+	
+	if( !m_maxInstructions )
+	{
+		return UV_ERR_DONE;
+	}
+	
+	space = &m_spaces[address.m_space];
+	if( space->m_data != address.m_space->m_data )
+	{
+		invalidate(address.m_space);
+		space = &m_spaces[address.m_space];
+		space->m_data = address.m_space->m_data;
+	}
+	//Someone decoded it twice, keep the first since it may be in use
+	if( space->m_instructions.find(address.m_addr) != space->m_instructions.end() )
+	{
+		return UV_ERR_DONE;
+	}
+	if( m_size >= m_maxInstructions )
+	{
+		uv_err_t rcEvict = evict();
+		
+		uv_assert_err_ret(rcEvict);
+		if( rcEvict == UV_ERR_DONE )
+		{
+			return UV_ERR_DONE;
+		}
+	}
+	space->m_instructions[address.m_addr] = instruction;
+	m_order.push_back(address);
+	++m_size;
+	pin(instruction);
+	
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDInstructionCache::evict()
+{
+	//Pinned entries get moved to the back, give up once we've seen them all
+	for( uint32_t remaining = m_order.size(); remaining; --remaining )
+	{
+		UVDAddress address = m_order.front();
+		std::map<UVDAddressSpace *, Space>::iterator spaceIter;
+		std::map<uv_addr_t, UVDInstruction *>::iterator iter;
+		
+		m_order.pop_front();
+		spaceIter = m_spaces.find(address.m_space);
+		if( spaceIter == m_spaces.end() )
+		{
+			continue;
+		}
+		iter = (*spaceIter).second.m_instructions.find(address.m_addr);
+		if( iter == (*spaceIter).second.m_instructions.end() )
+		{
+			continue;
+		}
+		//An iterator is still looking at it
+		if( m_pins.find((*iter).second) != m_pins.end() )
+		{
+			m_order.push_back(address);
+			continue;
+		}
+		
+		(*iter).second->release();
+		(*spaceIter).second.m_instructions.erase(iter);
+		--m_size;
+		++m_evictions;
+		g_profileInstructionCacheEvictions.increment();
+		return UV_ERR_OK;
+	}
+	
+	return UV_ERR_DONE;
+}
+
+void UVDInstructionCache::pin(UVDInstruction *instruction)
+{
+	++m_pins[instruction];
+}
+
+void UVDInstructionCache::unpin(UVDInstruction *instruction)
+{
+	std::map<UVDInstruction *, uint32_t>::iterator iter;
+	
+	iter = m_pins.find(instruction);
+	if( iter == m_pins.end() )
+	{
+		return;
+	}
+	--(*iter).second;
+	if( !(*iter).second )
+	{
+		m_pins.erase(iter);
+		if( m_detached.erase(instruction) )
+		{
+			instruction->release();
+		}
+	}
+}
+
+void UVDInstructionCache::drop(UVDInstruction *instruction)
+{
+	if( m_pins.find(instruction) != m_pins.end() )
+	{
+		m_detached.insert(instruction);
+	}
+	else
+	{
+		instruction->release();
+	}
+}
+
+void UVDInstructionCache::invalidate()
+{
+	for( std::map<UVDAddressSpace *, Space>::iterator spaceIter = m_spaces.begin(); spaceIter != m_spaces.end(); ++spaceIter )
+	{
+		std::map<uv_addr_t, UVDInstruction *> &instructions = (*spaceIter).second.m_instructions;
+		
+		for( std::map<uv_addr_t, UVDInstruction *>::iterator iter = instructions.begin(); iter != instructions.end(); ++iter )
+		{
+			drop((*iter).second);
+		}
+	}
+	m_spaces.clear();
+	m_order.clear();
+	m_size = 0;
+}
+
+void UVDInstructionCache::invalidate(UVDAddressSpace *addressSpace)
+{
+	std::map<UVDAddressSpace *, Space>::iterator spaceIter;
+	
+	spaceIter = m_spaces.find(addressSpace);
+	if( spaceIter == m_spaces.end() )
+	{
+		return;
+	}
+	
+	std::map<uv_addr_t, UVDInstruction *> &instructions = (*spaceIter).second.m_instructions;
+	for( std::map<uv_addr_t, UVDInstruction *>::iterator iter = instructions.begin(); iter != instructions.end(); ++iter )
+	{
+		drop((*iter).second);
+	}
+	m_size -= instructions.size();
+	m_spaces.erase(spaceIter);
+	
+	for( std::deque<UVDAddress>::iterator iter = m_order.begin(); iter != m_order.end(); )
+	{
+		if( (*iter).m_space == addressSpace )
+		{
+			iter = m_order.erase(iter);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+}
+
+uint32_t UVDInstructionCache::size() const
+{
+	return m_size;
+}
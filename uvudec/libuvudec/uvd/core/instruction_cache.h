@@ -0,0 +1,95 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVD_INSTRUCTION_CACHE_H
+#define UVD_INSTRUCTION_CACHE_H
+
+#include <deque>
+#include <map>
+#include <set>
+#include "uvd/assembly/address.h"
+#include "uvd/util/types.h"
+
+/*
+Decoded instructions by address
+Analysis decodes every instruction and printing, previous(), the GUI, etc would otherwise decode them all again
+Only architectures that hand out a new instruction object per parse (UVDArchitecture::m_cacheInstructions) use this
+When full, the oldest entry nobody has pinned is released to make room
+Invalidating never releases a pinned entry out from under whoever holds it, its last unpin() does
+*/
+class UVDInstruction;
+class UVDData;
+class UVDInstructionCache
+{
+public:
+	//Entries for a single address space
+	class Space
+	{
+	public:
+		Space();
+	
+	public:
+		//Data the instructions were decoded from, if the space is remapped the entries are stale
+		const UVDData *m_data;
+		std::map<uv_addr_t, UVDInstruction *> m_instructions;
+	};
+
+public:
+	UVDInstructionCache();
+	~UVDInstructionCache();
+	uv_err_t init(uint32_t maxInstructions);
+	uv_err_t deinit();
+	
+	/*
+	Returns UV_ERR_NOTFOUND if address isn't cached
+	Otherwise the instruction is pinned, unpin() it when done
+	*/
+	uv_err_t get(const UVDAddress &address, UVDInstruction **out);
+	/*
+	Returns UV_ERR_OK if the cache took ownership of instruction, it is pinned as with get()
+	Returns UV_ERR_DONE if the cache is disabled, already has address or every entry is pinned and caller keeps it
+	*/
+	uv_err_t add(const UVDAddress &address, UVDInstruction *instruction);
+	//Pinned instructions are not evicted
+	//Each pin() needs an unpin(), releases instructions invalidated while pinned
+	void pin(UVDInstruction *instruction);
+	void unpin(UVDInstruction *instruction);
+	
+	/*
+	Drop all entries, see UVDInstruction::release()
+	Unpinned ones are released now, pinned ones stay valid until their last unpin()
+	*/
+	void invalidate();
+	void invalidate(UVDAddressSpace *space);
+
+	uint32_t size() const;
+
+protected:
+	//Release the oldest unpinned entry
+	//Returns UV_ERR_DONE if all are pinned
+	uv_err_t evict();
+	//Release an entry no longer in the cache, or leave it to unpin() if pinned
+	void drop(UVDInstruction *instruction);
+	
+public:
+	std::map<UVDAddressSpace *, Space> m_spaces;
+	//Number of instructions across all spaces
+	uint32_t m_size;
+	//Entries in the order they were added, the front is evicted first
+	std::deque<UVDAddress> m_order;
+	//Pin counts, only instructions with at least one
+	std::map<UVDInstruction *, uint32_t> m_pins;
+	//Invalidated while pinned, released on their last unpin()
+	std::set<UVDInstruction *> m_detached;
+	//0 disables
+	uint32_t m_maxInstructions;
+	//Statistics
+	uint32_t m_hits;
+	uint32_t m_misses;
+	uint32_t m_evictions;
+};
+
+#endif
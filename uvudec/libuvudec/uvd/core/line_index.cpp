@@ -0,0 +1,367 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include "uvd/assembly/address.h"
+#include "uvd/core/line_index.h"
+#include "uvd/core/runtime.h"
+#include "uvd/core/uvd.h"
+#include "uvd/event/engine.h"
+#include "uvd/event/events.h"
+#include "uvd/util/debug.h"
+#include "uvd/util/error.h"
+#include "uvd/util/util.h"
+
+UVDPrintLineIndex::UVDPrintLineIndex()
+{
+	m_uvd = NULL;
+	m_space = NULL;
+	m_lineCount = 0;
+	m_started = false;
+	m_complete = false;
+	m_registered = false;
+}
+
+UVDPrintLineIndex::~UVDPrintLineIndex()
+{
+	UV_DEBUG(deinit());
+}
+
+uv_err_t UVDPrintLineIndex::init(UVD *uvd)
+{
+	uv_assert_ret(uvd);
+	m_uvd = uvd;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDPrintLineIndex::deinit()
+{
+	if( m_registered && m_uvd && m_uvd->m_eventEngine )
+	{
+		uv_assert_err_ret(m_uvd->m_eventEngine->unregisterHandler(eventHandler, this));
+	}
+	m_registered = false;
+	invalidate();
+	delete m_frontier.m_iter;
+	m_frontier.m_iter = NULL;
+	delete m_end.m_iter;
+	m_end.m_iter = NULL;
+
+	return UV_ERR_OK;
+}
+
+void UVDPrintLineIndex::invalidate()
+{
+	if( m_started )
+	{
+		printf_debug_level(UVD_DEBUG_VERBOSE, "print line index: invalidating %d groups, %d lines\n", m_groups.size(), m_lineCount);
+	}
+	m_groups.clear();
+	m_lineCount = 0;
+	m_space = NULL;
+	m_started = false;
+	m_complete = false;
+}
+
+uv_err_t UVDPrintLineIndex::eventHandler(const UVDEvent *event, void *data)
+{
+	UVDPrintLineIndex *lineIndex = (UVDPrintLineIndex *)data;
+
+	uv_assert_ret(event);
+	uv_assert_ret(lineIndex);
+	//Labels and names are printed, so any function change can shift lines
+	if( event->m_type == UVD_EVENT_FUNCTION_CHANGED
+			|| event->m_type == UVD_EVENT_IDENTIFY_FUNCTIONS )
+	{
+		lineIndex->invalidate();
+	}
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDPrintLineIndex::getAddressSpace(UVDAddressSpace **out)
+{
+	uv_assert_ret(m_uvd);
+	uv_assert_ret(m_uvd->m_runtime);
+	if( !m_space )
+	{
+		uv_assert_err_ret(m_uvd->m_runtime->getPrimaryExecutableAddressSpace(&m_space));
+		uv_assert_ret(m_space);
+	}
+	uv_assert_ret(out);
+	*out = m_space;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDPrintLineIndex::extend()
+{
+	uint32_t groups = 0;
+
+	if( m_complete )
+	{
+		return UV_ERR_DONE;
+	}
+	uv_assert_ret(m_uvd);
+
+	if( !m_started )
+	{
+		UVDAddressSpace *space = NULL;
+		uv_addr_t minAddress = 0;
+
+		//Event engine comes up after us, so hook it on first use
+		if( !m_registered )
+		{
+			uv_assert_ret(m_uvd->m_eventEngine);
+			uv_assert_err_ret(m_uvd->m_eventEngine->registerHandler(eventHandler, this, UVD_EVENT_HANDLER_PRIORITY_LAST));
+			m_registered = true;
+		}
+
+		uv_assert_err_ret(getAddressSpace(&space));
+		uv_assert_err_ret(space->getMinValidAddress(&minAddress));
+		//Factories overwrite the abstract iterator rather than freeing it
+		delete m_frontier.m_iter;
+		m_frontier.m_iter = NULL;
+		delete m_end.m_iter;
+		m_end.m_iter = NULL;
+		uv_assert_err_ret(m_uvd->begin(UVDAddress(minAddress, space), m_frontier));
+		uv_assert_err_ret(m_uvd->end(m_end));
+		m_started = true;
+	}
+
+	for( ;; )
+	{
+		UVDAddress address;
+
+		if( m_frontier == m_end )
+		{
+			m_complete = true;
+			break;
+		}
+		uv_assert_err_ret(m_frontier.getAddress(&address));
+		//Only the primary space is indexed
+		if( address.m_space != m_space
+				|| (!m_groups.empty() && address.m_addr < m_groups.back().m_address) )
+		{
+			m_complete = true;
+			break;
+		}
+
+		if( m_groups.empty() || m_groups.back().m_address != address.m_addr )
+		{
+			Group group;
+
+			//Only stop between groups so that the last group is always complete
+			if( groups >= UVD_PRINT_LINE_INDEX_CHUNK )
+			{
+				break;
+			}
+			group.m_address = address.m_addr;
+			group.m_firstLine = m_lineCount;
+			group.m_lineCount = 0;
+			m_groups.push_back(group);
+			++groups;
+		}
+		++m_groups.back().m_lineCount;
+		++m_lineCount;
+		uv_assert_err_ret(m_frontier.next());
+	}
+
+	printf_debug_level(UVD_DEBUG_VERBOSE, "print line index: %d groups, %d lines, complete: %d\n",
+			m_groups.size(), m_lineCount, m_complete);
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDPrintLineIndex::extendToAddress(uv_addr_t address)
+{
+	while( !m_complete && (m_groups.empty() || m_groups.back().m_address < address) )
+	{
+		uv_assert_err_ret(extend());
+	}
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDPrintLineIndex::extendToLine(uint32_t line)
+{
+	while( !m_complete && m_lineCount <= line )
+	{
+		uv_assert_err_ret(extend());
+	}
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDPrintLineIndex::findGroup(uv_addr_t address, uint32_t *out)
+{
+	uint32_t low = 0;
+	uint32_t high = m_groups.size();
+
+	//First group starting after address
+	while( low < high )
+	{
+		uint32_t mid = low + (high - low) / 2;
+
+		if( m_groups[mid].m_address <= address )
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+	if( low == 0 )
+	{
+		return UV_ERR_NOTFOUND;
+	}
+	uv_assert_ret(out);
+	*out = low - 1;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDPrintLineIndex::getLine(uv_addr_t address, uint32_t index, uint32_t *out)
+{
+	uint32_t groupIndex = 0;
+	uv_err_t rc = UV_ERR_GENERAL;
+
+	uv_assert_ret(out);
+	uv_assert_err_ret(extendToAddress(address));
+
+	rc = findGroup(address, &groupIndex);
+	if( rc == UV_ERR_NOTFOUND )
+	{
+		*out = 0;
+		return UV_ERR_OK;
+	}
+	uv_assert_err_ret(rc);
+
+	const Group &group = m_groups[groupIndex];
+	if( group.m_address == address )
+	{
+		*out = group.m_firstLine + uvd_min(index, group.m_lineCount - 1);
+	}
+	else
+	{
+		*out = group.m_firstLine + group.m_lineCount;
+	}
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDPrintLineIndex::getPosition(uint32_t line, uv_addr_t *addressOut, uint32_t *indexOut)
+{
+	uint32_t low = 0;
+	uint32_t high = 0;
+
+	uv_assert_err_ret(extendToLine(line));
+	if( line >= m_lineCount )
+	{
+		return UV_ERR_DONE;
+	}
+
+	//Last group starting at or before line
+	high = m_groups.size();
+	while( low + 1 < high )
+	{
+		uint32_t mid = low + (high - low) / 2;
+
+		if( m_groups[mid].m_firstLine <= line )
+		{
+			low = mid;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	uv_assert_ret(addressOut);
+	uv_assert_ret(indexOut);
+	*addressOut = m_groups[low].m_address;
+	*indexOut = line - m_groups[low].m_firstLine;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDPrintLineIndex::getLineCount(uint32_t *out)
+{
+	while( !m_complete )
+	{
+		uv_assert_err_ret(extend());
+	}
+	uv_assert_ret(out);
+	*out = m_lineCount;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDPrintLineIndex::seek(uint32_t line, UVDPrintIterator &iter)
+{
+	uv_addr_t address = 0;
+	uint32_t index = 0;
+	uv_err_t rc = UV_ERR_GENERAL;
+	UVDAddressSpace *space = NULL;
+
+	rc = getPosition(line, &address, &index);
+	uv_assert_err_ret(rc);
+	delete iter.m_iter;
+	iter.m_iter = NULL;
+	if( rc == UV_ERR_DONE )
+	{
+		uv_assert_err_ret(m_uvd->end(iter));
+		return UV_ERR_OK;
+	}
+
+	uv_assert_err_ret(getAddressSpace(&space));
+	uv_assert_err_ret(m_uvd->begin(UVDAddress(address, space), iter));
+	//Within a group is only stepping through the buffered lines
+	for( uint32_t i = 0; i < index; ++i )
+	{
+		uv_assert_err_ret(iter.next());
+	}
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDPrintLineIndex::seekDelta(UVDPrintIterator &iter, int delta)
+{
+	UVDPrintIterator endIter;
+	UVDAddressSpace *space = NULL;
+	uint32_t line = 0;
+
+	uv_assert_ret(m_uvd);
+	uv_assert_err_ret(m_uvd->end(endIter));
+	uv_assert_err_ret(getAddressSpace(&space));
+	if( iter == endIter )
+	{
+		uv_assert_err_ret(getLineCount(&line));
+	}
+	else
+	{
+		UVDAddress address;
+		uint32_t index = 0;
+		uv_err_t rc = UV_ERR_GENERAL;
+
+		uv_assert_err_ret(iter.getAddress(&address));
+		if( address.m_space != space )
+		{
+			return UV_ERR_NOTSUPPORTED;
+		}
+		rc = iter.getIndex(&index);
+		if( rc == UV_ERR_NOTSUPPORTED )
+		{
+			index = 0;
+		}
+		else
+		{
+			uv_assert_err_ret(rc);
+		}
+		uv_assert_err_ret(getLine(address.m_addr, index, &line));
+	}
+
+	if( delta < 0 && (uint32_t)-delta > line )
+	{
+		line = 0;
+	}
+	else
+	{
+		line += delta;
+	}
+	uv_assert_err_ret(seek(line, iter));
+	return UV_ERR_OK;
+}
@@ -0,0 +1,97 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVD_LINE_INDEX_H
+#define UVD_LINE_INDEX_H
+
+#include <vector>
+#include "uvd/core/iterator.h"
+#include "uvd/util/types.h"
+
+/*
+Print line positions of the primary executable address space
+Lets the GUI scroll by lines and print iterators go backwards without disassembling again
+
+A print group is the lines printed for one address (labels, comments, the instruction)
+Groups are recorded in print order, which is also address order
+The index is built lazily from the start of the space a chunk of groups at a time,
+extending only as far as a query needs
+Anything that changes what would be printed (analysis, function changes) must invalidate it
+
+Addresses in the middle of a group (ex: a GUI scrollbar position) are treated as
+being just after the group they are in
+*/
+
+//Groups indexed per extension
+#define UVD_PRINT_LINE_INDEX_CHUNK			1024
+
+class UVD;
+class UVDAddressSpace;
+class UVDEvent;
+class UVDPrintLineIndex
+{
+public:
+	class Group
+	{
+	public:
+		uv_addr_t m_address;
+		uint32_t m_firstLine;
+		uint32_t m_lineCount;
+	};
+
+public:
+	UVDPrintLineIndex();
+	~UVDPrintLineIndex();
+	uv_err_t init(UVD *uvd);
+	uv_err_t deinit();
+
+	//Drop everything indexed, rebuilt on next query
+	void invalidate();
+
+	//Only addresses in this space are indexed
+	uv_err_t getAddressSpace(UVDAddressSpace **out);
+	//Line printed at address / index within its group
+	uv_err_t getLine(uv_addr_t address, uint32_t index, uint32_t *out);
+	/*
+	Group address and index within the group of line
+	Returns UV_ERR_DONE if line is past the last line
+	*/
+	uv_err_t getPosition(uint32_t line, uv_addr_t *addressOut, uint32_t *indexOut);
+	//Number of lines, indexes everything
+	uv_err_t getLineCount(uint32_t *out);
+
+	//Iterator at line, end() if line is past the last line
+	uv_err_t seek(uint32_t line, UVDPrintIterator &iter);
+	//Move iter by delta lines, stopping at the beginning or end
+	uv_err_t seekDelta(UVDPrintIterator &iter, int delta);
+
+	static uv_err_t eventHandler(const UVDEvent *event, void *data);
+
+protected:
+	//Index another chunk, UV_ERR_DONE if there is nothing more to index
+	uv_err_t extend();
+	//Index at least through address / line or until done
+	uv_err_t extendToAddress(uv_addr_t address);
+	uv_err_t extendToLine(uint32_t line);
+	//Last group starting at or before address, UV_ERR_NOTFOUND if address is before all groups
+	uv_err_t findGroup(uv_addr_t address, uint32_t *out);
+
+public:
+	UVD *m_uvd;
+	UVDAddressSpace *m_space;
+	//Sorted by both address and line
+	std::vector<Group> m_groups;
+	//Lines in m_groups
+	uint32_t m_lineCount;
+	//Next line to index, only valid while m_started && !m_complete
+	UVDPrintIterator m_frontier;
+	UVDPrintIterator m_end;
+	bool m_started;
+	bool m_complete;
+	bool m_registered;
+};
+
+#endif
@@ -57,6 +57,11 @@ uv_err_t UVDAbstractPrintIterator::previous()
 	return UV_ERR_NOTIMPLEMENTED;
 }
 
+uv_err_t UVDAbstractPrintIterator::getIndex(uint32_t *)
+{
+	return UV_ERR_NOTSUPPORTED;
+}
+
 /*
 Make it print nicely for output
 Any non-printable characters should be converted to some "nicer" form
@@ -24,6 +24,9 @@ public:
 	virtual uv_err_t getCurrent(std::string &out) = 0;
 	//Needed for printing address columns and such
 	virtual uv_err_t getAddress(UVDAddress *out) = 0;
+	//Line within the lines printed for the current address, as given to init()
+	//Not supported by default
+	virtual uv_err_t getIndex(uint32_t *out);
 	std::string operator*();
 
 	virtual uv_err_t next() = 0;
@@ -111,6 +114,11 @@ public:
 		return m_iter->getAddress(out);
 	}
 	
+	inline uv_err_t getIndex(uint32_t *out) {
+		uv_assert_ret(m_iter);
+		return m_iter->getIndex(out);
+	}
+	
 	inline std::string operator*() {
 		return m_iter->operator*();
 	}
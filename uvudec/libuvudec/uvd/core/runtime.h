@@ -21,7 +21,7 @@ class UVDRuntime
 {
 public:
 	UVDRuntime();
-	~UVDRuntime();
+	virtual ~UVDRuntime();
 	
 	uv_err_t init(UVDObject *object, UVDArchitecture *architecture);
 
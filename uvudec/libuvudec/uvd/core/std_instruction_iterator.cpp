@@ -27,9 +27,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 
 UVDStdInstructionIterator::UVDStdInstructionIterator(UVD *uvd)
 {
-	if (uvd == NULL) {
-		uvd = g_uvd;
-	}
+	//Set by init() if not given here
 	m_uvd = uvd;
 	
 	m_addressSpacesIndex = 0;
@@ -54,12 +52,14 @@ uv_err_t UVDStdInstructionIterator::init(UVD *uvd, UVDAddressSpace *addressSpace
 
 uv_err_t UVDStdInstructionIterator::init(UVD *uvd, UVDAddress address)
 {
+	uv_assert_ret(uvd);
+	m_uvd = uvd;
 	m_addressSpaces.push_back(address.m_space);
 	
 	m_addressSpacesIndex = 0;
 	m_iter = UVDASInstructionIterator();
 	uv_assert_ret(address.m_space);
-	uv_assert_err_ret(m_iter.init(g_uvd, address));
+	uv_assert_err_ret(m_iter.init(uvd, address));
 	
 	return UV_ERR_OK;
 }
@@ -73,7 +73,7 @@ uv_err_t UVDStdInstructionIterator::beginningOfCurrentAddressSpace() {
 	uv_assert_err_ret(address.m_space->getMinValidAddress(&address.m_addr));
 		
 	m_iter = UVDASInstructionIterator();
-	uv_assert_err_ret(m_iter.init(g_uvd, address));
+	uv_assert_err_ret(m_iter.init(m_uvd, address));
 	
 	return UV_ERR_OK;
 }
@@ -260,6 +260,9 @@ uv_err_t UVDStdInstructionIterator::nextValidExecutableAddressIncludingCurrent()
 
 uv_err_t UVDStdInstructionIterator::consumeCurrentExecutableAddress(uint8_t *out)
 {
+	const UVDData *data = NULL;
+	const uint8_t *buffer = NULL;
+	
 	//Current address should always be valid unless we are at end()
 	//This is not a hard error because it can happen from malformed opcodes in the input
 	if( isEnd() )
@@ -267,7 +270,17 @@ uv_err_t UVDStdInstructionIterator::consumeCurrentExecutableAddress(uint8_t *out
 		return UV_ERR_DONE;
 	}
 
-	uv_assert_err_ret(m_address.m_space->m_data->readData(m_address.m_addr, (char *)out));	
+	data = m_address.m_space->m_data;
+	//Skip the generic read path if we can see the data directly
+	buffer = data->getBuffer(m_address.m_addr, 1);
+	if( buffer )
+	{
+		*out = *buffer;
+	}
+	else
+	{
+		uv_assert_err_ret(data->readData(m_address.m_addr, (char *)out));
+	}
 	++m_currentSize;
 	//We don't care if next address leads to end
 	//Current address was valid and it is up to next call to return done if required
@@ -41,12 +41,16 @@ and generate all indexes at once
 */
 class UVD;
 class UVDAddressSpace;
+class UVDOutputSink;
 //Address space instruction iterator
 //As of this writing is the lowest level instruction iterator
 class UVDASInstructionIterator
 {
 public:
 	UVDASInstructionIterator();
+	//A copy never shares an instruction we own, it decodes its own
+	UVDASInstructionIterator(const UVDASInstructionIterator &other);
+	UVDASInstructionIterator &operator=(const UVDASInstructionIterator &other);
 	//uv_err_t init(UVD *disassembler, uint32_t position = g_addr_min, uint32_t index = 0);
 	//uv_err_t init(UVD *uvd, UVDAddressSpace *addressSpace);
 	uv_err_t init(UVD *uvd, UVDAddress address);
@@ -98,6 +102,8 @@ protected:
 
 	//Some sort of disassembly issue
 	uv_err_t addWarning(const std::string &lineRaw);	
+	//Give back m_instruction if it is ours or unpin it if it is the cache's
+	void releaseInstruction();
 
 public:
 	//TODO: should have a list of address spaces?
@@ -106,6 +112,11 @@ public:
 	Source of data to disassemble, there what and where
 	*/
 	UVDAddress m_address;
+	/*
+	Valid executable addresses found by the last nextValidExecutableAddressIncludingCurrent()
+	Consuming within it just increments the address
+	*/
+	UVDAddressRange m_executableRun;
 
 	//How many bytes we consumed to create currently analyzed instruction
 	//Think this is actually more used to calculate instruction size than actual iteration
@@ -115,6 +126,17 @@ public:
 	//Valid until nextInstruction() is called again
 	//This may result in this being NULL if we aren't at a coding address
 	UVDInstruction *m_instruction;
+	/*
+	m_instruction was handed to us by an architecture that creates one per parse (UVDArchitecture::m_cacheInstructions)
+	and the instruction cache didn't take it
+	Released before the next parse and at deinit()
+	*/
+	uvd_bool_t m_ownsInstruction;
+	/*
+	m_instruction belongs to UVDAnalyzer::m_instructionCache, which won't evict it while we hold it
+	Unpinned before the next parse and at deinit()
+	*/
+	uvd_bool_t m_pinnedInstruction;
 
 	//Object we are iterating on
 	UVD *m_uvd;
@@ -190,6 +212,7 @@ public:
 	//Error checked version of operator *
 	uv_err_t getCurrent(std::string &out);
 	virtual uv_err_t getAddress(UVDAddress *out);
+	virtual uv_err_t getIndex(uint32_t *out);
 	std::string operator*();
 
 	uv_err_t next();
@@ -218,6 +241,13 @@ public:
 	
 	virtual uv_err_t check();
 
+	/*
+	Write every line up to end (not inclusive) to sink, leaving us at end
+	Same output as getCurrent() / next() but locations are formatted straight into the sink
+	instead of being buffered a line at a time
+	*/
+	uv_err_t printRange(const UVDStdPrintIterator &end, UVDOutputSink *sink);
+
 protected:
 	//sets up begin()
 	uv_err_t prime();
@@ -226,8 +256,13 @@ protected:
 
 	//Some sort of disassembly issue
 	uv_err_t addWarning(const std::string &lineRaw);	
+	//Give back m_instruction if it is ours or unpin it if it is the cache's
+	void releaseInstruction();
 	//Add a comment to the end of the print buffer
 	uv_err_t addComment(const std::string &lineRaw);
+	//Add a line to the end of the print buffer, or the sink if streaming
+	uv_err_t addLine(const char *line);
+	uv_err_t addLine(const std::string &line);
 
 public:
 	//Next index to check on generated lines
@@ -239,6 +274,12 @@ public:
 	std::vector<std::string> m_indexBuffer;
 	//UVDInstructionIterator *m_iter;
 	UVDInstructionIterator m_iter;
+	//Engine we are printing, not owned
+	UVD *m_uvd;
+	//Set during printRange() only, lines go here instead of m_indexBuffer
+	UVDOutputSink *m_sink;
+	//Reused for instruction text while streaming
+	std::string m_scratch;
 
 	//Printed startup information yet?
 	//FIXME: get rid of this and instead check for start address condition maybe?
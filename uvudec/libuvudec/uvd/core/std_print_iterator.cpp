@@ -12,6 +12,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvd/assembly/cpu_vector.h"
 #include "uvd/assembly/instruction.h"
 #include "uvd/core/analysis.h"
+#include "uvd/core/analyzer.h"
 #include "uvd/core/runtime.h"
 #include "uvd/core/std_iterator.h"
 #include "uvd/core/uvd.h"
@@ -22,6 +23,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvd/util/benchmark.h"
 #include "uvd/util/debug.h"
 #include "uvd/util/error.h"
+#include "uvd/util/output_sink.h"
 #include "uvd/util/types.h"
 #include "uvd/util/util.h"
 
@@ -60,6 +62,8 @@ UVDStdPrintIterator
 UVDStdPrintIterator::UVDStdPrintIterator()
 {
 	m_positionIndex = 0;
+	m_uvd = NULL;
+	m_sink = NULL;
 	//eh this doesn't make sense...suprised this compiled before I added operator
 	//m_iter = NULL;
 }
@@ -70,6 +74,8 @@ UVDStdPrintIterator::~UVDStdPrintIterator()
 
 uv_err_t UVDStdPrintIterator::init(UVD *uvd, UVDAddress address, uint32_t index)
 {
+	uv_assert_ret(uvd);
+	m_uvd = uvd;
 	//uv_assert_err_ret(uvd->m_runtime->m_architecture->getInstructionIterator(&m_iter));
 	uv_assert_err_ret(uvd->instructionBeginByAddress(address, m_iter));
 	uv_assert_err_ret(m_iter.check());
@@ -180,7 +186,7 @@ uv_err_t UVDStdPrintIterator::initialProcessHeader()
 
 uv_err_t UVDStdPrintIterator::initialProcessStringTable()
 {
-	UVDAnalyzer *analyzer = g_uvd->m_analyzer;
+	UVDAnalyzer *analyzer = m_uvd->m_analyzer;
 
 	m_indexBuffer.push_back("# String table:");
 
@@ -231,12 +237,10 @@ uv_err_t UVDStdPrintIterator::initialProcess()
 	UVDConfig *config = NULL;
 	UVDAnalyzer *analyzer = NULL;
 		
-	//uv_assert_ret(g_uvd);
-	config = g_uvd->m_config;
+	uv_assert_ret(m_uvd);
+	config = m_uvd->m_config;
 	uv_assert_ret(config);
-
-	uv_assert_ret(g_uvd);
-	analyzer = g_uvd->m_analyzer;
+	analyzer = m_uvd->m_analyzer;
 	
 	if( config->m_print_header )
 	{
@@ -244,8 +248,8 @@ uv_err_t UVDStdPrintIterator::initialProcess()
 	}
 
 	//TODO: add a plugin header supression option
-	for( std::map<std::string, UVDPlugin *>::iterator iter = g_uvd->m_config->m_plugin.m_pluginEngine.m_loadedPlugins.begin();
-		iter != g_uvd->m_config->m_plugin.m_pluginEngine.m_loadedPlugins.end(); ++iter )
+	for( std::map<std::string, UVDPlugin *>::iterator iter = m_uvd->m_config->m_plugin.m_pluginEngine.m_loadedPlugins.begin();
+		iter != m_uvd->m_config->m_plugin.m_pluginEngine.m_loadedPlugins.end(); ++iter )
 	{
 		UVDPlugin *plugin = (*iter).second;
 		std::vector<std::string> headerLines;
@@ -303,7 +307,9 @@ uv_err_t UVDStdPrintIterator::getEnd(UVD *uvd, UVDAddressSpace *addressSpace, UV
 	iter = new UVDStdPrintIterator();
 	uv_assert_ret(iter);
 	
-	instFactory = g_uvd->m_runtime->m_architecture->m_instructionIteratorFactory;
+	iter->m_uvd = uvd;
+	uv_assert_ret(uvd);
+	instFactory = uvd->m_runtime->m_architecture->m_instructionIteratorFactory;
 	uv_assert_err_ret(instFactory->instructionIteratorEndByAddressSpace(&iter->m_iter, addressSpace));
 	
 	uv_assert_ret(out);
@@ -387,6 +393,34 @@ uv_err_t UVDStdPrintIterator::previous()
 		return UV_ERR_OK;
 	}
 	
+	//The line index knows where the previous group starts, no need to disassemble forward to find it
+	if( m_uvd && m_uvd->m_analyzer )
+	{
+		UVDPrintLineIndex *lineIndex = NULL;
+		UVDAddressSpace *space = NULL;
+		UVDAddress address;
+		
+		uv_assert_err_ret(m_uvd->m_analyzer->getLineIndex(&lineIndex));
+		uv_assert_err_ret(lineIndex->getAddressSpace(&space));
+		uv_assert_err_ret(m_iter.getAddress(&address));
+		if( address.m_space == space )
+		{
+			uint32_t line = 0;
+			uv_addr_t previousAddress = 0;
+			uint32_t previousIndex = 0;
+			
+			uv_assert_err_ret(lineIndex->getLine(address.m_addr, 0, &line));
+			uv_assert_ret(line > 0);
+			uv_assert_err_ret(lineIndex->getPosition(line - 1, &previousAddress, &previousIndex));
+			uv_assert_err_ret(m_uvd->instructionBeginByAddress(UVDAddress(previousAddress, space), m_iter));
+			m_positionIndex = 0;
+			uv_assert_err_ret(parseCurrentLocation());
+			uv_assert_ret(previousIndex < m_indexBuffer.size());
+			m_positionIndex = previousIndex;
+			return UV_ERR_OK;
+		}
+	}
+	
 	//Okay, now the f my life case
 	//Fortunatly, its not too bad from the print perspective
 	uv_assert_err_ret(m_iter.previous());
@@ -470,7 +504,7 @@ uv_err_t UVDStdPrintIterator::parseCurrentLocation()
 	//uv_err_t rcSuper = UV_ERR_GENERAL;
 	UVDBenchmark benchmark;
 	UVDAddress startPosition;
-	UVDConfig *config = g_uvd->m_config;
+	UVDConfig *config = m_uvd->m_config;
 	
 	uv_assert_err_ret(m_iter.getAddress(&startPosition));
 	
@@ -516,7 +550,17 @@ uv_err_t UVDStdPrintIterator::parseCurrentLocation()
 	if( instruction )
 	{
 		uv_assert_ret(instruction->m_inst_size);
-		uv_assert_err_ret(g_uvd->stringListAppend(instruction, m_indexBuffer));
+		if( m_sink )
+		{
+			//Multiple lines go out as is, same as splitting them
+			m_scratch.clear();
+			uv_assert_err_ret(instruction->print_disasm(m_scratch));
+			uv_assert_err_ret(addLine(m_scratch));
+		}
+		else
+		{
+			uv_assert_err_ret(m_uvd->stringListAppend(instruction, m_indexBuffer));
+		}
 	}
 	//printf("Generated string list, size: %d\n", m_indexBuffer.size());
 
@@ -533,7 +577,7 @@ uv_err_t UVDStdPrintIterator::printReferenceList(UVDAnalyzedMemoryRange *memLoc,
 	UVD *uvd = NULL;
 	UVDFormat *format = NULL;
 		
-	uvd = g_uvd;
+	uvd = m_uvd;
 	uv_assert_ret(uvd);
 	format = uvd->m_format;
 	uv_assert_ret(format);
@@ -554,7 +598,7 @@ uv_err_t UVDStdPrintIterator::printReferenceList(UVDAnalyzedMemoryRange *memLoc,
 		std::string formattedAddress;
 		uv_assert_err_ret(format->formatAddress(from, formattedAddress));
 		snprintf(buff, 256, "#\t%s", formattedAddress.c_str());
-		m_indexBuffer.push_back(buff);
+		uv_assert_err_ret(addLine(buff));
 	}
 	
 	return UV_ERR_OK;
@@ -569,12 +613,32 @@ uv_err_t UVDStdPrintIterator::addComment(const std::string &lineRaw)
 {
 	std::string lineCommented;
 	
-	uv_assert_err_ret(g_uvd->m_format->m_compiler->comment(lineRaw, lineCommented));
-	m_indexBuffer.push_back(lineCommented);
+	uv_assert_err_ret(m_uvd->m_format->m_compiler->comment(lineRaw, lineCommented));
+	uv_assert_err_ret(addLine(lineCommented));
 
 	return UV_ERR_OK;
 }
 
+uv_err_t UVDStdPrintIterator::addLine(const char *line)
+{
+	if( m_sink )
+	{
+		return UV_DEBUG(m_sink->writeLine(line, strlen(line)));
+	}
+	m_indexBuffer.push_back(line);
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDStdPrintIterator::addLine(const std::string &line)
+{
+	if( m_sink )
+	{
+		return UV_DEBUG(m_sink->writeLine(line));
+	}
+	m_indexBuffer.push_back(line);
+	return UV_ERR_OK;
+}
+
 uv_err_t UVDStdPrintIterator::nextAddressLabel(UVDAddress startPosition)
 {
 	char buff[256];
@@ -583,8 +647,7 @@ uv_err_t UVDStdPrintIterator::nextAddressLabel(UVDAddress startPosition)
 	//Limit leading zeros by max address size?
 	//X00001234:
 	snprintf(buff, 256, "X%.8X:", startPosition.m_addr);
-	
-	m_indexBuffer.insert(m_indexBuffer.end(), buff);
+	uv_assert_err_ret(addLine(buff));
 
 	return UV_ERR_OK;
 }
@@ -605,7 +668,7 @@ uv_err_t UVDStdPrintIterator::nextVectorComment(UVDAddress startPosition)
 	uv_err_t rcTemp = UV_ERR_GENERAL;
 	UVDCPUVector *vector = NULL;
 	
-	rcTemp = g_uvd->m_runtime->m_architecture->getVector(&startPosition, &vector);
+	rcTemp = m_uvd->m_runtime->m_architecture->getVector(&startPosition, &vector);
 	if( rcTemp == UV_ERR_NOTFOUND ) {
 		return UV_ERR_OK;
 	}
@@ -623,16 +686,16 @@ uv_err_t UVDStdPrintIterator::nextCalledSources(UVDAddress startPosition)
 	std::string sNameBlock;
 	UVDAnalyzedFunction analyzedFunction;
 	UVDAnalyzedMemoryRange *memLoc = NULL;
-	UVDAnalyzedMemorySpace calledAddresses;
-	UVDConfig *config = g_uvd->m_config;
+	UVDConfig *config = m_uvd->m_config;
+	uv_err_t rcTemp = UV_ERR_GENERAL;
 
-	uv_assert_err_ret(g_uvd->m_analyzer->getCalledAddresses(calledAddresses));
-	if( calledAddresses.find(startPosition.m_addr) == calledAddresses.end() )
+	rcTemp = m_uvd->m_analyzer->getReferencedAddress(startPosition.m_addr, UVD_MEMORY_REFERENCE_CALL_DEST, &memLoc);
+	if( rcTemp == UV_ERR_NOTFOUND )
 	{
 		return UV_ERR_OK;
 	}
-
-	memLoc = (*(calledAddresses.find(startPosition.m_addr))).second;
+	uv_assert_err_ret(rcTemp);
+	uv_assert_ret(memLoc);
 	
 	//empty name indicates no data
 	if( !analyzedFunction.m_sName.empty() )
@@ -640,18 +703,18 @@ uv_err_t UVDStdPrintIterator::nextCalledSources(UVDAddress startPosition)
 		sNameBlock = analyzedFunction.m_sName + "(args?) ";
 	}
 	
-	m_indexBuffer.insert(m_indexBuffer.end(), "\n");
-	m_indexBuffer.insert(m_indexBuffer.end(), "\n");
+	uv_assert_err_ret(addLine("\n"));
+	uv_assert_err_ret(addLine("\n"));
 	std::string formattedAddress;
-	uv_assert_err_ret(g_uvd->m_format->formatAddress(startPosition.m_addr, formattedAddress));
+	uv_assert_err_ret(m_uvd->m_format->formatAddress(startPosition.m_addr, formattedAddress));
 	snprintf(buff, 256, "# FUNCTION START %s@ %s", sNameBlock.c_str(), formattedAddress.c_str());
-	m_indexBuffer.insert(m_indexBuffer.end(), buff);
+	uv_assert_err_ret(addLine(buff));
 
 	//Print number of callees?
 	if( config->m_calledCount )
 	{
 		snprintf(buff, 256, "# References: %d", memLoc->getReferenceCount());
-		m_indexBuffer.push_back(buff);
+		uv_assert_err_ret(addLine(buff));
 	}
 
 	//Print callees?
@@ -667,28 +730,28 @@ uv_err_t UVDStdPrintIterator::nextJumpedSources(UVDAddress startPosition)
 	char buff[256];
 	std::string sNameBlock;
 	UVDAnalyzedMemoryRange *memLoc = NULL;
-	UVDAnalyzedMemorySpace jumpedAddresses;
-	UVDConfig *config = g_uvd->m_config;
+	UVDConfig *config = m_uvd->m_config;
+	uv_err_t rcTemp = UV_ERR_GENERAL;
 
-	uv_assert_err_ret(g_uvd->m_analyzer->getJumpedAddresses(jumpedAddresses));
+	rcTemp = m_uvd->m_analyzer->getReferencedAddress(startPosition.m_addr, UVD_MEMORY_REFERENCE_JUMP_DEST, &memLoc);
 	//Can be an entry and continue point
-	if( jumpedAddresses.find(startPosition.m_addr) == jumpedAddresses.end() )
+	if( rcTemp == UV_ERR_NOTFOUND )
 	{
 		return UV_ERR_OK;
 	}
-
-	memLoc = (*(jumpedAddresses.find(startPosition.m_addr))).second;
+	uv_assert_err_ret(rcTemp);
+	uv_assert_ret(memLoc);
 			
 	std::string formattedAddress;
-	uv_assert_err_ret(g_uvd->m_format->formatAddress(startPosition.m_addr, formattedAddress));
+	uv_assert_err_ret(m_uvd->m_format->formatAddress(startPosition.m_addr, formattedAddress));
 	snprintf(buff, 256, "# Jump destination %s@ %s", sNameBlock.c_str(), formattedAddress.c_str());
-	m_indexBuffer.push_back(buff);
+	uv_assert_err_ret(addLine(buff));
 
 	//Print number of references?
 	if( config->m_jumpedCount )
 	{
 		snprintf(buff, 256, "# References: %d", memLoc->getReferenceCount());
-		m_indexBuffer.push_back(buff);
+		uv_assert_err_ret(addLine(buff));
 	}
 
 	//Print sources?
@@ -704,6 +767,12 @@ uv_err_t UVDStdPrintIterator::getAddress(UVDAddress *out) {
 	return UV_DEBUG(m_iter.getAddress(out));
 }
 
+uv_err_t UVDStdPrintIterator::getIndex(uint32_t *out) {
+	uv_assert_ret(out);
+	*out = m_positionIndex;
+	return UV_ERR_OK;
+}
+
 uv_err_t UVDStdPrintIterator::check() {
 	UVDInstruction *instruction = NULL;
 	
@@ -719,3 +788,38 @@ uv_err_t UVDStdPrintIterator::check() {
 	return UV_DEBUG(m_iter.check());
 }
 
+uv_err_t UVDStdPrintIterator::printRange(const UVDStdPrintIterator &end, UVDOutputSink *sink)
+{
+	uv_assert_ret(sink);
+	uv_assert_ret(!m_sink);
+
+	for( ;; )
+	{
+		bool lastLocation = m_iter.compare(end.m_iter) == 0;
+		uint32_t stop = lastLocation ? end.m_positionIndex : m_indexBuffer.size();
+		uv_err_t rc = UV_ERR_GENERAL;
+
+		//Already buffered, ex: the header from prime() or where a range starts part way into a location
+		for( ; m_positionIndex < stop; ++m_positionIndex )
+		{
+			uv_assert_err_ret(sink->writeLine(m_indexBuffer[m_positionIndex]));
+		}
+		if( lastLocation )
+		{
+			return UV_ERR_OK;
+		}
+
+		uv_assert_err_ret(m_iter.next());
+		//end is expressed as an index into its location's lines, so that one must be buffered
+		if( m_iter.compare(end.m_iter) == 0 )
+		{
+			uv_assert_err_ret(parseCurrentLocation());
+			continue;
+		}
+		m_sink = sink;
+		rc = parseCurrentLocation();
+		m_sink = NULL;
+		uv_assert_err_ret(rc);
+	}
+}
+
@@ -9,6 +9,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include <ctype.h>
 #include <errno.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -26,11 +27,14 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvd/core/std_iterator.h"
 #include "uvd/core/runtime.h"
 #include "uvd/data/data.h"
+#include "uvd/event/engine.h"
 #include "uvd/language/format.h"
 #include "uvd/language/language.h"
 #include "uvd/string/engine.h"
 #include "uvd/util/types.h"
 #include "uvd/util/benchmark.h"
+#include "uvd/util/profile.h"
+#include "uvd/util/output_sink.h"
 
 UVD *g_uvd = NULL;
 
@@ -149,6 +153,12 @@ error:
 
 
 
+/*
+Held while an engine is created or destroyed
+Plugins are shared and their engine hooks and UVDPlugin::m_uvd assume one engine at a time
+*/
+static pthread_mutex_t g_uvdLifecycleMutex = PTHREAD_MUTEX_INITIALIZER;
+
 UVD::UVD()
 {
 	m_analyzer = NULL;
@@ -166,6 +176,16 @@ UVD::~UVD()
 }
 
 uv_err_t UVD::deinit()
+{
+	uv_err_t rc = UV_ERR_GENERAL;
+	
+	pthread_mutex_lock(&g_uvdLifecycleMutex);
+	rc = doDeinit();
+	pthread_mutex_unlock(&g_uvdLifecycleMutex);
+	return UV_DEBUG(rc);
+}
+
+uv_err_t UVD::doDeinit()
 {
 	UVD_POKE(this);
 	UVD_POKE(&m_runtime);
@@ -180,17 +200,34 @@ uv_err_t UVD::deinit()
 			(int)this, (int)g_uvd, (int)m_config, (int)g_config);
 	if( m_config )
 	{
+		//Plugins may have been pointed at another engine since we were created
+		uv_assert_err_ret(initEarly());
 		uv_assert_err_ret(m_config->m_plugin.m_pluginEngine.onUVDDeinit());
 	}
 	
-	//m_data deallocated by UVD engine caller
-	
 	delete m_analyzer;
 	m_analyzer = NULL;
 
 	delete m_format;
 	m_format = NULL;
 
+	delete m_eventEngine;
+	m_eventEngine = NULL;
+
+	/*
+	So that many engines can be run in one process (ex: batch mode) without leaking each one
+	The object owns the data it was loaded from
+	*/
+	if( m_runtime )
+	{
+		delete m_runtime->m_architecture;
+		m_runtime->m_architecture = NULL;
+		delete m_runtime->m_object;
+		m_runtime->m_object = NULL;
+		delete m_runtime;
+		m_runtime = NULL;
+	}
+
 	//To help migrate from global instances
 	//At the time of this writing, g_config is deleted during UVDDeinit()
 	if( m_config != g_config )
@@ -210,14 +247,8 @@ uv_err_t UVD::deinit()
 uv_err_t UVD::getUVDFromFileName(UVD **uvdOut, const std::string &file)
 {
 	UVD *uvd = NULL;
+	uv_err_t rc = UV_ERR_GENERAL;
 	
-	//Because code needs lots of fixing before this will work
-	if( g_uvd )
-	{
-		printf_error("sorry, only one UVD instance supported at a time (active = 0x%08X)\n", (int)g_uvd);
-		return UV_DEBUG(UV_ERR_NOTIMPLEMENTED);
-	}
-
 	uvd = new UVD();
 	if( !uvd )
 	{
@@ -227,12 +258,19 @@ uv_err_t UVD::getUVDFromFileName(UVD **uvdOut, const std::string &file)
 	uv_assert_ret(g_config);
 	uvd->m_config = g_config;
 	
-	if( UV_FAILED(uvd->initFromFileName(file)) )
+	pthread_mutex_lock(&g_uvdLifecycleMutex);
+	//Legacy default engine for code not given one, the first one created
+	if( !g_uvd )
+	{
+		g_uvd = uvd;
+	}
+	rc = uvd->initFromFileName(file);
+	pthread_mutex_unlock(&g_uvdLifecycleMutex);
+	if( UV_FAILED(rc) )
 	{
 		delete uvd;
 		return UV_DEBUG(UV_ERR_GENERAL);
-	}	
-	g_uvd = uvd;
+	}
 
 	uv_assert_ret(uvdOut);
 	*uvdOut = uvd;
@@ -243,28 +281,29 @@ uv_err_t UVD::getUVDFromFileName(UVD **uvdOut, const std::string &file)
 uv_err_t UVD::getUVDFromData(UVD **uvdOut, UVDData *data)
 {
 	UVD *uvd = NULL;
+	uv_err_t rc = UV_ERR_GENERAL;
 	
-	if( g_uvd )
+	uvd = new UVD();
+	if( !uvd )
 	{
-		uvd = g_uvd;
+		return UV_DEBUG(UV_ERR_GENERAL);
 	}
-	else
+	
+	uv_assert_ret(g_config);
+	uvd->m_config = g_config;
+	
+	pthread_mutex_lock(&g_uvdLifecycleMutex);
+	//Legacy default engine for code not given one, the first one created
+	if( !g_uvd )
 	{
-		uvd = new UVD();
-		if( !uvd )
-		{
-			return UV_DEBUG(UV_ERR_GENERAL);
-		}
-		
-		uv_assert_ret(g_config);
-		uvd->m_config = g_config;
 		g_uvd = uvd;
-		
-		if( UV_FAILED(uvd->initFromData(data)) )
-		{
-			delete uvd;
-			return UV_DEBUG(UV_ERR_GENERAL);
-		}
+	}
+	rc = uvd->initFromData(data);
+	pthread_mutex_unlock(&g_uvdLifecycleMutex);
+	if( UV_FAILED(rc) )
+	{
+		delete uvd;
+		return UV_DEBUG(UV_ERR_GENERAL);
 	}
 
 	uv_assert_ret(uvdOut);
@@ -414,13 +453,28 @@ uv_err_t UVD::disassembleByCallback(uvd_string_callback_t callback, void *user)
 	return UV_DEBUG(decompileByCallback(callback, user));
 }
 
+uv_err_t UVD::disassemble(UVDOutputSink *sink)
+{
+	return UV_DEBUG(decompile(sink));
+}
+
 uv_err_t UVD::decompile(std::string &output)
 {
+	UVDStringOutputSink sink;
+
+	output.clear();
+	uv_assert_err_ret(sink.init(&output));
+	return UV_DEBUG(decompile(&sink));
+}
+
+uv_err_t UVD::decompile(UVDOutputSink *sink)
+{
+	UVDProfileScope profileScope("decompile");
 	UVDBenchmark decompileBenchmark;
 	UVDPrintIterator iterBegin;
 	UVDPrintIterator iterEnd;
 
-	output.clear();
+	uv_assert_ret(sink);
 	decompileBenchmark.start();
 
 	//Most of program time should be spent here
@@ -432,7 +486,7 @@ uv_err_t UVD::decompile(std::string &output)
 	uv_assert_err_ret(iterBegin.check());
 	uv_assert_err_ret(end(iterEnd));
 	uv_assert_err_ret(iterEnd.check());
-	uv_assert_err_ret(printRangeCore(iterBegin, iterEnd, UVDPrintToStringStringCallback, &output));
+	uv_assert_err_ret(printRangeCore(iterBegin, iterEnd, sink));
 
 	printf_debug_level(UVD_DEBUG_PASSES, "decompile: done\n");
 	decompileBenchmark.stop();
@@ -443,6 +497,7 @@ uv_err_t UVD::decompile(std::string &output)
 
 uv_err_t UVD::decompileByCallback(uvd_string_callback_t callback, void *user)
 {
+	UVDProfileScope profileScope("decompile");
 	UVDBenchmark decompileBenchmark;
 	UVDPrintIterator iterBegin;
 	UVDPrintIterator iterEnd;
@@ -495,6 +550,7 @@ uv_err_t UVD::setDestinationLanguage(uint32_t destinationLanguage)
 
 uv_err_t UVD::printRangeCore(UVDPrintIterator iterBegin, UVDPrintIterator iterEnd, uvd_string_callback_t callback, void *user)
 {
+	UVDProfileScope profileScope("print");
 	UVDPrintIterator iter;
 	//UVDPrintIterator iterEnd;
 	//int printPercentage = 1;
@@ -591,6 +647,58 @@ uv_err_t UVD::printRangeCore(UVDPrintIterator iterBegin, UVDPrintIterator iterEn
 	return UV_ERR_OK;
 }
 
+uv_err_t UVD::printRangeCore(UVDPrintIterator iterBegin, UVDPrintIterator iterEnd, UVDOutputSink *sink)
+{
+	UVDProfileScope profileScope("print");
+	UVDPrintIterator iter;
+	UVDStdPrintIterator *stdIter = NULL;
+	UVDStdPrintIterator *stdIterEnd = NULL;
+	UVDBenchmark decompilePrintBenchmark;
+	uv_err_t rc = UV_ERR_GENERAL;
+	int verbose_old = 0;
+
+	uv_assert_ret(sink);
+	uv_assert_err_ret(iterBegin.check());
+	uv_assert_err_ret(iterEnd.check());
+	uv_assert_ret(m_config);
+	verbose_old = m_config->m_verbose;
+	m_config->m_verbose = m_config->m_verbose_printing;
+
+	printf_debug_level(UVD_DEBUG_PASSES, "decompile: printing...\n");
+	decompilePrintBenchmark.start();
+	uv_assert_err(iter = iterBegin);
+	uv_assert(iter.m_iter);
+	uv_assert(iterEnd.m_iter);
+
+	stdIter = dynamic_cast<UVDStdPrintIterator *>(iter.m_iter);
+	stdIterEnd = dynamic_cast<UVDStdPrintIterator *>(iterEnd.m_iter);
+	if( stdIter && stdIterEnd )
+	{
+		uv_assert_err(stdIter->printRange(*stdIterEnd, sink));
+	}
+	else
+	{
+		//Other printers only have the line at a time interface
+		while( iter != iterEnd )
+		{
+			std::string line;
+
+			uv_assert_err(iter.getCurrent(line));
+			uv_assert_err(sink->writeLine(line));
+			uv_assert_err(iter.next());
+		}
+	}
+	uv_assert_err(sink->flush());
+
+	decompilePrintBenchmark.stop();
+	printf_debug_level(UVD_DEBUG_PASSES, "decompile print time (%llu bytes): %s\n", (unsigned long long)sink->m_written, decompilePrintBenchmark.toString().c_str());
+	rc = UV_ERR_OK;
+
+error:
+	m_config->m_verbose = verbose_old;
+	return UV_DEBUG(rc);
+}
+
 uv_err_t UVD::setOutputFormatting(UVDFormat *format)
 {
 	uv_assert_ret(format);
@@ -130,11 +130,26 @@ individual instructions
 /*
 UV Decompiler engine
 Primary end user object
+
+Threading
+Independent engines may be used concurrently, one thread per engine
+(ex: analyze() on one while another is being printed)
+A single engine is not thread safe, callers sharing one must serialize access (as the GUI does)
+Shared by all engines:
+-g_config: read only once the first engine is created
+	Every engine's m_config is g_config, so engines can't differ in config yet (not done, needs UVDConfig to stop being a singleton)
+-Plugins: loaded and activated before creating engines
+	Their per engine hooks (onUVDInit()/onUVDDeinit()) run under a process wide lock,
+	so creating and destroying engines is serialized; UVDPlugin::m_uvd is only meaningful during those
+-Architecture data such as uvdasm opcode tables: immutable once loaded
+-Script interpreters with process wide state (ex: embedded Python) lock internally
+g_uvd is only the first engine created, for legacy code
 */
 class UVDEventEngine;
 class UVDArchitecture;
 class UVDObject;
 class UVDRuntime;
+class UVDOutputSink;
 class UVD
 {
 public:
@@ -161,6 +176,8 @@ public:
 	//Core version with a pre-supplied object and architecture
 	uv_err_t init(UVDObject *object, UVDArchitecture *architecture);
 	uv_err_t deinit();
+	//deinit() with the engine lifecycle lock held
+	uv_err_t doDeinit();
 
 	/*
 	Iterator functions
@@ -198,16 +215,21 @@ public:
 	*/
 	uv_err_t disassemble(std::string &output);
 	uv_err_t disassembleByCallback(uvd_string_callback_t callback, void *user);
+	//Preferred for large outputs, memory use doesn't grow with the listing
+	uv_err_t disassemble(UVDOutputSink *sink);
 	/*
 	Given file, generate best representation possible in specified langauge to output file
 	Using what created the engine init
 	*/
 	uv_err_t decompile(std::string &output);
 	uv_err_t decompileByCallback(uvd_string_callback_t callback, void *user);
+	//Flushes sink when done
+	uv_err_t decompile(UVDOutputSink *sink);
 	//Intended for things like printing a function
 	uv_err_t printRange(uv_addr_t start, uv_addr_t end, uint32_t destinationLanguage, std::string &output);
 	//iterEnd is not inclusive
 	uv_err_t printRangeCore(UVDPrintIterator iterBegin, UVDPrintIterator iterEnd, uvd_string_callback_t callback, void *user);
+	uv_err_t printRangeCore(UVDPrintIterator iterBegin, UVDPrintIterator iterEnd, UVDOutputSink *sink);
 	//What we will try to output when printing
 	//Used to format assembly output and such
 	uv_err_t setDestinationLanguage(uint32_t destinationLanguage);
@@ -223,6 +245,8 @@ public:
 	uv_err_t analyzeConstData();
 	uv_err_t analyzeStrings();
 	
+	//One function per called address, running until the next one
+	uv_err_t constructFunctions();
 	uv_err_t mapSymbols();
 #if 0
 	uv_err_t constructBlock(UVDAddressRange addressRange, UVDAnalyzedBlock **blockOut);
@@ -216,6 +216,19 @@ bool UVDDataChunk::operator==(UVDDataChunk &other)
 }
 #endif //else UGLY_READ_HACK
 	
+const uint8_t *UVDDataChunk::getBuffer(unsigned int offset, unsigned int bufferSize) const
+{
+#ifdef UGLY_READ_HACK
+	return NULL;
+#else
+	if( !m_data || offset > m_bufferSize || bufferSize > m_bufferSize - offset )
+	{
+		return NULL;
+	}
+	return m_data->getBuffer(m_offset + offset, bufferSize);
+#endif
+}
+
 uint32_t UVDDataChunk::getMin()
 {
 	return m_offset;
@@ -17,6 +17,34 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvd/data/data.h"
 #include "uvd/util/types.h"
 
+/*
+UVDDataView
+*/
+
+UVDDataView::UVDDataView()
+{
+	m_buffer = NULL;
+	m_bufferSize = 0;
+	m_copy = NULL;
+}
+
+UVDDataView::~UVDDataView()
+{
+	reset();
+}
+
+void UVDDataView::reset()
+{
+	free(m_copy);
+	m_copy = NULL;
+	m_buffer = NULL;
+	m_bufferSize = 0;
+}
+
+/*
+UVDData
+*/
+
 UVDData::UVDData()
 {
 }
@@ -173,6 +201,33 @@ int UVDData::read(unsigned int offset) const
 	return (unsigned int)(unsigned char)c;
 }
 
+const uint8_t *UVDData::getBuffer(uint32_t, uint32_t) const
+{
+	//No idea how we are stored, caller must copy
+	return NULL;
+}
+
+uv_err_t UVDData::getView(uint32_t offset, uint32_t bufferSize, UVDDataView &view) const
+{
+	const uint8_t *buffer = NULL;
+	
+	view.reset();
+	
+	buffer = getBuffer(offset, bufferSize);
+	if( !buffer )
+	{
+		//Non-contiguous source, fall back to a copy
+		view.m_copy = (uint8_t *)malloc(bufferSize ? bufferSize : 1);
+		uv_assert_ret(view.m_copy);
+		uv_assert_err_ret(readData(offset, (char *)view.m_copy, bufferSize));
+		buffer = view.m_copy;
+	}
+	view.m_buffer = buffer;
+	view.m_bufferSize = bufferSize;
+	
+	return UV_ERR_OK;
+}
+
 uv_err_t UVDData::writeData(uint32_t offset, const char *buffer, unsigned int bufferSize)
 {
 	return UV_DEBUG(UV_ERR_GENERAL);
@@ -32,6 +32,37 @@ PDP mixed endian
 #define UVD_DATA_ENDIAN_DEFAULT				UVD_DATA_ENDIAN_LITTLE
 #endif
 
+/*
+A read only window onto a range of a UVDData
+If the source is contiguous in memory (memory buffer, mapped file, etc) this points directly into it
+Otherwise, the range is copied into a buffer owned by the view
+Either way, m_buffer is only valid while the source data is not modified or destroyed
+*/
+class UVDDataView
+{
+public:
+	UVDDataView();
+	~UVDDataView();
+	
+	//Release any copy we are holding
+	void reset();
+	
+	inline const uint8_t *begin() const { return m_buffer; }
+	inline const uint8_t *end() const { return m_buffer + m_bufferSize; }
+	inline uint32_t size() const { return m_bufferSize; }
+
+private:
+	//Would need to duplicate m_copy, just don't
+	UVDDataView(const UVDDataView &other);
+	UVDDataView &operator=(const UVDDataView &other);
+
+public:
+	const uint8_t *m_buffer;
+	uint32_t m_bufferSize;
+	//Only set if we had to fall back to a copy, we own this
+	uint8_t *m_copy;
+};
+
 /*
 Abstracts how we get the data for the disassembly
 Similar in concept to BFD
@@ -83,6 +114,18 @@ public:
 	//Named resolved version of above
 	inline int readByte(uint32_t offset) const { return read(offset); }
 
+	/*
+	If [offset, offset + bufferSize) is contiguous in memory, return a pointer to offset
+	Otherwise return NULL and the caller must use one of the read functions
+	No copy is made: don't hold onto the pointer past modification or destruction of this object
+	*/
+	virtual const uint8_t *getBuffer(uint32_t offset, uint32_t bufferSize) const;
+	/*
+	Zero copy access to a range when getBuffer() can provide it, otherwise copy into the view
+	Errors if the full range cannot be read
+	*/
+	uv_err_t getView(uint32_t offset, uint32_t bufferSize, UVDDataView &view) const;
+
 	//Try to move away from returning int
 	virtual uv_err_t writeData(uint32_t offset, const char *buffer, uint32_t bufferSize);
 	virtual uv_err_t writeData(uint32_t offset, const UVDData *data);
@@ -190,6 +233,30 @@ public:
 	FILE *m_pFile;
 };
 
+/*
+A file mapped into our address space
+Reads are plain memory accesses and getBuffer() can hand out pointers into the mapping
+getUVDDataFile() prefers this and falls back to UVDDataFile if the file can't be mapped
+*/
+class UVDDataMappedFile : public UVDDataFile
+{
+public:
+	UVDDataMappedFile();
+	uv_err_t init(const std::string &file);
+	virtual ~UVDDataMappedFile();
+	void deinit();
+
+	int read(uint32_t offset, char *buffer, uint32_t bufferSize) const;
+	int read(uint32_t offset) const;
+	const uint8_t *getBuffer(uint32_t offset, uint32_t bufferSize) const;
+	uint32_t size() const;
+
+public:
+	const uint8_t *m_map;
+	//File size at time of mapping
+	uint32_t m_mapSize;
+};
+
 class UVDCompressedDataFile : public UVDDataFile
 {
 public:
@@ -220,6 +287,7 @@ public:
 	uv_err_t realloc(uint32_t bufferSize);
 	
 	int read(uint32_t offset, char *buffer, uint32_t bufferSize) const;
+	const uint8_t *getBuffer(uint32_t offset, uint32_t bufferSize) const;
 	uv_err_t writeData(uint32_t offset, const char *buffer, uint32_t bufferSize);
 	uint32_t size() const;
 	
@@ -289,6 +357,8 @@ public:
 	uint32_t size() const;
 
 	virtual int read(uint32_t offset, char *buffer, uint32_t bufferSize) const;	
+	//Passes through to the underlying data if possible
+	virtual const uint8_t *getBuffer(uint32_t offset, uint32_t bufferSize) const;
 
 	uv_err_t deepCopy(UVDData **out);
 
@@ -48,12 +48,23 @@ uv_err_t UVDDataFile::getUVDDataFile(UVDDataFile** pDataFile, const std::string
 uv_err_t UVDDataFile::getUVDDataFile(UVDData **pDataFile, const std::string &file)
 {
 	UVDDataFile *dataFile = NULL;
+	UVDDataMappedFile *mappedFile = NULL;
 	uv_err_t rc = UV_ERR_GENERAL;
 
 	if( !pDataFile )
 	{
 		return UV_ERR_GENERAL;
 	}
+	
+	//Prefer a mapping so readers can scan directly over memory
+	mappedFile = new UVDDataMappedFile();
+	if( mappedFile && UV_SUCCEEDED(mappedFile->init(file)) )
+	{
+		*pDataFile = mappedFile;
+		return UV_ERR_OK;
+	}
+	delete mappedFile;
+	
 	dataFile = new UVDDataFile();
 	if( !dataFile )
 	{
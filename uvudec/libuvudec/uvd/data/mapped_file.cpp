@@ -0,0 +1,123 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2008 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "uvd/util/debug.h"
+#include "uvd/util/util.h"
+#include "uvd/data/data.h"
+#include "uvd/util/types.h"
+
+/*
+UVDDataMappedFile
+*/
+
+UVDDataMappedFile::UVDDataMappedFile()
+{
+	m_map = NULL;
+	m_mapSize = 0;
+}
+
+UVDDataMappedFile::~UVDDataMappedFile()
+{
+	deinit();
+}
+
+uv_err_t UVDDataMappedFile::init(const std::string &file)
+{
+	struct stat statStruct;
+	void *map = NULL;
+
+	//Not an error to fail here, caller is expected to fall back to stdio
+	if( UV_FAILED(UVDDataFile::init(file)) )
+	{
+		return UV_ERR_GENERAL;
+	}
+	if( fstat(fileno(m_pFile), &statStruct) )
+	{
+		return UV_ERR_GENERAL;
+	}
+	//Can't map 0 bytes and don't want to deal with pipes and such
+	if( !S_ISREG(statStruct.st_mode) || statStruct.st_size == 0
+			|| (uint64_t)statStruct.st_size > (uint64_t)UINT_MAX )
+	{
+		return UV_ERR_GENERAL;
+	}
+
+	map = mmap(NULL, statStruct.st_size, PROT_READ, MAP_PRIVATE, fileno(m_pFile), 0);
+	if( map == MAP_FAILED )
+	{
+		return UV_ERR_GENERAL;
+	}
+	//Most of our access is a forward sweep
+	madvise(map, statStruct.st_size, MADV_SEQUENTIAL);
+	m_map = (const uint8_t *)map;
+	m_mapSize = statStruct.st_size;
+
+	//Mapping holds its own reference to the file
+	fclose(m_pFile);
+	m_pFile = NULL;
+
+	return UV_ERR_OK;
+}
+
+void UVDDataMappedFile::deinit()
+{
+	if( m_map )
+	{
+		munmap((void *)m_map, m_mapSize);
+		m_map = NULL;
+	}
+	m_mapSize = 0;
+	UVDDataFile::deinit();
+}
+
+uint32_t UVDDataMappedFile::size() const
+{
+	return m_mapSize;
+}
+
+int UVDDataMappedFile::read(unsigned int offset, char *buffer, unsigned int bufferSize) const
+{
+	unsigned int leftToRead = 0;
+
+	if( !m_map || offset > m_mapSize )
+	{
+		return -1;
+	}
+
+	//Truncate at end of file like fread() would
+	leftToRead = m_mapSize - offset;
+	if( leftToRead > bufferSize )
+	{
+		leftToRead = bufferSize;
+	}
+	memcpy(buffer, m_map + offset, leftToRead);
+	return leftToRead;
+}
+
+int UVDDataMappedFile::read(unsigned int offset) const
+{
+	if( !m_map || offset >= m_mapSize )
+	{
+		return -1;
+	}
+	return m_map[offset];
+}
+
+const uint8_t *UVDDataMappedFile::getBuffer(unsigned int offset, unsigned int bufferSize) const
+{
+	if( !m_map || offset > m_mapSize || bufferSize > m_mapSize - offset )
+	{
+		return NULL;
+	}
+	return m_map + offset;
+}
@@ -189,6 +189,18 @@ int UVDDataMemory::read(unsigned int offset, char *buffer, unsigned int bufferSi
 	return bufferSize;
 }
 
+const uint8_t *UVDDataMemory::getBuffer(unsigned int offset, unsigned int bufferSize) const
+{
+	uint32_t thisSize = size();
+	
+	//Careful of wraparound on large requests
+	if( !m_buffer || offset > thisSize || bufferSize > thisSize - offset )
+	{
+		return NULL;
+	}
+	return (const uint8_t *)m_buffer + offset;
+}
+
 uv_err_t UVDDataMemory::deepCopy(UVDData **out)
 {
 	//FIXME: this won't work as well for buffered version
@@ -20,6 +20,8 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 //Function no longer exists
 //#define UVD_EVENT_FUNCTION_DELETED		UVD_EVENT_STATIC(0x0002)
 #define UVD_EVENT_FUNCTION_CHANGED			UVD_EVENT_STATIC(0x0003)
+//Functions have been located, plugins should try to name them from known code (FLIRT, etc)
+#define UVD_EVENT_IDENTIFY_FUNCTIONS		UVD_EVENT_STATIC(0x0004)
 
 #endif
 
@@ -38,6 +38,8 @@ Will have to see how hard it is to calc mem addresses rather than file
 #define UVD_LANGUAGE_PYTHON						100
 #define UVD_LANGUAGE_LUA						101
 #define UVD_LANGUAGE_JAVASCRIPT					102
+//uvdasm's native ACTION expression evaluator
+#define UVD_LANGUAGE_BUILTIN					103
 
 /*
 Best suited for things of different types, or an as yet
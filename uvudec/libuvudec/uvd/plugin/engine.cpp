@@ -8,6 +8,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvd/plugin/plugin.h"
 #include "uvd/core/uvd.h"
 #include "uvd/config/config.h"
+#include "uvd/util/profile.h"
 #include <boost/filesystem.hpp>
 #include <dlfcn.h>
 
@@ -446,7 +447,12 @@ uv_err_t UVDPluginEngine::activatePluginByName(const std::string &name)
 		uv_assert_err_ret(ensurePluginActiveByName(dependentPlugin->getName()));
 	}
 	
-	uv_assert_err_ret(plugin->init(g_config));
+	{
+		std::string profileName = "plugin:" + name;
+		UVDProfileScope profileScope(profileName.c_str());
+
+		uv_assert_err_ret(plugin->init(g_config));
+	}
 	m_loadedPlugins[name] = plugin;
 	
 	//Notify callbacks
@@ -485,6 +491,15 @@ uv_err_t UVDPluginEngine::registerPluginActivatedCallback(OnPluginActivated call
 	return UV_ERR_OK;
 }
 
+uv_err_t UVDPluginEngine::unregisterPluginActivatedCallback(OnPluginActivated callback, void *user)
+{
+	if( m_onPluginActivated.erase(OnPluginActivatedItem(callback, user)) == 0 )
+	{
+		return UV_ERR_NOTFOUND;
+	}
+	return UV_ERR_OK;
+}
+
 uv_err_t UVDPluginEngine::ensurePluginActiveByName(const std::string &name)
 {
 	if( m_plugins.find(name) == m_plugins.end() )
@@ -541,6 +556,8 @@ uv_err_t UVDPluginEngine::onUVDInit()
 		}
 		
 		uv_assert_ret(plugin);
+		std::string profileName = "plugin:" + plugin->getName();
+		UVDProfileScope profileScope(profileName.c_str());
 		//FIXME: add config for potentially nonfatal errors
 		uv_assert_err_ret(plugin->onUVDInit());
 	}
@@ -77,6 +77,8 @@ public:
 	uv_err_t getPluginDependencyOrder(std::vector<UVDPlugin *> &out);
 
 	uv_err_t registerPluginActivatedCallback(OnPluginActivated callback, void *user, bool emitAlreadyLoaded);
+	//UV_ERR_NOTFOUND if not registered
+	uv_err_t unregisterPluginActivatedCallback(OnPluginActivated callback, void *user);
 
 protected:
 	//Initialize statically linked plugins
@@ -8,6 +8,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 
 UVDStringsAnalyzer::UVDStringsAnalyzer()
 {
+	m_uvd = NULL;
 }
 
 UVDStringsAnalyzer::~UVDStringsAnalyzer()
@@ -10,6 +10,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvd/string/string.h"
 #include "uvd/util/types.h"
 
+class UVD;
 class UVDStringsAnalyzer
 {
 public:
@@ -17,8 +18,16 @@ public:
 	virtual ~UVDStringsAnalyzer();
 	
 	//virtual uv_err_t analyze() = 0;
-	//Do not clear the vector
+	/*
+	Do not clear the vector
+	Strings should be appended in address space then address order
+	May use the analyzer thread pool, see UVDAnalyzer::getThreadPool()
+	*/
 	virtual uv_err_t appendAllStrings(std::vector<UVDString> &out) = 0;
+
+public:
+	//Engine being analyzed, set by UVDStringEngine when the analyzer is added
+	UVD *m_uvd;
 };
 
 #endif
@@ -6,8 +6,47 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 
 #include "uvd/string/engine.h"
 #include "uvd/plugin/engine.h"
+#include "uvd/core/runtime.h"
 #include "uvd/core/uvd.h"
 #include "uvd/util/benchmark.h"
+#include "uvd/util/profile.h"
+#include <algorithm>
+#include <map>
+
+/*
+Address order: by address space in UVDAddressSpaces order, then address
+*/
+class UVDStringAddressLess
+{
+public:
+	UVDStringAddressLess(const std::map<UVDAddressSpace *, uint32_t> *spaceOrder)
+	{
+		m_spaceOrder = spaceOrder;
+	}
+
+	bool operator()(const UVDString &a, const UVDString &b) const
+	{
+		if( a.m_addressRange.m_space != b.m_addressRange.m_space )
+		{
+			return getSpaceOrder(a.m_addressRange.m_space) < getSpaceOrder(b.m_addressRange.m_space);
+		}
+		return a.m_addressRange.m_min_addr < b.m_addressRange.m_min_addr;
+	}
+
+	uint32_t getSpaceOrder(UVDAddressSpace *space) const
+	{
+		std::map<UVDAddressSpace *, uint32_t>::const_iterator iter = m_spaceOrder->find(space);
+		
+		if( iter == m_spaceOrder->end() )
+		{
+			return m_spaceOrder->size();
+		}
+		return (*iter).second;
+	}
+
+public:
+	const std::map<UVDAddressSpace *, uint32_t> *m_spaceOrder;
+};
 
 /*
 UVDStringEngine
@@ -22,6 +61,12 @@ static uv_err_t onPluginActivated(UVDPlugin *plugin, void *user)
 UVDStringEngine::UVDStringEngine()
 {
 	m_uvd = NULL;
+	m_registered = false;
+}
+
+UVDStringEngine::~UVDStringEngine()
+{
+	deinit();
 }
 
 uv_err_t UVDStringEngine::init(UVD *uvd)
@@ -32,11 +77,30 @@ uv_err_t UVDStringEngine::init(UVD *uvd)
 	pluginEngine = &m_uvd->m_config->m_plugin.m_pluginEngine;
 
 	uv_assert_err_ret(pluginEngine->registerPluginActivatedCallback(onPluginActivated, this, true));
+	m_registered = true;
 	//uv_assert_err_ret(findAnalyzers());
 	
 	return UV_ERR_OK;
 }
 
+uv_err_t UVDStringEngine::deinit()
+{
+	if( m_registered && m_uvd && m_uvd->m_config )
+	{
+		UV_DEBUG(m_uvd->m_config->m_plugin.m_pluginEngine.unregisterPluginActivatedCallback(onPluginActivated, this));
+	}
+	m_registered = false;
+	
+	for( std::set<UVDStringsAnalyzer *>::iterator iter = m_analyzers.begin(); iter != m_analyzers.end(); ++iter )
+	{
+		delete *iter;
+	}
+	m_analyzers.clear();
+	m_strings.clear();
+	
+	return UV_ERR_OK;
+}
+
 uv_err_t UVDStringEngine::pluginActivatedCallback(UVDPlugin *plugin)
 {
 	return UV_DEBUG(tryPlugin(plugin));
@@ -89,6 +153,8 @@ uv_err_t UVDStringEngine::tryPlugin(UVDPlugin *plugin)
 	}
 	uv_assert_err_ret(rc);
 	uv_assert_ret(analyzer);
+	//Plugins are shared by all engines, analyzers are per engine
+	analyzer->m_uvd = m_uvd;
 	m_analyzers.insert(analyzer);
 
 	return UV_ERR_OK;
@@ -96,6 +162,7 @@ uv_err_t UVDStringEngine::tryPlugin(UVDPlugin *plugin)
 
 uv_err_t UVDStringEngine::getAllStrings(std::vector<UVDString> &out)
 {
+	UVDProfileScope profileScope("strings");
 	printf_debug_level(UVD_DEBUG_PASSES, "UVDStringsAnalyzerImpl: getting/analyzering strings...\n");
 	UVDBenchmark stringAnalysisBenchmark;
 	stringAnalysisBenchmark.start();
@@ -108,7 +175,20 @@ uv_err_t UVDStringEngine::getAllStrings(std::vector<UVDString> &out)
 		
 		uv_assert_err_ret(analyzer->appendAllStrings(out));
 	}
+	//Each analyzer gives address order, merge theirs
+	if( m_analyzers.size() > 1 )
+	{
+		std::map<UVDAddressSpace *, uint32_t> spaceOrder;
+		std::vector<UVDAddressSpace *> &addressSpaces = m_uvd->m_runtime->m_addressSpaces.m_addressSpaces;
+		
+		for( uint32_t i = 0; i < addressSpaces.size(); ++i )
+		{
+			spaceOrder[addressSpaces[i]] = i;
+		}
+		std::stable_sort(out.begin(), out.end(), UVDStringAddressLess(&spaceOrder));
+	}
 
+	g_profileStringsFound.add(out.size());
 	stringAnalysisBenchmark.stop();
 	printf_debug_level(UVD_DEBUG_PASSES, "string analysis time: %s\n", stringAnalysisBenchmark.toString().c_str());
 	
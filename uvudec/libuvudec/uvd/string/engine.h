@@ -31,11 +31,13 @@ class UVDStringEngine
 {
 public:
 	UVDStringEngine();
+	~UVDStringEngine();
 	uv_err_t init(UVD *uvd);
+	uv_err_t deinit();
 	
 	//Called when a new plugin is loaded/activated
 	uv_err_t pluginActivatedCallback(UVDPlugin *plugin);
-	//Have all string analyzers do their magic and populate the DB
+	//Have all string analyzers do their magic and populate the DB, strings are in address order
 	uv_err_t analyze();
 	//Clear analyzer DB and re-populate it
 	//FIXME: maybe need to register callback to probe new plugins as loaded?
@@ -54,8 +56,11 @@ public:
 
 	//There are no priority rules right now
 	//Mostly I'm currently just trying to create an updgrade path to make the system more flexible later
+	//Owned
 	std::set<UVDStringsAnalyzer *> m_analyzers;
 	UVD *m_uvd;
+	//Plugin engine is shared by all engines, don't leave it calling back into a freed one
+	bool m_registered;
 };
 
 #endif
@@ -5,6 +5,43 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 */
 
 #include "uvd/string/string.h"
+#include "uvd/util/debug.h"
+#include "uvd/util/error.h"
+#include "uvd/util/util.h"
+#include <string.h>
+
+const UVDEBCDICRange g_ebcdicPrintableRanges[] =
+{
+	{0x40, " "},
+	{0x4B, ".<(+|&"},
+	{0x5A, "!$*);"},
+	{0x60, "-/"},
+	{0x6B, ",%_>?"},
+	{0x79, "`:#@'=\""},
+	{0x81, "abcdefghi"},
+	{0x91, "jklmnopqr"},
+	{0xA1, "~stuvwxyz"},
+	{0xC0, "{ABCDEFGHI"},
+	{0xD0, "}JKLMNOPQR"},
+	{0xE0, "\\"},
+	{0xE2, "STUVWXYZ"},
+	{0xF0, "0123456789"},
+};
+const unsigned int g_ebcdicPrintableRangeCount = sizeof(g_ebcdicPrintableRanges) / sizeof(g_ebcdicPrintableRanges[0]);
+
+char UVDEBCDICToASCII(uint8_t c)
+{
+	for( unsigned int i = 0; i < g_ebcdicPrintableRangeCount; ++i )
+	{
+		const UVDEBCDICRange &range = g_ebcdicPrintableRanges[i];
+		
+		if( c >= range.m_first && c < range.m_first + strlen(range.m_ascii) )
+		{
+			return range.m_ascii[c - range.m_first];
+		}
+	}
+	return 0;
+}
 
 /*
 UVDString
@@ -27,6 +64,80 @@ UVDString::~UVDString()
 
 uv_err_t UVDString::readString(std::string &out, bool safe) const
 {
-	return UV_DEBUG(m_addressRange.memoryToString(out, safe));
+	std::string raw;
+	std::string decoded;
+	unsigned int characterSize = getCharacterSize(m_encoding);
+	
+	if( m_encoding == UVD_STRING_ENCODING_ASCII || m_encoding == UVD_STRING_ENCODING_UNKNOWN )
+	{
+		return UV_DEBUG(m_addressRange.memoryToString(out, safe));
+	}
+	uv_assert_ret(characterSize);
+	
+	uv_assert_err_ret(m_addressRange.memoryToString(raw, false));
+	for( std::string::size_type i = 0; i + characterSize <= raw.size(); i += characterSize )
+	{
+		const uint8_t *character = (const uint8_t *)raw.c_str() + i;
+		uint32_t code = 0;
+		
+		switch( m_encoding )
+		{
+		case UVD_STRING_ENCODING_EBCDIC:
+			//Keep the terminator as ASCII strings do
+			if( character[0] == 0 )
+			{
+				decoded += '\0';
+			}
+			else
+			{
+				char c = UVDEBCDICToASCII(character[0]);
+				decoded += c ? c : '?';
+			}
+			continue;
+		case UVD_STRING_ENCODING_BIG_ENDIAN16:
+			code = (character[0] << 8) | character[1];
+			break;
+		case UVD_STRING_ENCODING_LITTLE_ENDIAN16:
+			code = character[0] | (character[1] << 8);
+			break;
+		case UVD_STRING_ENCODING_BIG_ENDIAN32:
+			code = (character[0] << 24) | (character[1] << 16) | (character[2] << 8) | character[3];
+			break;
+		case UVD_STRING_ENCODING_LITTLE_ENDIAN32:
+			code = character[0] | (character[1] << 8) | (character[2] << 16) | (character[3] << 24);
+			break;
+		default:
+			return UV_DEBUG(UV_ERR_GENERAL);
+		}
+		decoded += code < 0x80 ? (char)code : '?';
+	}
+	
+	if( safe )
+	{
+		out = UVDSafeStringFromBuffer(decoded.c_str(), decoded.size());
+	}
+	else
+	{
+		out = decoded;
+	}
+	return UV_ERR_OK;
+}
+
+unsigned int UVDString::getCharacterSize(UVDStringEncoding encoding)
+{
+	switch( encoding )
+	{
+	case UVD_STRING_ENCODING_ASCII:
+	case UVD_STRING_ENCODING_EBCDIC:
+		return 1;
+	case UVD_STRING_ENCODING_BIG_ENDIAN16:
+	case UVD_STRING_ENCODING_LITTLE_ENDIAN16:
+		return 2;
+	case UVD_STRING_ENCODING_BIG_ENDIAN32:
+	case UVD_STRING_ENCODING_LITTLE_ENDIAN32:
+		return 4;
+	default:
+		return 0;
+	}
 }
 
@@ -49,6 +49,22 @@ Assorted other archeaic encodings
 #define UVD_STRING_ENCODING_EBCDIC				6
 typedef int UVDStringEncoding;
 
+/*
+EBCDIC as IBM code page 037
+Only the printable characters that have an ASCII equivalent are recognized
+They come in runs of consecutive codes, each listed with the ASCII characters it maps to
+*/
+class UVDEBCDICRange
+{
+public:
+	uint8_t m_first;
+	const char *m_ascii;
+};
+extern const UVDEBCDICRange g_ebcdicPrintableRanges[];
+extern const unsigned int g_ebcdicPrintableRangeCount;
+//0 if c isn't a printable EBCDIC character
+char UVDEBCDICToASCII(uint8_t c);
+
 class UVDString
 {
 public:
@@ -56,9 +72,15 @@ public:
 	UVDString(UVDAddressRange addressRange, UVDStringEncoding encoding = UVD_STRING_ENCODING_ASCII);
 	~UVDString();
 	
-	//Try to convert to a std::string
+	/*
+	Try to convert to a std::string
+	Wide and EBCDIC characters are narrowed to ASCII, anything without an ASCII equivalent becomes '?'
+	*/
 	uv_err_t readString(std::string &out, bool safe = true) const;
 
+	//Bytes per character, 0 if unknown
+	static unsigned int getCharacterSize(UVDStringEncoding encoding);
+
 public:
 	UVDStringEncoding m_encoding;
 	UVDAddressRange m_addressRange;
@@ -114,11 +114,16 @@ UVDSectionConfigFile::~UVDSectionConfigFile()
 uv_err_t UVDSectionConfigFile::fromFileNameByDot(const std::string &configFileName, UVDSectionConfigFile &sectionsOut)
 {
 	std::string configFileData;
-	std::vector<std::string> lines;
-	unsigned int start_index = 0;
 	
 	printf_debug("Reading file...\n");
 	uv_assert_err_ret(UVDReadFileByString(configFileName, configFileData));
+	return UV_DEBUG(fromStringByDot(configFileData, sectionsOut));
+}
+
+uv_err_t UVDSectionConfigFile::fromStringByDot(const std::string &configFileData, UVDSectionConfigFile &sectionsOut)
+{
+	std::vector<std::string> lines;
+	unsigned int start_index = 0;
 	
 	//Find out how many sections we got
 	lines = UVDSplitLines(configFileData);
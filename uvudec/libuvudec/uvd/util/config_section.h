@@ -65,6 +65,8 @@ public:
 	//static uv_err_t readSections(const std::string config_file, std::vector<UVDConfigSection> &sectionsIn);
 	//Splits on .SECTIOs type names
 	static uv_err_t fromFileNameByDot(const std::string &fileNameIn, UVDSectionConfigFile &out);
+	//Same as above for an already read file
+	static uv_err_t fromStringByDot(const std::string &configFileData, UVDSectionConfigFile &out);
 	//NAME= type delim
 	static uv_err_t fromFileNameByDelim(const std::string &fileNameIn, const std::string &delim,
 			UVDSectionConfigFile &out);
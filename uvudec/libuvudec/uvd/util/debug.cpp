@@ -20,11 +20,13 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include <execinfo.h>
 #endif
 
-static const char *g_last_func = NULL;
+//Per thread, each thread running an engine has its own last function
+static __thread const char *g_last_func = NULL;
 
 //#define UVD_DEBUG_TYPE_DEFAULT			UVD_DEBUG_TYPE_ALL
 #define UVD_DEBUG_TYPE_DEFAULT			UVD_DEBUG_TYPE_NONE
 uint32_t g_debugTypeFlags = UVD_DEBUG_TYPE_DEFAULT;
+uint32_t g_debugLevel = UVD_DEBUG_NONE;
 
 static void uvd_signal_handler(int sig)
 {
@@ -64,15 +66,21 @@ uv_err_t UVDSetDebugFlag(uint32_t flag, uint32_t shouldSet)
 {
 	if( shouldSet )
 	{
-		g_debugTypeFlags |= flag;
+		__sync_fetch_and_or(&g_debugTypeFlags, flag);
 	}
 	else
 	{
-		g_debugTypeFlags &= ~flag;
+		__sync_fetch_and_and(&g_debugTypeFlags, ~flag);
 	}
 	return UV_ERR_OK;
 }
 
+uv_err_t UVDSetDebugLevel(uint32_t level)
+{
+	g_debugLevel = level;
+	return UV_ERR_OK;
+}
+
 bool UVDGetDebugFlag(uint32_t flag)
 {
 	return g_debugTypeFlags & flag;
@@ -100,49 +108,33 @@ void printf_debug_core(uint32_t level, uint32_t type, const char *file, uint32_t
 {
 	FILE *fileHandle = g_log_handle;
 	va_list ap;
-	uint32_t verbose = 0;
-	uint32_t set_level = 0;
+	std::string typePrefix;
 
-	if( shouldPrintType(type) )
+	//Normally already checked by printf_debug_macro
+	if( !shouldPrintType(type) || level > g_debugLevel )
 	{
-		std::string typePrefix;
-		
-		//Keep logging before g_config initialized
-		if( !fileHandle )
-		{
-			fileHandle = stdout;
-		}
-		if( g_config )
-		{
-			set_level = g_config->m_debugLevel;
-		}
-		else
-		{
-			verbose = 0;
-			set_level = 0;
-		}
+		return;
+	}
 	
-		//Is logging disabled or are we at too high of a level?
-		if( level > set_level )
-		{
-			return;
-		}
-		
-		if( g_config && g_config->m_modulePrefixes.find(type) != g_config->m_modulePrefixes.end() )
+	//Keep logging before g_config initialized
+	if( !fileHandle )
+	{
+		fileHandle = stdout;
+	}
+	if( g_config && !g_config->m_modulePrefixes.empty() && g_config->m_modulePrefixes.find(type) != g_config->m_modulePrefixes.end() )
+	{
+		typePrefix = g_config->m_modulePrefixes[type];
+		if( !typePrefix.empty() )
 		{
-			typePrefix = g_config->m_modulePrefixes[type];
-			if( !typePrefix.empty() )
-			{
-				typePrefix += ": ";
-			}
+			typePrefix += ": ";
 		}
-		printf_debug_prefix(fileHandle, typePrefix.c_str(), file, line, func);
-
-		va_start(ap, format);
-		vfprintf(fileHandle, format, ap);
-		fflush(fileHandle);
-		va_end(ap);
 	}
+	printf_debug_prefix(fileHandle, typePrefix.c_str(), file, line, func);
+
+	va_start(ap, format);
+	vfprintf(fileHandle, format, ap);
+	fflush(fileHandle);
+	va_end(ap);
 }
 
 void uv_enter(const char *file, uint32_t line, const char *func)
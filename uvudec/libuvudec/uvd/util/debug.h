@@ -40,6 +40,22 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #define UVD_DEBUG_VERBOSE		5
 //extern int g_verbose_level;
 
+/*
+Messages above this level are compiled out
+ex: -DUVD_DEBUG_LEVEL_MAX=UVD_DEBUG_PASSES for a release build that keeps pass timing available
+*/
+#ifndef UVD_DEBUG_LEVEL_MAX
+#define UVD_DEBUG_LEVEL_MAX		UVD_DEBUG_VERBOSE
+#endif
+
+#ifdef __GNUC__
+#define UVD_LIKELY(x)			__builtin_expect(!!(x), 1)
+#define UVD_UNLIKELY(x)			__builtin_expect(!!(x), 0)
+#else
+#define UVD_LIKELY(x)			(x)
+#define UVD_UNLIKELY(x)			(x)
+#endif
+
 const char *get_last_func();
 
 /*
@@ -142,7 +158,26 @@ Trying to avoid relying on g_uvd...hard to do without that since otherwise lacki
 #define printf_debug(format, ...) printf_debug_level(UVD_DEBUG_VERBOSE, format, ## __VA_ARGS__)
 #define printf_debug_type(type, format, ...) printf_debug_macro(UVD_DEBUG_TEMP, type, format, ## __VA_ARGS__)
 #define printf_debug_level(level, format, ...) printf_debug_macro(level, UVD_DEBUG_TYPE_ALL, format, ## __VA_ARGS__)
-#define printf_debug_macro(level, type, format, ...) printf_debug_core(level, type, UVD_FILE, __LINE__, __FUNCTION__, format, ## __VA_ARGS__)
+/*
+Disabled messages cost a load and a branch on the cached flags
+Arguments aren't evaluated and nothing is formatted unless the message will be printed
+*/
+#define printf_debug_macro(level, type, format, ...) do { \
+		if( UVDDebugEnabled(level, type) ) \
+		{ \
+			printf_debug_core(level, type, UVD_FILE, __LINE__, __FUNCTION__, format, ## __VA_ARGS__); \
+		} \
+	} while( 0 )
+#define UVDDebugEnabled(level, type)	((level) <= UVD_DEBUG_LEVEL_MAX \
+		&& UVD_UNLIKELY(((type) & g_debugTypeFlags) && (level) <= g_debugLevel))
+/*
+Set through UVDSetDebugFlag() / UVDSetDebugLevel()
+Worker threads read these unlocked: aligned 32 bit loads can't tear
+and a thread seeing a change late only prints or skips a message around the change
+Flag changes are atomic read-modify-writes so concurrent ones don't drop each other's bits
+*/
+extern uint32_t g_debugTypeFlags;
+extern uint32_t g_debugLevel;
 void printf_debug_core(uint32_t level, uint32_t type, const char *file, uint32_t line, const char *func, const char *format, ...);
 //void UVDPrintfDebugCore(uint32_t level, const std::string &type, const char *file, uint32_t line, const char *func, const char *format, ...);
 
@@ -152,7 +187,17 @@ void printf_debug_core(uint32_t level, uint32_t type, const char *file, uint32_t
 uv_err_t uv_err_ret_handler(uv_err_t rc, const char *file, uint32_t line, const char *func);
 void uv_enter(const char *file, uint32_t line, const char *func);
 
-#define UV_DEBUG(x) uv_err_ret_handler(x, UVD_FILE, __LINE__, __FUNCTION__)
+//Only calls out to the handler if there is something it might print
+static inline uv_err_t uv_err_ret_check(uv_err_t rc, const char *file, uint32_t line, const char *func)
+{
+	if( UVD_UNLIKELY(rc != UV_ERR_OK && g_debugTypeFlags) )
+	{
+		return uv_err_ret_handler(rc, file, line, func);
+	}
+	return rc;
+}
+
+#define UV_DEBUG(x) uv_err_ret_check(x, UVD_FILE, __LINE__, __FUNCTION__)
 //This was an old distinction
 #define UV_ERR		UV_DEBUG
 #define UV_ENTER() uv_enter(UVD_FILE, __LINE__, __FUNCTION__)
@@ -167,6 +212,8 @@ uv_err_t UVDDebugDeinit();
 //Log file
 uv_err_t UVDSetDebugFile(const std::string &file);
 uv_err_t UVDSetDebugFlag(uint32_t flag, uint32_t shouldSet);
+//Highest UVD_DEBUG_* level printed, kept by UVDConfig::setDebugLevel()
+uv_err_t UVDSetDebugLevel(uint32_t level);
 //Returns true if the given flag is set
 bool UVDGetDebugFlag(uint32_t flag);
 bool UVDAnyDebugActive();
@@ -22,6 +22,8 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include <linux/limits.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <dirent.h>
+#include <algorithm>
 
 uv_err_t UVDGetInstallDir(std::string &installDir)
 {
@@ -299,6 +301,34 @@ uv_err_t isDir(const std::string &file)
 	}
 }
 
+uv_err_t getDirFiles(const std::string &dir, std::vector<std::string> &out)
+{
+	DIR *dirHandle = NULL;
+	struct dirent *entry = NULL;
+	std::vector<std::string> files;
+	
+	dirHandle = opendir(dir.c_str());
+	if( !dirHandle )
+	{
+		printf_error("could not open dir %s\n", dir.c_str());
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	while( (entry = readdir(dirHandle)) != NULL )
+	{
+		std::string file = dir + "/" + entry->d_name;
+		
+		if( UV_SUCCEEDED(isRegularFile(file)) )
+		{
+			files.push_back(file);
+		}
+	}
+	closedir(dirHandle);
+	
+	std::sort(files.begin(), files.end());
+	out.insert(out.end(), files.begin(), files.end());
+	return UV_ERR_OK;
+}
+
 uv_err_t createDir(const std::string &file, bool bestEffort)
 {
 	//if( !bestEffort )
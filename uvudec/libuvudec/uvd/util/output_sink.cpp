@@ -0,0 +1,264 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "uvd/util/output_sink.h"
+#include "uvd/util/debug.h"
+
+/*
+UVDOutputSink
+*/
+
+UVDOutputSink::UVDOutputSink()
+{
+	m_buffer = NULL;
+	m_bufferSize = 0;
+	m_used = 0;
+	m_written = 0;
+	m_ownsBuffer = false;
+}
+
+UVDOutputSink::~UVDOutputSink()
+{
+	if( m_ownsBuffer )
+	{
+		free(m_buffer);
+	}
+}
+
+uv_err_t UVDOutputSink::initBuffer(uint32_t bufferSize)
+{
+	uv_assert_ret(bufferSize);
+	uv_assert_ret(!m_buffer);
+	m_buffer = (char *)malloc(bufferSize);
+	uv_assert_ret(m_buffer);
+	m_bufferSize = bufferSize;
+	m_ownsBuffer = true;
+	return UV_ERR_OK;
+}
+
+void UVDOutputSink::setBuffer(char *buffer, uint32_t bufferSize)
+{
+	m_buffer = buffer;
+	m_bufferSize = bufferSize;
+	m_ownsBuffer = false;
+}
+
+uv_err_t UVDOutputSink::writeSlow(const char *data, uint32_t size)
+{
+	uint32_t remaining = m_bufferSize - m_used;
+	uv_err_t rc = UV_ERR_GENERAL;
+
+	//Top off the buffer so writes always go out in full buffers
+	memcpy(m_buffer + m_used, data, remaining);
+	m_used += remaining;
+	m_written += remaining;
+	data += remaining;
+	size -= remaining;
+	uv_assert_err_ret(flush());
+
+	//Larger than the buffer, no point in copying
+	//Also if the buffer couldn't drain, let the destination decide
+	if( size >= m_bufferSize || m_used )
+	{
+		rc = writeCore(data, size);
+		if( UV_SUCCEEDED(rc) )
+		{
+			m_written += size;
+		}
+		return UV_DEBUG(rc);
+	}
+	memcpy(m_buffer, data, size);
+	m_used = size;
+	m_written += size;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDOutputSink::print(const char *format, ...)
+{
+	va_list ap;
+	int size = 0;
+
+	va_start(ap, format);
+	size = vsnprintf(m_buffer + m_used, m_bufferSize - m_used, format, ap);
+	va_end(ap);
+	uv_assert_ret(size >= 0);
+
+	if( (uint32_t)size >= m_bufferSize - m_used )
+	{
+		//Didn't fit, make room and format again
+		uv_assert_err_ret(flush());
+		if( (uint32_t)size >= m_bufferSize - m_used )
+		{
+			//Larger than the whole buffer
+			char *tmp = (char *)malloc(size + 1);
+			uv_err_t rc = UV_ERR_GENERAL;
+
+			uv_assert_ret(tmp);
+			va_start(ap, format);
+			vsnprintf(tmp, size + 1, format, ap);
+			va_end(ap);
+			rc = write(tmp, size);
+			free(tmp);
+			return UV_DEBUG(rc);
+		}
+		va_start(ap, format);
+		vsnprintf(m_buffer + m_used, m_bufferSize - m_used, format, ap);
+		va_end(ap);
+	}
+	m_used += size;
+	m_written += size;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDOutputSink::flush()
+{
+	if( m_used )
+	{
+		uv_assert_err_ret(writeCore(m_buffer, m_used));
+		m_used = 0;
+	}
+	return UV_ERR_OK;
+}
+
+/*
+UVDFileOutputSink
+*/
+
+UVDFileOutputSink::UVDFileOutputSink()
+{
+	m_fd = -1;
+	m_ownsFd = false;
+}
+
+UVDFileOutputSink::~UVDFileOutputSink()
+{
+	deinit();
+}
+
+uv_err_t UVDFileOutputSink::init(int fd, uint32_t bufferSize)
+{
+	uv_assert_ret(fd >= 0);
+	uv_assert_err_ret(initBuffer(bufferSize));
+	m_fd = fd;
+	m_ownsFd = false;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDFileOutputSink::init(const std::string &fileName, uint32_t bufferSize)
+{
+	int fd = open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	if( fd < 0 )
+	{
+		printf_error("could not open %s: %s\n", fileName.c_str(), strerror(errno));
+		return UV_DEBUG(UV_ERR_ACCESS);
+	}
+	if( UV_FAILED(init(fd, bufferSize)) )
+	{
+		close(fd);
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	m_ownsFd = true;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDFileOutputSink::deinit()
+{
+	uv_err_t rc = UV_ERR_OK;
+
+	if( m_fd < 0 )
+	{
+		return UV_ERR_OK;
+	}
+	rc = flush();
+	if( m_ownsFd && close(m_fd) )
+	{
+		rc = UV_ERR_ACCESS;
+	}
+	m_fd = -1;
+	m_ownsFd = false;
+	return UV_DEBUG(rc);
+}
+
+uv_err_t UVDFileOutputSink::writeCore(const char *data, uint32_t size)
+{
+	uv_assert_ret(m_fd >= 0);
+	while( size )
+	{
+		ssize_t rc = ::write(m_fd, data, size);
+
+		if( rc < 0 )
+		{
+			if( errno == EINTR )
+			{
+				continue;
+			}
+			printf_error("write failed: %s\n", strerror(errno));
+			return UV_DEBUG(UV_ERR_ACCESS);
+		}
+		data += rc;
+		size -= rc;
+	}
+	return UV_ERR_OK;
+}
+
+/*
+UVDMemoryOutputSink
+*/
+
+UVDMemoryOutputSink::UVDMemoryOutputSink()
+{
+}
+
+uv_err_t UVDMemoryOutputSink::init(char *region, uint32_t size)
+{
+	uv_assert_ret(region);
+	setBuffer(region, size);
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDMemoryOutputSink::flush()
+{
+	//Already where it belongs
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDMemoryOutputSink::writeCore(const char *, uint32_t)
+{
+	//Only called once the region is full, there is nowhere to put it
+	return UV_ERR_BUFFERSIZE;
+}
+
+/*
+UVDStringOutputSink
+*/
+
+UVDStringOutputSink::UVDStringOutputSink()
+{
+	m_out = NULL;
+}
+
+uv_err_t UVDStringOutputSink::init(std::string *out, uint32_t bufferSize)
+{
+	uv_assert_ret(out);
+	uv_assert_err_ret(initBuffer(bufferSize));
+	m_out = out;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDStringOutputSink::writeCore(const char *data, uint32_t size)
+{
+	uv_assert_ret(m_out);
+	m_out->append(data, size);
+	return UV_ERR_OK;
+}
+
@@ -0,0 +1,149 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVD_UTIL_OUTPUT_SINK_H
+#define UVD_UTIL_OUTPUT_SINK_H
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include "uvd/util/error.h"
+
+/*
+Destination for large outputs such as a full listing
+Writes are copied into one reusable buffer and handed to the destination a buffer at a time
+so output costs a memcpy per line and a write() per buffer regardless of size
+Not thread safe
+*/
+
+#define UVD_OUTPUT_SINK_BUFFER_SIZE_DEFAULT		0x100000
+
+class UVDOutputSink
+{
+public:
+	UVDOutputSink();
+	//Does not flush, errors couldn't be reported: flush() before
+	virtual ~UVDOutputSink();
+
+	inline uv_err_t write(const char *data, uint32_t size)
+	{
+		if( size <= m_bufferSize - m_used )
+		{
+			memcpy(m_buffer + m_used, data, size);
+			m_used += size;
+			m_written += size;
+			return UV_ERR_OK;
+		}
+		return UV_DEBUG(writeSlow(data, size));
+	}
+	inline uv_err_t write(const std::string &s)
+	{
+		return UV_DEBUG(write(s.c_str(), s.size()));
+	}
+	//data followed by a newline
+	inline uv_err_t writeLine(const char *data, uint32_t size)
+	{
+		if( size < m_bufferSize - m_used )
+		{
+			memcpy(m_buffer + m_used, data, size);
+			m_buffer[m_used + size] = '\n';
+			m_used += size + 1;
+			m_written += size + 1;
+			return UV_ERR_OK;
+		}
+		//Keep the error, UVDMemoryOutputSink callers check for UV_ERR_BUFFERSIZE
+		uv_assert_err_ret_rc(writeSlow(data, size));
+		return UV_DEBUG(write("\n", 1));
+	}
+	inline uv_err_t writeLine(const std::string &s)
+	{
+		return UV_DEBUG(writeLine(s.c_str(), s.size()));
+	}
+	//printf() formatted directly into the buffer
+	uv_err_t print(const char *format, ...);
+	//Hand everything buffered to the destination
+	virtual uv_err_t flush();
+
+protected:
+	//Buffer is owned by us
+	uv_err_t initBuffer(uint32_t bufferSize);
+	//Destination is written in place, for destinations that are themselves memory
+	void setBuffer(char *buffer, uint32_t bufferSize);
+	uv_err_t writeSlow(const char *data, uint32_t size);
+	//Write size bytes of data to the destination, all or error
+	virtual uv_err_t writeCore(const char *data, uint32_t size) = 0;
+
+public:
+	char *m_buffer;
+	uint32_t m_bufferSize;
+	//Bytes of m_buffer not yet written to the destination
+	uint32_t m_used;
+	//Total stored so far, including what is still buffered
+	//A write that fails with nothing stored doesn't count
+	uint64_t m_written;
+
+protected:
+	bool m_ownsBuffer;
+};
+
+//A file descriptor, ex: an output file or stdout
+class UVDFileOutputSink : public UVDOutputSink
+{
+public:
+	UVDFileOutputSink();
+	//Flushes and closes if we opened it, ignoring errors
+	~UVDFileOutputSink();
+
+	//fd is not closed by us
+	uv_err_t init(int fd, uint32_t bufferSize = UVD_OUTPUT_SINK_BUFFER_SIZE_DEFAULT);
+	//Create or truncate fileName
+	uv_err_t init(const std::string &fileName, uint32_t bufferSize = UVD_OUTPUT_SINK_BUFFER_SIZE_DEFAULT);
+	//Flush and close if we opened it
+	uv_err_t deinit();
+
+protected:
+	virtual uv_err_t writeCore(const char *data, uint32_t size);
+
+public:
+	int m_fd;
+	bool m_ownsFd;
+};
+
+/*
+A caller supplied memory region, formatted into directly with no copy
+UV_ERR_BUFFERSIZE once the region is full
+m_written says how much fit, the write that overflowed is stored up to the end of the region
+*/
+class UVDMemoryOutputSink : public UVDOutputSink
+{
+public:
+	UVDMemoryOutputSink();
+
+	uv_err_t init(char *region, uint32_t size);
+	virtual uv_err_t flush();
+
+protected:
+	virtual uv_err_t writeCore(const char *data, uint32_t size);
+};
+
+//Appended to a std::string a buffer at a time instead of a line at a time
+class UVDStringOutputSink : public UVDOutputSink
+{
+public:
+	UVDStringOutputSink();
+
+	//out is not cleared
+	uv_err_t init(std::string *out, uint32_t bufferSize = UVD_OUTPUT_SINK_BUFFER_SIZE_DEFAULT);
+
+protected:
+	virtual uv_err_t writeCore(const char *data, uint32_t size);
+
+public:
+	std::string *m_out;
+};
+
+#endif
+
@@ -0,0 +1,446 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include "uvd/util/profile.h"
+#include "uvd/util/util.h"
+#include <algorithm>
+#include <stdio.h>
+
+bool g_profileEnabled = false;
+//Plain pointer so it is set before any counter's constructor runs
+static UVDProfileCounter *g_profileCounters = NULL;
+
+UVDProfileCounter g_profileInstructionsDecoded("instructions.decoded");
+UVDProfileCounter g_profileInstructionCacheHits("instruction_cache.hits");
+UVDProfileCounter g_profileInstructionCacheMisses("instruction_cache.misses");
+UVDProfileCounter g_profileInstructionCacheEvictions("instruction_cache.evictions");
+UVDProfileCounter g_profileInstructionAllocations("instructions.allocated");
+UVDProfileCounter g_profileInstructionRecycles("instructions.recycled");
+UVDProfileCounter g_profileInterpreterEvaluations("interpreter.evaluations");
+UVDProfileCounter g_profileStringBytesScanned("strings.bytes_scanned");
+UVDProfileCounter g_profileStringsFound("strings.found");
+
+UVDProfiler g_profiler;
+
+//Scopes this thread has open
+static __thread const char *g_profileStack[UVD_PROFILE_DEPTH_MAX];
+static __thread uint32_t g_profileDepth = 0;
+//Index + 1, 0 until the thread first records
+static __thread uint32_t g_profileThread = 0;
+
+/*
+UVDProfileCounter
+*/
+
+UVDProfileCounter::UVDProfileCounter(const char *name)
+{
+	m_name = name;
+	m_value = 0;
+	m_next = g_profileCounters;
+	g_profileCounters = this;
+}
+
+/*
+UVDProfileScope
+*/
+
+UVDProfileScope::UVDProfileScope(const char *name)
+{
+	m_name = name;
+	m_active = UVDProfileEnabled();
+	if( m_active )
+	{
+		if( g_profileDepth < UVD_PROFILE_DEPTH_MAX )
+		{
+			g_profileStack[g_profileDepth] = name;
+		}
+		++g_profileDepth;
+		m_benchmark.start();
+	}
+}
+
+UVDProfileScope::~UVDProfileScope()
+{
+	std::string path;
+
+	if( !m_active )
+	{
+		return;
+	}
+	m_benchmark.stop();
+	--g_profileDepth;
+	if( g_profileDepth >= UVD_PROFILE_DEPTH_MAX )
+	{
+		return;
+	}
+
+	for( uint32_t i = 0; i <= g_profileDepth; ++i )
+	{
+		if( i )
+		{
+			path += UVD_PROFILE_PATH_SEPARATOR;
+		}
+		path += g_profileStack[i];
+	}
+	g_profiler.record(path, m_name, m_benchmark.getStart(), m_benchmark.getDelta());
+}
+
+/*
+UVDProfiler
+*/
+
+//Depth first: separator sorts before any other character
+static bool UVDProfileScopePathLess(const UVDProfiler::Scope &l, const UVDProfiler::Scope &r)
+{
+	const std::string &lPath = l.m_path;
+	const std::string &rPath = r.m_path;
+	uint32_t size = std::min(lPath.size(), rPath.size());
+
+	for( uint32_t i = 0; i < size; ++i )
+	{
+		if( lPath[i] == rPath[i] )
+		{
+			continue;
+		}
+		if( lPath[i] == UVD_PROFILE_PATH_SEPARATOR )
+		{
+			return true;
+		}
+		if( rPath[i] == UVD_PROFILE_PATH_SEPARATOR )
+		{
+			return false;
+		}
+		return (unsigned char)lPath[i] < (unsigned char)rPath[i];
+	}
+	return lPath.size() < rPath.size();
+}
+
+static std::string UVDProfileJSONString(const std::string &in)
+{
+	std::string ret = "\"";
+
+	for( std::string::const_iterator iter = in.begin(); iter != in.end(); ++iter )
+	{
+		unsigned char c = *iter;
+
+		if( c == '"' || c == '\\' )
+		{
+			ret += '\\';
+			ret += c;
+		}
+		else if( c < 0x20 )
+		{
+			char buffer[8];
+			snprintf(buffer, sizeof(buffer), "\\u%.4X", c);
+			ret += buffer;
+		}
+		else
+		{
+			ret += c;
+		}
+	}
+	ret += '"';
+	return ret;
+}
+
+static std::string UVDProfileJSONNumber(uint64_t in)
+{
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)in);
+	return buffer;
+}
+
+UVDProfiler::Scope::Scope()
+{
+	m_count = 0;
+	m_total = 0;
+	m_self = 0;
+}
+
+UVDProfiler::UVDProfiler()
+{
+	pthread_mutex_init(&m_mutex, NULL);
+	m_start = 0;
+	m_eventsDropped = 0;
+	m_threads = 0;
+}
+
+UVDProfiler::~UVDProfiler()
+{
+	pthread_mutex_destroy(&m_mutex);
+}
+
+void UVDProfiler::enable()
+{
+	m_start = getTimingMicroseconds();
+	g_profileEnabled = true;
+}
+
+void UVDProfiler::disable()
+{
+	g_profileEnabled = false;
+}
+
+void UVDProfiler::reset()
+{
+	pthread_mutex_lock(&m_mutex);
+	m_scopes.clear();
+	m_events.clear();
+	m_eventsDropped = 0;
+	m_start = getTimingMicroseconds();
+	pthread_mutex_unlock(&m_mutex);
+
+	for( UVDProfileCounter *counter = g_profileCounters; counter; counter = counter->m_next )
+	{
+		counter->m_value = 0;
+	}
+}
+
+void UVDProfiler::record(const std::string &path, const char *name, uint64_t start, uint64_t duration)
+{
+	if( !g_profileThread )
+	{
+		g_profileThread = __sync_add_and_fetch(&m_threads, 1);
+	}
+
+	pthread_mutex_lock(&m_mutex);
+	Scope &scope = m_scopes[path];
+	if( scope.m_path.empty() )
+	{
+		scope.m_path = path;
+	}
+	++scope.m_count;
+	scope.m_total += duration;
+
+	if( m_events.size() < UVD_PROFILE_EVENTS_MAX )
+	{
+		Event event;
+
+		event.m_name = name;
+		event.m_thread = g_profileThread - 1;
+		event.m_start = start > m_start ? start - m_start : 0;
+		event.m_duration = duration;
+		m_events.push_back(event);
+	}
+	else
+	{
+		++m_eventsDropped;
+	}
+	pthread_mutex_unlock(&m_mutex);
+}
+
+uv_err_t UVDProfiler::getScopes(std::vector<Scope> &out)
+{
+	std::map<std::string, uint32_t> indexes;
+
+	pthread_mutex_lock(&m_mutex);
+	out.clear();
+	for( std::map<std::string, Scope>::iterator iter = m_scopes.begin(); iter != m_scopes.end(); ++iter )
+	{
+		out.push_back((*iter).second);
+	}
+	pthread_mutex_unlock(&m_mutex);
+
+	std::sort(out.begin(), out.end(), UVDProfileScopePathLess);
+	for( uint32_t i = 0; i < out.size(); ++i )
+	{
+		out[i].m_self = out[i].m_total;
+		indexes[out[i].m_path] = i;
+	}
+	//Take children out of their parent
+	for( uint32_t i = 0; i < out.size(); ++i )
+	{
+		std::string::size_type separator = out[i].m_path.rfind(UVD_PROFILE_PATH_SEPARATOR);
+		std::map<std::string, uint32_t>::iterator parentIter;
+
+		if( separator == std::string::npos )
+		{
+			continue;
+		}
+		parentIter = indexes.find(out[i].m_path.substr(0, separator));
+		if( parentIter == indexes.end() )
+		{
+			continue;
+		}
+		Scope &parent = out[(*parentIter).second];
+		//Clock granularity can make children add up to slightly more
+		parent.m_self -= std::min(parent.m_self, out[i].m_total);
+	}
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDProfiler::getCounters(std::map<std::string, uint64_t> &out)
+{
+	out.clear();
+	for( UVDProfileCounter *counter = g_profileCounters; counter; counter = counter->m_next )
+	{
+		out[counter->m_name] = counter->m_value;
+	}
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDProfiler::getCounter(const std::string &name, uint64_t *out)
+{
+	uv_assert_ret(out);
+	for( UVDProfileCounter *counter = g_profileCounters; counter; counter = counter->m_next )
+	{
+		if( name == counter->m_name )
+		{
+			*out = counter->m_value;
+			return UV_ERR_OK;
+		}
+	}
+	return UV_ERR_NOTFOUND;
+}
+
+void UVDProfiler::writeJSONScopes(std::string &out, const std::vector<Scope> &scopes, uint32_t first, uint32_t end, uint32_t prefixLength, uint32_t depth)
+{
+	std::string indent(depth, '\t');
+	uint32_t i = first;
+
+	out += "[";
+	while( i < end )
+	{
+		const Scope &scope = scopes[i];
+		std::string childPrefix = scope.m_path + UVD_PROFILE_PATH_SEPARATOR;
+		uint32_t childEnd = i + 1;
+
+		//Depth first order puts the whole subtree right after us
+		while( childEnd < end && scopes[childEnd].m_path.compare(0, childPrefix.size(), childPrefix) == 0 )
+		{
+			++childEnd;
+		}
+
+		if( i != first )
+		{
+			out += ",";
+		}
+		out += "\n" + indent + "\t{";
+		out += "\"name\": " + UVDProfileJSONString(scope.m_path.substr(prefixLength));
+		out += ", \"count\": " + UVDProfileJSONNumber(scope.m_count);
+		out += ", \"total_us\": " + UVDProfileJSONNumber(scope.m_total);
+		out += ", \"self_us\": " + UVDProfileJSONNumber(scope.m_self);
+		out += ", \"children\": ";
+		writeJSONScopes(out, scopes, i + 1, childEnd, childPrefix.size(), depth + 1);
+		out += "}";
+
+		i = childEnd;
+	}
+	if( first != end )
+	{
+		out += "\n" + indent;
+	}
+	out += "]";
+}
+
+uv_err_t UVDProfiler::toJSON(std::string &out)
+{
+	std::vector<Scope> scopes;
+	std::map<std::string, uint64_t> counters;
+
+	uv_assert_err_ret(getScopes(scopes));
+	uv_assert_err_ret(getCounters(counters));
+
+	out = "{\n\t\"scopes\": ";
+	writeJSONScopes(out, scopes, 0, scopes.size(), 0, 1);
+	out += ",\n\t\"counters\": {";
+	for( std::map<std::string, uint64_t>::iterator iter = counters.begin(); iter != counters.end(); ++iter )
+	{
+		if( iter != counters.begin() )
+		{
+			out += ",";
+		}
+		out += "\n\t\t" + UVDProfileJSONString((*iter).first) + ": " + UVDProfileJSONNumber((*iter).second);
+	}
+	out += "\n\t}\n}\n";
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDProfiler::toChromeTrace(std::string &out)
+{
+	std::map<std::string, uint64_t> counters;
+	//Counters are only known at the end
+	uint64_t end = 0;
+	uint32_t eventsDropped = 0;
+
+	uv_assert_err_ret(getCounters(counters));
+
+	out = "{\"traceEvents\": [";
+	pthread_mutex_lock(&m_mutex);
+	for( std::vector<Event>::iterator iter = m_events.begin(); iter != m_events.end(); ++iter )
+	{
+		const Event &event = *iter;
+
+		out += "\n\t{\"name\": " + UVDProfileJSONString(event.m_name);
+		out += ", \"cat\": \"uvudec\", \"ph\": \"X\", \"pid\": 1";
+		out += ", \"tid\": " + UVDProfileJSONNumber(event.m_thread);
+		out += ", \"ts\": " + UVDProfileJSONNumber(event.m_start);
+		out += ", \"dur\": " + UVDProfileJSONNumber(event.m_duration);
+		out += "},";
+		end = std::max(end, event.m_start + event.m_duration);
+	}
+	eventsDropped = m_eventsDropped;
+	pthread_mutex_unlock(&m_mutex);
+
+	out += "\n\t{\"name\": \"counters\", \"ph\": \"C\", \"pid\": 1, \"tid\": 0";
+	out += ", \"ts\": " + UVDProfileJSONNumber(end);
+	out += ", \"args\": {";
+	for( std::map<std::string, uint64_t>::iterator iter = counters.begin(); iter != counters.end(); ++iter )
+	{
+		if( iter != counters.begin() )
+		{
+			out += ", ";
+		}
+		out += UVDProfileJSONString((*iter).first) + ": " + UVDProfileJSONNumber((*iter).second);
+	}
+	out += "}}\n],\n";
+	out += "\"displayTimeUnit\": \"ms\",\n";
+	out += "\"otherData\": {\"events_dropped\": " + UVDProfileJSONNumber(eventsDropped) + "}}\n";
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDProfiler::writeFile(const std::string &fileName, uint32_t format)
+{
+	std::string out;
+
+	switch( format )
+	{
+	case UVD_PROFILE_FORMAT_JSON:
+		uv_assert_err_ret(toJSON(out));
+		break;
+	case UVD_PROFILE_FORMAT_CHROME:
+		uv_assert_err_ret(toChromeTrace(out));
+		break;
+	default:
+		return UV_DEBUG(UV_ERR_GENERAL);
+	};
+	uv_assert_err_ret(::writeFile(fileName, out));
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDProfiler::parseFormat(const std::string &name, uint32_t *out)
+{
+	uv_assert_ret(out);
+	if( name == "json" )
+	{
+		*out = UVD_PROFILE_FORMAT_JSON;
+	}
+	else if( name == "chrome" )
+	{
+		*out = UVD_PROFILE_FORMAT_CHROME;
+	}
+	else
+	{
+		printf_error("unknown profile format: %s\n", name.c_str());
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	return UV_ERR_OK;
+}
+
@@ -0,0 +1,184 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVD_UTIL_PROFILE_H
+#define UVD_UTIL_PROFILE_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "uvd/util/benchmark.h"
+#include "uvd/util/debug.h"
+#include "uvd/util/error.h"
+
+/*
+Where time goes on a real input without attaching a profiler
+Passes and plugins open named scopes which nest per thread, ex: decompile/analyze/control_flow
+Hot paths bump counters instead (instructions decoded, bytes scanned...) since a scope per item would cost more than the item
+Nothing is recorded unless profiling was enabled (--profile), a counter is a single branch then
+
+Scope names must outlive the scope and shouldn't contain UVD_PROFILE_PATH_SEPARATOR
+Scopes opened on pool threads start a new root since they don't know who posted the job
+*/
+
+#define UVD_PROFILE_FORMAT_JSON				0
+//chrome://tracing, also loads in Perfetto
+#define UVD_PROFILE_FORMAT_CHROME			1
+
+#define UVD_PROFILE_PATH_SEPARATOR			'/'
+//Deeper scopes aren't recorded
+#define UVD_PROFILE_DEPTH_MAX				32
+//Individual scope instances kept for the trace, totals are kept regardless
+#define UVD_PROFILE_EVENTS_MAX				0x10000
+
+extern bool g_profileEnabled;
+
+static inline bool UVDProfileEnabled()
+{
+	return UVD_UNLIKELY(g_profileEnabled);
+}
+
+/*
+Monotonically increasing process wide count
+Must have static storage duration in libuvudec: counters link themselves into a list on construction
+and a counter in an unloaded plugin would leave that dangling
+*/
+class UVDProfileCounter
+{
+public:
+	UVDProfileCounter(const char *name);
+
+	inline void add(uint64_t n)
+	{
+		if( UVDProfileEnabled() )
+		{
+			__sync_fetch_and_add(&m_value, n);
+		}
+	}
+	inline void increment()
+	{
+		add(1);
+	}
+
+public:
+	const char *m_name;
+	volatile uint64_t m_value;
+	UVDProfileCounter *m_next;
+};
+
+//Core counters
+//UVDASInstructionIterator instructions parsed
+extern UVDProfileCounter g_profileInstructionsDecoded;
+//UVDAnalyzer::m_instructionCache
+extern UVDProfileCounter g_profileInstructionCacheHits;
+extern UVDProfileCounter g_profileInstructionCacheMisses;
+extern UVDProfileCounter g_profileInstructionCacheEvictions;
+//New instruction objects vs ones reused from a pool
+extern UVDProfileCounter g_profileInstructionAllocations;
+extern UVDProfileCounter g_profileInstructionRecycles;
+//ACTION / config interpreter programs run
+extern UVDProfileCounter g_profileInterpreterEvaluations;
+//Bytes searched for strings
+extern UVDProfileCounter g_profileStringBytesScanned;
+extern UVDProfileCounter g_profileStringsFound;
+
+/*
+Times from construction to destruction under name, nested inside whatever scope this thread has open
+	UVDProfileScope scope("control_flow");
+*/
+class UVDProfileScope
+{
+public:
+	UVDProfileScope(const char *name);
+	~UVDProfileScope();
+
+protected:
+	const char *m_name;
+	bool m_active;
+	UVDBenchmark m_benchmark;
+};
+
+class UVDProfiler
+{
+public:
+	//Totals of every instance of a scope path
+	class Scope
+	{
+	public:
+		Scope();
+
+	public:
+		std::string m_path;
+		uint32_t m_count;
+		//us
+		uint64_t m_total;
+		//m_total minus time in direct child scopes
+		uint64_t m_self;
+	};
+
+	//A single instance of a scope
+	class Event
+	{
+	public:
+		std::string m_name;
+		uint32_t m_thread;
+		//us since enable()
+		uint64_t m_start;
+		uint64_t m_duration;
+	};
+
+public:
+	UVDProfiler();
+	~UVDProfiler();
+
+	//Start recording, call before starting any threads that might profile
+	void enable();
+	//Stop recording, keeps what was recorded. Scopes already open are still recorded when they close
+	void disable();
+	//Drop everything recorded so far and zero counters, keeps enabled state
+	void reset();
+
+	//Ordered by path, children directly after their parent
+	uv_err_t getScopes(std::vector<Scope> &out);
+	uv_err_t getCounters(std::map<std::string, uint64_t> &out);
+	//UV_ERR_NOTFOUND if there is no counter by that name
+	uv_err_t getCounter(const std::string &name, uint64_t *out);
+
+	uv_err_t toJSON(std::string &out);
+	uv_err_t toChromeTrace(std::string &out);
+	//format: UVD_PROFILE_FORMAT_*
+	uv_err_t writeFile(const std::string &fileName, uint32_t format);
+	//"json" or "chrome"
+	static uv_err_t parseFormat(const std::string &name, uint32_t *out);
+
+	//Called by UVDProfileScope, start and duration in UVDBenchmark time
+	void record(const std::string &path, const char *name, uint64_t start, uint64_t duration);
+
+protected:
+	//Scopes [first, end) as a JSON array, names are paths without the first prefixLength chars
+	void writeJSONScopes(std::string &out, const std::vector<Scope> &scopes, uint32_t first, uint32_t end, uint32_t prefixLength, uint32_t depth);
+
+public:
+	//When enabled, in UVDBenchmark time
+	uint64_t m_start;
+
+protected:
+	pthread_mutex_t m_mutex;
+	//By path
+	std::map<std::string, Scope> m_scopes;
+	std::vector<Event> m_events;
+	//Events not kept because we hit UVD_PROFILE_EVENTS_MAX
+	uint32_t m_eventsDropped;
+	//For numbering threads as they first record
+	volatile uint32_t m_threads;
+};
+
+extern UVDProfiler g_profiler;
+
+#endif
+
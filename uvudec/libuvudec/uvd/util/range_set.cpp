@@ -0,0 +1,187 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include "uvd/util/error.h"
+#include "uvd/util/range_set.h"
+#include <limits.h>
+
+UVDUint32RangeSet::UVDUint32RangeSet()
+{
+}
+
+UVDUint32RangeSet::~UVDUint32RangeSet()
+{
+}
+
+void UVDUint32RangeSet::clear()
+{
+	m_runs.clear();
+}
+
+uint32_t UVDUint32RangeSet::lowerBound(uint32_t value) const
+{
+	uint32_t low = 0;
+	uint32_t high = m_runs.size();
+	
+	while( low < high )
+	{
+		uint32_t middle = low + (high - low) / 2;
+		
+		if( m_runs[middle].m_max < value )
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return low;
+}
+
+void UVDUint32RangeSet::add(uint32_t min, uint32_t max)
+{
+	uint32_t first = 0;
+	uint32_t last = 0;
+	
+	if( max < min )
+	{
+		return;
+	}
+	//First run we overlap or touch
+	first = lowerBound(min == 0 ? 0 : min - 1);
+	//One past the last run we overlap or touch
+	for( last = first; last < m_runs.size() && (max == UINT_MAX || m_runs[last].m_min <= max + 1); ++last )
+	{
+		if( m_runs[last].m_min < min )
+		{
+			min = m_runs[last].m_min;
+		}
+		if( m_runs[last].m_max > max )
+		{
+			max = m_runs[last].m_max;
+		}
+	}
+	m_runs.erase(m_runs.begin() + first, m_runs.begin() + last);
+	m_runs.insert(m_runs.begin() + first, UVDUint32RangePair(min, max));
+}
+
+void UVDUint32RangeSet::remove(uint32_t min, uint32_t max)
+{
+	UVDUint32RangeSet removed;
+	
+	removed.add(min, max);
+	removed.invert();
+	intersect(removed);
+}
+
+void UVDUint32RangeSet::invert()
+{
+	std::vector<UVDUint32RangePair> inverted;
+	uint32_t next = 0;
+	bool more = true;
+	
+	for( std::vector<UVDUint32RangePair>::iterator iter = m_runs.begin(); iter != m_runs.end(); ++iter )
+	{
+		const UVDUint32RangePair &run = *iter;
+		
+		if( run.m_min > next )
+		{
+			inverted.push_back(UVDUint32RangePair(next, run.m_min - 1));
+		}
+		if( run.m_max == UINT_MAX )
+		{
+			more = false;
+			break;
+		}
+		next = run.m_max + 1;
+	}
+	if( more )
+	{
+		inverted.push_back(UVDUint32RangePair(next, UINT_MAX));
+	}
+	m_runs = inverted;
+}
+
+void UVDUint32RangeSet::intersect(const UVDUint32RangeSet &other)
+{
+	std::vector<UVDUint32RangePair> intersection;
+	std::vector<UVDUint32RangePair>::const_iterator a = m_runs.begin();
+	std::vector<UVDUint32RangePair>::const_iterator b = other.m_runs.begin();
+	
+	//Both sorted, walk them together
+	while( a != m_runs.end() && b != other.m_runs.end() )
+	{
+		uint32_t min = (*a).m_min > (*b).m_min ? (*a).m_min : (*b).m_min;
+		uint32_t max = (*a).m_max < (*b).m_max ? (*a).m_max : (*b).m_max;
+		
+		if( min <= max )
+		{
+			intersection.push_back(UVDUint32RangePair(min, max));
+		}
+		if( (*a).m_max < (*b).m_max )
+		{
+			++a;
+		}
+		else
+		{
+			++b;
+		}
+	}
+	m_runs = intersection;
+}
+
+bool UVDUint32RangeSet::contains(uint32_t value) const
+{
+	uint32_t index = lowerBound(value);
+	
+	return index < m_runs.size() && m_runs[index].m_min <= value;
+}
+
+uv_err_t UVDUint32RangeSet::find(uint32_t value, UVDUint32RangePair *out) const
+{
+	uint32_t index = lowerBound(value);
+	
+	if( index >= m_runs.size() || m_runs[index].m_min > value )
+	{
+		return UV_ERR_NOTFOUND;
+	}
+	uv_assert_ret(out);
+	*out = m_runs[index];
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDUint32RangeSet::next(uint32_t value, UVDUint32RangePair *out) const
+{
+	uint32_t index = lowerBound(value);
+	
+	if( index >= m_runs.size() )
+	{
+		return UV_ERR_DONE;
+	}
+	uv_assert_ret(out);
+	*out = m_runs[index];
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDUint32RangeSet::last(uint32_t value, UVDUint32RangePair *out) const
+{
+	uint32_t index = lowerBound(value);
+	
+	//The run containing value or else the one before it
+	if( index >= m_runs.size() || m_runs[index].m_min > value )
+	{
+		if( index == 0 )
+		{
+			return UV_ERR_DONE;
+		}
+		--index;
+	}
+	uv_assert_ret(out);
+	*out = m_runs[index];
+	return UV_ERR_OK;
+}
+
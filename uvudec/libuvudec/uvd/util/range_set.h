@@ -0,0 +1,52 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVD_UTIL_RANGE_SET_H
+#define UVD_UTIL_RANGE_SET_H
+
+#include <vector>
+#include "uvd/util/types.h"
+
+/*
+Set of uint32_t values stored as sorted inclusive runs
+Runs never overlap or touch, adding merges them
+Lookups are a binary search over the runs
+*/
+class UVDUint32RangeSet
+{
+public:
+	UVDUint32RangeSet();
+	~UVDUint32RangeSet();
+	
+	void clear();
+	inline bool empty() const { return m_runs.empty(); }
+	//Add [min, max]
+	void add(uint32_t min, uint32_t max);
+	//Remove [min, max]
+	void remove(uint32_t min, uint32_t max);
+	//All values not in this set
+	void invert();
+	//Keep only values also in other
+	void intersect(const UVDUint32RangeSet &other);
+	
+	bool contains(uint32_t value) const;
+	//Run containing value, UV_ERR_NOTFOUND if none
+	uv_err_t find(uint32_t value, UVDUint32RangePair *out) const;
+	//First run containing or after value, UV_ERR_DONE if none
+	uv_err_t next(uint32_t value, UVDUint32RangePair *out) const;
+	//Last run containing or before value, UV_ERR_DONE if none
+	uv_err_t last(uint32_t value, UVDUint32RangePair *out) const;
+
+protected:
+	//Index of the first run with m_max >= value, m_runs.size() if none
+	uint32_t lowerBound(uint32_t value) const;
+
+public:
+	std::vector<UVDUint32RangePair> m_runs;
+};
+
+#endif
+
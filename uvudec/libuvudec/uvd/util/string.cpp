@@ -169,7 +169,7 @@ char **uv_split_core(const char *str, char delim, unsigned int *n_ret, int ret_b
 {
 	unsigned int n = 0;
 	char *buff = NULL;
-	static char **ret = NULL;
+	char **ret = NULL;
 	unsigned int str_index = 0;
 	unsigned int i = 0;
 
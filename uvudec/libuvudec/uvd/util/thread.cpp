@@ -0,0 +1,210 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include "uvd/util/thread.h"
+#include "uvd/util/debug.h"
+#include <unistd.h>
+
+UVDThreadPool::UVDThreadPool()
+{
+	m_initialized = false;
+	m_stopping = false;
+	m_generation = 0;
+	m_busy = 0;
+	m_started = 0;
+	m_job = NULL;
+	m_user = NULL;
+	m_count = 0;
+	m_next = 0;
+	m_errorIndex = 0;
+	m_error = UV_ERR_OK;
+}
+
+UVDThreadPool::~UVDThreadPool()
+{
+	deinit();
+}
+
+uv_err_t UVDThreadPool::init(uint32_t threads)
+{
+	uv_assert_ret(!m_initialized);
+	
+	if( threads == 0 )
+	{
+		threads = getCPUCount();
+	}
+	
+	uv_assert_ret(pthread_mutex_init(&m_mutex, NULL) == 0);
+	uv_assert_ret(pthread_cond_init(&m_workCond, NULL) == 0);
+	uv_assert_ret(pthread_cond_init(&m_doneCond, NULL) == 0);
+	m_initialized = true;
+	m_stopping = false;
+	m_started = 0;
+	//Workers start out having seen generation 0, even if they get scheduled after the first run()
+	m_generation = 0;
+	
+	//Caller is thread 0
+	for( uint32_t i = 1; i < threads; ++i )
+	{
+		pthread_t thread;
+		
+		if( pthread_create(&thread, NULL, workerMain, this) != 0 )
+		{
+			//Run with what we got
+			printf_warn("could only start %d of %d threads\n", i, threads);
+			break;
+		}
+		m_threads.push_back(thread);
+	}
+	printf_debug_level(UVD_DEBUG_VERBOSE, "thread pool: %d threads\n", getThreadCount());
+	
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDThreadPool::deinit()
+{
+	if( !m_initialized )
+	{
+		return UV_ERR_OK;
+	}
+	
+	pthread_mutex_lock(&m_mutex);
+	m_stopping = true;
+	pthread_cond_broadcast(&m_workCond);
+	pthread_mutex_unlock(&m_mutex);
+	
+	for( std::vector<pthread_t>::iterator iter = m_threads.begin(); iter != m_threads.end(); ++iter )
+	{
+		pthread_join(*iter, NULL);
+	}
+	m_threads.clear();
+	
+	pthread_cond_destroy(&m_doneCond);
+	pthread_cond_destroy(&m_workCond);
+	pthread_mutex_destroy(&m_mutex);
+	m_initialized = false;
+
+	return UV_ERR_OK;
+}
+
+uint32_t UVDThreadPool::getThreadCount() const
+{
+	return m_threads.size() + 1;
+}
+
+uint32_t UVDThreadPool::getCPUCount()
+{
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	
+	if( cpus < 1 )
+	{
+		return 1;
+	}
+	return (uint32_t)cpus;
+}
+
+uv_err_t UVDThreadPool::run(uint32_t count, Job job, void *user)
+{
+	uv_assert_ret(m_initialized);
+	uv_assert_ret(job);
+	
+	if( count == 0 )
+	{
+		return UV_ERR_OK;
+	}
+	
+	m_job = job;
+	m_user = user;
+	m_count = count;
+	m_next = 0;
+	m_errorIndex = count;
+	m_error = UV_ERR_OK;
+	
+	if( m_threads.empty() )
+	{
+		work(0);
+		return UV_DEBUG(m_error);
+	}
+	
+	pthread_mutex_lock(&m_mutex);
+	m_busy = m_threads.size();
+	++m_generation;
+	pthread_cond_broadcast(&m_workCond);
+	pthread_mutex_unlock(&m_mutex);
+
+	work(0);
+	
+	pthread_mutex_lock(&m_mutex);
+	while( m_busy )
+	{
+		pthread_cond_wait(&m_doneCond, &m_mutex);
+	}
+	pthread_mutex_unlock(&m_mutex);
+	
+	return UV_DEBUG(m_error);
+}
+
+void UVDThreadPool::work(uint32_t thread)
+{
+	for( ;; )
+	{
+		uint32_t index = __sync_fetch_and_add(&m_next, 1);
+		uv_err_t rc = UV_ERR_GENERAL;
+		
+		if( index >= m_count )
+		{
+			break;
+		}
+		
+		rc = m_job(index, thread, m_user);
+		if( UV_FAILED(rc) )
+		{
+			pthread_mutex_lock(&m_mutex);
+			if( index < m_errorIndex )
+			{
+				m_errorIndex = index;
+				m_error = rc;
+			}
+			pthread_mutex_unlock(&m_mutex);
+		}
+	}
+}
+
+void *UVDThreadPool::workerMain(void *poolIn)
+{
+	UVDThreadPool *pool = (UVDThreadPool *)poolIn;
+	uint32_t thread = 0;
+	uint32_t generation = 0;
+
+	pthread_mutex_lock(&pool->m_mutex);
+	++pool->m_started;
+	thread = pool->m_started;
+	for( ;; )
+	{
+		while( !pool->m_stopping && pool->m_generation == generation )
+		{
+			pthread_cond_wait(&pool->m_workCond, &pool->m_mutex);
+		}
+		if( pool->m_stopping )
+		{
+			break;
+		}
+		generation = pool->m_generation;
+		pthread_mutex_unlock(&pool->m_mutex);
+		
+		pool->work(thread);
+		
+		pthread_mutex_lock(&pool->m_mutex);
+		--pool->m_busy;
+		if( pool->m_busy == 0 )
+		{
+			pthread_cond_signal(&pool->m_doneCond);
+		}
+	}
+	pthread_mutex_unlock(&pool->m_mutex);
+	
+	return NULL;
+}
@@ -0,0 +1,78 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVD_UTIL_THREAD_H
+#define UVD_UTIL_THREAD_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <vector>
+#include "uvd/util/error.h"
+
+/*
+Fixed size pool of worker threads for analysis passes where each item is independent
+Work is handed out as an index range so callers can keep one result slot per item
+and merge them in index order afterwards, making output independent of scheduling
+The calling thread works too, so a pool of 1 thread never creates any
+*/
+class UVDThreadPool
+{
+public:
+	/*
+	index: item in [0, count)
+	thread: in [0, getThreadCount()), for indexing per thread scratch
+	*/
+	typedef uv_err_t (*Job)(uint32_t index, uint32_t thread, void *user);
+
+public:
+	UVDThreadPool();
+	~UVDThreadPool();
+	//0 for one thread per online CPU
+	uv_err_t init(uint32_t threads);
+	uv_err_t deinit();
+	
+	/*
+	Call job for every index and wait until all have completed
+	If any fail, the error of the lowest failed index is returned
+	Not reentrant: jobs must not call run() on the same pool
+	*/
+	uv_err_t run(uint32_t count, Job job, void *user);
+	uint32_t getThreadCount() const;
+	inline bool isInitialized() const { return m_initialized; }
+	
+	static uint32_t getCPUCount();
+
+protected:
+	static void *workerMain(void *pool);
+	void work(uint32_t thread);
+
+protected:
+	std::vector<pthread_t> m_threads;
+	pthread_mutex_t m_mutex;
+	//A new batch was posted or we are shutting down
+	pthread_cond_t m_workCond;
+	//Last worker finished the current batch
+	pthread_cond_t m_doneCond;
+	bool m_initialized;
+	bool m_stopping;
+	//Incremented for each batch so workers can tell a new one from a spurious wakeup
+	uint32_t m_generation;
+	//Workers that haven't finished the current batch
+	uint32_t m_busy;
+	//Hands out worker thread indexes at startup
+	uint32_t m_started;
+	
+	//Current batch
+	Job m_job;
+	void *m_user;
+	uint32_t m_count;
+	//Next index to hand out, atomic
+	volatile uint32_t m_next;
+	uint32_t m_errorIndex;
+	uv_err_t m_error;
+};
+
+#endif
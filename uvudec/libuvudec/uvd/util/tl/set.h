@@ -0,0 +1,29 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVD_UTIL_TL_SET_H
+#define UVD_UTIL_TL_SET_H
+
+#include <set>
+
+/*
+Small template helpers for std::set
+*/
+namespace UVDN {
+
+//A set containing only the given item
+//Mostly for building interval_map codomain values
+template <typename T>
+std::set<T> singleton_set(const T &item) {
+	std::set<T> ret;
+	
+	ret.insert(item);
+	return ret;
+}
+
+}
+
+#endif
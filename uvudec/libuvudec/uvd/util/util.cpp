@@ -143,36 +143,26 @@ uv_err_t UVDExecuteToText(const std::string &sCommand,
 		std::string *stdErr)
 {
 	uv_err_t rc = UV_ERR_GENERAL;
-	static std::string stdOutFile;
-	static std::string stdErrFile;
 	std::string stdOutFileLocal;
 	std::string stdErrFileLocal;
 	
 	UV_ENTER();
 	
-	if( stdOutFile.empty() )
-	{
-		uv_assert_err(getTempFile(stdOutFile));
-	}
-	if( stdErrFile.empty() )
-	{
-		uv_assert_err(getTempFile(stdErrFile));
-	}
-	
+	//Fresh files each call, concurrent callers (ex: interpreters of different engines) must not share them
 	if( stdOut )
 	{
-		stdOutFileLocal = stdOutFile;		
+		uv_assert_err(getTempFile(stdOutFileLocal));
 	}
 	if( stdErr )
 	{
 		if( stdOut == stdErr )
 		{
-			stdErrFileLocal = stdOutFile;
+			stdErrFileLocal = stdOutFileLocal;
 			stdErr = NULL;
 		}
 		else
 		{
-			stdErrFileLocal = stdErrFile;
+			uv_assert_err(getTempFile(stdErrFileLocal));
 		}
 	}
 	
@@ -182,11 +172,11 @@ uv_err_t UVDExecuteToText(const std::string &sCommand,
 			&stdOutFileLocal,
 			&stdErrFileLocal));
 	
-	if( stdOut && UV_FAILED(readFile(stdOutFile, *stdOut)) )
+	if( stdOut && UV_FAILED(readFile(stdOutFileLocal, *stdOut)) )
 	{
 		goto error;
 	}
-	if( stdErr && UV_FAILED(readFile(stdErrFile, *stdErr)) )
+	if( stdErr && UV_FAILED(readFile(stdErrFileLocal, *stdErr)) )
 	{
 		goto error;
 	}
@@ -426,11 +416,9 @@ uv_err_t getArguments(const std::string &in, std::vector<std::string> &out)
 uint64_t getTimingMicroseconds(void)
 {
 	struct timeval tv;
-	struct timezone tz;
-	struct tm *tm;
-	gettimeofday(&tv, &tz);
-	tm=localtime(&tv.tv_sec);
-	return ((tm->tm_hour * 60 + tm->tm_min) * 60 + tm->tm_sec) * 1000000 + tv.tv_usec;
+	//Not time of day: localtime() isn't thread safe and that wrapped at midnight
+	gettimeofday(&tv, NULL);
+	return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
 }
 
 uv_err_t isCSymbol(const std::string &in)
@@ -15,6 +15,7 @@ But if you insist, be warned I will be testing integration of boost::filesystem
 
 #include <stdint.h>
 #include <string>
+#include <vector>
 #include "uvd/util/types.h"
 #include "uvd/util/error.h"
 
@@ -77,6 +78,8 @@ uv_err_t ensurePathEndsWith(const std::string &in, const std::string &ending, st
 
 uv_err_t isRegularFile(const std::string &file);
 uv_err_t isDir(const std::string &file);
+//Full paths of the regular files directly in dir, sorted
+uv_err_t getDirFiles(const std::string &dir, std::vector<std::string> &out);
 //If bestEffort is set, willl try to create all dirs needed
 uv_err_t createDir(const std::string &file, bool bestEffort);
 
@@ -5,6 +5,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 */
 
 #include "uvdasm/architecture.h"
+#include "uvdasm/instruction_pool.h"
 #include "uvdasm/plugin_config.h"
 #include "uvd/assembly/instruction.h"
 #include "uvd/core/iterator.h"
@@ -14,6 +15,8 @@ UVDDisasmArchitecture::UVDDisasmArchitecture()
 	m_opcodeTable = NULL;
 	m_symMap = NULL;
 	m_interpreter = NULL;
+	//Each parse hands out its own UVDDisasmInstruction, recycled through m_instructionPool
+	m_cacheInstructions = true;
 }
 
 UVDDisasmArchitecture::~UVDDisasmArchitecture()
@@ -35,10 +38,7 @@ uv_err_t UVDDisasmArchitecture::init()
 	printf_plugin_debug("config file: %s\n", m_architectureFileName.c_str());
 	
 	
-	m_opcodeTable = new UVDDisasmOpcodeLookupTable();
-	//printf_debug("Initializing opcode table, address: 0x%.8X\n", (unsigned int)m_opcodeTable);
-	uv_assert_ret(m_opcodeTable);
-	//m_CPU->m_opcodeTable = m_opcodeTable;
+	//m_opcodeTable is loaded or shared by init_config()
 	
 	m_symMap = new UVDSymbolMap();
 	uv_assert_ret(m_symMap);
@@ -46,6 +46,8 @@ uv_err_t UVDDisasmArchitecture::init()
 	//m_interpreter = new UVDConfigExpressionInterpreter();
 	UVDConfigExpressionInterpreter::getConfigExpressionInterpreter(&m_interpreter);
 	uv_assert_ret(m_interpreter);
+	uv_assert_ret(m_interpreter->m_interpreter);
+	m_interpreter->m_interpreter->m_architecture = this;
 
 	printf_debug("Initializing config...\n");
 	if( UV_FAILED(init_config()) )
@@ -59,9 +61,12 @@ uv_err_t UVDDisasmArchitecture::init()
 
 uv_err_t UVDDisasmArchitecture::deinit()
 {
-	delete m_opcodeTable;
+	//Owned by g_disasmOpcodeTables
 	m_opcodeTable = NULL;
 
+	//Cache and iterators have released theirs by now
+	UV_DEBUG(m_instructionPool.deinit());
+
 	delete m_symMap;
 	m_symMap = NULL;
 
@@ -92,7 +97,7 @@ uv_err_t UVDDisasmArchitecture::parseCurrentInstruction(UVDASInstructionIterator
 	
 	//printf("UVDDisasmArchitecture::parseCurrentInstruction()\n");
 	
-	instruction = new UVDDisasmInstruction();
+	uv_assert_err_ret(m_instructionPool.get(&instruction));
 	uv_assert_ret(instruction);
 	rc_tmp = instruction->parseCurrentInstruction(iter);
 	return UV_DEBUG(rc_tmp);
@@ -101,8 +106,11 @@ uv_err_t UVDDisasmArchitecture::parseCurrentInstruction(UVDASInstructionIterator
 uv_err_t UVDDisasmArchitecture::getInstruction(UVDInstruction **out)
 {
 	uv_assert_ret(out);
-	*out = new UVDDisasmInstruction();
-	uv_assert_ret(*out);
+	UVDDisasmInstruction *instruction = NULL;
+
+	uv_assert_err_ret(m_instructionPool.get(&instruction));
+	uv_assert_ret(instruction);
+	*out = instruction;
 	return UV_ERR_OK;
 }
 
@@ -10,6 +10,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvd/architecture/architecture.h"
 #include "uvd/core/std_iterator.h"
 #include "uvdasm/util.h"
+#include "uvdasm/instruction_pool.h"
 #include "uvdasm/opcode_table.h"
 #include "uvdasm/config_symbol.h"
 
@@ -28,6 +29,8 @@ public:
 	//uv_err_t opcodeDeinit();
 	uv_err_t init_misc(UVDConfigSection *misc_section);
 	uv_err_t init_memory(UVDConfigSection *mem_section);
+	//Load, or share an already loaded, opcode table
+	uv_err_t init_opcode_table(UVDConfigSection *op_section, const std::string &configFileData);
 	uv_err_t init_reg(UVDConfigSection *reg_section);
 	uv_err_t init_prefix(UVDConfigSection *pre_section);
 	uv_err_t init_vectors(UVDConfigSection *section);
@@ -48,8 +51,7 @@ public:
 
 	//TODO: move to UVDCPU
 	//Lookup table for opcodes
-	//This in theory could be shared between multiple engines for the same arch
-	//But not much of an issue since only one instance is expected per run
+	//Shared between engines for the same architecture, owned by g_disasmOpcodeTables
 	UVDDisasmOpcodeLookupTable *m_opcodeTable;
 	//For special modifiers mostly for now (functions)
 	//Allows special mapping of addresses and others
@@ -71,6 +73,9 @@ public:
 
 	//Registers, mapped by name
 	std::map<std::string, UVDRegisterShared *> m_registers;
+	
+	//Instructions handed out by parseCurrentInstruction() come from and return to here
+	UVDDisasmInstructionPool m_instructionPool;
 
 protected:
 	//Segmented memory view instead of flat m_data view
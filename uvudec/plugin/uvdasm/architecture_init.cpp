@@ -9,6 +9,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvd/util/util.h"
 #include "uvd/core/uvd.h"
 #include "uvdasm/architecture.h"
+#include "uvdasm/opcode_cache.h"
 #include "uvdasm/plugin_config.h"
 
 #if 0
@@ -74,6 +75,7 @@ Ex:
 uv_err_t UVDDisasmArchitecture::init_config()
 {
 	UVDSectionConfigFile sections;
+	std::string configFileData;
 		
 	UVDConfigSection *op_section = NULL;
 	UVDConfigSection *mem_section = NULL;
@@ -83,11 +85,12 @@ uv_err_t UVDDisasmArchitecture::init_config()
 	UVDConfigSection *vec_section = NULL;
 
 	printf_debug("Reading file...\n");
-	if( UV_FAILED(UVDSectionConfigFile::fromFileNameByDot(m_architectureFileName, sections)) )
+	if( UV_FAILED(UVDReadFileByString(m_architectureFileName, configFileData)) )
 	{
 		printf_error("Could not read config file: %s\n", g_asmConfig->m_architectureFileName.c_str());
 		return UV_DEBUG(UV_ERR_GENERAL);
 	}
+	uv_assert_err_ret(UVDSectionConfigFile::fromStringByDot(configFileData, sections));
 	
 	for( std::vector<UVDConfigSection>::size_type curSectionIndex = 0; curSectionIndex < sections.m_sections.size(); ++curSectionIndex )
 	{
@@ -127,7 +130,7 @@ uv_err_t UVDDisasmArchitecture::init_config()
 	uv_assert_err_ret(init_misc(misc_section));
 	/* Because of register memory mapping, memory should be initialized first */
 	uv_assert_err_ret(init_memory(mem_section));
-	uv_assert_err_ret(m_opcodeTable->init_opcode(op_section));
+	uv_assert_err_ret(init_opcode_table(op_section, configFileData));
 	uv_assert_err_ret(init_reg(reg_section));
 	uv_assert_err_ret(init_prefix(pre_section));
 	uv_assert_err_ret(init_vectors(vec_section));
@@ -137,6 +140,47 @@ uv_err_t UVDDisasmArchitecture::init_config()
 
 int g_format_debug = false;
  
+uv_err_t UVDDisasmArchitecture::init_opcode_table(UVDConfigSection *op_section, const std::string &configFileData)
+{
+	UVDDisasmOpcodeCache opcodeCache;
+	UVDDisasmOpcodeLookupTable *table = NULL;
+	uv_err_t rcCache = UV_ERR_GENERAL;
+	std::string key;
+
+	//Engines on the same architecture in this process (ex: batch mode) share the table
+	key = UVDSprintf("%s:%d", m_architectureFileName.c_str(), g_asmConfig->m_configInterpreterLanguage);
+	g_disasmOpcodeTables.lock();
+	if( UV_SUCCEEDED(g_disasmOpcodeTables.get(key, &m_opcodeTable)) )
+	{
+		g_disasmOpcodeTables.unlock();
+		printf_plugin_debug("sharing opcode table for %s\n", key.c_str());
+		return UV_ERR_OK;
+	}
+
+	//Parsing .OP dominates startup, try the binary form first
+	uv_assert_err(opcodeCache.init(m_architectureFileName, configFileData));
+	rcCache = opcodeCache.load(&table);
+	//Missing or bad, the text is the authority
+	if( rcCache != UV_ERR_OK )
+	{
+		table = new UVDDisasmOpcodeLookupTable();
+		uv_assert(table);
+		uv_assert_err(table->init_opcode(op_section));
+		//Not being able to write it just means we parse again next time
+		UV_DEBUG(opcodeCache.save(table));
+	}
+	uv_assert_err(g_disasmOpcodeTables.add(key, table));
+	g_disasmOpcodeTables.unlock();
+	m_opcodeTable = table;
+
+	return UV_ERR_OK;
+
+error:
+	g_disasmOpcodeTables.unlock();
+	delete table;
+	return UV_DEBUG(UV_ERR_GENERAL);
+}
+
 uv_err_t UVDDisasmArchitecture::init_misc(UVDConfigSection *misc_section)
 {
 	/* 
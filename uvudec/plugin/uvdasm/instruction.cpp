@@ -7,9 +7,13 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvd/core/uvd.h"
 #include "uvdasm/architecture.h"
 #include "uvdasm/instruction.h"
+#include "uvdasm/instruction_pool.h"
+#include "uvdasm/plugin_config.h"
+#include "uvd/util/profile.h"
 #include "uvd/util/types.h"
 #include "uvd/core/runtime.h"
 #include "uvd/language/format.h"
+#include "uvd/language/language.h"
 #include "uvd/util/util.h"
 #include <vector>
 #include <string>
@@ -29,6 +33,7 @@ UVDDisasmInstructionShared::UVDDisasmInstructionShared()
 	m_cpi_hi = 0;
 	m_isJump = false;
 	m_isCall = false;
+	m_isReturn = false;
 	m_isConditional = false;
 	m_conditionalExtraInstructions = 0;
 	m_config_line_syntax = 0;
@@ -84,59 +89,55 @@ std::string UVDDisasmInstructionShared::getHumanReadableUsage()
 	return sRet;
 }
 
-uv_err_t UVDDisasmInstructionShared::getOpcodes(std::set<uint8_t> &ret) const
+uv_err_t UVDDisasmInstructionShared::getOpcodes(uint32_t position, std::set<uint8_t> &ret) const
 {
 	/*
 	0x12 => 0x12
 	0x10/0x02 => 0x10, 0x11
 	0x10:0x12 => 0x10, 0x11, 0x12
 	*/
+	uv_assert_ret(position < m_opcode_length);
 	
-	//FIXME: multiple opcodes, the return type will also need to be changed
-	uv_assert_ret(m_opcode_length == 1);
-	for( unsigned int i = 0; i < m_opcode_length; ++i )
+	uint8_t opcode = m_opcode[position];
+	uint8_t rangeOffset = m_opcodeRangeOffset[position];
+	uint8_t bitmask = m_bitmask[position];
+	
+	if( rangeOffset == 0 && bitmask == 0 )
 	{
-		uint8_t opcode = m_opcode[i];
-		uint8_t rangeOffset = m_opcodeRangeOffset[i];
-		uint8_t bitmask = m_bitmask[i];
-		
-		if( rangeOffset == 0 && bitmask == 0 )
+		ret.insert(opcode);
+	}
+	else if( rangeOffset )
+	{
+		//Logically equivilent to above...
+		for( uint32_t i = 0; i <= rangeOffset; ++i )
 		{
-			ret.insert(opcode);
+			ret.insert(opcode + i);
 		}
-		else if( rangeOffset )
+	}
+	else if( bitmask )
+	{
+		/*
+		0xF0/0xF0: 0xF0:0xFF
+		0x03/0x0F: 0x03, 0x13, 0x23, ...
+		Anded means keep, 0'd means wild
+		FIXME: get a better algorithm for this..but only computed once, so w/e
+		*/
+		uint8_t currentOpcode = 0;
+		uint8_t workingOpcode = opcode & bitmask;
+		
+		do
 		{
-			//Logically equivilent to above...
-			for( uint32_t i = 0; i <= rangeOffset; ++i )
+			if( (currentOpcode & bitmask) == workingOpcode )
 			{
-				ret.insert(opcode + i);
+				ret.insert(currentOpcode);
 			}
-		}
-		else if( bitmask )
-		{
-			/*
-			0xF0/0xF0: 0xF0:0xFF
-			0x03/0x0F: 0x03, 0x13, 0x23, ...
-			Anded means keep, 0'd means wild
-			FIXME: get a better algorithm for this..but only computed once, so w/e
-			*/
-			uint8_t currentOpcode = 0;
-			uint8_t workingOpcode = opcode & bitmask;
-			
-			do
-			{
-				if( (currentOpcode & bitmask) == workingOpcode )
-				{
-					ret.insert(currentOpcode);
-				}
-				++currentOpcode;
-			//Looped around?
-			} while( currentOpcode != 0x00 );
-		}
-		else
-		{
-			return UV_DEBUG(UV_ERR_GENERAL);
-		}
+			++currentOpcode;
+		//Looped around?
+		} while( currentOpcode != 0x00 );
+	}
+	else
+	{
+		return UV_DEBUG(UV_ERR_GENERAL);
 	}
 	
 	return UV_ERR_OK;
@@ -152,9 +153,69 @@ uv_err_t UVDDisasmInstructionShared::analyzeAction()
 	{
 		m_isJump = true;
 	}
+	if( m_action.find("RETURN") != std::string::npos )
+	{
+		m_isReturn = true;
+	}
 	
 	m_isImmediateOnlyFunction = isImmediateOnlyFunctionCore();
 	
+	uv_assert_err_ret(compileActionProgram());
+	
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDDisasmInstructionShared::compileActionProgram()
+{
+	m_actionProgram.clear();
+	m_actionVariableOperands.clear();
+
+	//Only control flow is evaluated
+	if( !m_isCall && !m_isJump )
+	{
+		return UV_ERR_OK;
+	}
+	uv_assert_ret(g_asmConfig);
+	if( g_asmConfig->m_configInterpreterLanguage != UVD_LANGUAGE_BUILTIN )
+	{
+		return UV_ERR_OK;
+	}
+
+	//Not fatal, interpreter will report it if it really is bad
+	if( UV_FAILED(m_actionProgram.compile(m_action)) )
+	{
+		printf_debug("could not precompile action <%s>\n", m_action.c_str());
+		return UV_ERR_OK;
+	}
+
+	//Resolve names now so analysis doesn't have to
+	for( std::vector<std::string>::iterator iter = m_actionProgram.m_variables.begin(); iter != m_actionProgram.m_variables.end(); ++iter )
+	{
+		const std::string &name = *iter;
+		int operandIndex = UVD_ACTION_VARIABLE_PC;
+
+		if( name != "PC" )
+		{
+			operandIndex = -2;
+			for( std::vector<UVDDisasmOperandShared *>::size_type i = 0; i < m_operands.size(); ++i )
+			{
+				if( m_operands[i]->getVariableName() == name )
+				{
+					operandIndex = i;
+					break;
+				}
+			}
+			if( operandIndex < 0 )
+			{
+				printf_debug("action <%s> variable %s not an operand\n", m_action.c_str(), name.c_str());
+				m_actionProgram.clear();
+				m_actionVariableOperands.clear();
+				return UV_ERR_OK;
+			}
+		}
+		m_actionVariableOperands.push_back(operandIndex);
+	}
+	
 	return UV_ERR_OK;
 }
 
@@ -257,7 +318,10 @@ UVDDisasmInstruction::UVDDisasmInstruction()
 	m_offset = 0;
 	m_inst_size = 0;
 	m_uvd = NULL;
+	m_pool = NULL;
 	memset(m_inst, 0, sizeof(m_inst));
+	m_operandSlotsUsed = 0;
+	m_functionSlotsUsed = 0;
 }
 
 UVDDisasmInstruction::~UVDDisasmInstruction()
@@ -281,8 +345,67 @@ uv_err_t UVDDisasmInstruction::deinit()
 		delete *iter;
 	}
 	*/
+	//Operands are in our slots, clear() keeps the capacity for the next parse
 	m_operands.clear();
+	m_prefixes.clear();
+	for( uint32_t i = 0; i < m_functionSlotsUsed; ++i )
+	{
+		m_functionSlots[i].m_args.clear();
+	}
+	m_operandSlotsUsed = 0;
+	m_functionSlotsUsed = 0;
+	m_shared = NULL;
+	m_offset = 0;
+	m_inst_size = 0;
+
+	return UV_ERR_OK;
+}
 
+void UVDDisasmInstruction::release()
+{
+	if( m_pool )
+	{
+		m_pool->put(this);
+	}
+	else
+	{
+		delete this;
+	}
+}
+
+uv_err_t UVDDisasmInstruction::allocateOperand(UVDDisasmOperandShared *shared, UVDDisasmOperand **out)
+{
+	UVDDisasmOperand *operand = NULL;
+
+	uv_assert_ret(out);
+	if( m_operandSlotsUsed >= UVD_DISASM_INSTRUCTION_OPERANDS_MAX )
+	{
+		printf_error("instruction needs more than %d operands\n", UVD_DISASM_INSTRUCTION_OPERANDS_MAX);
+		return UV_DEBUG(UV_ERR_NOTSUPPORTED);
+	}
+	operand = &m_operandSlots[m_operandSlotsUsed];
+	++m_operandSlotsUsed;
+	uv_assert_err_ret(operand->deinit());
+	operand->m_shared = shared;
+	operand->m_instruction = this;
+	*out = operand;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDDisasmInstruction::allocateFunction(UVDDisasmFunction **out)
+{
+	UVDDisasmFunction *function = NULL;
+
+	uv_assert_ret(out);
+	if( m_functionSlotsUsed >= UVD_DISASM_INSTRUCTION_FUNCTIONS_MAX )
+	{
+		printf_error("instruction needs more than %d function operands\n", UVD_DISASM_INSTRUCTION_FUNCTIONS_MAX);
+		return UV_DEBUG(UV_ERR_NOTSUPPORTED);
+	}
+	function = &m_functionSlots[m_functionSlotsUsed];
+	++m_functionSlotsUsed;
+	function->m_args.clear();
+	*out = function;
 	return UV_ERR_OK;
 }
 
@@ -346,12 +469,13 @@ error:
 }
 
 //Given an identified instruction operand, parse the next operand out of the remaining binary (data)
-uv_err_t UVDDisasmInstruction::parseOperands(UVDASInstructionIterator *uvdIter,
-		std::vector<UVDDisasmOperandShared *> ops_shared, std::vector<UVDOperand *> &operands)
+uv_err_t UVDDisasmInstruction::parseOperands(UVDASInstructionIterator *uvdIter, UVDDisasmInstruction *instruction,
+		const std::vector<UVDDisasmOperandShared *> &ops_shared, std::vector<UVDOperand *> &operands)
 {
 	UVDData *data = NULL;;
 	data = uvdIter->m_address.m_space->m_data;
 	uv_assert_ret(data);
+	uv_assert_ret(instruction);
 	
 	//uv_assert(instruction);
 	//shared = instruction->m_shared;
@@ -368,7 +492,7 @@ uv_err_t UVDDisasmInstruction::parseOperands(UVDASInstructionIterator *uvdIter,
 		
 		uv_assert_ret(op_shared);
 		
-		rcParse = op_shared->parseOperand(uvdIter, &op);
+		rcParse = op_shared->parseOperand(uvdIter, instruction, &op);
 		uv_assert_ret(op);
 		
 		uv_assert_err_ret(rcParse);
@@ -419,6 +543,13 @@ uv_err_t UVDDisasmInstruction::analyzeControlFlow(UVDInstructionAnalysis *out)
 	uint32_t followingPos = 0;
 	UVDDisasmArchitecture *architecture = NULL;
 
+	//Static attributes are known even if we can't resolve a target
+	if( out )
+	{
+		out->m_isConditional = getShared()->m_isConditional;
+		out->m_isReturn = getShared()->m_isReturn;
+	}
+
 	//Only can analyze calls and jumps currently
 	if( !getShared()->m_isCall && !getShared()->m_isJump )
 	{
@@ -491,6 +622,11 @@ uv_err_t UVDDisasmInstruction::analyzeControlFlow(UVDInstructionAnalysis *out)
 	*/
 
 	//printf("Action: %s, type: %d\n", action.c_str(), getShared()->m_inst_class);
+	if( getShared()->m_actionProgram.isCompiled() )
+	{
+		return UV_DEBUG(analyzeControlFlowBuiltin(followingPos, out));
+	}
+
 	//See if its a call instruction
 	UVDVariableMap environment;
 	UVDVariableMap mapOut;
@@ -604,6 +740,45 @@ uv_err_t UVDDisasmInstruction::analyzeControlFlow(UVDInstructionAnalysis *out)
 	}
 #endif
 
+uv_err_t UVDDisasmInstruction::analyzeControlFlowBuiltin(uint32_t followingPos, UVDInstructionAnalysis *out)
+{
+	UVDDisasmInstructionShared *shared = getShared();
+	int64_t variables[UVD_BUILTIN_VARIABLES_MAX];
+	UVDBuiltinResult result;
+
+	uv_assert_ret(shared->m_actionVariableOperands.size() <= UVD_BUILTIN_VARIABLES_MAX);
+	for( std::vector<int>::size_type i = 0; i < shared->m_actionVariableOperands.size(); ++i )
+	{
+		int operandIndex = shared->m_actionVariableOperands[i];
+
+		if( operandIndex == UVD_ACTION_VARIABLE_PC )
+		{
+			variables[i] = followingPos;
+		}
+		else
+		{
+			uv_assert_ret(operandIndex < (int)m_operands.size());
+			uv_assert_err_ret(((UVDDisasmOperand *)m_operands[operandIndex])->getVariableValue(&variables[i]));
+		}
+	}
+
+	g_profileInterpreterEvaluations.increment();
+	uv_assert_err_ret(shared->m_actionProgram.execute(variables, &result));
+	//Same checks the scripted version does on missing keys
+	if( shared->m_isCall )
+	{
+		uv_assert_ret(result.m_isCall);
+		uv_assert_err_ret(analyzeCallTarget(followingPos, result.m_callTarget, out));
+	}
+	if( shared->m_isJump )
+	{
+		uv_assert_ret(result.m_isJump);
+		uv_assert_err_ret(analyzeJumpTarget(followingPos, result.m_jumpTarget, out));
+	}
+
+	return UV_ERR_OK;
+}
+
 #define BASIC_SYMBOL_ANALYSIS			
 
 uv_err_t UVDDisasmInstruction::analyzeCall(uint32_t startPos, const UVDVariableMap &attributes, UVDInstructionAnalysis *out)
@@ -612,10 +787,18 @@ uv_err_t UVDDisasmInstruction::analyzeCall(uint32_t startPos, const UVDVariableM
 	uint32_t targetAddress = 0;
 	UVDDisasmArchitecture *architecture = NULL;
  	
- 	architecture = (UVDDisasmArchitecture *)g_uvd->m_runtime->m_architecture;
+	uv_assert_ret(m_uvd);
+ 	architecture = (UVDDisasmArchitecture *)m_uvd->m_runtime->m_architecture;
 	uv_assert_ret(attributes.find(SCRIPT_KEY_CALL) != attributes.end());
 	(*attributes.find(SCRIPT_KEY_CALL)).second.getString(sAddr);
 	targetAddress = (uint32_t)strtol(sAddr.c_str(), NULL, 0);
+	architecture->updateCache(startPos, attributes);
+
+	return UV_DEBUG(analyzeCallTarget(startPos, targetAddress, out));
+}
+
+uv_err_t UVDDisasmInstruction::analyzeCallTarget(uint32_t startPos, uint32_t targetAddress, UVDInstructionAnalysis *out)
+{
 	//FIXME: we currently are leaving out unknown call/jump targets
 	if( out )
 	{
@@ -623,9 +806,9 @@ uv_err_t UVDDisasmInstruction::analyzeCall(uint32_t startPos, const UVDVariableM
 		out->m_callTarget = targetAddress;
 	}
 	
-	uv_assert_err_ret(g_uvd->m_analyzer->insertCallReference(targetAddress, startPos));
+	uv_assert_ret(m_uvd);
+	uv_assert_err_ret(m_uvd->m_analyzer->insertCallReference(targetAddress, startPos));
 	//uv_assert_err(insertReference(targetAddress, startPos, ));
-	architecture->updateCache(startPos, attributes);
 
 #ifdef BASIC_SYMBOL_ANALYSIS
 	/*
@@ -645,7 +828,7 @@ uv_err_t UVDDisasmInstruction::analyzeCall(uint32_t startPos, const UVDVariableM
 
 		//We know the location of a call symbol relocation
 		//uv_assert_ret(m_symbolManager);
-		uv_assert_err_ret(g_uvd->m_analyzer->m_symbolManager.addAbsoluteFunctionRelocationByBits(targetAddress,
+		uv_assert_err_ret(m_uvd->m_analyzer->m_symbolManager.addAbsoluteFunctionRelocationByBits(targetAddress,
 				relocationPos, relocatableDataSizeBits));
 	}
 #endif
@@ -664,14 +847,22 @@ uv_err_t UVDDisasmInstruction::analyzeJump(uint32_t startPos, const UVDVariableM
 	uv_assert_ret(attributes.find(SCRIPT_KEY_JUMP) != attributes.end());
 	(*attributes.find(SCRIPT_KEY_JUMP)).second.getString(sAddr);
 	targetAddress = (uint32_t)strtol(sAddr.c_str(), NULL, 0);
+	uv_assert_ret(m_uvd);
+	((UVDDisasmArchitecture *)(m_uvd->m_runtime->m_architecture))->updateCache(startPos, attributes);
+
+	return UV_DEBUG(analyzeJumpTarget(startPos, targetAddress, out));
+}
+
+uv_err_t UVDDisasmInstruction::analyzeJumpTarget(uint32_t startPos, uint32_t targetAddress, UVDInstructionAnalysis *out)
+{
 	if( out )
 	{
 		out->m_isJump = true;
 		out->m_jumpTarget = targetAddress;
 	}
 	
-	uv_assert_err_ret(g_uvd->m_analyzer->insertJumpReference(targetAddress, startPos));
-	((UVDDisasmArchitecture *)(g_uvd->m_runtime->m_architecture))->updateCache(startPos, attributes);
+	uv_assert_ret(m_uvd);
+	uv_assert_err_ret(m_uvd->m_analyzer->insertJumpReference(targetAddress, startPos));
 
 #ifdef BASIC_SYMBOL_ANALYSIS			
 	uv_assert_ret(instruction);
@@ -710,6 +901,7 @@ uv_err_t UVDDisasmInstruction::parseCurrentInstruction(UVDASInstructionIterator
 	//UVDData *data = m_uvd->m_data;
 	//UVDData *data = m_data;
 	UVDDisasmInstructionShared *element = NULL;
+	UVDDisasmOpcodeLookupTable *subTable = NULL;
 	uint8_t opcode = 0;
 	UVD *uvd = NULL;
 	uv_addr_t absoluteMaxAddress = 0;
@@ -718,7 +910,10 @@ uv_err_t UVDDisasmInstruction::parseCurrentInstruction(UVDASInstructionIterator
 		
 	//printf_debug("m_address.m_addr: 0x%.8X\n", iterCommon.m_address.m_addr);
 		
-	uvd = g_uvd;
+	//Drop any previous parse, frees our operand slots
+	uv_assert_err_ret(deinit());
+	//Whichever engine is iterating, not necessarily the only one
+	uvd = iterCommon.m_uvd;
 	m_uvd = uvd;
 	uv_assert_ret(uvd);
 	architecture = (UVDDisasmArchitecture *)uvd->m_runtime->m_architecture;
@@ -768,7 +963,19 @@ uv_err_t UVDDisasmInstruction::parseCurrentInstruction(UVDASInstructionIterator
 	//But this doesn't mean we can't analyze the current byte
 	
 	uv_assert_ret(architecture->m_opcodeTable);
-	uv_assert_err_ret(architecture->m_opcodeTable->getElement(opcode, &element));
+	uv_assert_err_ret(architecture->m_opcodeTable->getElement(opcode, &element, &subTable));
+	//Multi byte opcode, one table per byte
+	while( subTable )
+	{
+		rcTemp = iterCommon.consumeCurrentExecutableAddress(&opcode);
+		uv_assert_err_ret(rcTemp);
+		//Truncated opcode, treat like an undefined one below
+		if( rcTemp == UV_ERR_DONE )
+		{
+			break;
+		}
+		uv_assert_err_ret(subTable->getElement(opcode, &element, &subTable));
+	}
 
 	if( element == NULL )
 	{
@@ -779,6 +986,13 @@ uv_err_t UVDDisasmInstruction::parseCurrentInstruction(UVDASInstructionIterator
 		}
 		//XXX add something more descriptive
 		//uv_assert_err_ret(uvd->addWarning("Undefined instruction"));
+		/*
+		Only the first byte is undefined, even if it was a prefix and we looked further
+		Parse only as below, the byte after the prefix is decoded on its own next
+		*/
+		m_offset = startPosition;
+		iterCommon.m_currentSize = 1;
+		iterCommon.m_address.m_addr = startPosition;
 		return UV_ERR_OK;
 	}
 	//XXX: this may change in the future to be less direct
@@ -792,7 +1006,7 @@ uv_err_t UVDDisasmInstruction::parseCurrentInstruction(UVDASInstructionIterator
 	There should be a perfect matching between each of these and the shared structs
 	*/
 	/* Since operand and shared operand structs are linked list, we can setup the entire structure by passing in the first elements */
-	rcTemp = parseOperands(&iterCommon, getShared()->m_operands, m_operands);
+	rcTemp = parseOperands(&iterCommon, this, getShared()->m_operands, m_operands);
 	/*
 	for( std::vector<UVDOperand *>::size_type i = 0; i < m_operands.size(); ++iter )
 	{
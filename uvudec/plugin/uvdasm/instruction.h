@@ -10,6 +10,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvdasm/function.h"
 #include "uvdasm/operand.h"
 #include "uvdasm/util.h"
+#include "uvdasm/interpreter/builtin.h"
 #include "uvd/core/std_iterator.h"
 
 /*
@@ -31,6 +32,14 @@ However, this also applies to constant syntax parts, such as x86's INT3
 /* func like syntax used to express things like the memory type */
 #define UV_DISASM_DATA_FUNC					64
 
+//m_actionVariableOperands entry for the program counter rather than an operand
+#define UVD_ACTION_VARIABLE_PC				-1
+
+//Inline operand slots per instruction, function arguments included
+#define UVD_DISASM_INSTRUCTION_OPERANDS_MAX		8
+//Inline function operand slots per instruction
+#define UVD_DISASM_INSTRUCTION_FUNCTIONS_MAX	4
+
 class UVDDisasmInstructionShared : public UVDInstructionShared
 {
 public:
@@ -51,13 +60,16 @@ public:
 
 	//Partially to rapidly support FLIRT signature creation,
 	//opcodes were masked and others to allow rapid decoding of register ranges
-	uv_err_t getOpcodes(std::set<uint8_t> &out) const;
+	//Values opcode byte position can have
+	uv_err_t getOpcodes(uint32_t position, std::set<uint8_t> &out) const;
 
 	//Make ready instruction class
 	uv_err_t analyzeAction();
 
 private:
 	uv_err_t isImmediateOnlyFunctionCore();
+	//Precompile m_action for the builtin interpreter
+	uv_err_t compileActionProgram();
 
 public:
 
@@ -115,6 +127,8 @@ public:
 	//Make additional flags as needed, maybe we should just do char 
 	uvd_bool_t m_isJump;
 	uvd_bool_t m_isCall;
+	//ACTION contains RETURN()
+	uvd_bool_t m_isReturn;
 	//Instruction only executes under some given condition
 	//FIXME: replace with a pointer to a conditional
 	uvd_bool_t m_isConditional;
@@ -140,8 +154,18 @@ public:
 	uint32_t m_config_line_usage;
 	
 	uv_err_t m_isImmediateOnlyFunction;
+
+	/*
+	m_action precompiled when the builtin interpreter is selected
+	Lets control flow analysis skip building a variable map and reparsing the action per instruction
+	Not compiled if the action isn't understood, the configured interpreter is used instead
+	*/
+	UVDBuiltinProgram m_actionProgram;
+	//For each m_actionProgram.m_variables, the m_operands index it is read from or UVD_ACTION_VARIABLE_PC
+	std::vector<int> m_actionVariableOperands;
 };
 
+class UVDDisasmInstructionPool;
 class UVDDisasmInstruction : public UVDInstruction
 {
 public:
@@ -149,7 +173,10 @@ public:
 	~UVDDisasmInstruction();
 	
 	virtual uv_err_t init();
+	//Also resets us to be parsed into again, see UVDDisasmInstructionPool
 	virtual uv_err_t deinit();
+	//Back to m_pool
+	virtual void release();
 
 	UVDDisasmInstructionShared *getShared();
 
@@ -161,18 +188,44 @@ public:
 
 	virtual uv_err_t parseCurrentInstruction(UVDASInstructionIterator &iterCommon);
 
-	static uv_err_t parseOperands(UVDASInstructionIterator *uvdIter,
-			std::vector<UVDDisasmOperandShared *> ops_shared, std::vector<UVDOperand *> &operands);
+	//Operands are allocated from instruction's inline slots
+	static uv_err_t parseOperands(UVDASInstructionIterator *uvdIter, UVDDisasmInstruction *instruction,
+			const std::vector<UVDDisasmOperandShared *> &ops_shared, std::vector<UVDOperand *> &operands);
+
+	/*
+	Next unused inline slot, valid until we are deinit()'d
+	Returns UV_ERR_NOTSUPPORTED if the .op file needs more slots than we have
+	*/
+	uv_err_t allocateOperand(UVDDisasmOperandShared *shared, UVDDisasmOperand **out);
+	uv_err_t allocateFunction(UVDDisasmFunction **out);
 
 	//Hmm is this UVDDisasm specifc?
 	virtual uv_err_t collectVariables(UVDVariableMap &environment);
 
 	uv_err_t analyzeCall(uint32_t startPos, const UVDVariableMap &attributes, UVDInstructionAnalysis *out);
 	uv_err_t analyzeJump(uint32_t startPos, const UVDVariableMap &attributes, UVDInstructionAnalysis *out);
+	//Common to scripted and builtin analysis once the target is known
+	uv_err_t analyzeCallTarget(uint32_t startPos, uint32_t targetAddress, UVDInstructionAnalysis *out);
+	uv_err_t analyzeJumpTarget(uint32_t startPos, uint32_t targetAddress, UVDInstructionAnalysis *out);
+
+private:
+	//Evaluate a precompiled action, see UVDDisasmInstructionShared::m_actionProgram
+	uv_err_t analyzeControlFlowBuiltin(uint32_t followingPos, UVDInstructionAnalysis *out);
 
 public:	
 	//FIXME: this should be arch pointer, not uvd
 	UVD *m_uvd;
+	//Architecture's pool we came from, NULL if we weren't from one
+	UVDDisasmInstructionPool *m_pool;
+
+	/*
+	Storage for m_operands and function arguments
+	Instructions are recycled so this avoids any allocation per parse
+	*/
+	UVDDisasmOperand m_operandSlots[UVD_DISASM_INSTRUCTION_OPERANDS_MAX];
+	uint32_t m_operandSlotsUsed;
+	UVDDisasmFunction m_functionSlots[UVD_DISASM_INSTRUCTION_FUNCTIONS_MAX];
+	uint32_t m_functionSlotsUsed;
 };
 
 #endif
@@ -0,0 +1,76 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include "uvdasm/instruction.h"
+#include "uvdasm/instruction_pool.h"
+#include "uvd/util/debug.h"
+#include "uvd/util/error.h"
+#include "uvd/util/profile.h"
+
+UVDDisasmInstructionPool::UVDDisasmInstructionPool()
+{
+	m_allocated = 0;
+	m_recycled = 0;
+}
+
+UVDDisasmInstructionPool::~UVDDisasmInstructionPool()
+{
+	deinit();
+}
+
+uv_err_t UVDDisasmInstructionPool::deinit()
+{
+	for( std::vector<UVDDisasmInstruction *>::iterator iter = m_free.begin(); iter != m_free.end(); ++iter )
+	{
+		delete *iter;
+	}
+	m_free.clear();
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDDisasmInstructionPool::get(UVDDisasmInstruction **out)
+{
+	UVDDisasmInstruction *instruction = NULL;
+
+	uv_assert_ret(out);
+	//Most recently released first, likely still in cache
+	if( !m_free.empty() )
+	{
+		instruction = m_free.back();
+		m_free.pop_back();
+		++m_recycled;
+		g_profileInstructionRecycles.increment();
+	}
+	else
+	{
+		instruction = new UVDDisasmInstruction();
+		uv_assert_ret(instruction);
+		instruction->m_pool = this;
+		++m_allocated;
+		g_profileInstructionAllocations.increment();
+	}
+	*out = instruction;
+	return UV_ERR_OK;
+}
+
+void UVDDisasmInstructionPool::put(UVDDisasmInstruction *instruction)
+{
+	if( !instruction )
+	{
+		return;
+	}
+	//Drop what it was parsed from, keeps allocated capacity
+	UV_DEBUG(instruction->deinit());
+
+	if( m_free.size() < UVD_DISASM_INSTRUCTION_POOL_MAX )
+	{
+		m_free.push_back(instruction);
+		return;
+	}
+	delete instruction;
+}
+
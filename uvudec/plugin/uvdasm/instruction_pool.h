@@ -0,0 +1,49 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVDASM_INSTRUCTION_POOL_H
+#define UVDASM_INSTRUCTION_POOL_H
+
+#include <vector>
+#include "uvd/util/types.h"
+
+/*
+Recycled UVDDisasmInstruction objects
+Each parse used to allocate a new instruction, its operands and their function argument vectors
+Operands now live inline in the instruction (see UVDDisasmInstruction::allocateOperand())
+and a released instruction keeps its vector capacity, so reparsing into a recycled one doesn't allocate
+Instructions come back through UVDInstruction::release()
+	ex: when the instruction cache is invalidated or an iterator decodes over one the cache didn't take
+One per UVDDisasmArchitecture, which like the rest of an engine is used by one thread at a time
+*/
+
+//Released instructions beyond this are freed instead of kept
+#define UVD_DISASM_INSTRUCTION_POOL_MAX			0x10000
+
+class UVDDisasmInstruction;
+class UVDDisasmInstructionPool
+{
+public:
+	UVDDisasmInstructionPool();
+	~UVDDisasmInstructionPool();
+	//Free everything kept
+	//Instructions still handed out must not be released afterwards
+	uv_err_t deinit();
+
+	//A new or recycled instruction, ready to parse into
+	uv_err_t get(UVDDisasmInstruction **out);
+	//Nothing may reference instruction afterwards
+	void put(UVDDisasmInstruction *instruction);
+
+public:
+	std::vector<UVDDisasmInstruction *> m_free;
+	//Statistics
+	uint32_t m_allocated;
+	uint32_t m_recycled;
+};
+
+#endif
+
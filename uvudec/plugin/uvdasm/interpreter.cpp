@@ -6,6 +6,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 
 #include "uvd/config/config.h"
 #include "uvd/language/language.h"
+#include "uvd/util/profile.h"
 #include "uvd/util/util.h"
 #include "uvdasm/plugin_config.h"
 #include "uvdasm/interpreter.h"
@@ -72,6 +73,9 @@ uv_err_t UVDConfigExpressionInterpreterTemplate<T>::init()
 	return UV_ERR_OK;
 }
 
+#include "uvdasm/interpreter/builtin.h"
+typedef UVDConfigExpressionInterpreterTemplate<UVDBuiltinInterpreter> UVDBuiltinConfigExpressionInterpreter;
+
 #ifdef USING_JAVASCRIPT
 #include "uvdasm/interpreter/javascript.h"
 typedef UVDConfigExpressionInterpreterTemplate<UVDJavascriptInterpreter> UVDJavascriptConfigExpressionInterpreter;
@@ -188,6 +192,7 @@ uv_err_t UVDConfigExpressionInterpreter::interpret(const std::string &sExp, int
 uv_err_t UVDConfigExpressionInterpreter::interpret(const UVDConfigExpression *configExpression, const UVDVariableMap &environment, std::string &sRet)
 {
 	uv_assert_ret(configExpression);
+	g_profileInterpreterEvaluations.increment();
 	uv_assert_err_ret(m_interpreter->interpret(*(configExpression->m_interpreterExpression), environment, sRet));
 	return UV_ERR_OK;
 }
@@ -263,6 +268,10 @@ uv_err_t UVDConfigExpressionInterpreter::getConfigExpressionInterpreter(UVDConfi
 	selectedInterpreterInterface = g_asmConfig->m_configInterpreterLanguageInterface;
 	switch( selectedInterpreter )
 	{
+	case UVD_LANGUAGE_BUILTIN:
+		printf_debug_level(UVD_DEBUG_SUMMARY, "Chose builtin interpreter\n");
+		interpreter = new UVDBuiltinConfigExpressionInterpreter();
+		break;
 #ifdef USING_PYTHON
 	case UVD_LANGUAGE_PYTHON:
 		switch( selectedInterpreterInterface )
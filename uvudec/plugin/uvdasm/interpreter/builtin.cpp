@@ -0,0 +1,735 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "uvd/util/debug.h"
+#include "uvd/util/error.h"
+#include "uvdasm/interpreter/builtin.h"
+
+/*
+UVDBuiltinInstruction
+*/
+
+UVDBuiltinInstruction::UVDBuiltinInstruction()
+{
+	m_opcode = UVD_BUILTIN_OP_NONE;
+	m_operand = 0;
+}
+
+UVDBuiltinInstruction::UVDBuiltinInstruction(uint32_t opcode, int64_t operand)
+{
+	m_opcode = opcode;
+	m_operand = operand;
+}
+
+/*
+UVDBuiltinResult
+*/
+
+UVDBuiltinResult::UVDBuiltinResult()
+{
+	m_isCall = false;
+	m_callTarget = 0;
+	m_isJump = false;
+	m_jumpTarget = 0;
+}
+
+/*
+UVDBuiltinCompiler
+Recursive descent over a single expression string
+Only lives for the duration of UVDBuiltinProgram::compile()
+*/
+
+class UVDBuiltinCompiler
+{
+public:
+	UVDBuiltinCompiler(const std::string &sExpression, UVDBuiltinProgram *program);
+
+	uv_err_t compileProgram();
+
+private:
+	uv_err_t compileStatement();
+	//Each level of precedence, lowest first
+	uv_err_t compileOr();
+	uv_err_t compileXor();
+	uv_err_t compileAnd();
+	uv_err_t compileShift();
+	uv_err_t compileAdditive();
+	uv_err_t compileMultiplicative();
+	uv_err_t compileUnary();
+	uv_err_t compilePrimary();
+	uv_err_t compileFunction(const std::string &name);
+
+	uv_err_t emit(uint32_t opcode, int64_t operand = 0);
+	void skipWhitespace();
+	//Consume string if it is next
+	bool accept(const char *s);
+	bool atEnd();
+	uv_err_t parseIdentifier(std::string &out);
+	uv_err_t parseNumber(int64_t *out);
+
+public:
+	const std::string &m_sExpression;
+	std::string::size_type m_pos;
+	UVDBuiltinProgram *m_program;
+	//Values on the stack at current emit position
+	uint32_t m_stackDepth;
+};
+
+UVDBuiltinCompiler::UVDBuiltinCompiler(const std::string &sExpression, UVDBuiltinProgram *program)
+		: m_sExpression(sExpression)
+{
+	m_pos = 0;
+	m_program = program;
+	m_stackDepth = 0;
+}
+
+uv_err_t UVDBuiltinCompiler::compileProgram()
+{
+	for( ;; )
+	{
+		uv_assert_err_ret(compileStatement());
+		if( !accept(";") )
+		{
+			break;
+		}
+		//Allow a trailing ;
+		if( atEnd() )
+		{
+			break;
+		}
+	}
+	if( !atEnd() )
+	{
+		printf_debug("unexpected trailing data at %d in <%s>\n", m_pos, m_sExpression.c_str());
+		return UV_ERR_GENERAL;
+	}
+	uv_assert_ret(m_stackDepth == 0);
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDBuiltinCompiler::compileStatement()
+{
+	std::string::size_type start = 0;
+	std::string identifier;
+
+	skipWhitespace();
+	start = m_pos;
+	//nop is a placeholder statement rather than a variable
+	if( UV_SUCCEEDED(parseIdentifier(identifier)) && identifier == "nop" )
+	{
+		skipWhitespace();
+		if( atEnd() || m_sExpression[m_pos] == ';' )
+		{
+			return UV_ERR_OK;
+		}
+	}
+	m_pos = start;
+
+	uv_assert_err_ret(compileOr());
+	//Value of a statement is unused
+	uv_assert_err_ret(emit(UVD_BUILTIN_OP_POP));
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDBuiltinCompiler::compileOr()
+{
+	uv_assert_err_ret(compileXor());
+	while( accept("|") )
+	{
+		uv_assert_err_ret(compileXor());
+		uv_assert_err_ret(emit(UVD_BUILTIN_OP_OR));
+	}
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDBuiltinCompiler::compileXor()
+{
+	uv_assert_err_ret(compileAnd());
+	while( accept("^") )
+	{
+		uv_assert_err_ret(compileAnd());
+		uv_assert_err_ret(emit(UVD_BUILTIN_OP_XOR));
+	}
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDBuiltinCompiler::compileAnd()
+{
+	uv_assert_err_ret(compileShift());
+	while( accept("&") )
+	{
+		uv_assert_err_ret(compileShift());
+		uv_assert_err_ret(emit(UVD_BUILTIN_OP_AND));
+	}
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDBuiltinCompiler::compileShift()
+{
+	uv_assert_err_ret(compileAdditive());
+	for( ;; )
+	{
+		if( accept("<<") )
+		{
+			uv_assert_err_ret(compileAdditive());
+			uv_assert_err_ret(emit(UVD_BUILTIN_OP_SHIFT_LEFT));
+		}
+		else if( accept(">>") )
+		{
+			uv_assert_err_ret(compileAdditive());
+			uv_assert_err_ret(emit(UVD_BUILTIN_OP_SHIFT_RIGHT));
+		}
+		else
+		{
+			break;
+		}
+	}
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDBuiltinCompiler::compileAdditive()
+{
+	uv_assert_err_ret(compileMultiplicative());
+	for( ;; )
+	{
+		if( accept("+") )
+		{
+			uv_assert_err_ret(compileMultiplicative());
+			uv_assert_err_ret(emit(UVD_BUILTIN_OP_ADD));
+		}
+		else if( accept("-") )
+		{
+			uv_assert_err_ret(compileMultiplicative());
+			uv_assert_err_ret(emit(UVD_BUILTIN_OP_SUBTRACT));
+		}
+		else
+		{
+			break;
+		}
+	}
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDBuiltinCompiler::compileMultiplicative()
+{
+	uv_assert_err_ret(compileUnary());
+	for( ;; )
+	{
+		if( accept("*") )
+		{
+			uv_assert_err_ret(compileUnary());
+			uv_assert_err_ret(emit(UVD_BUILTIN_OP_MULTIPLY));
+		}
+		else if( accept("/") )
+		{
+			uv_assert_err_ret(compileUnary());
+			uv_assert_err_ret(emit(UVD_BUILTIN_OP_DIVIDE));
+		}
+		else
+		{
+			break;
+		}
+	}
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDBuiltinCompiler::compileUnary()
+{
+	if( accept("-") )
+	{
+		uv_assert_err_ret(compileUnary());
+		return UV_DEBUG(emit(UVD_BUILTIN_OP_NEGATE));
+	}
+	else if( accept("~") )
+	{
+		uv_assert_err_ret(compileUnary());
+		return UV_DEBUG(emit(UVD_BUILTIN_OP_INVERT));
+	}
+	else if( accept("+") )
+	{
+		return UV_DEBUG(compileUnary());
+	}
+	return UV_DEBUG(compilePrimary());
+}
+
+uv_err_t UVDBuiltinCompiler::compilePrimary()
+{
+	std::string identifier;
+	int64_t number = 0;
+	int variableIndex = 0;
+
+	skipWhitespace();
+	if( atEnd() )
+	{
+		printf_debug("unexpected end of expression <%s>\n", m_sExpression.c_str());
+		return UV_ERR_GENERAL;
+	}
+
+	if( accept("(") )
+	{
+		uv_assert_err_ret(compileOr());
+		if( !accept(")") )
+		{
+			printf_debug("expected ) at %d in <%s>\n", m_pos, m_sExpression.c_str());
+			return UV_ERR_GENERAL;
+		}
+		return UV_ERR_OK;
+	}
+
+	if( isdigit(m_sExpression[m_pos]) )
+	{
+		uv_assert_err_ret(parseNumber(&number));
+		return UV_DEBUG(emit(UVD_BUILTIN_OP_PUSH_CONST, number));
+	}
+
+	if( UV_FAILED(parseIdentifier(identifier)) )
+	{
+		printf_debug("unexpected character at %d in <%s>\n", m_pos, m_sExpression.c_str());
+		return UV_ERR_GENERAL;
+	}
+	if( accept("(") )
+	{
+		return UV_DEBUG(compileFunction(identifier));
+	}
+
+	//Plain variable
+	variableIndex = m_program->getVariableIndex(identifier);
+	if( variableIndex < 0 )
+	{
+		if( m_program->m_variables.size() >= UVD_BUILTIN_VARIABLES_MAX )
+		{
+			printf_debug("too many variables in <%s>\n", m_sExpression.c_str());
+			return UV_ERR_GENERAL;
+		}
+		variableIndex = m_program->m_variables.size();
+		m_program->m_variables.push_back(identifier);
+	}
+	return UV_DEBUG(emit(UVD_BUILTIN_OP_PUSH_VARIABLE, variableIndex));
+}
+
+uv_err_t UVDBuiltinCompiler::compileFunction(const std::string &name)
+{
+	//Opening ( already consumed
+	if( name == "RETURN" )
+	{
+		if( !accept(")") )
+		{
+			printf_debug("RETURN() takes no arguments\n");
+			return UV_ERR_GENERAL;
+		}
+		//No control flow information to extract, just needs some value
+		return UV_DEBUG(emit(UVD_BUILTIN_OP_PUSH_CONST, 0));
+	}
+
+	uv_assert_err_ret(compileOr());
+	if( !accept(")") )
+	{
+		printf_debug("expected single argument to %s() in <%s>\n", name.c_str(), m_sExpression.c_str());
+		return UV_ERR_GENERAL;
+	}
+
+	if( name == "CALL" )
+	{
+		uv_assert_err_ret(emit(UVD_BUILTIN_OP_CALL));
+		uv_assert_err_ret(emit(UVD_BUILTIN_OP_PUSH_CONST, 0));
+	}
+	else if( name == "GOTO" )
+	{
+		uv_assert_err_ret(emit(UVD_BUILTIN_OP_GOTO));
+		uv_assert_err_ret(emit(UVD_BUILTIN_OP_PUSH_CONST, 0));
+	}
+	//Otherwise an address space tag, argument is left as the value
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDBuiltinCompiler::emit(uint32_t opcode, int64_t operand)
+{
+	switch( opcode )
+	{
+	case UVD_BUILTIN_OP_PUSH_CONST:
+	case UVD_BUILTIN_OP_PUSH_VARIABLE:
+		++m_stackDepth;
+		if( m_stackDepth > UVD_BUILTIN_STACK_MAX )
+		{
+			printf_debug("expression too complex: <%s>\n", m_sExpression.c_str());
+			return UV_ERR_GENERAL;
+		}
+		break;
+	case UVD_BUILTIN_OP_NEGATE:
+	case UVD_BUILTIN_OP_INVERT:
+		uv_assert_ret(m_stackDepth >= 1);
+		break;
+	case UVD_BUILTIN_OP_CALL:
+	case UVD_BUILTIN_OP_GOTO:
+	case UVD_BUILTIN_OP_POP:
+		uv_assert_ret(m_stackDepth >= 1);
+		--m_stackDepth;
+		break;
+	default:
+		//Binary operators
+		uv_assert_ret(m_stackDepth >= 2);
+		--m_stackDepth;
+		break;
+	}
+	m_program->m_code.push_back(UVDBuiltinInstruction(opcode, operand));
+	return UV_ERR_OK;
+}
+
+void UVDBuiltinCompiler::skipWhitespace()
+{
+	while( m_pos < m_sExpression.size() && isspace(m_sExpression[m_pos]) )
+	{
+		++m_pos;
+	}
+}
+
+bool UVDBuiltinCompiler::accept(const char *s)
+{
+	std::string::size_type length = strlen(s);
+
+	skipWhitespace();
+	if( m_sExpression.compare(m_pos, length, s) != 0 )
+	{
+		return false;
+	}
+	//Don't let < match the start of <<
+	if( length == 1 && (s[0] == '<' || s[0] == '>') && m_pos + 1 < m_sExpression.size() && m_sExpression[m_pos + 1] == s[0] )
+	{
+		return false;
+	}
+	m_pos += length;
+	return true;
+}
+
+bool UVDBuiltinCompiler::atEnd()
+{
+	skipWhitespace();
+	return m_pos >= m_sExpression.size();
+}
+
+uv_err_t UVDBuiltinCompiler::parseIdentifier(std::string &out)
+{
+	std::string::size_type start = 0;
+
+	skipWhitespace();
+	//Register prefix
+	if( m_pos < m_sExpression.size() && m_sExpression[m_pos] == '%' )
+	{
+		++m_pos;
+	}
+	start = m_pos;
+	if( m_pos >= m_sExpression.size() || !(isalpha(m_sExpression[m_pos]) || m_sExpression[m_pos] == '_') )
+	{
+		return UV_ERR_GENERAL;
+	}
+	while( m_pos < m_sExpression.size() && (isalnum(m_sExpression[m_pos]) || m_sExpression[m_pos] == '_') )
+	{
+		++m_pos;
+	}
+	out = m_sExpression.substr(start, m_pos - start);
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDBuiltinCompiler::parseNumber(int64_t *out)
+{
+	const char *start = NULL;
+	char *end = NULL;
+
+	start = m_sExpression.c_str() + m_pos;
+	//Same as the config file: 0x hex, leading 0 octal, otherwise decimal
+	*out = (int64_t)strtoull(start, &end, 0);
+	uv_assert_ret(end != start);
+	m_pos += end - start;
+	return UV_ERR_OK;
+}
+
+/*
+UVDBuiltinProgram
+*/
+
+UVDBuiltinProgram::UVDBuiltinProgram()
+{
+	m_compiled = false;
+}
+
+UVDBuiltinProgram::~UVDBuiltinProgram()
+{
+}
+
+uv_err_t UVDBuiltinProgram::compile(const std::string &sExpression)
+{
+	UVDBuiltinCompiler compiler(sExpression, this);
+
+	clear();
+	m_sExpression = sExpression;
+	if( UV_FAILED(compiler.compileProgram()) )
+	{
+		clear();
+		return UV_ERR_GENERAL;
+	}
+	m_compiled = true;
+	return UV_ERR_OK;
+}
+
+void UVDBuiltinProgram::clear()
+{
+	m_code.clear();
+	m_variables.clear();
+	m_sExpression.clear();
+	m_compiled = false;
+}
+
+bool UVDBuiltinProgram::isCompiled() const
+{
+	return m_compiled;
+}
+
+int UVDBuiltinProgram::getVariableIndex(const std::string &name) const
+{
+	for( std::vector<std::string>::size_type i = 0; i < m_variables.size(); ++i )
+	{
+		if( m_variables[i] == name )
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+uv_err_t UVDBuiltinProgram::execute(const int64_t *variables, UVDBuiltinResult *result) const
+{
+	int64_t stack[UVD_BUILTIN_STACK_MAX];
+	uint32_t stackDepth = 0;
+
+	uv_assert_ret(m_compiled);
+	uv_assert_ret(result);
+	uv_assert_ret(variables || m_variables.empty());
+	*result = UVDBuiltinResult();
+
+	//Stack bounds were verified during compile
+	for( std::vector<UVDBuiltinInstruction>::const_iterator iter = m_code.begin(); iter != m_code.end(); ++iter )
+	{
+		const UVDBuiltinInstruction &instruction = *iter;
+
+		switch( instruction.m_opcode )
+		{
+		case UVD_BUILTIN_OP_PUSH_CONST:
+			stack[stackDepth++] = instruction.m_operand;
+			break;
+		case UVD_BUILTIN_OP_PUSH_VARIABLE:
+			stack[stackDepth++] = variables[instruction.m_operand];
+			break;
+		case UVD_BUILTIN_OP_NEGATE:
+			stack[stackDepth - 1] = -stack[stackDepth - 1];
+			break;
+		case UVD_BUILTIN_OP_INVERT:
+			stack[stackDepth - 1] = ~stack[stackDepth - 1];
+			break;
+		case UVD_BUILTIN_OP_MULTIPLY:
+			--stackDepth;
+			stack[stackDepth - 1] *= stack[stackDepth];
+			break;
+		case UVD_BUILTIN_OP_DIVIDE:
+			--stackDepth;
+			if( stack[stackDepth] == 0 )
+			{
+				printf_error("divide by zero in <%s>\n", m_sExpression.c_str());
+				return UV_DEBUG(UV_ERR_GENERAL);
+			}
+			stack[stackDepth - 1] /= stack[stackDepth];
+			break;
+		case UVD_BUILTIN_OP_ADD:
+			--stackDepth;
+			stack[stackDepth - 1] += stack[stackDepth];
+			break;
+		case UVD_BUILTIN_OP_SUBTRACT:
+			--stackDepth;
+			stack[stackDepth - 1] -= stack[stackDepth];
+			break;
+		case UVD_BUILTIN_OP_SHIFT_LEFT:
+			--stackDepth;
+			stack[stackDepth - 1] = (int64_t)((uint64_t)stack[stackDepth - 1] << (stack[stackDepth] & 0x3F));
+			break;
+		case UVD_BUILTIN_OP_SHIFT_RIGHT:
+			--stackDepth;
+			stack[stackDepth - 1] >>= (stack[stackDepth] & 0x3F);
+			break;
+		case UVD_BUILTIN_OP_AND:
+			--stackDepth;
+			stack[stackDepth - 1] &= stack[stackDepth];
+			break;
+		case UVD_BUILTIN_OP_XOR:
+			--stackDepth;
+			stack[stackDepth - 1] ^= stack[stackDepth];
+			break;
+		case UVD_BUILTIN_OP_OR:
+			--stackDepth;
+			stack[stackDepth - 1] |= stack[stackDepth];
+			break;
+		case UVD_BUILTIN_OP_CALL:
+			--stackDepth;
+			result->m_isCall = true;
+			result->m_callTarget = (uint32_t)stack[stackDepth];
+			break;
+		case UVD_BUILTIN_OP_GOTO:
+			--stackDepth;
+			result->m_isJump = true;
+			result->m_jumpTarget = (uint32_t)stack[stackDepth];
+			break;
+		case UVD_BUILTIN_OP_POP:
+			--stackDepth;
+			break;
+		default:
+			printf_error("bad builtin opcode 0x%02X\n", instruction.m_opcode);
+			return UV_DEBUG(UV_ERR_GENERAL);
+		}
+	}
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDBuiltinProgram::execute(const UVDVariableMap &environment, UVDBuiltinResult *result) const
+{
+	int64_t variables[UVD_BUILTIN_VARIABLES_MAX];
+
+	for( std::vector<std::string>::size_type i = 0; i < m_variables.size(); ++i )
+	{
+		UVDVariableMap::const_iterator iter = environment.find(m_variables[i]);
+
+		if( iter == environment.end() )
+		{
+			printf_error("undefined variable %s in <%s>\n", m_variables[i].c_str(), m_sExpression.c_str());
+			return UV_DEBUG(UV_ERR_GENERAL);
+		}
+
+		switch( (*iter).second.getType() )
+		{
+		case UVD_VARIENT_INT32:
+		{
+			int32_t value = 0;
+
+			uv_assert_err_ret((*iter).second.getI32(value));
+			variables[i] = value;
+			break;
+		}
+		case UVD_VARIENT_UINT32:
+		{
+			uint32_t value = 0;
+
+			uv_assert_err_ret((*iter).second.getUI32(value));
+			variables[i] = value;
+			break;
+		}
+		case UVD_VARIENT_STRING:
+		{
+			std::string value;
+
+			uv_assert_err_ret((*iter).second.getString(value));
+			variables[i] = strtoll(value.c_str(), NULL, 0);
+			break;
+		}
+		default:
+			return UV_DEBUG(UV_ERR_GENERAL);
+		}
+	}
+
+	return UV_DEBUG(execute(variables, result));
+}
+
+/*
+UVDBuiltinInterpreterExpression
+*/
+
+UVDBuiltinInterpreterExpression::UVDBuiltinInterpreterExpression()
+{
+}
+
+UVDBuiltinInterpreterExpression::~UVDBuiltinInterpreterExpression()
+{
+}
+
+/*
+UVDBuiltinInterpreter
+*/
+
+UVDBuiltinInterpreter::UVDBuiltinInterpreter()
+{
+}
+
+UVDBuiltinInterpreter::~UVDBuiltinInterpreter()
+{
+}
+
+uv_err_t UVDBuiltinInterpreter::init()
+{
+	uv_assert_err_ret(UVDInterpreter::init());
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDBuiltinInterpreter::compile(const std::string &sExp, UVDInterpreterExpression *resultIn)
+{
+	UVDBuiltinInterpreterExpression *result = NULL;
+
+	//Only our own expressions have a place to put the program
+	result = dynamic_cast<UVDBuiltinInterpreterExpression *>(resultIn);
+	uv_assert_ret(result);
+
+	uv_assert_err_ret(UVDInterpreter::compile(sExp, result));
+	if( UV_FAILED(result->m_program.compile(sExp)) )
+	{
+		printf_error("could not compile expression <%s>\n", sExp.c_str());
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	result->m_compiled = &result->m_program;
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDBuiltinInterpreter::interpret(const UVDInterpreterExpression &expIn, const UVDVariableMap &environment, std::string &sRet)
+{
+	const UVDBuiltinInterpreterExpression *exp = NULL;
+	UVDBuiltinResult result;
+	char buff[64];
+
+	exp = dynamic_cast<const UVDBuiltinInterpreterExpression *>(&expIn);
+	uv_assert_ret(exp);
+	uv_assert_err_ret(exp->m_program.execute(environment, &result));
+
+	//Match what the scripting interpreters print
+	sRet.clear();
+	if( result.m_isCall )
+	{
+		snprintf(buff, sizeof(buff), SCRIPT_KEY_CALL "=%u\n", result.m_callTarget);
+		sRet += buff;
+	}
+	if( result.m_isJump )
+	{
+		snprintf(buff, sizeof(buff), SCRIPT_KEY_JUMP "=%u\n", result.m_jumpTarget);
+		sRet += buff;
+	}
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDBuiltinInterpreter::getInterpreterExpression(UVDInterpreterExpression **expression_in)
+{
+	UVDBuiltinInterpreterExpression *expression = NULL;
+
+	expression = new UVDBuiltinInterpreterExpression();
+	uv_assert_ret(expression);
+
+	expression->m_interpreter = this;
+
+	uv_assert_ret(expression_in);
+	*expression_in = expression;
+
+	return UV_ERR_OK;
+}
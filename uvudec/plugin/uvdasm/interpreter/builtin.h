@@ -0,0 +1,146 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVD_BUILTIN_H
+#define UVD_BUILTIN_H
+
+#include <string>
+#include <vector>
+#include "uvd/util/types.h"
+#include "uvdasm/interpreter/interpreter.h"
+
+/*
+Native evaluator for .op ACTION expressions
+The scripting backends are general but cost a process or interpreter round trip per instruction
+ACTION expressions only need a tiny subset of that:
+
+<program> := <statement> [; <statement>]*
+<statement> := nop | <expression>
+<expression> := C style integer expression over
+	numbers (0x1F00, 12), variables (%PC, u8_0), unary - ~, binary * / + - << >> & ^ |
+	and function calls
+Functions
+	CALL(x): x is a call target
+	GOTO(x): x is a jump target
+	RETURN(): ignored
+	Anything else with a single argument is an address space tag (ROM(x)) and evaluates to x
+Register prefixes (%) are stripped as the other interpreters do
+
+Expressions are compiled once into a stack program which is then evaluated without any allocation
+*/
+
+#define UVD_BUILTIN_OP_NONE					0
+//Push m_operand
+#define UVD_BUILTIN_OP_PUSH_CONST			1
+//Push variable at index m_operand
+#define UVD_BUILTIN_OP_PUSH_VARIABLE		2
+#define UVD_BUILTIN_OP_NEGATE				3
+#define UVD_BUILTIN_OP_INVERT				4
+#define UVD_BUILTIN_OP_MULTIPLY				5
+#define UVD_BUILTIN_OP_DIVIDE				6
+#define UVD_BUILTIN_OP_ADD					7
+#define UVD_BUILTIN_OP_SUBTRACT				8
+#define UVD_BUILTIN_OP_SHIFT_LEFT			9
+#define UVD_BUILTIN_OP_SHIFT_RIGHT			10
+#define UVD_BUILTIN_OP_AND					11
+#define UVD_BUILTIN_OP_XOR					12
+#define UVD_BUILTIN_OP_OR					13
+//Pop value as call target
+#define UVD_BUILTIN_OP_CALL					14
+//Pop value as jump target
+#define UVD_BUILTIN_OP_GOTO					15
+//Discard top of stack (end of a statement)
+#define UVD_BUILTIN_OP_POP					16
+
+//Limits so that evaluation can use fixed size buffers
+#define UVD_BUILTIN_STACK_MAX				32
+#define UVD_BUILTIN_VARIABLES_MAX			16
+
+class UVDBuiltinInstruction
+{
+public:
+	UVDBuiltinInstruction();
+	UVDBuiltinInstruction(uint32_t opcode, int64_t operand = 0);
+
+public:
+	uint32_t m_opcode;
+	int64_t m_operand;
+};
+
+/*
+Control flow extracted from a program run
+*/
+class UVDBuiltinResult
+{
+public:
+	UVDBuiltinResult();
+
+public:
+	uvd_bool_t m_isCall;
+	uint32_t m_callTarget;
+	uvd_bool_t m_isJump;
+	uint32_t m_jumpTarget;
+};
+
+class UVDBuiltinProgram
+{
+public:
+	UVDBuiltinProgram();
+	~UVDBuiltinProgram();
+
+	//Returns error on anything outside of the above grammar
+	uv_err_t compile(const std::string &sExpression);
+	//Forget any compiled code
+	void clear();
+	bool isCompiled() const;
+
+	//Variable index for given name or -1 if not referenced
+	int getVariableIndex(const std::string &name) const;
+
+	/*
+	variables is indexed the same as m_variables and must have m_variables.size() entries
+	No allocation is done here
+	*/
+	uv_err_t execute(const int64_t *variables, UVDBuiltinResult *result) const;
+	//Convenience for when we only have a scripting style environment
+	uv_err_t execute(const UVDVariableMap &environment, UVDBuiltinResult *result) const;
+
+public:
+	std::vector<UVDBuiltinInstruction> m_code;
+	//Names of variables referenced, index is what PUSH_VARIABLE refers to
+	std::vector<std::string> m_variables;
+	//What the expression was compiled from
+	std::string m_sExpression;
+	bool m_compiled;
+};
+
+/*
+Compiles expressions into an UVDBuiltinProgram
+*/
+class UVDBuiltinInterpreterExpression : public UVDInterpreterExpression
+{
+public:
+	UVDBuiltinInterpreterExpression();
+	virtual ~UVDBuiltinInterpreterExpression();
+
+public:
+	UVDBuiltinProgram m_program;
+};
+
+class UVDBuiltinInterpreter : public UVDInterpreter
+{
+public:
+	UVDBuiltinInterpreter();
+	virtual ~UVDBuiltinInterpreter();
+	virtual uv_err_t init();
+
+	virtual uv_err_t compile(const std::string &sExp, UVDInterpreterExpression *result);
+	//Output is in the same key=value form the scripting interpreters print
+	virtual uv_err_t interpret(const UVDInterpreterExpression &exp, const UVDVariableMap &environment, std::string &sRet);
+	virtual uv_err_t getInterpreterExpression(UVDInterpreterExpression **expression);
+};
+
+#endif
@@ -26,6 +26,7 @@ uv_err_t UVDInterpreterExpression::compile(const std::string &sExpression)
 
 UVDInterpreter::UVDInterpreter()
 {
+	m_architecture = NULL;
 }
 
 UVDInterpreter::~UVDInterpreter()
@@ -24,6 +24,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 /*
 A compiled expression to be passed into an interpreter
 */
+class UVDArchitecture;
 class UVDInterpreter;
 class UVDInterpreterExpression
 {
@@ -90,6 +91,10 @@ public:
 	uv_err_t extractCallOutput(UVDVariableMap &variableMap, UVDInterpretedCall *out);
 	//for unconditional and conditional branches/jumps
 	uv_err_t extractBranchOutput(UVDVariableMap &variableMap, UVDInterpretedBranch *out);
+
+public:
+	//Architecture we interpret for, set by it, not owned
+	UVDArchitecture *m_architecture;
 };
 
 #endif
@@ -14,6 +14,7 @@ These are licensed under GPL/LGPL/Mozilla
 If this small code excert is an issue, will rewrite and such to avoid issues
 */
 
+#include <pthread.h>
 #include <string>
 #include <vector>
 #include "uvd/util/util.h"
@@ -29,6 +30,8 @@ If this small code excert is an issue, will rewrite and such to avoid issues
 #define JS_SUCCEEDED(x) (x == JS_TRUE)
 
 static std::stringstream g_stringStream;
+//print goes through g_stringStream, so only one engine may be running a script at a time
+static pthread_mutex_t g_stringStreamMutex = PTHREAD_MUTEX_INITIALIZER;
 
 static void spiderMonkeyErrorReporter(JSContext *cx, const char *message, JSErrorReport *report)
 {
@@ -203,6 +206,7 @@ uv_err_t UVDJavascriptSpiderapeInterpreter::interpret(const UVDInterpreterExpres
 	Run it!
 	*/
 	jsval retVal;	
+	pthread_mutex_lock(&g_stringStreamMutex);
 	if( JS_FAILED(m_monkeyWrapper.eval_source(
 			// arbitrary JS code
 			sJavascriptProgram.c_str(), 
@@ -212,6 +216,8 @@ uv_err_t UVDJavascriptSpiderapeInterpreter::interpret(const UVDInterpreterExpres
 			"uvudec_anonymous" 
 			)) )
 	{
+		getNextBufferData();
+		pthread_mutex_unlock(&g_stringStreamMutex);
 		printf_error("Failed to execute script!\n");
 		printf_error("%s\n", sJavascriptProgram.c_str());
 		return UV_DEBUG(UV_ERR_GENERAL);
@@ -221,6 +227,7 @@ uv_err_t UVDJavascriptSpiderapeInterpreter::interpret(const UVDInterpreterExpres
 	printf_debug("script returned: %s\n", sScriptRet.c_str());
 
 	sRet = getNextBufferData();
+	pthread_mutex_unlock(&g_stringStreamMutex);
 	printf_debug("Buffered output: <%s>\n", sRet.c_str());	
 	
 	return UV_ERR_OK;
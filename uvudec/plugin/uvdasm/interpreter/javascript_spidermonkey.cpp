@@ -36,7 +36,8 @@ uv_err_t UVDJavascriptSpidermonkeyInterpreter::interpret(const UVDInterpreterExp
 	[mcmaster@localhost uv_udec]$ python -c 'print "test";'
 	test
 	*/
-	static std::string pythonFile;
+	//Per call, engines on other threads may be interpreting at the same time
+	std::string pythonFile;
 	
 	uv_err_t rc = UV_ERR_GENERAL;
 	std::vector<std::string> args;
@@ -48,10 +49,7 @@ uv_err_t UVDJavascriptSpidermonkeyInterpreter::interpret(const UVDInterpreterExp
 	UV_ENTER();
 
 	
-	if( pythonFile.empty() )
-	{
-		uv_assert_err(getTempFile(pythonFile));
-	}
+	uv_assert_err(getTempFile(pythonFile));
 
 	//Execut an expression
 	//args.push_back("-c");
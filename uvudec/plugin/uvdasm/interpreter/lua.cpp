@@ -20,13 +20,6 @@ extern "C"
 }
 
 
-/*
-WARNING
-If this was made multitrheaded (for w/e reason), this would need to be synchronized or something
-*/
-
-std::string g_luaPrintBuffer;
-
 //Ovveridden print function
 static int luaPrint(lua_State *L);
 
@@ -52,8 +45,10 @@ uv_err_t UVDLuaInterpreter::init()
 	//luaL_openlibs(m_luaState);
 
 	//Overrite print so we can instead do internal processing and not print to stdout/stderr
-    lua_pushcfunction(m_luaState, luaPrint);
-    lua_setglobal(m_luaState, "print");
+	//Output goes to this interpreter's buffer so engines on different threads don't mix it
+	lua_pushlightuserdata(m_luaState, &m_printBuffer);
+	lua_pushcclosure(m_luaState, luaPrint, 1);
+	lua_setglobal(m_luaState, "print");
 
 	/*
 	std::string sExec = "print(\"sin res: \" .. mysin(1.57) .. \"\\n\")";
@@ -82,7 +77,7 @@ uv_err_t UVDLuaInterpreter::interpret(const UVDInterpreterExpression &exp, const
 	std::string sLuaProgram;
 
 	//Make sure we don't have any garbaged buffered
-	g_luaPrintBuffer.clear();
+	m_printBuffer.clear();
 
 
 	/*
@@ -132,7 +127,7 @@ uv_err_t UVDLuaInterpreter::interpret(const UVDInterpreterExpression &exp, const
 
 
 	//Returns 0 on success
-	g_luaPrintBuffer.clear();
+	m_printBuffer.clear();
 	if( luaL_dostring(m_luaState, sLuaProgram.c_str()) != 0 )
 	{
 		//Execution failed
@@ -141,9 +136,9 @@ uv_err_t UVDLuaInterpreter::interpret(const UVDInterpreterExpression &exp, const
 	}
 
 	//Grab the buffer we accumulated
-	sRet = g_luaPrintBuffer;
+	sRet = m_printBuffer;
 	//We grabbed the data already
-	g_luaPrintBuffer.clear();
+	m_printBuffer.clear();
 
 	return UV_ERR_OK;
 }
@@ -160,6 +155,7 @@ static int luaPrint(lua_State *L)
 	*/
 	
 	int n_opts = lua_gettop(L);
+	std::string *printBuffer = (std::string *)lua_touserdata(L, lua_upvalueindex(1));
 	printf_debug("luaPrint: n_opts: %d\n", n_opts);
 
 	for( int i = 1; i <= n_opts; ++i )
@@ -173,7 +169,7 @@ static int luaPrint(lua_State *L)
 		else
 		{
 			printf_debug("val: <%s>\n", val);
-			g_luaPrintBuffer += val;
+			*printBuffer += val;
 		}
 	}
 	
@@ -31,6 +31,8 @@ public:
 
 protected:
 	lua_State *m_luaState;
+	//Output of print() during the current interpret()
+	std::string m_printBuffer;
 };
 
 #endif //USING_LUA
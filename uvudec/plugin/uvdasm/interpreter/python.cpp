@@ -9,6 +9,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include <string>
 #include <sstream>
 #include <vector>
+#include "uvd/architecture/architecture.h"
 #include "uvd/core/uvd.h"
 #include "uvd/util/util.h"
 #include "uvd/config/config.h"
@@ -91,7 +92,8 @@ uv_err_t UVDPythonInterpreter::preparePythonProgram(const UVDInterpreterExpressi
 		addressSpaceName = (*iter).first;
 #endif
 	std::vector<std::string> addressSpaceNames;
-	g_uvd->m_runtime->m_architecture->getAddresssSpaceNames(addressSpaceNames);
+	uv_assert_ret(m_architecture);
+	m_architecture->getAddresssSpaceNames(addressSpaceNames);
 	for( std::vector<std::string>::iterator iter = addressSpaceNames.begin(); iter != addressSpaceNames.end(); ++iter )
 	{
 		std::string addressSpaceName = *iter;
@@ -35,7 +35,12 @@ public:
 	virtual uv_err_t interpret(const UVDInterpreterExpression &exp, const UVDVariableMap &environment, std::string &sRet);
 
 protected:
+	//Caller must hold the process wide Python lock
 	uv_err_t execPythonLines(std::string pycode, std::string &sRet);
+
+protected:
+	//Counted as a user of the shared Python interpreter
+	bool m_initialized;
 };
 #endif
 
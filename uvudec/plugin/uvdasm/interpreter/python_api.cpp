@@ -9,6 +9,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 //This file has to go first or it gets angry
 //#include "python2.6/Python.h"
 #include <Python.h>
+#include <pthread.h>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -18,8 +19,16 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 
 UVDPythonAPIInterpreter::UVDPythonAPIInterpreter()
 {
+	m_initialized = false;
 }
 
+/*
+There is one Python interpreter per process no matter how many engines there are
+g_pythonMutex serializes its use (and g_stringStream, where uvd_print() output goes)
+The interpreter lives from the first UVDPythonAPIInterpreter::init() to the last destructor
+*/
+static pthread_mutex_t g_pythonMutex = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t g_pythonUsers = 0;
 static std::stringstream g_stringStream;
 
 static PyObject *uvd_print(PyObject *self, PyObject* args)
@@ -50,22 +59,43 @@ void initeasy(void)
 
 UVDPythonAPIInterpreter::~UVDPythonAPIInterpreter()
 {
-	Py_Finalize();
+	pthread_mutex_lock(&g_pythonMutex);
+	if( m_initialized )
+	{
+		--g_pythonUsers;
+		if( g_pythonUsers == 0 )
+		{
+			Py_Finalize();
+		}
+	}
+	pthread_mutex_unlock(&g_pythonMutex);
 }
 
 uv_err_t UVDPythonAPIInterpreter::init()
 {
+	uv_err_t rc = UV_ERR_GENERAL;
+	
 	uv_assert_err_ret(UVDPythonInterpreter::init());
 
-	Py_Initialize();
-	if( !Py_IsInitialized() )
+	pthread_mutex_lock(&g_pythonMutex);
+	if( g_pythonUsers == 0 )
 	{
-		printf_error("Failed to initialize python!");
-		return UV_DEBUG(UV_ERR_GENERAL);
+		Py_Initialize();
+		if( !Py_IsInitialized() )
+		{
+			printf_error("Failed to initialize python!");
+			UV_DEBUG(rc);
+			goto error;
+		}
+		initeasy();
 	}
+	++g_pythonUsers;
+	m_initialized = true;
+	rc = UV_ERR_OK;
 
-	initeasy();
-	return UV_ERR_OK;
+error:
+	pthread_mutex_unlock(&g_pythonMutex);
+	return rc;
 }
 
 uv_err_t UVDPythonAPIInterpreter::execPythonLines(std::string pycode, std::string &sRet)
@@ -109,8 +139,15 @@ uv_err_t UVDPythonAPIInterpreter::interpret(const UVDInterpreterExpression &exp,
 {
 	std::string sPythonProgram;
 
+	uv_err_t rc = UV_ERR_GENERAL;
+
 	uv_assert_err_ret(preparePythonProgram(exp, environment, sPythonProgram));
-	uv_assert_err_ret(execPythonLines(sPythonProgram, sRet));
+	pthread_mutex_lock(&g_pythonMutex);
+	rc = execPythonLines(sPythonProgram, sRet);
+	//Don't leave partial output for the next caller
+	g_stringStream.str("");
+	pthread_mutex_unlock(&g_pythonMutex);
+	uv_assert_err_ret(rc);
 
 	return UV_ERR_OK;
 }
@@ -35,7 +35,8 @@ uv_err_t UVDPythonExecInterpreter::interpret(const UVDInterpreterExpression &exp
 	[mcmaster@localhost uv_udec]$ python -c 'print "test";'
 	test
 	*/
-	static std::string pythonFile;
+	//Per call, engines on other threads may be interpreting at the same time
+	std::string pythonFile;
 	
 	uv_err_t rc = UV_ERR_GENERAL;
 	std::vector<std::string> args;
@@ -43,10 +44,7 @@ uv_err_t UVDPythonExecInterpreter::interpret(const UVDInterpreterExpression &exp
 	int iRet = 0;
 	std::string sErr;
 
-	if( pythonFile.empty() )
-	{
-		uv_assert_err(getTempFile(pythonFile));
-	}
+	uv_assert_err(getTempFile(pythonFile));
 
 	//Execut an expression
 	//args.push_back("-c");
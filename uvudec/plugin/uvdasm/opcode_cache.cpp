@@ -0,0 +1,642 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include "uvd/data/data.h"
+#include "uvd/util/debug.h"
+#include "uvd/util/error.h"
+#include "uvd/util/util.h"
+#include "uvdasm/instruction.h"
+#include "uvdasm/opcode_cache.h"
+#include "uvdasm/opcode_table.h"
+#include "uvdasm/plugin_config.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+//Written in native byte order, this tells us if the file came from somewhere else
+#define UVD_DISASM_OPCODE_CACHE_BYTE_ORDER		0x01020304
+
+/*
+Bounds checked cursor over the mapped cache file
+Running off the end means the file is truncated or otherwise bad
+*/
+class UVDDisasmOpcodeCacheReader
+{
+public:
+	UVDDisasmOpcodeCacheReader(const uint8_t *buffer, uint32_t size)
+	{
+		m_cur = buffer;
+		m_end = buffer + size;
+	}
+
+	uv_err_t read(void *out, uint32_t size)
+	{
+		if( (uint32_t)(m_end - m_cur) < size )
+		{
+			return UV_ERR_GENERAL;
+		}
+		memcpy(out, m_cur, size);
+		m_cur += size;
+		return UV_ERR_OK;
+	}
+
+	template <typename T> uv_err_t readValue(T *out)
+	{
+		return read(out, sizeof(T));
+	}
+
+	uv_err_t readBool(uvd_bool_t *out)
+	{
+		uint8_t value = 0;
+
+		if( UV_FAILED(readValue(&value)) )
+		{
+			return UV_ERR_GENERAL;
+		}
+		*out = value != 0;
+		return UV_ERR_OK;
+	}
+
+	uv_err_t readString(std::string &out)
+	{
+		uint32_t size = 0;
+
+		if( UV_FAILED(readValue(&size)) || (uint32_t)(m_end - m_cur) < size )
+		{
+			return UV_ERR_GENERAL;
+		}
+		out.assign((const char *)m_cur, size);
+		m_cur += size;
+		return UV_ERR_OK;
+	}
+
+	bool isEnd() const
+	{
+		return m_cur == m_end;
+	}
+
+public:
+	const uint8_t *m_cur;
+	const uint8_t *m_end;
+};
+
+template <typename T> static void writeValue(std::string &out, T value)
+{
+	out.append((const char *)&value, sizeof(T));
+}
+
+static void writeString(std::string &out, const std::string &value)
+{
+	writeValue<uint32_t>(out, value.size());
+	out.append(value);
+}
+
+UVDDisasmOpcodeCache::UVDDisasmOpcodeCache()
+{
+	m_hash = 0;
+	m_language = 0;
+}
+
+UVDDisasmOpcodeCache::~UVDDisasmOpcodeCache()
+{
+}
+
+uv_err_t UVDDisasmOpcodeCache::init(const std::string &architectureFileName, const std::string &architectureFileData)
+{
+	uv_assert_ret(g_asmConfig);
+	m_fileName.clear();
+	if( !g_asmConfig->m_architectureCache )
+	{
+		return UV_ERR_OK;
+	}
+
+	if( g_asmConfig->m_architectureCacheDir.empty() )
+	{
+		std::string cacheDir;
+		
+		//Not next to the architecture file, that's usually the source tree or a shared install
+		if( UV_FAILED(getDefaultDir(cacheDir)) )
+		{
+			printf_debug("no user architecture cache dir, not caching\n");
+			return UV_ERR_OK;
+		}
+		m_fileName = cacheDir + "/" + uv_basename(architectureFileName) + UVD_DISASM_OPCODE_CACHE_EXTENSION;
+	}
+	else
+	{
+		m_fileName = g_asmConfig->m_architectureCacheDir + "/" + uv_basename(architectureFileName) + UVD_DISASM_OPCODE_CACHE_EXTENSION;
+	}
+	m_hash = hash(architectureFileData.c_str(), architectureFileData.size());
+	m_language = g_asmConfig->m_configInterpreterLanguage;
+	printf_debug("architecture cache: %s, hash: 0x%016llX\n", m_fileName.c_str(), (unsigned long long)m_hash);
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDDisasmOpcodeCache::getDefaultDir(std::string &out)
+{
+	std::string homeDir;
+	std::string dir;
+	
+	if( UV_FAILED(UVDGetHomeDir(homeDir)) || homeDir.empty() )
+	{
+		return UV_ERR_NOTFOUND;
+	}
+	//Same place as the user config file
+	dir = homeDir + "/.uvudec";
+	if( UV_FAILED(isDir(dir)) && UV_FAILED(createDir(dir, true)) )
+	{
+		return UV_ERR_NOTFOUND;
+	}
+	dir += UVD_DISASM_OPCODE_CACHE_USER_DIR;
+	if( UV_FAILED(isDir(dir)) && UV_FAILED(createDir(dir, true)) )
+	{
+		return UV_ERR_NOTFOUND;
+	}
+	out = dir;
+	return UV_ERR_OK;
+}
+
+uint64_t UVDDisasmOpcodeCache::hash(const char *data, uint32_t size)
+{
+	uint64_t ret = 0xCBF29CE484222325ULL;
+
+	for( uint32_t i = 0; i < size; ++i )
+	{
+		ret ^= (uint8_t)data[i];
+		ret *= 0x100000001B3ULL;
+	}
+	return ret;
+}
+
+uv_err_t UVDDisasmOpcodeCache::writeOperand(std::string &out, const UVDDisasmOperandShared *operand)
+{
+	uv_assert_ret(operand);
+	writeValue<uint32_t>(out, operand->m_type);
+	writeString(out, operand->m_name);
+	switch( operand->m_type )
+	{
+	case UV_DISASM_DATA_REG:
+		break;
+	case UV_DISASM_DATA_IMMS:
+	case UV_DISASM_DATA_IMMU:
+		writeValue<int32_t>(out, operand->m_immediate_size);
+		break;
+	case UV_DISASM_DATA_CONSTANT:
+		writeValue<uint32_t>(out, ((const UVDDisasmConstantOperandShared *)operand)->m_value);
+		break;
+	case UV_DISASM_DATA_FUNC:
+		uv_assert_ret(operand->m_func);
+		writeValue<uint32_t>(out, operand->m_func->m_args.size());
+		for( std::vector<UVDDisasmOperandShared *>::const_iterator iter = operand->m_func->m_args.begin();
+				iter != operand->m_func->m_args.end(); ++iter )
+		{
+			uv_assert_err_ret(writeOperand(out, *iter));
+		}
+		break;
+	default:
+		printf_error("unknown operand type: %d\n", operand->m_type);
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDDisasmOpcodeCache::writeInstruction(std::string &out, const UVDDisasmInstructionShared *instruction)
+{
+	uv_assert_ret(instruction);
+	const UVDBuiltinProgram &program = instruction->m_actionProgram;
+
+	writeString(out, instruction->m_memoric);
+	writeString(out, instruction->m_desc);
+	writeString(out, instruction->m_action);
+
+	writeValue<uint32_t>(out, instruction->m_opcode_length);
+	for( uint32_t i = 0; i < instruction->m_opcode_length; ++i )
+	{
+		writeValue<uint8_t>(out, instruction->m_opcode[i]);
+		writeValue<uint32_t>(out, instruction->m_opcodeRangeOffset[i]);
+		writeValue<uint32_t>(out, instruction->m_bitmask[i]);
+	}
+	writeValue<uint32_t>(out, instruction->m_total_length);
+	writeValue<uint32_t>(out, instruction->m_cpi);
+	writeValue<uint32_t>(out, instruction->m_cpi_low);
+	writeValue<uint32_t>(out, instruction->m_cpi_hi);
+	writeValue<uint8_t>(out, instruction->m_isJump);
+	writeValue<uint8_t>(out, instruction->m_isCall);
+	writeValue<uint8_t>(out, instruction->m_isReturn);
+	writeValue<uint8_t>(out, instruction->m_isConditional);
+	writeValue<uint32_t>(out, instruction->m_conditionalExtraInstructions);
+	writeValue<uint32_t>(out, instruction->m_config_line_syntax);
+	writeValue<uint32_t>(out, instruction->m_config_line_usage);
+	writeValue<uint32_t>(out, instruction->m_isImmediateOnlyFunction);
+
+	writeValue<uint32_t>(out, instruction->m_operands.size());
+	for( std::vector<UVDDisasmOperandShared *>::const_iterator iter = instruction->m_operands.begin();
+			iter != instruction->m_operands.end(); ++iter )
+	{
+		uv_assert_err_ret(writeOperand(out, *iter));
+	}
+
+	writeValue<uint8_t>(out, program.isCompiled());
+	if( program.isCompiled() )
+	{
+		writeString(out, program.m_sExpression);
+		writeValue<uint32_t>(out, program.m_code.size());
+		for( std::vector<UVDBuiltinInstruction>::const_iterator iter = program.m_code.begin(); iter != program.m_code.end(); ++iter )
+		{
+			writeValue<uint32_t>(out, (*iter).m_opcode);
+			writeValue<int64_t>(out, (*iter).m_operand);
+		}
+		writeValue<uint32_t>(out, program.m_variables.size());
+		for( std::vector<std::string>::const_iterator iter = program.m_variables.begin(); iter != program.m_variables.end(); ++iter )
+		{
+			writeString(out, *iter);
+		}
+		writeValue<uint32_t>(out, instruction->m_actionVariableOperands.size());
+		for( std::vector<int>::const_iterator iter = instruction->m_actionVariableOperands.begin();
+				iter != instruction->m_actionVariableOperands.end(); ++iter )
+		{
+			writeValue<int32_t>(out, *iter);
+		}
+	}
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDDisasmOpcodeCache::save(const UVDDisasmOpcodeLookupTable *table)
+{
+	std::string out;
+	//Everything after the header
+	std::string payload;
+	std::string tempFileName;
+
+	uv_assert_ret(table);
+	if( m_fileName.empty() )
+	{
+		return UV_ERR_OK;
+	}
+
+	writeValue<uint32_t>(payload, table->m_instructions.size());
+	for( std::vector<UVDDisasmInstructionShared *>::const_iterator iter = table->m_instructions.begin();
+			iter != table->m_instructions.end(); ++iter )
+	{
+		uv_assert_err_ret(writeInstruction(payload, *iter));
+	}
+
+	out.append(UVD_DISASM_OPCODE_CACHE_MAGIC, UVD_DISASM_OPCODE_CACHE_MAGIC_SIZE);
+	writeValue<uint32_t>(out, UVD_DISASM_OPCODE_CACHE_VERSION);
+	writeValue<uint32_t>(out, UVD_DISASM_OPCODE_CACHE_BYTE_ORDER);
+	writeValue<uint32_t>(out, m_language);
+	writeValue<uint64_t>(out, m_hash);
+	writeValue<uint64_t>(out, hash(payload.c_str(), payload.size()));
+	out.append(payload);
+
+	//Many instances may start at once, never let one see a partial file
+	tempFileName = UVDSprintf("%s.%d", m_fileName.c_str(), (int)getpid());
+	if( UV_FAILED(writeFile(tempFileName, out)) )
+	{
+		//Ex: read only install
+		printf_debug("could not write architecture cache %s\n", tempFileName.c_str());
+		return UV_ERR_OK;
+	}
+	if( rename(tempFileName.c_str(), m_fileName.c_str()) )
+	{
+		printf_debug("could not rename architecture cache %s\n", tempFileName.c_str());
+		unlink(tempFileName.c_str());
+		return UV_ERR_OK;
+	}
+	printf_debug("wrote architecture cache %s, %d instructions, %d bytes\n",
+			m_fileName.c_str(), table->m_instructions.size(), out.size());
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDDisasmOpcodeCache::readOperand(UVDDisasmOpcodeCacheReader &reader, UVDDisasmOperandShared **out)
+{
+	uint32_t type = 0;
+	std::string name;
+	UVDDisasmOperandShared *operand = NULL;
+
+	if( UV_FAILED(reader.readValue(&type)) || UV_FAILED(reader.readString(name)) )
+	{
+		return UV_ERR_GENERAL;
+	}
+
+	switch( type )
+	{
+	case UV_DISASM_DATA_REG:
+		operand = new UVDDisasmOperandShared();
+		break;
+	case UV_DISASM_DATA_IMMS:
+	case UV_DISASM_DATA_IMMU:
+	{
+		int32_t immediateSize = 0;
+
+		if( UV_FAILED(reader.readValue(&immediateSize)) )
+		{
+			return UV_ERR_GENERAL;
+		}
+		operand = new UVDDisasmOperandShared();
+		operand->m_immediate_size = immediateSize;
+		break;
+	}
+	case UV_DISASM_DATA_CONSTANT:
+	{
+		UVDDisasmConstantOperandShared *constantOperand = NULL;
+		uint32_t value = 0;
+
+		if( UV_FAILED(reader.readValue(&value)) )
+		{
+			return UV_ERR_GENERAL;
+		}
+		constantOperand = new UVDDisasmConstantOperandShared();
+		constantOperand->m_value = value;
+		operand = constantOperand;
+		break;
+	}
+	case UV_DISASM_DATA_FUNC:
+	{
+		uint32_t args = 0;
+
+		if( UV_FAILED(reader.readValue(&args)) )
+		{
+			return UV_ERR_GENERAL;
+		}
+		operand = new UVDDisasmOperandShared();
+		//Set type first so deinit() frees the function if an argument is bad
+		operand->m_type = type;
+		operand->m_func = new UVDDisasmFunctionShared();
+		for( uint32_t i = 0; i < args; ++i )
+		{
+			UVDDisasmOperandShared *arg = NULL;
+
+			if( UV_FAILED(readOperand(reader, &arg)) )
+			{
+				delete operand;
+				return UV_ERR_GENERAL;
+			}
+			operand->m_func->m_args.push_back(arg);
+		}
+		break;
+	}
+	default:
+		return UV_ERR_GENERAL;
+	}
+	uv_assert_ret(operand);
+	operand->m_type = type;
+	operand->m_name = name;
+
+	*out = operand;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDDisasmOpcodeCache::readInstruction(UVDDisasmOpcodeCacheReader &reader, UVDDisasmInstructionShared **out)
+{
+	UVDDisasmInstructionShared *instruction = NULL;
+	uint32_t operands = 0;
+	uint32_t isImmediateOnlyFunction = 0;
+	uvd_bool_t compiled = false;
+	uv_err_t rc = UV_ERR_GENERAL;
+
+	instruction = new UVDDisasmInstructionShared();
+	uv_assert_ret(instruction);
+
+	if( UV_FAILED(reader.readString(instruction->m_memoric))
+			|| UV_FAILED(reader.readString(instruction->m_desc))
+			|| UV_FAILED(reader.readString(instruction->m_action))
+			|| UV_FAILED(reader.readValue(&instruction->m_opcode_length))
+			|| instruction->m_opcode_length == 0 || instruction->m_opcode_length > MAX_OPCODE_SIZE )
+	{
+		goto error;
+	}
+	for( uint32_t i = 0; i < instruction->m_opcode_length; ++i )
+	{
+		if( UV_FAILED(reader.readValue(&instruction->m_opcode[i]))
+				|| UV_FAILED(reader.readValue(&instruction->m_opcodeRangeOffset[i]))
+				|| UV_FAILED(reader.readValue(&instruction->m_bitmask[i])) )
+		{
+			goto error;
+		}
+	}
+	if( UV_FAILED(reader.readValue(&instruction->m_total_length))
+			|| UV_FAILED(reader.readValue(&instruction->m_cpi))
+			|| UV_FAILED(reader.readValue(&instruction->m_cpi_low))
+			|| UV_FAILED(reader.readValue(&instruction->m_cpi_hi))
+			|| UV_FAILED(reader.readBool(&instruction->m_isJump))
+			|| UV_FAILED(reader.readBool(&instruction->m_isCall))
+			|| UV_FAILED(reader.readBool(&instruction->m_isReturn))
+			|| UV_FAILED(reader.readBool(&instruction->m_isConditional))
+			|| UV_FAILED(reader.readValue(&instruction->m_conditionalExtraInstructions))
+			|| UV_FAILED(reader.readValue(&instruction->m_config_line_syntax))
+			|| UV_FAILED(reader.readValue(&instruction->m_config_line_usage))
+			|| UV_FAILED(reader.readValue(&isImmediateOnlyFunction))
+			|| UV_FAILED(reader.readValue(&operands)) )
+	{
+		goto error;
+	}
+	instruction->m_isImmediateOnlyFunction = isImmediateOnlyFunction;
+
+	for( uint32_t i = 0; i < operands; ++i )
+	{
+		UVDDisasmOperandShared *operand = NULL;
+
+		if( UV_FAILED(readOperand(reader, &operand)) )
+		{
+			goto error;
+		}
+		instruction->m_operands.push_back(operand);
+	}
+
+	if( UV_FAILED(reader.readBool(&compiled)) )
+	{
+		goto error;
+	}
+	if( compiled )
+	{
+		UVDBuiltinProgram &program = instruction->m_actionProgram;
+		uint32_t count = 0;
+
+		if( UV_FAILED(reader.readString(program.m_sExpression))
+				|| UV_FAILED(reader.readValue(&count)) )
+		{
+			goto error;
+		}
+		for( uint32_t i = 0; i < count; ++i )
+		{
+			UVDBuiltinInstruction code;
+
+			if( UV_FAILED(reader.readValue(&code.m_opcode)) || UV_FAILED(reader.readValue(&code.m_operand)) )
+			{
+				goto error;
+			}
+			program.m_code.push_back(code);
+		}
+
+		if( UV_FAILED(reader.readValue(&count)) )
+		{
+			goto error;
+		}
+		for( uint32_t i = 0; i < count; ++i )
+		{
+			std::string variable;
+
+			if( UV_FAILED(reader.readString(variable)) )
+			{
+				goto error;
+			}
+			program.m_variables.push_back(variable);
+		}
+
+		if( UV_FAILED(reader.readValue(&count)) || count != program.m_variables.size() )
+		{
+			goto error;
+		}
+		for( uint32_t i = 0; i < count; ++i )
+		{
+			int32_t operandIndex = 0;
+
+			if( UV_FAILED(reader.readValue(&operandIndex))
+					|| (operandIndex != UVD_ACTION_VARIABLE_PC && (operandIndex < 0 || (uint32_t)operandIndex >= operands)) )
+			{
+				goto error;
+			}
+			instruction->m_actionVariableOperands.push_back(operandIndex);
+		}
+		program.m_compiled = true;
+	}
+
+	*out = instruction;
+	return UV_ERR_OK;
+
+error:
+	delete instruction;
+	return rc;
+}
+
+uv_err_t UVDDisasmOpcodeCache::readHeader(UVDDisasmOpcodeCacheReader &reader, uint32_t *instructionsOut)
+{
+	char magic[UVD_DISASM_OPCODE_CACHE_MAGIC_SIZE];
+	uint32_t version = 0;
+	uint32_t byteOrder = 0;
+	uint32_t language = 0;
+	uint64_t hash = 0;
+	uint64_t payloadHash = 0;
+
+	if( UV_FAILED(reader.read(magic, sizeof(magic)))
+			|| memcmp(magic, UVD_DISASM_OPCODE_CACHE_MAGIC, sizeof(magic))
+			|| UV_FAILED(reader.readValue(&version)) || version != UVD_DISASM_OPCODE_CACHE_VERSION
+			|| UV_FAILED(reader.readValue(&byteOrder)) || byteOrder != UVD_DISASM_OPCODE_CACHE_BYTE_ORDER
+			|| UV_FAILED(reader.readValue(&language)) || language != m_language
+			|| UV_FAILED(reader.readValue(&hash)) || hash != m_hash
+			|| UV_FAILED(reader.readValue(&payloadHash)) )
+	{
+		return UV_ERR_GENERAL;
+	}
+	//Otherwise a flipped byte could decode as a different, still well formed, instruction
+	if( payloadHash != UVDDisasmOpcodeCache::hash((const char *)reader.m_cur, reader.m_end - reader.m_cur) )
+	{
+		printf_debug("architecture cache %s doesn't match its checksum\n", m_fileName.c_str());
+		return UV_ERR_GENERAL;
+	}
+	if( UV_FAILED(reader.readValue(instructionsOut)) )
+	{
+		return UV_ERR_GENERAL;
+	}
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDDisasmOpcodeCache::load(UVDDisasmOpcodeLookupTable **out)
+{
+	UVDDisasmOpcodeLookupTable *table = NULL;
+	UVDData *data = NULL;
+	const uint8_t *buffer = NULL;
+	std::string copy;
+	uint32_t size = 0;
+	uint32_t instructionCount = 0;
+	std::vector<UVDDisasmInstructionShared *> instructions;
+	uv_err_t rc = UV_ERR_NOTFOUND;
+
+	uv_assert_ret(out);
+	if( m_fileName.empty() )
+	{
+		return UV_ERR_NOTFOUND;
+	}
+	//Missing is the normal first run case
+	if( UV_FAILED(UVDDataFile::getUVDDataFile(&data, m_fileName)) || !data )
+	{
+		printf_debug("no architecture cache %s\n", m_fileName.c_str());
+		return UV_ERR_NOTFOUND;
+	}
+	size = data->size();
+	buffer = data->getBuffer(0, size);
+	if( !buffer )
+	{
+		if( UV_FAILED(data->readDataAsString(0, size, copy)) )
+		{
+			delete data;
+			return UV_ERR_NOTFOUND;
+		}
+		buffer = (const uint8_t *)copy.c_str();
+	}
+
+	{
+		UVDDisasmOpcodeCacheReader reader(buffer, size);
+
+		if( UV_FAILED(readHeader(reader, &instructionCount)) )
+		{
+			printf_debug("stale architecture cache %s\n", m_fileName.c_str());
+			goto error;
+		}
+		for( uint32_t i = 0; i < instructionCount; ++i )
+		{
+			UVDDisasmInstructionShared *instruction = NULL;
+
+			if( UV_FAILED(readInstruction(reader, &instruction)) )
+			{
+				printf_debug("bad architecture cache %s, instruction %d\n", m_fileName.c_str(), i);
+				goto error;
+			}
+			instructions.push_back(instruction);
+		}
+		if( !reader.isEnd() )
+		{
+			printf_debug("bad architecture cache %s, trailing data\n", m_fileName.c_str());
+			goto error;
+		}
+	}
+
+	//A table of our own so a conflict partway through never leaves the caller a partial one
+	table = new UVDDisasmOpcodeLookupTable();
+	if( !table )
+	{
+		goto error;
+	}
+	for( std::vector<UVDDisasmInstructionShared *>::size_type i = 0; i < instructions.size(); ++i )
+	{
+		uv_err_t rcAdd = table->addInstruction(instructions[i]);
+
+		//Table owns it either way
+		instructions[i] = NULL;
+		if( UV_FAILED(rcAdd) )
+		{
+			printf_debug("bad architecture cache %s, instruction %d can't be added\n", m_fileName.c_str(), i);
+			goto error;
+		}
+	}
+	printf_debug("loaded architecture cache %s, %d instructions\n", m_fileName.c_str(), instructions.size());
+	*out = table;
+	table = NULL;
+	rc = UV_ERR_OK;
+
+error:
+	for( std::vector<UVDDisasmInstructionShared *>::iterator iter = instructions.begin(); iter != instructions.end(); ++iter )
+	{
+		delete *iter;
+	}
+	delete table;
+	delete data;
+	return rc;
+}
+
@@ -0,0 +1,77 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVDASM_OPCODE_CACHE_H
+#define UVDASM_OPCODE_CACHE_H
+
+#include <string>
+#include "uvd/util/types.h"
+
+/*
+Precompiled .OP section of an architecture file
+On small inputs startup is dominated by parsing the text form:
+splitting lines, UVDConfigValue::parseType(), matching SYNTAX against USAGE and compiling ACTIONs
+After a text parse the resulting instructions (operand templates and compiled ACTION programs included)
+are written out in a flat binary form
+Later runs map that and only have to rebuild the lookup tables
+
+Validated by a hash of the entire architecture file, the format version and the interpreter language
+The header also holds a hash of everything after it, so damage to the cache itself is caught too
+Anything wrong with the cache file just means we parse the text and rewrite it
+*/
+
+#define UVD_DISASM_OPCODE_CACHE_MAGIC			"UVDOPC\0"
+#define UVD_DISASM_OPCODE_CACHE_MAGIC_SIZE		8
+//Bump whenever the format or anything saved changes meaning
+#define UVD_DISASM_OPCODE_CACHE_VERSION			2
+//Cache file name is the architecture file name plus this
+#define UVD_DISASM_OPCODE_CACHE_EXTENSION		".cache"
+//Under ~/.uvudec when no --arch-cache dir is given
+#define UVD_DISASM_OPCODE_CACHE_USER_DIR		"/cache"
+
+class UVDDisasmInstructionShared;
+class UVDDisasmOperandShared;
+class UVDDisasmOpcodeLookupTable;
+class UVDDisasmOpcodeCacheReader;
+class UVDDisasmOpcodeCache
+{
+public:
+	UVDDisasmOpcodeCache();
+	~UVDDisasmOpcodeCache();
+	//architectureFileData is the content of architectureFileName
+	uv_err_t init(const std::string &architectureFileName, const std::string &architectureFileData);
+
+	/*
+	A new table holding the cached instructions
+	Returns UV_ERR_NOTFOUND if disabled, missing, stale or bad in any way, nothing is returned in that case
+	*/
+	uv_err_t load(UVDDisasmOpcodeLookupTable **out);
+	//Save table's instructions, table should have just been parsed from the architecture file
+	uv_err_t save(const UVDDisasmOpcodeLookupTable *table);
+
+	//FNV-1a
+	static uint64_t hash(const char *data, uint32_t size);
+	//~/.uvudec/cache, created if needed
+	//Returns UV_ERR_NOTFOUND if there is no home dir or it can't be created
+	static uv_err_t getDefaultDir(std::string &out);
+
+protected:
+	uv_err_t writeInstruction(std::string &out, const UVDDisasmInstructionShared *instruction);
+	uv_err_t writeOperand(std::string &out, const UVDDisasmOperandShared *operand);
+	uv_err_t readInstruction(UVDDisasmOpcodeCacheReader &reader, UVDDisasmInstructionShared **out);
+	uv_err_t readOperand(UVDDisasmOpcodeCacheReader &reader, UVDDisasmOperandShared **out);
+	uv_err_t readHeader(UVDDisasmOpcodeCacheReader &reader, uint32_t *instructionsOut);
+
+public:
+	//Empty if caching is disabled
+	std::string m_fileName;
+	uint64_t m_hash;
+	//ACTIONs are only precompiled for the builtin interpreter
+	uint32_t m_language;
+};
+
+#endif
+
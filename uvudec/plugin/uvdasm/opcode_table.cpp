@@ -22,7 +22,8 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 UVDDisasmOpcodeLookupTable::UVDDisasmOpcodeLookupTable()
 {
 	memset(m_lookupTable, 0, sizeof(m_lookupTable));
-	memset(m_lookupTable, 0, sizeof(m_lookupTableHits));
+	memset(m_subTables, 0, sizeof(m_subTables));
+	memset(m_lookupTableHits, 0, sizeof(m_lookupTableHits));
 }
 
 UVDDisasmOpcodeLookupTable::~UVDDisasmOpcodeLookupTable()
@@ -45,7 +46,7 @@ uv_err_t UVDDisasmOpcodeLookupTable::registerOpcode(unsigned char opcode, UVDDis
 }
 
 /*
-TODO: branch to sub tables
+Sub tables aren't broken down, only counted as used
 */
 void UVDDisasmOpcodeLookupTable::usageStats(void)
 {
@@ -55,7 +56,7 @@ void UVDDisasmOpcodeLookupTable::usageStats(void)
 	
 	for( i = 0; i < 256; ++i )
 	{
-		if( m_lookupTable[i] )
+		if( m_lookupTable[i] || m_subTables[i] )
 		{
 			++used;
 		}
@@ -81,6 +82,10 @@ void UVDDisasmOpcodeLookupTable::usedStats(void)
 		{
 			sOp = m_lookupTable[i]->getHumanReadableUsage();
 		}
+		else if( m_subTables[i] )
+		{
+			sOp = "prefix";
+		}
 		
 		printf_debug("hits[0x%.2X] (%s): %d\n", i, sOp.c_str(), m_lookupTableHits[i]);
 		if( m_lookupTableHits[i] )
@@ -318,7 +323,6 @@ uv_err_t UVDDisasmOpcodeLookupTable::uvd_parse_usage(UVDDisasmInstructionShared
 	{
 		const std::string &cur = usageParts[curUsagePart];
 		/* Iterate over the fields already setup by usage */
-		UVDDisasmOperandShared *op_shared = NULL;
 		UVDConfigValue parsed_type;
 
 		printf_debug("Current operand: %s\n", cur.c_str());
@@ -340,60 +344,78 @@ uv_err_t UVDDisasmOpcodeLookupTable::uvd_parse_usage(UVDDisasmInstructionShared
 			continue;
 		}
 		
-		/*
-		Find the syntax field that matches parsed_type from the list of
-		syntax fields in inst_shared and place it in op_shared
-		*/
-		if( UV_FAILED(uvd_match_syntax_usage(inst_shared, &parsed_type, &op_shared)) )
-		{
-			printf_error("can't match syntax and usage for syntax line %d, usage line %d\n",
-					inst_shared->m_config_line_syntax, inst_shared->m_config_line_usage);
-			return UV_DEBUG(UV_ERR_GENERAL);
-		}
-		
-		if( !op_shared )
-		{
-			printf_debug("Could not match up SHARED and USAGE fields\n");
-			return UV_DEBUG(UV_ERR_GENERAL);
-		}
-		if( op_shared->m_type != parsed_type.m_operand_type )
-		{
-			printf_debug("USAGE/SYNTAX type mismatch\n");
-			printf_debug("shared: %s=%s(%d), parsed: %s=%s(%d)\n", op_shared->m_name.c_str(), uvd_data_str(op_shared->m_type), op_shared->m_type, 
-					parsed_type.m_name.c_str(), uvd_data_str(parsed_type.m_operand_type), parsed_type.m_operand_type);
-			return UV_DEBUG(UV_ERR_GENERAL);
-		}
+		uv_assert_err_ret(uvd_parse_usage_operand(inst_shared, &parsed_type));
+	}
 		
-		if( parsed_type.m_operand_type == UV_DISASM_DATA_IMMS
-			|| parsed_type.m_operand_type == UV_DISASM_DATA_IMMU )
-		{
-			/* It is possible that DPTR may cause a few 16 bit immediates, but syntax does not yet support that */
-			if( op_shared->m_immediate_size != parsed_type.m_num_bits )
-			{
-				printf_error("USAGE/SYNTAX size mismatch\n");
-				return UV_DEBUG(UV_ERR_GENERAL);
-			}
-			inst_shared->m_total_length += op_shared->m_immediate_size / 8;
-		}
-		else if( parsed_type.m_operand_type == UV_DISASM_DATA_REG )
-		{
-			/* Mayber later some sort of Intel /r thing */
-			printf_error("No registers during usage\n");
-			return UV_DEBUG(UV_ERR_GENERAL);
-		}
-		else if( parsed_type.m_operand_type == UV_DISASM_DATA_FUNC )
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDDisasmOpcodeLookupTable::uvd_parse_usage_operand(UVDDisasmInstructionShared *inst_shared, UVDConfigValue *parsed_type)
+{
+	UVDDisasmOperandShared *op_shared = NULL;
+
+	uv_assert_ret(parsed_type);
+	/*
+	A modifier only says how the syntax presents its arguments, ex: USAGE=0x85,RAM_INT(u8_0)
+	The binary is just the arguments
+	*/
+	if( parsed_type->m_operand_type == UV_DISASM_DATA_FUNC )
+	{
+		uv_assert_ret(parsed_type->m_func);
+		for( std::vector<UVDConfigValue *>::size_type i = 0; i < parsed_type->m_func->m_args.size(); ++i )
 		{
-			/* Likely this will involve a fork onto the linked list */
-			printf_error("Special modifier, not yet supported\n");
-			return UV_DEBUG(UV_ERR_GENERAL);
+			uv_assert_err_ret(uvd_parse_usage_operand(inst_shared, parsed_type->m_func->m_args[i]));
 		}
-		else
+		return UV_ERR_OK;
+	}
+
+	/*
+	Find the syntax field that matches parsed_type from the list of
+	syntax fields in inst_shared and place it in op_shared
+	*/
+	if( UV_FAILED(uvd_match_syntax_usage(inst_shared, parsed_type, &op_shared)) )
+	{
+		printf_error("can't match syntax and usage for syntax line %d, usage line %d\n",
+				inst_shared->m_config_line_syntax, inst_shared->m_config_line_usage);
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	
+	if( !op_shared )
+	{
+		printf_debug("Could not match up SHARED and USAGE fields\n");
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	if( op_shared->m_type != parsed_type->m_operand_type )
+	{
+		printf_debug("USAGE/SYNTAX type mismatch\n");
+		printf_debug("shared: %s=%s(%d), parsed: %s=%s(%d)\n", op_shared->m_name.c_str(), uvd_data_str(op_shared->m_type), op_shared->m_type, 
+				parsed_type->m_name.c_str(), uvd_data_str(parsed_type->m_operand_type), parsed_type->m_operand_type);
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	
+	if( parsed_type->m_operand_type == UV_DISASM_DATA_IMMS
+		|| parsed_type->m_operand_type == UV_DISASM_DATA_IMMU )
+	{
+		/* It is possible that DPTR may cause a few 16 bit immediates, but syntax does not yet support that */
+		if( op_shared->m_immediate_size != parsed_type->m_num_bits )
 		{
-			printf_error("Unknown operand type\n");
+			printf_error("USAGE/SYNTAX size mismatch\n");
 			return UV_DEBUG(UV_ERR_GENERAL);
 		}
+		inst_shared->m_total_length += op_shared->m_immediate_size / 8;
 	}
-		
+	else if( parsed_type->m_operand_type == UV_DISASM_DATA_REG )
+	{
+		/* Mayber later some sort of Intel /r thing */
+		printf_error("No registers during usage\n");
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	else
+	{
+		printf_error("Unknown operand type\n");
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+
 	return UV_ERR_OK;
 }
 
@@ -582,6 +604,11 @@ uv_err_t UVDDisasmOpcodeLookupTable::init_opcode(UVDConfigSection *op_section)
 		}
 		
 		inst_shared->m_action = value_action;
+		//CONDITION=Y marks branches that may fall through
+		if( !conditionLine.m_value.empty() && conditionLine.m_value != "N" )
+		{
+			inst_shared->m_isConditional = true;
+		}
 
 		printf_debug("Storing processed\n");
 		/*
@@ -593,33 +620,78 @@ uv_err_t UVDDisasmOpcodeLookupTable::init_opcode(UVDConfigSection *op_section)
 		//Compute some things to help speed up analysis and know the nature of this instruction
 		uv_assert_err_ret(inst_shared->analyzeAction());
 		
-		//Check for a repeated/conflicting opcode
-		printf_debug("table size: 0x%.8X\n", sizeof(m_lookupTable));
-		std::set<uint8_t> opcodes;
-		uv_assert_err_ret(inst_shared->getOpcodes(opcodes));
-		for( std::set<uint8_t>::iterator iter = opcodes.begin(); iter != opcodes.end(); ++iter )
-		{
-			uint8_t primary_opcode = 0;
-			
-			primary_opcode = *iter;
-			printf_debug("Primary opcode: 0x%.2X\n", primary_opcode);
+		uv_assert_err_ret(addInstruction(inst_shared));
+	}
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDDisasmOpcodeLookupTable::addInstruction(UVDDisasmInstructionShared *inst_shared)
+{
+	uv_assert_ret(inst_shared);
+	//We own it from here, even if it can't be stored
+	m_instructions.push_back(inst_shared);
+	uv_assert_err_ret(registerOpcodes(inst_shared, 0));
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDDisasmOpcodeLookupTable::registerOpcodes(UVDDisasmInstructionShared *inst_shared, uint32_t position)
+{
+	std::set<uint8_t> opcodes;
+	bool last = false;
+
+	uv_assert_ret(inst_shared);
+	last = position + 1 == inst_shared->m_opcode_length;
+	//Check for a repeated/conflicting opcode
+	uv_assert_err_ret(inst_shared->getOpcodes(position, opcodes));
+	for( std::set<uint8_t>::iterator iter = opcodes.begin(); iter != opcodes.end(); ++iter )
+	{
+		uint8_t opcode = *iter;
 		
-			if( m_lookupTable[primary_opcode] )
+		printf_debug("Opcode byte %d: 0x%.2X\n", position, opcode);
+		/*
+		An opcode can't both be an instruction and the start of longer ones
+		Ex: the old game_boy.op 0xCB "PREFIX" instruction with real 0xCB page instructions
+		*/
+		if( m_lookupTable[opcode] || (last && m_subTables[opcode]) )
+		{
+			if( g_error_opcode_repeat )
 			{
-				if( g_error_opcode_repeat )
+				printf_error("Duplicate opcode: 0x%.2X (byte %d)\n", opcode, position);
+				if( m_lookupTable[opcode] )
 				{
-					UVDDisasmInstructionShared *old = m_lookupTable[primary_opcode];
+					UVDDisasmInstructionShared *old = m_lookupTable[opcode];
 					
-					printf_error("Duplicate opcode: 0x%.2X\n", primary_opcode);
 					printf_error("old: %s/%s\n", old->m_memoric.c_str(), old->m_desc.c_str());
-					printf_error("new: %s\n", inst_shared->m_memoric.c_str(), inst_shared->m_desc.c_str());
-					return UV_DEBUG(UV_ERR_GENERAL);
 				}
+				else
+				{
+					printf_error("old: prefix of longer opcodes\n");
+				}
+				printf_error("new: %s/%s\n", inst_shared->m_memoric.c_str(), inst_shared->m_desc.c_str());
+				return UV_DEBUG(UV_ERR_GENERAL);
 			}
+			//Last one wins, as the flat table did
+			if( m_subTables[opcode] )
+			{
+				delete m_subTables[opcode];
+				m_subTables[opcode] = NULL;
+			}
+			m_lookupTable[opcode] = NULL;
+		}
 
-			printf_debug("Doing actual store of opcode 0x%02X\n", primary_opcode);
-			m_lookupTable[primary_opcode] = inst_shared;
-			printf_debug("Stored processed\n");
+		if( last )
+		{
+			printf_debug("Doing actual store of opcode 0x%02X\n", opcode);
+			m_lookupTable[opcode] = inst_shared;
+		}
+		else
+		{
+			if( !m_subTables[opcode] )
+			{
+				m_subTables[opcode] = new UVDDisasmOpcodeLookupTable();
+				uv_assert_ret(m_subTables[opcode]);
+			}
+			uv_assert_err_ret(m_subTables[opcode]->registerOpcodes(inst_shared, position + 1));
 		}
 	}
 	return UV_ERR_OK;
@@ -648,11 +720,18 @@ error:
 
 uv_err_t UVDDisasmOpcodeLookupTable::deinit(void)
 {
+	//Tables only reference instructions, the root owns them
 	for( unsigned i = 0; i < sizeof(m_lookupTable) / sizeof(m_lookupTable[0]); ++i )
 	{
-		delete m_lookupTable[i];
 		m_lookupTable[i] = NULL; 
+		delete m_subTables[i];
+		m_subTables[i] = NULL;
+	}
+	for( std::vector<UVDDisasmInstructionShared *>::iterator iter = m_instructions.begin(); iter != m_instructions.end(); ++iter )
+	{
+		delete *iter;
 	}
+	m_instructions.clear();
 	return UV_ERR_OK;
 }
 
@@ -664,7 +743,8 @@ uv_err_t UVDDisasmOpcodeLookupTable::getElement(unsigned int index, UVDDisasmIns
 	uv_assert(index < 0x100);
 
 	*element = m_lookupTable[index];
-	++m_lookupTableHits[index];
+	//Table may be shared by engines on other threads
+	__sync_fetch_and_add(&m_lookupTableHits[index], 1);
 
 	rc = UV_ERR_OK;
 
@@ -672,6 +752,20 @@ error:
 	return UV_DEBUG(rc);
 }
 
+uv_err_t UVDDisasmOpcodeLookupTable::getElement(unsigned int index, UVDDisasmInstructionShared **element, UVDDisasmOpcodeLookupTable **subTable)
+{
+	uv_assert_ret(element);
+	uv_assert_ret(subTable);
+	uv_assert_ret(index < 0x100);
+
+	*element = m_lookupTable[index];
+	*subTable = m_subTables[index];
+	//Table may be shared by engines on other threads
+	__sync_fetch_and_add(&m_lookupTableHits[index], 1);
+
+	return UV_ERR_OK;
+}
+
 /* Used for opcode processing funcs */
 //static uvd_func opcode_map[256];
 /* on 8051, its a fairly starightforward map from numbers to opcode descriptions */
@@ -682,3 +776,63 @@ int g_error_opcode_repeat = 1;
 /**********************
 End init related
 **********************/
+
+/*
+UVDDisasmOpcodeTables
+*/
+
+UVDDisasmOpcodeTables g_disasmOpcodeTables;
+
+UVDDisasmOpcodeTables::UVDDisasmOpcodeTables()
+{
+	pthread_mutex_init(&m_mutex, NULL);
+}
+
+UVDDisasmOpcodeTables::~UVDDisasmOpcodeTables()
+{
+	UV_DEBUG(deinit());
+	pthread_mutex_destroy(&m_mutex);
+}
+
+uv_err_t UVDDisasmOpcodeTables::deinit()
+{
+	for( std::map<std::string, UVDDisasmOpcodeLookupTable *>::iterator iter = m_tables.begin(); iter != m_tables.end(); ++iter )
+	{
+		delete (*iter).second;
+	}
+	m_tables.clear();
+	
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDDisasmOpcodeTables::get(const std::string &key, UVDDisasmOpcodeLookupTable **out)
+{
+	std::map<std::string, UVDDisasmOpcodeLookupTable *>::iterator iter;
+	
+	uv_assert_ret(out);
+	iter = m_tables.find(key);
+	if( iter == m_tables.end() )
+	{
+		return UV_ERR_NOTFOUND;
+	}
+	*out = (*iter).second;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDDisasmOpcodeTables::add(const std::string &key, UVDDisasmOpcodeLookupTable *table)
+{
+	uv_assert_ret(table);
+	uv_assert_ret(m_tables.find(key) == m_tables.end());
+	m_tables[key] = table;
+	return UV_ERR_OK;
+}
+
+void UVDDisasmOpcodeTables::lock()
+{
+	pthread_mutex_lock(&m_mutex);
+}
+
+void UVDDisasmOpcodeTables::unlock()
+{
+	pthread_mutex_unlock(&m_mutex);
+}
@@ -11,11 +11,17 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvdasm/interpreter.h"
 #include "uvd/util/types.h"
 
+#include <map>
+#include <pthread.h>
 #include <string>
 
 /*
 Byte based lookup table
 Should be ultimatly loaded from an opcode file
+
+Multi byte opcodes (ex: the Game Boy 0xCB page) branch to a sub table keyed on the next opcode byte
+Ranges and bitmasks (ex: 0x11/0x1F for all 8051 ACALL pages) are expanded into every byte they match at load
+So decoding is one indexed load per opcode byte regardless of how the .op file describes them
 */
 
 class UVDConfigSection;
@@ -86,21 +92,69 @@ public:
 	-Figure out how long the entire instruction is so the next instruction class can be deciphered
 	*/
 	uv_err_t uvd_parse_usage(UVDDisasmInstructionShared *inst_shared, const std::string value_usage);
+	//A non-opcode USAGE part, function arguments are treated as if they were listed directly
+	uv_err_t uvd_parse_usage_operand(UVDDisasmInstructionShared *inst_shared, UVDConfigValue *parsed_type);
 
 	uv_err_t init(UVDConfigSection *op_section);
 	uv_err_t deinit(void);
 	uv_err_t init_opcode(UVDConfigSection *op_section);
 	uv_err_t getElement(unsigned int index, UVDDisasmInstructionShared **element);
-	
+	/*
+	If index is only the start of longer opcodes, element is NULL and subTable is where to look up the next byte
+	Otherwise subTable is NULL
+	*/
+	uv_err_t getElement(unsigned int index, UVDDisasmInstructionShared **element, UVDDisasmOpcodeLookupTable **subTable);
+	//Take ownership of a fully parsed instruction and make it decodable
+	uv_err_t addInstruction(UVDDisasmInstructionShared *inst_shared);
+
+protected:
+	//Store inst_shared under all of its opcode bytes from position on, starting at this table
+	uv_err_t registerOpcodes(UVDDisasmInstructionShared *inst_shared, uint32_t position);
 	
 public:
 	//Change this to a map?
 	UVDDisasmInstructionShared *m_lookupTable[0x100];
+	//Tables for the next opcode byte, we own these
+	UVDDisasmOpcodeLookupTable *m_subTables[0x100];
 	unsigned int m_lookupTableHits[0x100];
+	/*
+	Instructions loaded into this (root) table, we own these
+	A range or bitmask stores the same instruction under many opcodes
+	*/
+	std::vector<UVDDisasmInstructionShared *> m_instructions;
 
 	UVDConfigExpressionInterpreter *m_interpreter;
 };
 
+/*
+Opcode tables already loaded in this process, keyed by architecture file
+Lets a batch of engines on the same architecture load .OP once instead of once per engine
+Tables are not modified after being added (hit counters aside) and live until the plugin is unloaded
+Engines may initialize on different threads, so get() and add() must be called between lock() and unlock()
+Holding it across a miss through add() means a table is only ever parsed once
+*/
+class UVDDisasmOpcodeTables
+{
+public:
+	UVDDisasmOpcodeTables();
+	~UVDDisasmOpcodeTables();
+	//Free all tables, nothing may still be using them
+	uv_err_t deinit();
+
+	//UV_ERR_NOTFOUND if key hasn't been added
+	uv_err_t get(const std::string &key, UVDDisasmOpcodeLookupTable **out);
+	//Takes ownership of table
+	uv_err_t add(const std::string &key, UVDDisasmOpcodeLookupTable *table);
+	void lock();
+	void unlock();
+
+public:
+	std::map<std::string, UVDDisasmOpcodeLookupTable *> m_tables;
+	pthread_mutex_t m_mutex;
+};
+
+extern UVDDisasmOpcodeTables g_disasmOpcodeTables;
+
 extern int g_error_opcode_repeat;
 
 #endif
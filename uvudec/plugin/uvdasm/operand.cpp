@@ -78,7 +78,7 @@ uv_err_t UVDDisasmOperandShared::deinit()
 	return UV_ERR_OK;
 }
 
-uv_err_t UVDDisasmOperandShared::parseOperand(UVDASInstructionIterator *uvdIter, UVDDisasmOperand **out)
+uv_err_t UVDDisasmOperandShared::parseOperand(UVDASInstructionIterator *uvdIter, UVDDisasmInstruction *instruction, UVDDisasmOperand **out)
 {
 	//TOOD: migrate code and replace with below
 	//Assume someone forgot to implement it
@@ -86,12 +86,11 @@ uv_err_t UVDDisasmOperandShared::parseOperand(UVDASInstructionIterator *uvdIter,
 	//In the meantime, use the old in place handler
 	UVDDisasmOperand *op = NULL;
 	
-	op = new UVDDisasmOperand();
-	uv_assert_ret(op);
+	uv_assert_ret(instruction);
+	uv_assert_err_ret(instruction->allocateOperand(this, &op));
 	*out = op;
-	op->m_shared = this;
 	//Direct pass, be mindful of UV_ERR_DONE and such
-	return UV_DEBUG(op->parseOperand(uvdIter));
+	return UV_DEBUG(op->parseOperand(uvdIter, instruction));
 }
 
 uv_err_t UVDDisasmOperandShared::uvd_parsed2opshared(const UVDConfigValue *parsed_type, UVDDisasmOperandShared **op_shared_in)
@@ -184,6 +183,29 @@ error:
 	return UV_DEBUG(rc);
 }
 
+std::string UVDDisasmOperandShared::getVariableName()
+{
+	switch( m_type )
+	{
+	case UV_DISASM_DATA_IMMS:
+	case UV_DISASM_DATA_IMMU:
+		return m_name;
+	case UV_DISASM_DATA_FUNC:
+		for( std::vector<UVDDisasmOperandShared *>::iterator iter = m_func->m_args.begin(); iter != m_func->m_args.end(); ++iter )
+		{
+			std::string name = (*iter)->getVariableName();
+
+			if( !name.empty() )
+			{
+				return name;
+			}
+		}
+		return "";
+	default:
+		return "";
+	}
+}
+
 /*
 uv_err_t UVDDisasmOperandShared::getImmediateSize(uint32_t *immediateSizeOut)
 {
@@ -204,14 +226,13 @@ UVDDisasmConstantOperandShared::~UVDDisasmConstantOperandShared()
 {
 }
 
-uv_err_t UVDDisasmConstantOperandShared::parseOperand(UVDASInstructionIterator *uvdIter, UVDDisasmOperand **out)
+uv_err_t UVDDisasmConstantOperandShared::parseOperand(UVDASInstructionIterator *, UVDDisasmInstruction *instruction, UVDDisasmOperand **out)
 {
 	//Like register, nothing to parse: this operand is implied
-	UVDDisasmConstantOperand *op = NULL;
+	UVDDisasmOperand *op = NULL;
 	
-	op = new UVDDisasmConstantOperand();
-	uv_assert_ret(op);
-	op->m_shared = this;
+	uv_assert_ret(instruction);
+	uv_assert_err_ret(instruction->allocateOperand(this, &op));
 	*out = op;
 
 	return UV_ERR_OK;
@@ -223,6 +244,7 @@ UVDDisasmOperand
 
 UVDDisasmOperand::UVDDisasmOperand()
 {
+	m_instruction = NULL;
 	m_extra = NULL;	
 }
 
@@ -238,20 +260,9 @@ uv_err_t UVDDisasmOperand::init()
 
 uv_err_t UVDDisasmOperand::deinit()
 {
-	//printf("this UVDOperand under deinit: 0x%08X\n", (int)this);
-	fflush(stdout);
-	//FIXME: a test
+	//m_func is one of the instruction's slots, not ours to free
 	m_shared = NULL;
-	if( m_shared )
-	{
-		switch( getShared()->m_type )
-		{
-		case UV_DISASM_DATA_FUNC:
-			delete m_func;
-			m_func = NULL;
-			break;
-		}
-	}
+	m_extra = NULL;
 	return UV_ERR_OK;
 }
 
@@ -260,7 +271,7 @@ UVDDisasmOperandShared *UVDDisasmOperand::getShared()
 	return (UVDDisasmOperandShared *)m_shared;
 }
 
-uv_err_t UVDDisasmOperand::parseOperand(UVDASInstructionIterator *uvdIter)
+uv_err_t UVDDisasmOperand::parseOperand(UVDASInstructionIterator *uvdIter, UVDDisasmInstruction *instruction)
 {
 	//UVDDisasmInstruction *inst = NULL;
 	UVDDisasmOperandShared *operandShared = (UVDDisasmOperandShared *)m_shared;
@@ -347,15 +358,14 @@ uv_err_t UVDDisasmOperand::parseOperand(UVDASInstructionIterator *uvdIter)
 	{
 		printf_debug("Func\n");
 
-		m_func = new UVDDisasmFunction();
-		if( !m_func )
+		if( UV_FAILED(instruction->allocateFunction(&m_func)) )
 		{
 			UV_ERR(rc);
 			goto error;
 		}
 		printf_debug("Function/modifier: %s\n", operandShared->m_name.c_str());
 		//uv_assert_err_ret(inst);
-		if( UV_FAILED(UVDDisasmInstruction::parseOperands(uvdIter, operandShared->m_func->m_args, m_func->m_args)) )
+		if( UV_FAILED(UVDDisasmInstruction::parseOperands(uvdIter, instruction, operandShared->m_func->m_args, m_func->m_args)) )
 		{
 			UV_ERR(rc);
 			goto error;
@@ -459,14 +469,76 @@ uv_err_t UVDDisasmOperand::getVariable(std::string &name, UVDVarient &value)
 	return UV_ERR_OK;
 }
 
+uv_err_t UVDDisasmOperand::getVariableValue(int64_t *value)
+{
+	uv_assert_ret(getShared());
+	uv_assert_ret(value);
+
+	switch( getShared()->m_type )
+	{
+	case UV_DISASM_DATA_IMMS:
+		switch( getShared()->m_immediate_size )
+		{
+		case 8:
+			*value = m_i8;
+			break;
+		case 16:
+			*value = m_i16;
+			break;
+		case 32:
+			*value = m_i32;
+			break;
+		default:
+			return UV_DEBUG(UV_ERR_GENERAL);
+		}
+		break;
+	case UV_DISASM_DATA_IMMU:
+		switch( getShared()->m_immediate_size )
+		{
+		case 8:
+			*value = m_ui8;
+			break;
+		case 16:
+			*value = m_ui16;
+			break;
+		case 32:
+			*value = m_ui32;
+			break;
+		default:
+			return UV_DEBUG(UV_ERR_GENERAL);
+		}
+		break;
+	case UV_DISASM_DATA_FUNC:
+		//Same search as getVariable()
+		for( std::vector<UVDOperand *>::iterator iter = m_func->m_args.begin(); iter != m_func->m_args.end(); ++iter )
+		{
+			UVDDisasmOperand *operand = (UVDDisasmOperand *)*iter;
+			
+			if( !operand->getShared()->getVariableName().empty() )
+			{
+				return UV_DEBUG(operand->getVariableValue(value));
+			}
+		}
+		return UV_DEBUG(UV_ERR_GENERAL);
+	default:
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+
+	return UV_ERR_OK;
+}
+
 int g_fail_no_sym = 1;
 
 uv_err_t UVDDisasmOperand::printDisassemblyOperand(std::string &out)
 {
 	uv_err_t rc = UV_ERR_GENERAL;
 	UVDDisasmArchitecture *architecture = NULL;
+	UVD *uvd = NULL;
  	
- 	architecture = (UVDDisasmArchitecture *)g_uvd->m_runtime->m_architecture;
+	uv_assert_ret(m_instruction);
+	uvd = m_instruction->m_uvd;
+	uv_assert_ret(uvd);
+ 	architecture = (UVDDisasmArchitecture *)uvd->m_runtime->m_architecture;
 //printf("printing operand\n");
 
 	//uv_assert(buff);
@@ -486,6 +558,13 @@ uv_err_t UVDDisasmOperand::printDisassemblyOperand(std::string &out)
 		out += getShared()->m_name;
 		break;
 	}
+	case UV_DISASM_DATA_CONSTANT:
+	{
+		//Eh we should figure out a way to make this cleaner
+		//Maybe give a size or base hint?
+		out += UVDSprintf("0x%X", ((UVDDisasmConstantOperandShared *)getShared())->m_value);
+		break;
+	}
 	case UV_DISASM_DATA_IMMS:
 	case UV_DISASM_DATA_IMMU:
 	{
@@ -598,10 +677,8 @@ uv_err_t UVDDisasmOperand::printDisassemblyOperand(std::string &out)
 		printf_debug("Print func\n");
 		printf_debug("Print func, args: %d, func: %s\n", m_func->m_args.size(), functionName.c_str());
 		
-		//FIXME: global UVD ref
-		uv_assert_ret(g_uvd);
-		uv_assert_ret(g_uvd->m_runtime->m_architecture);
-		architecture = (UVDDisasmArchitecture *)g_uvd->m_runtime->m_architecture;
+		uv_assert_ret(uvd->m_runtime->m_architecture);
+		architecture = (UVDDisasmArchitecture *)uvd->m_runtime->m_architecture;
 		uv_assert_ret(architecture->m_symMap);
 		if( UV_SUCCEEDED(architecture->m_symMap->getSym(functionName, &sym_value)) )
 		{
@@ -677,7 +754,7 @@ uv_err_t UVDDisasmOperand::printDisassemblyOperand(std::string &out)
 						//XXX we are acess m_ui32, is this an x86 specific thing we should be careful of?
 						//printf_debug("imm prefix hex: <%s>, ui32: %d, %X\n", g_config->m_asm_imm_prefix_hex.c_str(), memArg->m_ui32, memArg->m_ui32);
 						//FIXME: if this is a relative address, we need to compute the correct virtual address
-						uv_assert_err_ret(g_uvd->m_format->formatAddress(memArg->m_ui32, formattedAddress));
+						uv_assert_err_ret(uvd->m_format->formatAddress(memArg->m_ui32, formattedAddress));
 						out += g_asmConfig->m_asm_imm_prefix_hex;
 						out += formattedAddress;
 
@@ -880,32 +957,6 @@ uv_err_t UVDDisasmOperand::getI32Representation(int32_t &i)
 	return UV_ERR_OK;
 }
 
-/*
-UVDDisasmConstantOperand
-*/
-
-UVDDisasmConstantOperand::UVDDisasmConstantOperand()
-{
-}
-
-UVDDisasmConstantOperand::~UVDDisasmConstantOperand()
-{
-}
-
-UVDDisasmConstantOperandShared *UVDDisasmConstantOperand::getShared()
-{
-	return (UVDDisasmConstantOperandShared *)m_shared;
-}
-
-uv_err_t UVDDisasmConstantOperand::printDisassemblyOperand(std::string &out)
-{
-	//Eh we should figure out a way to make this cleaner
-	//Maybe give a size or base hint?
-	out += UVDSprintf("0x%X", getShared()->m_value);
-
-	return UV_ERR_OK;
-}
-
 /*
 uv_err_t UVDDisasmOperand::setInstruction(UVDInstruction *instruction)
 {
@@ -11,6 +11,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvd/core/std_iterator.h"
 #include "uvdasm/function.h"
 
+class UVDDisasmInstruction;
 class UVDDisasmOperandShared : public UVDOperandShared
 {
 public:
@@ -18,13 +19,17 @@ public:
 	~UVDDisasmOperandShared();
 	uv_err_t deinit();
 
-	virtual uv_err_t parseOperand(UVDASInstructionIterator *uvdIter, UVDDisasmOperand **out);
+	//The operand is allocated from instruction
+	virtual uv_err_t parseOperand(UVDASInstructionIterator *uvdIter, UVDDisasmInstruction *instruction, UVDDisasmOperand **out);
 
 	//Returns error if it isn't an immediate
 	//uv_err_t getImmediateSize(uint32_t *immediateSizeOut);
 
 	static uv_err_t uvd_parsed2opshared(const UVDConfigValue *parsed_type, UVDDisasmOperandShared **op_shared_in);
 
+	//Name UVDDisasmOperand::getVariable() would return for operands of this type, empty if none
+	std::string getVariableName();
+
 public:
 	/*
 	Register, memory, immediate
@@ -76,7 +81,7 @@ public:
 	UVDDisasmConstantOperandShared();
 	~UVDDisasmConstantOperandShared();
 		
-	virtual uv_err_t parseOperand(UVDASInstructionIterator *uvdIter, UVDDisasmOperand **out);
+	virtual uv_err_t parseOperand(UVDASInstructionIterator *uvdIter, UVDDisasmInstruction *instruction, UVDDisasmOperand **out);
 
 public:
 	//A constant value associated with a mmemoric
@@ -96,7 +101,8 @@ public:
 
 	//uv_err_t uvd_parsed2opshared(const struct uvd_parsed_t *parsed_type, UVDOperandShared **op_shared_in);
 	//DEPRECATED: move things to shared parsing so we can alloc instead of using union stuff
-	virtual uv_err_t parseOperand(UVDASInstructionIterator *uvdIter);
+	//Function arguments are allocated from instruction
+	virtual uv_err_t parseOperand(UVDASInstructionIterator *uvdIter, UVDDisasmInstruction *instruction);
 
 	virtual uv_err_t printDisassemblyOperand(std::string &out);
 	//uv_err_t print_disasm_operand(char *buff, unsigned int buffsz, unsigned int *buff_used_in);
@@ -104,6 +110,9 @@ public:
 	//Get a variable mapping suitable for scripting
 	//If name returns empty, is not applicable
 	uv_err_t getVariable(std::string &name, UVDVarient &value);
+	//Value getVariable() would return, sign or zero extended
+	//For the native ACTION evaluator which has already resolved names
+	uv_err_t getVariableValue(int64_t *value);
 
 	//Does not have to be original size
 	//Must match signedness
@@ -116,6 +125,10 @@ public:
 	uv_err_t getI32RepresentationAdjusted(int32_t &i);
 
 	//uv_err_t setInstruction(UVDInstruction *instruction);
+
+public:
+	//Slot owner, set by UVDDisasmInstruction::allocateOperand()
+	UVDDisasmInstruction *m_instruction;
 	
 private:
 	/* 
@@ -144,16 +157,5 @@ private:
 	};
 };
 
-class UVDDisasmConstantOperand : public UVDDisasmOperand
-{
-public:
-	UVDDisasmConstantOperand();
-	~UVDDisasmConstantOperand();
-
-	UVDDisasmConstantOperandShared *getShared();
-
-	virtual uv_err_t printDisassemblyOperand(std::string &out);
-};
-
 #endif
 
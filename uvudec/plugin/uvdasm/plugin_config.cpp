@@ -5,6 +5,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 */
 
 #include "uvdasm/config.h"
+#include "uvdasm/opcode_cache.h"
 #include "uvdasm/plugin_config.h"
 #include "uvd/config/arg_property.h"
 #include "uvd/language/language.h"
@@ -60,6 +61,19 @@ static uv_err_t argParser(const UVDArgConfig *argConfig, std::vector<std::string
 		uv_assert_ret(!argumentArguments.empty());
 		g_asmConfig->m_architectureFileName = firstArg;
 	}
+	else if( argConfig->m_propertyForm == UVD_PROP_ARCH_CACHE )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		if( firstArg == "none" )
+		{
+			g_asmConfig->m_architectureCache = false;
+		}
+		else
+		{
+			g_asmConfig->m_architectureCache = true;
+			g_asmConfig->m_architectureCacheDir = firstArg;
+		}
+	}
 	else
 	{
 		printf_error("Property not recognized in callback: %s\n", argConfig->m_propertyForm.c_str());
@@ -75,6 +89,7 @@ UVDAsmConfig::UVDAsmConfig()
 	//m_plugin = NULL;
 	m_configInterpreterLanguage = UVD_LANGUAGE_UNKNOWN;
 	m_configInterpreterLanguageInterface = UVD_LANGUAGE_INTERFACE_UNKNOWN;
+	m_architectureCache = true;
 	g_asmConfig = this;
 
 }
@@ -91,10 +106,20 @@ uv_err_t UVDAsmConfig::init(UVDConfig *config)
 	
 	//What a mess
 	uv_assert_err_ret(g_asmPlugin->registerArgument(UVD_PROP_ARCH_FILE, 0, "arch-file", "architecture/CPU module file", 1, argParser, true));
+	uv_assert_err_ret(g_asmPlugin->registerArgument(UVD_PROP_ARCH_CACHE, 0, "arch-cache",
+			"precompiled architecture files, saves parsing them on every run",
+			"\tnone: don't use\n"
+			"\t<dir>: keep them in dir\n"
+			"\tdefault: in ~/.uvudec" UVD_DISASM_OPCODE_CACHE_USER_DIR "\n",
+			1, argParser, true));
 	//Config file processing
 	uv_assert_err_ret(g_asmPlugin->registerArgument(UVD_PROP_CONFIG_LANGUAGE, 0, "config-language",
 			"default config interpreter language (plugins may require specific)", 
-			""
+			"\tbuiltin: use native ACTION evaluator"
+#if UVD_CONFIG_INTERPRETER_LANGUAGE_DEFAULT == UVD_LANGUAGE_BUILTIN
+				" (default)"
+#endif
+				"\n"
 #ifdef USING_LUA
 			"\tlua: use Lua"
 #if UVD_CONFIG_INTERPRETER_LANGUAGE_DEFAULT == UVD_LANGUAGE_LUA
@@ -143,8 +168,9 @@ uv_err_t UVDAsmConfig::deinit()
 uv_err_t UVDAsmConfig::setConfigInterpreterLanguage(const std::string &in)
 {
 	//To make selection pre-processable
-	if( false )
+	if( in == "builtin" )
 	{
+		m_configInterpreterLanguage = UVD_LANGUAGE_BUILTIN;
 	}
 #ifdef USING_LUA
 	else if( in == "lua" )
@@ -12,6 +12,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 //Architecture
 #define UVD_PROP_ARCH_FILE						"arch.file"
 #define UVD_PROP_ARCH_PATHS						"arch.paths"
+#define UVD_PROP_ARCH_CACHE						"arch.cache"
 
 class UVDAsmPlugin;
 class UVDAsmConfig
@@ -47,6 +48,10 @@ public:
 	std::string m_asm_imm_suffix;
 	//The file that will be used to load the CPU module and such
 	std::string m_architectureFileName;
+	//Keep precompiled architecture files, see UVDDisasmOpcodeCache
+	uvd_bool_t m_architectureCache;
+	//Where to keep them, empty for next to the architecture file
+	std::string m_architectureCacheDir;
 };
 
 extern UVDAsmConfig *g_asmConfig;
@@ -34,7 +34,7 @@ UVDBfdInstructionIteratorFactory::UVDBfdInstructionIteratorFactory( UVDBFDObject
 }
 
 UVDBFDObject *UVDBfdInstructionIteratorFactory::object() {
-	return dynamic_cast<UVDBFDObject*>(g_uvd->m_runtime->m_object);
+	return dynamic_cast<UVDBFDObject*>(m_uvd->m_runtime->m_object);
 }
 	
 //uv_err_t abstractInstructionIteratorBegin( UVDAbstractInstructionIterator **out );
@@ -43,6 +43,7 @@ uv_err_t UVDBfdInstructionIteratorFactory::abstractInstructionIteratorBeginByAdd
 	
 	iter = new UVDBfdInstructionIterator();
 	uv_assert_ret(iter);
+	iter->m_uvd = m_uvd;
 	
 	printf("Begin address space %s\n", address.m_space->m_name.c_str());
 	uv_assert_err_ret(iter->initByAddress(object(), address));
@@ -61,6 +62,7 @@ uv_err_t UVDBfdInstructionIteratorFactory::abstractInstructionIteratorEndByAddre
 	
 	iter = new UVDBfdInstructionIterator();
 	uv_assert_ret(iter);
+	iter->m_uvd = m_uvd;
 	
 	uv_assert_err_ret(iter->initEnd(object(), addressSpace));
 	
@@ -36,6 +36,17 @@ uv_err_t UVDBFDPatCore::deinit()
 }
 
 uv_err_t UVDBFDPatCore::generate()
+{
+	uv_assert_err_ret(load());
+	//And print the signatures
+	printf_flirt_debug("\n\nprinting\n");
+	uv_assert_err_ret(print());
+
+	printf_flirt_debug("\n\noh snap!  finished normally\n");
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDBFDPatCore::load()
 {
 	char **matching = NULL;
 	
@@ -59,11 +70,7 @@ uv_err_t UVDBFDPatCore::generate()
 	//Assign relocations to each function
 	printf_flirt_debug("\n\nplacing relocations into functions\n");
 	uv_assert_err_ret(placeRelocationsIntoFunctions());
-	//And print the signatures
-	printf_flirt_debug("\n\nprinting\n");
-	uv_assert_err_ret(print());
 
-	printf_flirt_debug("\n\noh snap!  finished normally\n");
 	return UV_ERR_OK;
 }
 
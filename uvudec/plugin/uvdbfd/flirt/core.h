@@ -21,11 +21,18 @@ public:
 	uv_err_t init(bfd *abfd);
 	uv_err_t deinit();
 
+	//load() then print()
 	uv_err_t generate();
+	/*
+	Everything that needs libbfd: symbols, section contents, function sizes and relocations
+	libbfd isn't thread safe so this must be serialized
+	*/
+	uv_err_t load();
 
 	uv_err_t buildSymbolTable();
 	uv_err_t setFunctionSizes();
 	uv_err_t placeRelocationsIntoFunctions();
+	//Only reads what load() gathered, safe to run on other cores concurrently
 	uv_err_t print();
 
 public:
@@ -43,6 +43,9 @@ UVDFLIRTPatternGeneratorBFD::~UVDFLIRTPatternGeneratorBFD()
 uv_err_t UVDFLIRTPatternGeneratorBFD::init()
 {
 	std::string defaultTarget = "i686-pc-linux-gnu";
+	
+	uv_assert_ret(g_config);
+	uv_assert_err_ret(m_threadPool.init(g_config->m_analysisThreads));
 	printf_flirt_debug("bfd init\n");
 	bfd_init();
 	if( !bfd_set_default_target(defaultTarget.c_str()) )
@@ -55,6 +58,8 @@ uv_err_t UVDFLIRTPatternGeneratorBFD::init()
 
 uv_err_t UVDFLIRTPatternGeneratorBFD::deinit()
 {
+	clearBatch();
+	uv_assert_err_ret(m_threadPool.deinit());
 	return UV_ERR_OK;
 }
 
@@ -86,27 +91,32 @@ uv_err_t UVDFLIRTPatternGeneratorBFD::tryLoad(const UVDRuntime *runtime, UVDFLIR
 	return UV_ERR_OK;
 }
 
-uv_err_t UVDFLIRTPatternGeneratorBFD::generateByBFDCore(bfd *abfd, std::string &output)
+uv_err_t UVDFLIRTPatternGeneratorBFD::generateByBFD(bfd *abfd, std::string &output)
 {
-	UVDBFDPatCore generator;
+	uv_err_t rc = UV_ERR_GENERAL;
 	
-	printf_flirt_debug("generating for bfd %s\n", bfd_get_filename(abfd));
+	//printf_flirt_debug("head bfd generation for filename %s\n", fileName.c_str());
+	uv_assert_ret(abfd);
+	rc = loadByBFD(abfd, output);
+	if( UV_SUCCEEDED(rc) )
+	{
+		rc = flushBatch(output);
+	}
+	//Don't leave members open on error
+	clearBatch();
+	uv_assert_err_ret(rc);
 	
-	uv_assert_err_ret(generator.init(abfd));
-	uv_assert_err_ret(generator.generate());
-	output += generator.m_writer.m_buffer;
 	return UV_ERR_OK;
 }
 
-uv_err_t UVDFLIRTPatternGeneratorBFD::generateByBFD(bfd *abfd, std::string &output)
+uv_err_t UVDFLIRTPatternGeneratorBFD::loadByBFD(bfd *abfd, std::string &output)
 {
-	//printf_flirt_debug("head bfd generation for filename %s\n", fileName.c_str());
 	uv_assert_ret(abfd);
 	//If we get an archive, we must recurse
 	if( bfd_check_format(abfd, bfd_archive) == TRUE )
 	{
-		bfd *lastArbfd = NULL;
 		bfd *arbfd = NULL;
+		uv_err_t rc = UV_ERR_GENERAL;
 
 		//Recursive for each file in the archive
 		for(;; )
@@ -115,32 +125,96 @@ uv_err_t UVDFLIRTPatternGeneratorBFD::generateByBFD(bfd *abfd, std::string &outp
 			bfd_set_error(bfd_error_no_error);
 
 			//If arbfd is NULL, indicates begin() on the linked list
+			//The previous member must still be open here, so only flush after advancing
 			arbfd = bfd_openr_next_archived_file(abfd, arbfd);
-			//We advanced, trash old if we are still hanging onto it
-			if( lastArbfd )
-			{
-				bfd_close(lastArbfd);
-			}
-			
 			//and end()?
 			if( arbfd == NULL )
 			{
 				uv_assert_ret(bfd_get_error() == bfd_error_no_more_archived_files);
 				break;
 			}
-			uv_assert_err_ret(generateByBFD(arbfd, output));
-			lastArbfd = arbfd;
+			if( m_batchCores.size() >= UVD_FLIRT_BFD_PAT_BATCH_SIZE )
+			{
+				uv_assert_err_ret(flushBatch(output));
+			}
+			rc = loadByBFD(arbfd, output);
+			//Closed with the batch it ends up in, a nested archive after its own members
+			m_batchBFDs.push_back(arbfd);
+			uv_assert_err_ret(rc);
 		}
 	}
 	//Otherwise, process
 	else
 	{
-		uv_assert_err_ret(generateByBFDCore(abfd, output));
+		uv_assert_err_ret(loadByBFDCore(abfd));
 	}
 	
 	return UV_ERR_OK;
 }
 
+uv_err_t UVDFLIRTPatternGeneratorBFD::loadByBFDCore(bfd *abfd)
+{
+	UVDBFDPatCore *core = NULL;
+	uv_err_t rc = UV_ERR_GENERAL;
+	
+	printf_flirt_debug("loading bfd %s\n", bfd_get_filename(abfd));
+	
+	core = new UVDBFDPatCore();
+	uv_assert_ret(core);
+	rc = core->init(abfd);
+	if( UV_SUCCEEDED(rc) )
+	{
+		rc = core->load();
+	}
+	if( UV_FAILED(rc) )
+	{
+		delete core;
+		return UV_DEBUG(rc);
+	}
+	m_batchCores.push_back(core);
+	
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDFLIRTPatternGeneratorBFD::printJob(uint32_t index, uint32_t thread, void *user)
+{
+	UVDFLIRTPatternGeneratorBFD *generator = (UVDFLIRTPatternGeneratorBFD *)user;
+	
+	uv_assert_ret(generator);
+	uv_assert_ret(index < generator->m_batchCores.size());
+	return UV_DEBUG(generator->m_batchCores[index]->print());
+}
+
+uv_err_t UVDFLIRTPatternGeneratorBFD::flushBatch(std::string &output)
+{
+	if( !m_batchCores.empty() )
+	{
+		uv_assert_err_ret(m_threadPool.run(m_batchCores.size(), printJob, this));
+		for( std::vector<UVDBFDPatCore *>::iterator iter = m_batchCores.begin(); iter != m_batchCores.end(); ++iter )
+		{
+			output += (*iter)->m_writer.m_buffer;
+		}
+	}
+	clearBatch();
+	
+	return UV_ERR_OK;
+}
+
+void UVDFLIRTPatternGeneratorBFD::clearBatch()
+{
+	//Cores hold pointers into their bfd, so they go first
+	for( std::vector<UVDBFDPatCore *>::iterator iter = m_batchCores.begin(); iter != m_batchCores.end(); ++iter )
+	{
+		delete *iter;
+	}
+	m_batchCores.clear();
+	for( std::vector<bfd *>::iterator iter = m_batchBFDs.begin(); iter != m_batchBFDs.end(); ++iter )
+	{
+		bfd_close(*iter);
+	}
+	m_batchBFDs.clear();
+}
+
 uv_err_t UVDFLIRTPatternGeneratorBFD::saveToStringCore(UVDObject *object, std::string &output)
 {
 	UVDBFDObject *bfdObject = NULL;
@@ -12,12 +12,22 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 
 #include "uvd/util/types.h"
 #include "uvdflirt/pat/pat.h"
+#include "uvd/util/thread.h"
 #include <string>
+#include <vector>
 #include <bfd.h>
 
+//Archive members loaded before printing them, bounds how many are open at once
+#define UVD_FLIRT_BFD_PAT_BATCH_SIZE		64
+
 /*
 Using libbfd to get symbols and relocations
+
+libbfd isn't thread safe, so archive members are opened and loaded serially in batches
+Each batch is then printed on a thread pool and appended in archive order
+so output is identical to a single threaded run
 */
+class UVDBFDPatCore;
 class UVDFLIRTPatternGeneratorBFD : public UVDFLIRTPatternGenerator
 {
 public:
@@ -33,9 +43,22 @@ public:
 
 protected:
 	uv_err_t generateByBFD(bfd *abfd, std::string &output);
+	//Load abfd (recursing into archives) into the current batch, printing full batches
+	uv_err_t loadByBFD(bfd *abfd, std::string &output);
 	//Not an archive
-	uv_err_t generateByBFDCore(bfd *abfd, std::string &output);
+	uv_err_t loadByBFDCore(bfd *abfd);
 	//uv_err_t generateByFile(const std::string &fileName, std::string &output);
+	//Print the current batch and append it to output in load order
+	uv_err_t flushBatch(std::string &output);
+	void clearBatch();
+	static uv_err_t printJob(uint32_t index, uint32_t thread, void *user);
+
+public:
+	UVDThreadPool m_threadPool;
+	//Loaded but not yet printed, we own these
+	std::vector<UVDBFDPatCore *> m_batchCores;
+	//Archive members to close once m_batchCores is printed, in the order to close them
+	std::vector<bfd *> m_batchBFDs;
 };
 
 #endif
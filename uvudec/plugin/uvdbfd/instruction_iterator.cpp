@@ -34,36 +34,33 @@ static int objdump_symbol_at_address(bfd_vma vma, struct disassemble_info * info
 	return 0;
 }
 
-disassembler_ftype g_disassembler_function;
-
-
-
-//XXX: if we become multithreaded we will have to lock this
-static char g_print_buffer[256];
-
 //static int ATTRIBUTE_PRINTF_2
 static int objdump_sprintf(SFILE *f, const char *format, ...)
 {
 	/*
 	Each one of these prints a single token / argument, not the whole line
+	Appended to the iterator's own buffer so iterators on different threads don't share output
 	*/
-
-printf("print func\n");
-	size_t n;
+	size_t space = 0;
+	int n = 0;
 	va_list args;
 
-	va_start (args, format);
-	//n = vprintf (format, args);
-	n = vsnprintf(g_print_buffer, sizeof(g_print_buffer), format, args);
-	//printf("\n");
-	va_end (args);
-
-	if (true) {
-		va_start (args, format);
-		vprintf (format, args);
-		n = vsnprintf(g_print_buffer, sizeof(g_print_buffer), format, args);
-		printf(" EOL\n");
-		va_end (args);
+	while( true )
+	{
+		space = f->alloc - f->pos;
+		va_start(args, format);
+		n = vsnprintf(f->buffer + f->pos, space, format, args);
+		va_end(args);
+		if( n < 0 || (size_t)n < space )
+		{
+			break;
+		}
+		f->alloc = (f->alloc + n) * 2;
+		f->buffer = (char *)realloc(f->buffer, f->alloc);
+	}
+	if( n > 0 )
+	{
+		f->pos += n;
 	}
 
 	return n;
@@ -71,6 +68,7 @@ printf("print func\n");
 
 
 UVDBfdInstructionIterator::UVDBfdInstructionIterator() {
+	m_uvd = NULL;
 	m_obj = NULL;
 	m_section = NULL;
 	m_curOffset = 0;
@@ -81,14 +79,14 @@ UVDBfdInstructionIterator::UVDBfdInstructionIterator() {
 	m_data = NULL;
 	m_datasize = 0;
 	memset( &m_sfile, 0, sizeof(m_sfile));
+	m_disassemble = NULL;
 }
 
 UVDBfdInstructionIterator::~UVDBfdInstructionIterator() {
 }
 
 UVDBFDArchitecture *UVDBfdInstructionIterator::arch() {
-	//return m_obj->m_uvd->m_runtime->m_arch;
-	return dynamic_cast<UVDBFDArchitecture *>(g_uvd->m_runtime->m_architecture);
+	return dynamic_cast<UVDBFDArchitecture *>(m_uvd->m_runtime->m_architecture);
 }
 
 uv_err_t UVDBfdInstructionIterator::getPosition(UVDAddress *out) {
@@ -153,6 +151,7 @@ uv_err_t UVDBfdInstructionIterator::copy(UVDAbstractInstructionIterator **out) c
 	uv_assert_ret(iter);
 	
 	//safest to just re-init
+	iter->m_uvd = m_uvd;
 	iter->m_obj = m_obj;
 	iter->m_startOffset = m_curOffset;
 	uv_assert_err_ret(iter->init());
@@ -220,8 +219,8 @@ uv_err_t UVDBfdInstructionIterator::init() {
    	target address.  Return number of octets processed.
 	typedef int (*disassembler_ftype) (bfd_vma, disassemble_info *);
 	*/
-	g_disassembler_function = disassembler(a_bfd);
-	if( !g_disassembler_function ) {
+	m_disassemble = disassembler(a_bfd);
+	if( !m_disassemble ) {
 		printf("failed \n");
 		return UV_DEBUG(UV_ERR_GENERAL);
 	}
@@ -384,8 +383,11 @@ uv_err_t UVDBfdInstructionIterator::initCurrentSection()
 
 	//section = aux->sec;
 
-	m_sfile.alloc = 120;
-	m_sfile.buffer = (char *) malloc(m_sfile.alloc);
+	if( !m_sfile.buffer ) {
+		m_sfile.alloc = 120;
+		m_sfile.buffer = (char *) malloc(m_sfile.alloc);
+		uv_assert_ret(m_sfile.buffer);
+	}
 	m_sfile.pos = 0;
 
 	pinfo->insn_info_valid = 0;
@@ -420,7 +422,7 @@ uv_err_t UVDBfdInstructionIterator::dissassembleCur()
 	unsigned int target_address = m_section->vma + m_curOffset;
 	//target_address = 0x8049558;
 	//printf("target address: 0x%08X\n", target_address);
-	octets = (*g_disassembler_function) (target_address, info);
+	octets = (*m_disassemble) (target_address, info);
 	//printf("\noctets: %d\n", octets);
 	info->fprintf_func = (fprintf_ftype) fprintf;
 	info->stream = stdout;
@@ -433,7 +435,7 @@ uv_err_t UVDBfdInstructionIterator::dissassembleCur()
 		return UV_DEBUG(UV_ERR_GENERAL);
 	}
 
-	m_instruction.m_disassembly = g_print_buffer;
+	m_instruction.m_disassembly = std::string(m_sfile.buffer, m_sfile.pos);
 
 	printf("\n");
 
@@ -18,6 +18,7 @@ typedef struct
 	size_t alloc;
 } SFILE;
 
+class UVD;
 class UVDBFDObject;
 class UVDBFDArchitecture;
 class UVDBfdInstructionIterator : public UVDAbstractInstructionIterator
@@ -55,6 +56,8 @@ public:
 	/*
 	Don't store things that are redundant with disassemble_info as it adds potential for errors
 	*/
+	//Engine we iterate, set by the factory before init
+	UVD *m_uvd;
 	UVDBFDObject *m_obj;
 	//XXX: not sure if we need this or not since its in m_disasm_info
 	//but original code didn't seem to want to rely on that
@@ -70,12 +73,15 @@ public:
 	//unsigned int m_octets_per_byte;
 	//unsigned int m_bytes_per_line;
 	struct disassemble_info m_disasm_info;
+	//Per iterator rather than global so iterators of different engines can run concurrently
+	disassembler_ftype m_disassemble;
 	bfd_byte *m_data;
 	bfd_size_type m_datasize;
 	//We must disassemble to advance
 	//Best to always disassemble and use it if someone cares
 	UVDBFDInstruction m_instruction;
 	
+	//Disassembly text of the current instruction
 	SFILE m_sfile;
 };
 
@@ -46,9 +46,13 @@ uv_err_t UVDBFDPlugin::onUVDInit()
 	uv_assert_ret(m_uvd);
 	uv_assert_ret(g_uvdFLIRTPlugin);
 	uv_assert_ret(g_uvdFLIRTPlugin->m_flirt);
-	uv_assert_err_ret(g_uvdFLIRTPlugin->m_flirt->m_patFactory.registerObject(pluginName,
-			UVDFLIRTPatternGeneratorBFD::canLoad, UVDFLIRTPatternGeneratorBFD::tryLoad,
-			this));
+	//FLIRT is kept across engines, only register for the first
+	if( g_uvdFLIRTPlugin->m_flirt->m_patFactory.m_loaders.find(pluginName) == g_uvdFLIRTPlugin->m_flirt->m_patFactory.m_loaders.end() )
+	{
+		uv_assert_err_ret(g_uvdFLIRTPlugin->m_flirt->m_patFactory.registerObject(pluginName,
+				UVDFLIRTPatternGeneratorBFD::canLoad, UVDFLIRTPatternGeneratorBFD::tryLoad,
+				this));
+	}
 	return UV_ERR_OK;
 }
 
@@ -10,6 +10,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvdflirt/config.h"
 #include "uvd/config/arg_property.h"
 #include "uvd/config/arg_util.h"
+#include "uvd/plugin/plugin.h"
 
 static uv_err_t argParser(const UVDArgConfig *argConfig, std::vector<std::string> argumentArguments, void *user);
 
@@ -28,6 +29,14 @@ uv_err_t UVDInitFLIRTSharedConfig(UVDConfig *config)
 	return UV_ERR_OK;	
 }
 
+uv_err_t UVDInitFLIRTPluginConfig(UVDPlugin *plugin)
+{
+	uv_assert_ret(plugin);
+	uv_assert_err_ret(plugin->registerArgument(UVD_PROP_FLIRT_MATCH_SIGNATURE_FILE, 0, "flirt-sig", "identify functions using given .sig or .pat file", 1, argParser, false));
+
+	return UV_ERR_OK;	
+}
+
 static uv_err_t argParser(const UVDArgConfig *argConfig, std::vector<std::string> argumentArguments, void *user)
 {
 	UVDConfig *config = NULL;
@@ -37,7 +46,7 @@ static uv_err_t argParser(const UVDArgConfig *argConfig, std::vector<std::string
 	uint32_t firstArgNum = 0;
 	bool firstArgBool = true;
 	
-	config = (UVDConfig *)config;
+	config = g_config;
 	uv_assert_ret(config);
 	flirtConfig = g_UVDFLIRTConfig;
 	uv_assert_ret(flirtConfig);
@@ -113,6 +122,11 @@ static uv_err_t argParser(const UVDArgConfig *argConfig, std::vector<std::string
 		uv_assert_ret(!argumentArguments.empty());
 		flirtConfig->m_outputFile = firstArg;
 	}
+	else if( argConfig->m_propertyForm == UVD_PROP_FLIRT_MATCH_SIGNATURE_FILE )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		flirtConfig->m_signatureFiles.push_back(firstArg);
+	}
 	//Unknown
 	else
 	{
@@ -10,5 +10,8 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 
 class UVDConfig;
 uv_err_t UVDInitFLIRTSharedConfig(UVDConfig *config);
+//Options for using FLIRT from within an analysis as opposed to the standalone tools
+class UVDPlugin;
+uv_err_t UVDInitFLIRTPluginConfig(UVDPlugin *plugin);
 
 #endif
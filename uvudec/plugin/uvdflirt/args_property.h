@@ -123,5 +123,12 @@ Applicable object type flags
 #define UVD_PROP_FLIRT_SIG_FILE_TYPES							"flirt.sig.file_types"
 #define UVD_PROP_FLIRT_SIG_FILE_TYPES_DEFAULT					UVD_FLIRT_SIG_FILE_PE
 
+/*
+Signature matching
+*/
+
+//.sig or .pat file to identify analyzed functions against, may be given multiple times
+#define UVD_PROP_FLIRT_MATCH_SIGNATURE_FILE						"flirt.match.signature_file"
+
 #endif
 
@@ -83,6 +83,10 @@ public:
 	//File to write to
 	std::string m_outputFile;
 
+	//UVD_PROP_FLIRT_MATCH_SIGNATURE_FILE
+	//Signature databases to name analyzed functions from
+	std::vector<std::string> m_signatureFiles;
+
 	//When debug dumping, what to append for an indent
 	std::string m_debugDumpTab;
 
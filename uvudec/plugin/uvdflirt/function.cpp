@@ -77,6 +77,15 @@ int UVDFLIRTSignatureRawSequence::const_iterator::deref::compare(const deref &ot
 	{
 		return 0;
 	}
+	//Relocations order before any fixed byte, m_byte isn't meaningful for them
+	if( m_isReloc )
+	{
+		return -1;
+	}
+	if( other.m_isReloc )
+	{
+		return 1;
+	}
 	return m_byte - other.m_byte;
 }
 
@@ -589,9 +598,7 @@ int UVDFLIRTSignatureRawSequence::compare(const UVDFLIRTSignatureRawSequence *ot
 		const_iterator::deref derefOther = *iterOther;
 		if( derefThis != derefOther )
 		{
-			uv_assert_ret(!(*iterThis).m_isReloc);
-			uv_assert_ret(!(*iterOther).m_isReloc);
-			return (*iterThis).m_byte - (*iterOther).m_byte;
+			return derefThis.compare(derefOther);
 		}
 		
 		UV_DEBUG(iterThis.next());
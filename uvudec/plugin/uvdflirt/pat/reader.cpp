@@ -7,12 +7,17 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvdflirt/pat/reader.h"
 #include "uvdflirt/sig/sig.h"
 #include "uvdflirt/function.h"
+#include "uvd/data/data.h"
 #include "uvd/util/util.h"
+#include <string.h>
 
 UVDPatLoaderCore::UVDPatLoaderCore(UVDFLIRTSignatureDB *db, const std::string &file)
 {
 	m_db = db;
 	m_file = file;
+	m_terminated = false;
+	m_nonBlankAfterTerminator = 0;
+	m_modules = 0;
 }
 
 UVDPatLoaderCore::~UVDPatLoaderCore()
@@ -21,40 +26,123 @@ UVDPatLoaderCore::~UVDPatLoaderCore()
 
 uv_err_t UVDPatLoaderCore::fromString(const std::string &in)
 {
-	std::vector<std::string> lines = split(in, '\n', false);
+	std::string::size_type lineStart = 0;
 	
-	for( std::vector<std::string>::iterator iter = lines.begin(); ; ++iter )
+	while( lineStart < in.size() )
 	{
-		std::string line;
+		std::string::size_type lineEnd = in.find('\n', lineStart);
 		
-		if( iter == lines.end() )
+		if( lineEnd == std::string::npos )
 		{
-			printf_error("ending .pat terminator " UVD_FLIRT_PAT_TERMINATOR " required\n");
-			return UV_DEBUG(UV_ERR_GENERAL);
+			lineEnd = in.size();
 		}
+		uv_assert_err_ret(nextLine(in.c_str() + lineStart, lineEnd - lineStart));
+		lineStart = lineEnd + 1;
+	}
+	
+	return UV_DEBUG(finish());
+}
+
+uv_err_t UVDPatLoaderCore::fromData(const UVDData *data, uint32_t readChunkSize)
+{
+	uint32_t dataSize = 0;
+	uint32_t offset = 0;
+	//Partial line left over from the previous chunk
+	std::string carry;
+	
+	uv_assert_ret(data);
+	uv_assert_ret(readChunkSize > 0);
+	uv_assert_err_ret(data->size(&dataSize));
+	
+	while( offset < dataSize )
+	{
+		UVDDataView view;
+		//Mapped files come back as one zero copy chunk
+		uint32_t chunkSize = data->getBuffer(offset, dataSize - offset) ?
+				dataSize - offset : uvd_min(dataSize - offset, readChunkSize);
+		const char *chunk = NULL;
+		const char *chunkEnd = NULL;
+		const char *lineStart = NULL;
 		
-		line = *iter;
+		uv_assert_err_ret(data->getView(offset, chunkSize, view));
+		chunk = (const char *)view.begin();
+		chunkEnd = (const char *)view.end();
+		lineStart = chunk;
 		
-		line = trimString(line);
-		if( line.empty() )
-		{
-			continue;
-		}
-		if( line == UVD_FLIRT_PAT_TERMINATOR )
+		for( ;; )
 		{
-			//There should not be any more lines
-			uint32_t nonBlank = nonBlankLinesRemaining(lines, iter);
-			if( nonBlank > 0 )
+			const char *lineEnd = (const char *)memchr(lineStart, '\n', chunkEnd - lineStart);
+			
+			if( !lineEnd )
 			{
-				printf_flirt_warning("%s: non blank lines remaining in .pat load: %d\n", m_file, nonBlank);
+				carry.append(lineStart, chunkEnd - lineStart);
+				break;
 			}
-			break;
+			if( carry.empty() )
+			{
+				uv_assert_err_ret(nextLine(lineStart, lineEnd - lineStart));
+			}
+			else
+			{
+				carry.append(lineStart, lineEnd - lineStart);
+				uv_assert_err_ret(nextLine(carry.c_str(), carry.size()));
+				carry.clear();
+			}
+			lineStart = lineEnd + 1;
 		}
-		
-		//Okay, all the prelims are over, ready to roll
-		uv_assert_err_ret(fileLine(line));
-		uv_assert_err_ret(m_db->debugDumpTree());
+		offset += chunkSize;
+	}
+	if( !carry.empty() )
+	{
+		uv_assert_err_ret(nextLine(carry.c_str(), carry.size()));
+	}
+	
+	return UV_DEBUG(finish());
+}
+
+uv_err_t UVDPatLoaderCore::nextLine(const char *lineIn, uint32_t lineSize)
+{
+	std::string line;
+	
+	uv_assert_ret(lineIn || lineSize == 0);
+	line = trimString(std::string(lineIn, lineSize));
+	if( line.empty() )
+	{
+		return UV_ERR_OK;
+	}
+	//There should not be any more lines
+	if( m_terminated )
+	{
+		++m_nonBlankAfterTerminator;
+		return UV_ERR_OK;
+	}
+	if( line == UVD_FLIRT_PAT_TERMINATOR )
+	{
+		m_terminated = true;
+		return UV_ERR_OK;
+	}
+	
+	//Okay, all the prelims are over, ready to roll
+	uv_assert_err_ret(fileLine(line));
+	++m_modules;
+	
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDPatLoaderCore::finish()
+{
+	if( !m_terminated )
+	{
+		printf_error("ending .pat terminator " UVD_FLIRT_PAT_TERMINATOR " required\n");
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	if( m_nonBlankAfterTerminator > 0 )
+	{
+		printf_flirt_warning("%s: non blank lines remaining in .pat load: %d\n", m_file.c_str(), m_nonBlankAfterTerminator);
 	}
+	printf_flirt_debug("%s: loaded %d modules\n", m_file.c_str(), m_modules);
+	//Dumping after every line is quadratic in the tree size
+	uv_assert_err_ret(m_db->debugDumpTree());
 	
 	return UV_ERR_OK;
 }
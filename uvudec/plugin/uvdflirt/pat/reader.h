@@ -12,7 +12,12 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 
 /*
 UVDPatLoaderCore
+Lines are handled one at a time as they are found so only the tree being built and the current line are held
 */
+//How much of a non-mappable .pat file is read at once
+#define UVD_FLIRT_PAT_READ_CHUNK_SIZE			0x100000
+
+class UVDData;
 class UVDFLIRTSignatureDB;
 class UVDFLIRTModule;
 class UVDFLIRTSignatureRawSequence;
@@ -23,6 +28,12 @@ public:
 	~UVDPatLoaderCore();
 	
 	uv_err_t fromString(const std::string &in);
+	//Streams over data readChunkSize at a time, zero copy if it is mapped
+	uv_err_t fromData(const UVDData *data, uint32_t readChunkSize = UVD_FLIRT_PAT_READ_CHUNK_SIZE);
+	//Handle one raw line (no newline), lines after the terminator are only checked for being blank
+	uv_err_t nextLine(const char *line, uint32_t lineSize);
+	//Call after the last line
+	uv_err_t finish();
 	uv_err_t fileLine(const std::string &in);
 	uv_err_t insert(UVDFLIRTModule *function, UVDFLIRTSignatureRawSequence &leadingBytes);
 
@@ -30,6 +41,10 @@ public:
 	//Do not own this
 	UVDFLIRTSignatureDB *m_db;
 	std::string m_file;
+	//Seen the terminator, anything after it should be blank
+	bool m_terminated;
+	uint32_t m_nonBlankAfterTerminator;
+	uint32_t m_modules;
 };
 
 #endif
@@ -4,30 +4,69 @@ Copyright 2010 John McMaster <JohnDMcMaster@gmail.com>
 Licensed under the terms of the LGPL V3 or later, see COPYING for details
 */
 
+#include "uvdflirt/args.h"
 #include "uvdflirt/plugin.h"
 #include "uvdflirt/flirt.h"
+#include "uvdflirt/sig/match.h"
+#include "uvd/core/event.h"
 #include "uvd/core/uvd.h"
+#include "uvd/event/engine.h"
+#include "uvd/event/events.h"
 
 UVDFLIRTPlugin *g_uvdFLIRTPlugin = NULL;
 
+static uv_err_t identifyFunctionsHandler(const UVDEvent *event, void *data)
+{
+	UVDFLIRTPlugin *plugin = (UVDFLIRTPlugin *)data;
+	const UVDEventIdentifyFunctions *identifyEvent = NULL;
+
+	uv_assert_ret(event);
+	uv_assert_ret(plugin);
+	if( event->m_type != UVD_EVENT_IDENTIFY_FUNCTIONS )
+	{
+		return UV_ERR_OK;
+	}
+	identifyEvent = (const UVDEventIdentifyFunctions *)event;
+	uv_assert_ret(plugin->m_matcher);
+	uv_assert_err_ret(plugin->m_matcher->identifyFunctions(identifyEvent->m_analyzer));
+	
+	return UV_ERR_OK;
+}
+
 UVDFLIRTPlugin::UVDFLIRTPlugin()
 {
 	g_uvdFLIRTPlugin = this;
 	m_flirt = NULL;
+	m_matcher = NULL;
 }
 
 UVDFLIRTPlugin::~UVDFLIRTPlugin()
 {
+	delete m_matcher;
+	m_matcher = NULL;
+	delete m_flirt;
+	m_flirt = NULL;
 }
 
 uv_err_t UVDFLIRTPlugin::init(UVDConfig *config)
 {
 	uv_assert_err_ret(UVDPlugin::init(config));
 	uv_assert_err_ret(m_config.init());
+	uv_assert_err_ret(UVDInitFLIRTPluginConfig(this));
 
 	return UV_ERR_OK;
 }
 
+uv_err_t UVDFLIRTPlugin::deinit(UVDConfig *config)
+{
+	delete m_matcher;
+	m_matcher = NULL;
+	delete m_flirt;
+	m_flirt = NULL;
+
+	return UV_DEBUG(UVDPlugin::deinit(config));
+}
+
 uv_err_t UVDFLIRTPlugin::getName(std::string &out)
 {
 	out = UVD_PLUGIN_NAME;
@@ -54,18 +93,52 @@ uv_err_t UVDFLIRTPlugin::getAuthor(std::string &out)
 
 uv_err_t UVDFLIRTPlugin::onUVDInit()
 {
-	m_flirt = new UVDFLIRT();
-	uv_assert_ret(m_flirt);
+	/*
+	Kept across engines so pattern generators registered by other plugins stay registered
+	Pattern generation works on the most recently created engine
+	*/
+	if( !m_flirt )
+	{
+		m_flirt = new UVDFLIRT();
+		uv_assert_ret(m_flirt);
+		uv_assert_err_ret(m_flirt->init());
+	}
 	m_flirt->m_uvd = m_uvd;
-	uv_assert_err_ret(m_flirt->init());
+
+	if( !m_config.m_signatureFiles.empty() )
+	{
+		//Signatures don't depend on the engine, only load them for the first one
+		if( !m_matcher )
+		{
+			m_matcher = new UVDFLIRTSignatureMatcher();
+			uv_assert_ret(m_matcher);
+			uv_assert_err_ret(m_matcher->init());
+			for( std::vector<std::string>::iterator iter = m_config.m_signatureFiles.begin(); iter != m_config.m_signatureFiles.end(); ++iter )
+			{
+				uv_assert_err_ret(m_matcher->loadFile(*iter));
+			}
+		}
+		uv_assert_err_ret(m_uvd->m_eventEngine->registerHandler(identifyFunctionsHandler, this, UVD_EVENT_HANDLER_PRIORITY_FUNCTION_RECOGNITION));
+	}
 
 	return UV_ERR_OK;
 }
 
 uv_err_t UVDFLIRTPlugin::onUVDDeinit()
 {
-	delete m_flirt;
-	m_flirt = NULL;
+	//Matcher is kept for the next engine
+	if( m_matcher )
+	{
+		if( m_uvd && m_uvd->m_eventEngine )
+		{
+			UV_DEBUG(m_uvd->m_eventEngine->unregisterHandler(identifyFunctionsHandler, this));
+		}
+	}
+
+	if( m_flirt && m_flirt->m_uvd == m_uvd )
+	{
+		m_flirt->m_uvd = NULL;
+	}
 
 	return UV_ERR_OK;
 }
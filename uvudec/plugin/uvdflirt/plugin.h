@@ -12,12 +12,14 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvdflirt/config.h"
 
 class UVDFLIRT;
+class UVDFLIRTSignatureMatcher;
 class UVDFLIRTPlugin : public UVDPlugin
 {
 public:
 	UVDFLIRTPlugin();
 	~UVDFLIRTPlugin();
 	virtual uv_err_t init(UVDConfig *config);
+	virtual uv_err_t deinit(UVDConfig *config);
 
 	virtual uv_err_t getName(std::string &out);
 	virtual uv_err_t getDescription(std::string &out);	
@@ -29,7 +31,13 @@ public:
 
 public:
 	UVDFLIRTConfig m_config;
+	//Created on first engine init and kept until deinit()
 	UVDFLIRT *m_flirt;
+	/*
+	Only present if signature files were given to identify functions with
+	Loaded on first engine init and kept for later engines (ex: batch mode), freed on deinit()
+	*/
+	UVDFLIRTSignatureMatcher *m_matcher;
 };
 
 extern UVDFLIRTPlugin *g_uvdFLIRTPlugin;
@@ -0,0 +1,349 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include "uvdflirt/sig/compiled.h"
+#include "uvdflirt/sig/tree/tree.h"
+#include "uvd/hash/crc.h"
+#include "uvd/util/debug.h"
+#include "uvd/util/util.h"
+#include <string.h>
+
+UVDFLIRTCompiledNode::UVDFLIRTCompiledNode()
+{
+	m_patternOffset = 0;
+	m_patternLength = 0;
+	m_firstChild = 0;
+	m_childCount = 0;
+	m_wildcardChildCount = 0;
+	m_dispatchOffset = UVD_FLIRT_COMPILED_NO_DISPATCH;
+	m_firstHash = 0;
+	m_hashCount = 0;
+}
+
+UVDFLIRTCompiledHash::UVDFLIRTCompiledHash()
+{
+	m_crc16 = 0;
+	m_crc16Length = 0;
+	m_firstModule = 0;
+	m_moduleCount = 0;
+}
+
+UVDFLIRTCompiledSignatures::UVDFLIRTCompiledSignatures()
+{
+	m_maxModuleLength = 0;
+}
+
+UVDFLIRTCompiledSignatures::~UVDFLIRTCompiledSignatures()
+{
+	UV_DEBUG(deinit());
+}
+
+uv_err_t UVDFLIRTCompiledSignatures::deinit()
+{
+	m_nodes.clear();
+	m_values.clear();
+	m_masks.clear();
+	m_dispatch.clear();
+	m_hashes.clear();
+	m_modules.clear();
+	m_maxModuleLength = 0;
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDFLIRTCompiledSignatures::compile(UVDFLIRTSignatureTreeLeadingNode *root)
+{
+	uv_assert_ret(root);
+	uv_assert_err_ret(deinit());
+
+	m_nodes.push_back(UVDFLIRTCompiledNode());
+	//Root has no bytes of its own
+	uv_assert_err_ret(compileNode(root, 0, 0));
+	printf_flirt_debug("compiled signatures: %d nodes, %d pattern bytes, %d dispatch tables, %d crc groups, %d modules\n",
+			m_nodes.size(), m_values.size(), m_dispatch.size() / 256, m_hashes.size(), m_modules.size());
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDFLIRTCompiledSignatures::compileNode(UVDFLIRTSignatureTreeLeadingNode *treeNode, uint32_t nodeIndex, uint32_t position)
+{
+	std::vector<UVDFLIRTSignatureTreeLeadingNode *> children;
+	uint32_t wildcardChildCount = 0;
+	uint32_t firstChild = 0;
+	uint32_t fixedChildCount = 0;
+
+	uv_assert_ret(treeNode);
+	uv_assert_ret(nodeIndex < m_nodes.size());
+
+	/*
+	Pattern bytes
+	*/
+	m_nodes[nodeIndex].m_patternOffset = m_values.size();
+	for( UVDFLIRTSignatureRawSequence::const_iterator iter = treeNode->m_bytes.const_begin();
+			iter != treeNode->m_bytes.const_end(); UV_DEBUG(iter.next()) )
+	{
+		UVDFLIRTSignatureRawSequence::const_iterator::deref cur = *iter;
+
+		if( cur.m_isReloc )
+		{
+			m_values.push_back(0x00);
+			m_masks.push_back(0x00);
+		}
+		else
+		{
+			m_values.push_back(cur.m_byte);
+			m_masks.push_back(0xFF);
+		}
+	}
+	m_nodes[nodeIndex].m_patternLength = m_values.size() - m_nodes[nodeIndex].m_patternOffset;
+	//Now where the leading bytes of modules ending here end
+	position += m_nodes[nodeIndex].m_patternLength;
+
+	/*
+	Modules ending here
+	*/
+	m_nodes[nodeIndex].m_firstHash = m_hashes.size();
+	for( UVDFLIRTSignatureTreeHashNodes::HashSet::iterator hashIter = treeNode->m_crcNodes.m_nodes.begin();
+			hashIter != treeNode->m_crcNodes.m_nodes.end(); ++hashIter )
+	{
+		UVDFLIRTSignatureTreeHashNode *hashNode = *hashIter;
+		UVDFLIRTCompiledHash hash;
+
+		uv_assert_ret(hashNode);
+		hash.m_crc16 = hashNode->m_crc16;
+		hash.m_crc16Length = hashNode->m_crc16Length;
+		hash.m_firstModule = m_modules.size();
+		m_maxModuleLength = uvd_max(m_maxModuleLength, position + hashNode->m_crc16Length);
+		for( UVDFLIRTSignatureTreeHashNode::BasicSet::iterator basicIter = hashNode->m_bucket.begin();
+				basicIter != hashNode->m_bucket.end(); ++basicIter )
+		{
+			UVDFLIRTSignatureTreeBasicNode *basicNode = *basicIter;
+
+			uv_assert_ret(basicNode);
+			m_modules.push_back(basicNode);
+			m_maxModuleLength = uvd_max(m_maxModuleLength, basicNode->m_totalLength);
+		}
+		hash.m_moduleCount = m_modules.size() - hash.m_firstModule;
+		m_hashes.push_back(hash);
+	}
+	m_nodes[nodeIndex].m_hashCount = m_hashes.size() - m_nodes[nodeIndex].m_firstHash;
+
+	/*
+	Children, relocation first ones at the front
+	*/
+	for( UVDFLIRTSignatureTreeLeadingNode::LeadingChildrenSet::iterator iter = treeNode->m_leadingChildren.begin();
+			iter != treeNode->m_leadingChildren.end(); ++iter )
+	{
+		UVDFLIRTSignatureTreeLeadingNode *child = *iter;
+
+		uv_assert_ret(child);
+		//Otherwise we could recurse forever
+		uv_assert_ret(!child->m_bytes.empty());
+		if( (*child->m_bytes.const_begin()).m_isReloc )
+		{
+			children.insert(children.begin() + wildcardChildCount, child);
+			++wildcardChildCount;
+		}
+		else
+		{
+			children.push_back(child);
+		}
+	}
+
+	//Reserve the sibling block now so children are adjacent, their own children go after
+	firstChild = m_nodes.size();
+	m_nodes[nodeIndex].m_firstChild = firstChild;
+	m_nodes[nodeIndex].m_childCount = children.size();
+	m_nodes[nodeIndex].m_wildcardChildCount = wildcardChildCount;
+	m_nodes.resize(m_nodes.size() + children.size());
+
+	fixedChildCount = children.size() - wildcardChildCount;
+	if( fixedChildCount >= UVD_FLIRT_COMPILED_DISPATCH_MIN_CHILDREN )
+	{
+		uint32_t dispatchOffset = m_dispatch.size();
+		bool collision = false;
+
+		m_dispatch.resize(m_dispatch.size() + 256, 0);
+		for( uint32_t i = wildcardChildCount; i < children.size(); ++i )
+		{
+			uint8_t firstByte = (*children[i]->m_bytes.const_begin()).m_byte;
+
+			if( m_dispatch[dispatchOffset + firstByte] )
+			{
+				collision = true;
+				break;
+			}
+			m_dispatch[dispatchOffset + firstByte] = firstChild + i;
+		}
+		//Shouldn't happen from the tree builder, but scanning is always correct
+		if( collision )
+		{
+			m_dispatch.resize(dispatchOffset);
+		}
+		else
+		{
+			m_nodes[nodeIndex].m_dispatchOffset = dispatchOffset;
+		}
+	}
+
+	for( uint32_t i = 0; i < children.size(); ++i )
+	{
+		uv_assert_err_ret(compileNode(children[i], firstChild + i, position));
+	}
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDFLIRTCompiledSignatures::match(const uint8_t *buffer, uint32_t bufferSize, std::vector<UVDFLIRTSignatureTreeBasicNode *> &out) const
+{
+	uv_assert_ret(buffer || bufferSize == 0);
+	if( m_nodes.empty() )
+	{
+		return UV_ERR_OK;
+	}
+	matchNode(0, buffer, bufferSize, 0, out);
+
+	return UV_ERR_OK;
+}
+
+bool UVDFLIRTCompiledSignatures::matchPattern(const UVDFLIRTCompiledNode &node, const uint8_t *buffer, uint32_t bufferSize, uint32_t position) const
+{
+	const uint8_t *values = NULL;
+	const uint8_t *masks = NULL;
+	uint32_t i = 0;
+
+	if( node.m_patternLength == 0 )
+	{
+		return true;
+	}
+	if( node.m_patternLength > bufferSize - position )
+	{
+		return false;
+	}
+	buffer += position;
+	values = &m_values[node.m_patternOffset];
+	masks = &m_masks[node.m_patternOffset];
+
+	//Word at a time, memcpy keeps it legal for unaligned and compiles to a plain load
+	for( ; i + 8 <= node.m_patternLength; i += 8 )
+	{
+		uint64_t bufferWord = 0;
+		uint64_t valueWord = 0;
+		uint64_t maskWord = 0;
+
+		memcpy(&bufferWord, buffer + i, 8);
+		memcpy(&valueWord, values + i, 8);
+		memcpy(&maskWord, masks + i, 8);
+		if( (bufferWord & maskWord) != valueWord )
+		{
+			return false;
+		}
+	}
+	for( ; i < node.m_patternLength; ++i )
+	{
+		if( (buffer[i] & masks[i]) != values[i] )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void UVDFLIRTCompiledSignatures::matchNode(uint32_t nodeIndex, const uint8_t *buffer, uint32_t bufferSize, uint32_t position,
+		std::vector<UVDFLIRTSignatureTreeBasicNode *> &out) const
+{
+	const UVDFLIRTCompiledNode &node = m_nodes[nodeIndex];
+
+	if( !matchPattern(node, buffer, bufferSize, position) )
+	{
+		return;
+	}
+	position += node.m_patternLength;
+
+	if( node.m_hashCount )
+	{
+		matchHashes(node, buffer, bufferSize, position, out);
+	}
+	if( !node.m_childCount )
+	{
+		return;
+	}
+
+	//Relocation first children can't be dispatched on
+	for( uint32_t i = 0; i < node.m_wildcardChildCount; ++i )
+	{
+		matchNode(node.m_firstChild + i, buffer, bufferSize, position, out);
+	}
+	if( position >= bufferSize )
+	{
+		return;
+	}
+	if( node.m_dispatchOffset != UVD_FLIRT_COMPILED_NO_DISPATCH )
+	{
+		uint32_t childIndex = m_dispatch[node.m_dispatchOffset + buffer[position]];
+
+		if( childIndex )
+		{
+			matchNode(childIndex, buffer, bufferSize, position, out);
+		}
+	}
+	else
+	{
+		for( uint32_t i = node.m_wildcardChildCount; i < node.m_childCount; ++i )
+		{
+			uint32_t childIndex = node.m_firstChild + i;
+
+			//Cheap first byte reject before the call
+			if( m_values[m_nodes[childIndex].m_patternOffset] == buffer[position] )
+			{
+				matchNode(childIndex, buffer, bufferSize, position, out);
+			}
+		}
+	}
+}
+
+void UVDFLIRTCompiledSignatures::matchHashes(const UVDFLIRTCompiledNode &node, const uint8_t *buffer, uint32_t bufferSize, uint32_t position,
+		std::vector<UVDFLIRTSignatureTreeBasicNode *> &out) const
+{
+	//Groups are mostly the same length so cache the last crc
+	uint32_t lastCRC16Length = 0;
+	uint16_t lastCRC16 = 0x0000;
+
+	for( uint32_t hashIndex = node.m_firstHash; hashIndex < node.m_firstHash + node.m_hashCount; ++hashIndex )
+	{
+		const UVDFLIRTCompiledHash &hash = m_hashes[hashIndex];
+		uint16_t crc16 = 0x0000;
+
+		if( hash.m_crc16Length )
+		{
+			if( hash.m_crc16Length > bufferSize - position )
+			{
+				continue;
+			}
+			if( hash.m_crc16Length != lastCRC16Length )
+			{
+				lastCRC16Length = hash.m_crc16Length;
+				lastCRC16 = uvd_crc16((const char *)buffer + position, lastCRC16Length);
+			}
+			crc16 = lastCRC16;
+		}
+		if( crc16 != hash.m_crc16 )
+		{
+			continue;
+		}
+
+		for( uint32_t moduleIndex = hash.m_firstModule; moduleIndex < hash.m_firstModule + hash.m_moduleCount; ++moduleIndex )
+		{
+			UVDFLIRTSignatureTreeBasicNode *module = m_modules[moduleIndex];
+
+			//A module can't run off the end of the image
+			if( module->m_totalLength <= bufferSize )
+			{
+				out.push_back(module);
+			}
+		}
+	}
+}
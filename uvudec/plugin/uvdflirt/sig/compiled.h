@@ -0,0 +1,107 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVD_FLIRT_SIG_COMPILED_H
+#define UVD_FLIRT_SIG_COMPILED_H
+
+#include "uvd/util/types.h"
+#include <vector>
+
+/*
+Flat, read only form of a signature tree for matching
+
+The tree is good for building and dumping, but matching against it means chasing set nodes
+and decoding the escaped byte sequences one iterator step at a time
+Compiling lays it out in a few contiguous arrays:
+-Nodes in breadth first order so siblings are adjacent
+-Node bytes as value/mask pairs (relocations have mask 0), compared 8 bytes at a time
+-Nodes with many children get a 256 entry first byte dispatch table
+-CRC groups and modules are ranges into their own arrays
+
+Modules point back into the tree so the source DB must outlive this
+*/
+
+//Node has no dispatch table, scan the children
+#define UVD_FLIRT_COMPILED_NO_DISPATCH				0xFFFFFFFF
+//Nodes with at least this many fixed first byte children get a dispatch table
+#define UVD_FLIRT_COMPILED_DISPATCH_MIN_CHILDREN	8
+
+class UVDFLIRTCompiledNode
+{
+public:
+	UVDFLIRTCompiledNode();
+
+public:
+	//Bytes this node must match, index into m_values / m_masks
+	uint32_t m_patternOffset;
+	uint32_t m_patternLength;
+	/*
+	Children are contiguous in m_nodes
+	The first m_wildcardChildCount of them start with a relocation and must always be tried
+	*/
+	uint32_t m_firstChild;
+	uint32_t m_childCount;
+	uint32_t m_wildcardChildCount;
+	//Start of 256 child indexes in m_dispatch or UVD_FLIRT_COMPILED_NO_DISPATCH
+	uint32_t m_dispatchOffset;
+	//CRC groups of modules whose leading bytes end here
+	uint32_t m_firstHash;
+	uint32_t m_hashCount;
+};
+
+class UVDFLIRTCompiledHash
+{
+public:
+	UVDFLIRTCompiledHash();
+
+public:
+	uint16_t m_crc16;
+	uint32_t m_crc16Length;
+	//Range in m_modules
+	uint32_t m_firstModule;
+	uint32_t m_moduleCount;
+};
+
+class UVDFLIRTSignatureTreeBasicNode;
+class UVDFLIRTSignatureTreeLeadingNode;
+class UVDFLIRTCompiledSignatures
+{
+public:
+	UVDFLIRTCompiledSignatures();
+	~UVDFLIRTCompiledSignatures();
+	uv_err_t deinit();
+
+	//Replaces anything previously compiled
+	uv_err_t compile(UVDFLIRTSignatureTreeLeadingNode *root);
+	//Appends all modules whose leading bytes, crc16 and total length agree with buffer
+	uv_err_t match(const uint8_t *buffer, uint32_t bufferSize, std::vector<UVDFLIRTSignatureTreeBasicNode *> &out) const;
+
+	//How many bytes at most a match may need to look at
+	inline uint32_t getMaxModuleLength() const { return m_maxModuleLength; }
+
+protected:
+	//position: where treeNode's bytes start relative to the function start
+	uv_err_t compileNode(UVDFLIRTSignatureTreeLeadingNode *treeNode, uint32_t nodeIndex, uint32_t position);
+	void matchNode(uint32_t nodeIndex, const uint8_t *buffer, uint32_t bufferSize, uint32_t position,
+			std::vector<UVDFLIRTSignatureTreeBasicNode *> &out) const;
+	void matchHashes(const UVDFLIRTCompiledNode &node, const uint8_t *buffer, uint32_t bufferSize, uint32_t position,
+			std::vector<UVDFLIRTSignatureTreeBasicNode *> &out) const;
+	bool matchPattern(const UVDFLIRTCompiledNode &node, const uint8_t *buffer, uint32_t bufferSize, uint32_t position) const;
+
+public:
+	//m_nodes[0] is the root, which has no bytes
+	std::vector<UVDFLIRTCompiledNode> m_nodes;
+	std::vector<uint8_t> m_values;
+	std::vector<uint8_t> m_masks;
+	//Child node index for each first byte, 0 (the root) if none
+	std::vector<uint32_t> m_dispatch;
+	std::vector<UVDFLIRTCompiledHash> m_hashes;
+	//We do not own these
+	std::vector<UVDFLIRTSignatureTreeBasicNode *> m_modules;
+	uint32_t m_maxModuleLength;
+};
+
+#endif
@@ -0,0 +1,398 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include "uvdflirt/config.h"
+#include "uvdflirt/sig/compiled.h"
+#include "uvdflirt/sig/match.h"
+#include "uvdflirt/sig/sig.h"
+#include "uvdflirt/sig/tree/tree.h"
+#include "uvd/assembly/address.h"
+#include "uvd/assembly/function.h"
+#include "uvd/assembly/symbol.h"
+#include "uvd/core/analyzer.h"
+#include "uvd/core/runtime.h"
+#include "uvd/core/uvd.h"
+#include "uvd/hash/crc.h"
+#include "uvd/util/benchmark.h"
+#include "uvd/util/profile.h"
+#include "uvd/util/debug.h"
+#include "uvd/util/thread.h"
+#include "uvd/util/util.h"
+
+UVDFLIRTSignatureMatcher::UVDFLIRTSignatureMatcher()
+{
+	m_maxModuleLength = 0;
+}
+
+UVDFLIRTSignatureMatcher::~UVDFLIRTSignatureMatcher()
+{
+	UV_DEBUG(deinit());
+}
+
+uv_err_t UVDFLIRTSignatureMatcher::init()
+{
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDFLIRTSignatureMatcher::deinit()
+{
+	for( std::vector<UVDFLIRTCompiledSignatures *>::iterator iter = m_compiled.begin(); iter != m_compiled.end(); ++iter )
+	{
+		delete *iter;
+	}
+	m_compiled.clear();
+	for( std::vector<UVDFLIRTSignatureDB *>::iterator iter = m_dbs.begin(); iter != m_dbs.end(); ++iter )
+	{
+		delete *iter;
+	}
+	m_dbs.clear();
+	m_maxModuleLength = 0;
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDFLIRTSignatureMatcher::loadFile(const std::string &file)
+{
+	UVDFLIRTSignatureDB *db = NULL;
+	std::string patExtension = ".pat";
+
+	db = new UVDFLIRTSignatureDB();
+	uv_assert_ret(db);
+	uv_assert_err_ret(db->init());
+
+	printf_flirt_debug("loading signature file %s\n", file.c_str());
+	if( file.size() >= patExtension.size()
+			&& file.compare(file.size() - patExtension.size(), patExtension.size(), patExtension) == 0 )
+	{
+		uv_assert_err_ret(db->loadFromPatFile(file));
+	}
+	else
+	{
+		uv_assert_err_ret(db->loadSigFile(file));
+	}
+	uv_assert_err_ret(addDB(db));
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDFLIRTSignatureMatcher::addDB(UVDFLIRTSignatureDB *db)
+{
+	uv_assert_ret(db);
+	m_dbs.push_back(db);
+	//Empty files won't have a tree
+	if( db->m_tree )
+	{
+		UVDFLIRTCompiledSignatures *compiled = NULL;
+		
+		compiled = new UVDFLIRTCompiledSignatures();
+		uv_assert_ret(compiled);
+		m_compiled.push_back(compiled);
+		uv_assert_err_ret(compiled->compile(db->m_tree));
+		m_maxModuleLength = uvd_max(m_maxModuleLength, compiled->getMaxModuleLength());
+	}
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDFLIRTSignatureMatcher::match(const uint8_t *buffer, uint32_t bufferSize, std::vector<UVDFLIRTSignatureTreeBasicNode *> &out) const
+{
+	uv_assert_ret(buffer || bufferSize == 0);
+	out.clear();
+	for( std::vector<UVDFLIRTCompiledSignatures *>::const_iterator iter = m_compiled.begin(); iter != m_compiled.end(); ++iter )
+	{
+		uv_assert_ret(*iter);
+		uv_assert_err_ret((*iter)->match(buffer, bufferSize, out));
+	}
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDFLIRTSignatureMatcher::getReferenceScore(UVDAnalyzer *analyzer, UVDBinaryFunction *function, const UVDFLIRTSignatureTreeBasicNode *node,
+		uint32_t *out) const
+{
+	uint32_t score = 0;
+
+	uv_assert_ret(analyzer);
+	uv_assert_ret(function);
+	uv_assert_ret(node);
+	uv_assert_ret(out);
+
+	if( node->m_references.empty() )
+	{
+		*out = 0;
+		return UV_ERR_OK;
+	}
+
+	/*
+	A reference agrees if analysis found a relocation at the same offset to a symbol that goes by that name
+	Names come from the symbol table or earlier matches
+	*/
+	for( std::set<UVDRelocationFixup *>::iterator fixupIter = function->m_relocatableData.m_fixups.begin();
+			fixupIter != function->m_relocatableData.m_fixups.end(); ++fixupIter )
+	{
+		UVDRelocationFixup *fixup = *fixupIter;
+		UVDBinarySymbolElement *binarySymbolElement = NULL;
+		UVDBinarySymbol *target = NULL;
+		uint32_t targetAddress = 0;
+		std::set<std::string> targetNames;
+
+		uv_assert_ret(fixup);
+		binarySymbolElement = dynamic_cast<UVDBinarySymbolElement *>(fixup->m_symbol);
+		if( !binarySymbolElement )
+		{
+			continue;
+		}
+		uv_assert_err_ret(binarySymbolElement->getDynamicValue(&targetAddress));
+		if( UV_FAILED(analyzer->m_symbolManager.findSymbolByAddress(targetAddress, &target)) || !target )
+		{
+			continue;
+		}
+		uv_assert_err_ret(target->getSymbolNames(targetNames));
+
+		for( std::vector<UVDFLIRTSignatureReference>::const_iterator refIter = node->m_references.begin();
+				refIter != node->m_references.end(); ++refIter )
+		{
+			const UVDFLIRTSignatureReference &reference = *refIter;
+
+			if( reference.m_offset == fixup->m_offset && targetNames.find(reference.m_name) != targetNames.end() )
+			{
+				++score;
+			}
+		}
+	}
+
+	*out = score;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDFLIRTSignatureMatcher::choose(UVDAnalyzer *analyzer, UVDBinaryFunction *function, const std::vector<UVDFLIRTSignatureTreeBasicNode *> &candidates,
+		UVDFLIRTSignatureTreeBasicNode **out) const
+{
+	UVDFLIRTSignatureTreeBasicNode *best = NULL;
+	uint32_t bestScore = 0;
+	bool bestLengthMatches = false;
+	bool ambiguous = false;
+	uint32_t functionSize = 0;
+
+	uv_assert_ret(function);
+	uv_assert_ret(out);
+
+	if( candidates.empty() )
+	{
+		return UV_ERR_NOTFOUND;
+	}
+	uv_assert_err_ret(function->getSymbolSize(&functionSize));
+
+	for( std::vector<UVDFLIRTSignatureTreeBasicNode *>::const_iterator iter = candidates.begin(); iter != candidates.end(); ++iter )
+	{
+		UVDFLIRTSignatureTreeBasicNode *candidate = *iter;
+		uint32_t score = 0;
+		bool lengthMatches = false;
+
+		uv_assert_ret(candidate);
+		uv_assert_err_ret(getReferenceScore(analyzer, function, candidate, &score));
+		lengthMatches = candidate->m_totalLength == functionSize;
+
+		if( !best || score > bestScore || (score == bestScore && lengthMatches && !bestLengthMatches) )
+		{
+			best = candidate;
+			bestScore = score;
+			bestLengthMatches = lengthMatches;
+			ambiguous = false;
+		}
+		else if( score == bestScore && lengthMatches == bestLengthMatches )
+		{
+			//Duplicate modules (ex: same object in two libraries) are fine as long as they agree on the names
+			if( candidate->m_publicNames.size() != best->m_publicNames.size() )
+			{
+				ambiguous = true;
+			}
+			else
+			{
+				for( uint32_t i = 0; i < candidate->m_publicNames.size(); ++i )
+				{
+					if( candidate->m_publicNames[i].m_name != best->m_publicNames[i].m_name
+							|| candidate->m_publicNames[i].getOffset() != best->m_publicNames[i].getOffset() )
+					{
+						ambiguous = true;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	if( ambiguous )
+	{
+		return UV_ERR_NOTFOUND;
+	}
+	*out = best;
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDFLIRTSignatureMatcher::applyNames(UVDAnalyzer *analyzer, UVDBinaryFunction *function, UVDFLIRTSignatureTreeBasicNode *node, uint32_t *namedOut)
+{
+	uv_addr_t functionAddress = 0;
+
+	uv_assert_ret(analyzer);
+	uv_assert_ret(function);
+	uv_assert_ret(node);
+	uv_assert_ret(namedOut);
+
+	uv_assert_err_ret(function->getSymbolAddress(&functionAddress));
+	for( std::vector<UVDFLIRTPublicName>::iterator iter = node->m_publicNames.begin(); iter != node->m_publicNames.end(); ++iter )
+	{
+		UVDFLIRTPublicName &publicName = *iter;
+		UVDBinarySymbol *symbol = NULL;
+		uv_err_t rc = UV_ERR_GENERAL;
+
+		//FLAIR uses short names (ex: ?) for unknown
+		if( publicName.isLocal() || publicName.m_name.size() < g_UVDFLIRTConfig->m_patternPublicNameLengthMin )
+		{
+			continue;
+		}
+
+		if( publicName.getOffset() == 0 )
+		{
+			symbol = function;
+		}
+		//Other entry points into the module only get named if analysis found them
+		else if( UV_FAILED(analyzer->m_symbolManager.findSymbolByAddress(functionAddress + publicName.getOffset(), &symbol)) || !symbol )
+		{
+			continue;
+		}
+
+		rc = analyzer->m_symbolManager.setSymbolName(symbol, publicName.m_name);
+		if( rc == UV_ERR_DUPLICATE )
+		{
+			//Statically linked twice or a false positive, either way keep the first
+			printf_flirt_debug("0x%08X: %s already used, not renaming\n", functionAddress + publicName.getOffset(), publicName.m_name.c_str());
+			continue;
+		}
+		uv_assert_err_ret(rc);
+		printf_flirt_debug("0x%08X: identified as %s\n", functionAddress + publicName.getOffset(), publicName.m_name.c_str());
+		++*namedOut;
+	}
+
+	return UV_ERR_OK;
+}
+
+/*
+identifyFunctions() work shared between the pool threads
+Each index only touches its own slot in m_matches
+*/
+class UVDFLIRTMatchJob
+{
+public:
+	UVDFLIRTSignatureMatcher *m_matcher;
+	UVDAnalyzer *m_analyzer;
+	UVDAddressSpace *m_addressSpace;
+	std::vector<UVDBinaryFunction *> m_functions;
+	//Indexed same as m_functions, NULL if no (unambiguous) match
+	std::vector<UVDFLIRTSignatureTreeBasicNode *> m_matches;
+};
+
+static uv_err_t matchFunction(uint32_t index, uint32_t, void *user)
+{
+	UVDFLIRTMatchJob *job = (UVDFLIRTMatchJob *)user;
+	UVDBinaryFunction *function = NULL;
+	uv_addr_t functionAddress = 0;
+	uint32_t dataSize = 0;
+	uint32_t viewSize = 0;
+	UVDDataView view;
+	std::vector<UVDFLIRTSignatureTreeBasicNode *> candidates;
+	UVDFLIRTSignatureTreeBasicNode *best = NULL;
+
+	uv_assert_ret(job);
+	uv_assert_ret(index < job->m_functions.size());
+	function = job->m_functions[index];
+	uv_assert_ret(function);
+
+	uv_assert_err_ret(function->getSymbolAddress(&functionAddress));
+	uv_assert_err_ret(job->m_addressSpace->m_data->size(&dataSize));
+	if( functionAddress >= dataSize )
+	{
+		return UV_ERR_OK;
+	}
+	viewSize = uvd_min(dataSize - functionAddress, job->m_matcher->getMaxModuleLength());
+	uv_assert_err_ret(job->m_addressSpace->m_data->getView(functionAddress, viewSize, view));
+
+	uv_assert_err_ret(job->m_matcher->match(view.begin(), view.size(), candidates));
+	if( UV_SUCCEEDED(job->m_matcher->choose(job->m_analyzer, function, candidates, &best)) )
+	{
+		job->m_matches[index] = best;
+	}
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDFLIRTSignatureMatcher::identifyFunctions(UVDAnalyzer *analyzer)
+{
+	UVDProfileScope profileScope("flirt");
+	UVDFLIRTMatchJob job;
+	UVDThreadPool *threadPool = NULL;
+	UVDBenchmark benchmark;
+	uint32_t identified = 0;
+	uint32_t pass = 0;
+
+	uv_assert_ret(analyzer);
+	uv_assert_ret(analyzer->m_uvd);
+	uv_assert_ret(analyzer->m_uvd->m_runtime);
+
+	if( m_dbs.empty() || analyzer->m_functions.empty() )
+	{
+		return UV_ERR_OK;
+	}
+
+	benchmark.start();
+	job.m_matcher = this;
+	job.m_analyzer = analyzer;
+	uv_assert_err_ret(analyzer->m_uvd->m_runtime->getPrimaryExecutableAddressSpace(&job.m_addressSpace));
+	uv_assert_ret(job.m_addressSpace);
+	uv_assert_ret(job.m_addressSpace->m_data);
+	//m_functions is ordered by pointer, names must not depend on heap layout
+	uv_assert_err_ret(analyzer->getFunctionsByAddress(job.m_functions));
+	uv_assert_err_ret(analyzer->getThreadPool(&threadPool));
+
+	/*
+	Names from one pass can settle reference ties in the next
+	Only functions that haven't been named are retried
+	*/
+	for( ;; )
+	{
+		std::vector<UVDBinaryFunction *> unmatched;
+		uint32_t named = 0;
+
+		++pass;
+		job.m_matches.assign(job.m_functions.size(), NULL);
+		uv_assert_err_ret(threadPool->run(job.m_functions.size(), matchFunction, &job));
+
+		//Apply in address order so naming conflicts resolve the same regardless of thread count
+		for( uint32_t i = 0; i < job.m_functions.size(); ++i )
+		{
+			if( job.m_matches[i] )
+			{
+				uv_assert_err_ret(applyNames(analyzer, job.m_functions[i], job.m_matches[i], &named));
+				++identified;
+			}
+			else
+			{
+				unmatched.push_back(job.m_functions[i]);
+			}
+		}
+		if( named == 0 || unmatched.empty() )
+		{
+			break;
+		}
+		job.m_functions = unmatched;
+	}
+	benchmark.stop();
+
+	printf_debug_level(UVD_DEBUG_PASSES, "FLIRT: identified %d / %d functions in %d passes on %d threads, time: %s\n",
+			identified, analyzer->m_functions.size(), pass, threadPool->getThreadCount(), benchmark.toString().c_str());
+
+	return UV_ERR_OK;
+}
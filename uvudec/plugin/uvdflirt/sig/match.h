@@ -0,0 +1,82 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVD_FLIRT_SIG_MATCH_H
+#define UVD_FLIRT_SIG_MATCH_H
+
+#include "uvd/util/types.h"
+#include <string>
+#include <vector>
+
+/*
+Identifies analyzed functions against signature databases
+
+Each DB is compiled (see compiled.h) when added
+For each function start:
+-Walk the leading byte tree, relocation bytes match anything
+-At each node with modules, verify the crc16 over the bytes after the leading bytes
+-Modules must fit in the image (total length)
+-Remaining candidates are ranked by how many of their references agree with analysis
+	and then whether their total length is the analyzed function size
+Ambiguous matches (different names, same rank) are not named
+
+Matching only reads the tree and analysis and so is run on the analyzer thread pool
+Names are applied serially afterwards
+*/
+
+class UVDAnalyzer;
+class UVDBinaryFunction;
+class UVDFLIRTCompiledSignatures;
+class UVDFLIRTSignatureDB;
+class UVDFLIRTSignatureTreeBasicNode;
+class UVDFLIRTSignatureMatcher
+{
+public:
+	UVDFLIRTSignatureMatcher();
+	~UVDFLIRTSignatureMatcher();
+	uv_err_t init();
+	uv_err_t deinit();
+
+	//.pat files are recognized by extension, anything else is assumed to be a .sig file
+	uv_err_t loadFile(const std::string &file);
+	//We take ownership of db
+	uv_err_t addDB(UVDFLIRTSignatureDB *db);
+
+	/*
+	All modules whose leading bytes, crc16 and total length agree with buffer
+	buffer should start at the candidate function and hold as many bytes as are in the image
+		up to getMaxModuleLength()
+	*/
+	uv_err_t match(const uint8_t *buffer, uint32_t bufferSize, std::vector<UVDFLIRTSignatureTreeBasicNode *> &out) const;
+	/*
+	Pick a module from match() results using analysis of function
+	Returns UV_ERR_NOTFOUND if there were no candidates or it was ambiguous
+	*/
+	uv_err_t choose(UVDAnalyzer *analyzer, UVDBinaryFunction *function, const std::vector<UVDFLIRTSignatureTreeBasicNode *> &candidates,
+			UVDFLIRTSignatureTreeBasicNode **out) const;
+
+	//Match all analyzed functions and rename the ones we recognize
+	uv_err_t identifyFunctions(UVDAnalyzer *analyzer);
+
+	//How many bytes at most a match may need to look at
+	inline uint32_t getMaxModuleLength() const { return m_maxModuleLength; }
+
+protected:
+	//How many references in node agree with the relocations in function
+	uv_err_t getReferenceScore(UVDAnalyzer *analyzer, UVDBinaryFunction *function, const UVDFLIRTSignatureTreeBasicNode *node,
+			uint32_t *out) const;
+	//Give function (and any other public names in node) their library names
+	uv_err_t applyNames(UVDAnalyzer *analyzer, UVDBinaryFunction *function, UVDFLIRTSignatureTreeBasicNode *node, uint32_t *namedOut);
+
+public:
+	//We own these
+	std::vector<UVDFLIRTSignatureDB *> m_dbs;
+	//Matching form of each DB with a tree, we own these
+	std::vector<UVDFLIRTCompiledSignatures *> m_compiled;
+	uint32_t m_maxModuleLength;
+};
+
+#endif
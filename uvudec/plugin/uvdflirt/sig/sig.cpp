@@ -157,10 +157,16 @@ uv_err_t UVDFLIRTSignatureDB::writeToData(UVDData **out)
 
 uv_err_t UVDFLIRTSignatureDB::loadFromPatFile(const std::string &fileNameIn)
 {
-	std::string fileContents;
+	UVDData *data = NULL;
+	UVDPatLoaderCore loader(this, fileNameIn);
+	uv_err_t rc = UV_ERR_GENERAL;
 	
-	uv_assert_err_ret(readFile(fileNameIn, fileContents));
-	uv_assert_err_ret(loadFromPatFileString(fileContents));
+	//Corpora can be large, stream instead of reading it all into a string
+	uv_assert_err_ret(UVDDataFile::getUVDDataFile(&data, fileNameIn));
+	uv_assert_ret(data);
+	rc = loader.fromData(data);
+	delete data;
+	uv_assert_err_ret(rc);
 
 	return UV_ERR_OK;
 }
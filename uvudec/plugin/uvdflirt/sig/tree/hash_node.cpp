@@ -28,6 +28,7 @@ UVDFLIRTSignatureTreeHashNode::UVDFLIRTSignatureTreeHashNode()
 {
 	m_crc16 = 0;
 	m_leadingLength = 0;
+	m_crc16Length = 0;
 }
 
 UVDFLIRTSignatureTreeHashNode::UVDFLIRTSignatureTreeHashNode(const UVDFLIRTModule *function)
@@ -38,6 +39,7 @@ UVDFLIRTSignatureTreeHashNode::UVDFLIRTSignatureTreeHashNode(const UVDFLIRTModul
 	}
 	m_crc16 = function->m_crc16;
 	m_leadingLength = uvd_min(function->m_sequence.size(), g_UVDFLIRTConfig->m_patLeadingLength);
+	m_crc16Length = function->m_crc16Length;
 }
 
 UVDFLIRTSignatureTreeHashNode::~UVDFLIRTSignatureTreeHashNode()
@@ -98,17 +100,21 @@ int UVDFLIRTSignatureTreeHashNode::compare(const UVDFLIRTSignatureTreeHashNode *
 	{
 		return m_crc16 - r->m_crc16;
 	}
-	else
+	else if( m_leadingLength != r->m_leadingLength )
 	{
 		return m_leadingLength - r->m_leadingLength;
 	}
+	else
+	{
+		return m_crc16Length - r->m_crc16Length;
+	}
 }
 
 uv_err_t UVDFLIRTSignatureTreeHashNode::debugDump(const std::string &prefix, uint32_t hashNodeIndex)
 {
 	uint32_t basicNodeIndex = 0;
 
-	printf("%s%d) CRC16:0x%.4X leadingLength:0x%.2X\n", prefix.c_str(), hashNodeIndex, m_crc16, m_leadingLength);
+	printf("%s%d) CRC16:0x%.4X leadingLength:0x%.2X crc16Length:0x%.2X\n", prefix.c_str(), hashNodeIndex, m_crc16, m_leadingLength, m_crc16Length);
 	for( BasicSet::iterator iter = m_bucket.begin(); iter != m_bucket.end(); ++iter )
 	{
 		UVDFLIRTSignatureTreeBasicNode *basicNode = *iter;
@@ -139,6 +139,8 @@ public:
 	//Entire length including prefix and tailing bytes, if present
 	uint16_t m_crc16;
 	uint32_t m_leadingLength;
+	//How many bytes after the leading bytes m_crc16 was computed over
+	uint32_t m_crc16Length;
 };
 
 struct UVDFLIRTSignatureTreeHashNodeCompare
@@ -298,8 +298,8 @@ uv_err_t UVDFLIRTSignatureDBWriter::constructCRCNode(UVDFLIRTSignatureTreeLeadin
 		uint32_t a_crc16 = read16();
 		*/
 		uv_assert_ret(hashNode);
-		printf_flirt_debug("leading length: 0x%02X\n", hashNode->m_leadingLength);
-		uv_assert_err_ret(uint8Append(hashNode->m_leadingLength));
+		printf_flirt_debug("CRC16 length: 0x%02X\n", hashNode->m_crc16Length);
+		uv_assert_err_ret(uint8Append(hashNode->m_crc16Length));
 		printf_flirt_debug("CRC16: 0x%02X\n", hashNode->m_crc16);
 		uv_assert_err_ret(uint16Append(hashNode->m_crc16));
 		for( UVDFLIRTSignatureTreeHashNode::BasicSet::iterator basicIter = hashNode->m_bucket.begin(); basicIter != hashNode->m_bucket.end(); ++basicIter )
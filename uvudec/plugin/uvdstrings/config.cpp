@@ -7,6 +7,9 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvdstrings/config.h"
 #include "uvdstrings/plugin.h"
 #include "uvd/util/debug.h"
+#include "uvd/util/util.h"
+
+UVDStringsConfig *g_stringsConfig = NULL;
 
 static uv_err_t argParser(const UVDArgConfig *argConfig, std::vector<std::string> argumentArguments, void *user)
 {
@@ -27,10 +30,15 @@ static uv_err_t argParser(const UVDArgConfig *argConfig, std::vector<std::string
 		firstArgNum = strtol(firstArg.c_str(), NULL, 0);
 	}
 
-	if( argConfig->m_propertyForm == UVDBFD_ARCHITECTURE_HINT )
+	if( argConfig->m_propertyForm == UVDSTRINGS_ENCODINGS )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		uv_assert_err_ret(UVDStringsConfig::parseEncodings(firstArg, &g_stringsConfig->m_encodings));
+	}
+	else if( argConfig->m_propertyForm == UVDSTRINGS_MIN_LENGTH )
 	{
 		uv_assert_ret(!argumentArguments.empty());
-		g_bfdConfig->m_architecture = firstArg;
+		g_stringsConfig->m_minLength = firstArgNum;
 	}
 	else
 	{
@@ -41,21 +49,80 @@ static uv_err_t argParser(const UVDArgConfig *argConfig, std::vector<std::string
 	return UV_ERR_OK;
 }
 
-UVDStringsConfig::UVDBFDConfig()
+UVDStringsConfig::UVDStringsConfig()
 {
-	g_bfdConfig = this;
+	g_stringsConfig = this;
 
-	m_architecture = UVDBFD_ARCHITECTURE_HINT_DEFAULT;
+	m_encodings = UVDSTRINGS_ENCODINGS_DEFAULT;
+	m_minLength = UVDSTRINGS_MIN_LENGTH_DEFAULT;
 }
 
-UVDStringsConfig::~UVDBFDConfig()
+UVDStringsConfig::~UVDStringsConfig()
 {
 }
 
 uv_err_t UVDStringsConfig::init(UVDConfig *config)
 {
-	uv_assert_err_ret(g_bfdPlugin->registerArgument(UVDBFD_ARCHITECTURE_HINT, 0, "encoding", "string encodings to look for", 1, argParser, true));
+	uv_assert_ret(g_stringsPlugin);
+	uv_assert_err_ret(g_stringsPlugin->registerArgument(UVDSTRINGS_ENCODINGS, 0, "strings-encodings",
+			"encodings to look for, comma separated: ascii, be16, le16, be32, le32, ebcdic or all", 1, argParser, true));
+	uv_assert_err_ret(g_stringsPlugin->registerArgument(UVDSTRINGS_MIN_LENGTH, 0, "strings-min-length",
+			"strings must be longer than this many characters", 1, argParser, true));
 
 	return UV_ERR_OK;
 }
 
+uv_err_t UVDStringsConfig::parseEncodings(const std::string &in, uint32_t *out)
+{
+	std::vector<std::string> names = split(in, ',', false);
+	uint32_t encodings = 0;
+	
+	uv_assert_ret(out);
+	for( std::vector<std::string>::iterator iter = names.begin(); iter != names.end(); ++iter )
+	{
+		const std::string &name = *iter;
+		
+		if( name == "all" )
+		{
+			encodings |= UVD_STRING_ENCODINGS_ALL;
+		}
+		else if( name == "ascii" )
+		{
+			encodings |= UVD_STRING_ENCODING_BIT(UVD_STRING_ENCODING_ASCII);
+		}
+		else if( name == "be16" )
+		{
+			encodings |= UVD_STRING_ENCODING_BIT(UVD_STRING_ENCODING_BIG_ENDIAN16);
+		}
+		else if( name == "le16" )
+		{
+			encodings |= UVD_STRING_ENCODING_BIT(UVD_STRING_ENCODING_LITTLE_ENDIAN16);
+		}
+		else if( name == "be32" )
+		{
+			encodings |= UVD_STRING_ENCODING_BIT(UVD_STRING_ENCODING_BIG_ENDIAN32);
+		}
+		else if( name == "le32" )
+		{
+			encodings |= UVD_STRING_ENCODING_BIT(UVD_STRING_ENCODING_LITTLE_ENDIAN32);
+		}
+		else if( name == "ebcdic" )
+		{
+			encodings |= UVD_STRING_ENCODING_BIT(UVD_STRING_ENCODING_EBCDIC);
+		}
+		else
+		{
+			printf_error("unknown string encoding: %s\n", name.c_str());
+			return UV_DEBUG(UV_ERR_GENERAL);
+		}
+	}
+	if( !encodings )
+	{
+		printf_error("no string encodings given\n");
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	*out = encodings;
+	
+	return UV_ERR_OK;
+}
+
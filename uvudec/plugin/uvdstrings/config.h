@@ -4,15 +4,20 @@ Copyright 2010 John McMaster <JohnDMcMaster@gmail.com>
 Licensed under the terms of the LGPL V3 or later, see COPYING for details
 */
 
-#ifndef UVDBFD_CONFIG_H
-#define UVDBFD_CONFIG_H
+#ifndef UVDSTRINGS_CONFIG_H
+#define UVDSTRINGS_CONFIG_H
 
 #include "uvd/config/config.h"
+#include "uvd/plugin/plugin.h"
+#include "uvdstrings/scanner.h"
 #include <string>
 
-#define UVDSTRINGS_ENCODINGS						UVD_PLUGIN_PROPERTY("encoding")
-//ASCII probably
-#define UVDSTRINGS_ENCODINGS_DEFAULT				""
+//Comma separated: ascii, be16, le16, be32, le32, ebcdic or all
+#define UVDSTRINGS_ENCODINGS						UVD_PLUGIN_PROPERTY("encodings")
+#define UVDSTRINGS_ENCODINGS_DEFAULT				UVD_STRING_ENCODINGS_ALL
+//Strings must be longer than this many characters
+#define UVDSTRINGS_MIN_LENGTH						UVD_PLUGIN_PROPERTY("min_length")
+#define UVDSTRINGS_MIN_LENGTH_DEFAULT				3
 
 class UVDStringsConfig
 {
@@ -21,10 +26,17 @@ public:
 	~UVDStringsConfig();
 	
 	uv_err_t init(UVDConfig *config);
+	
+	//Comma separated encoding names to a mask of UVD_STRING_ENCODING_BIT()
+	static uv_err_t parseEncodings(const std::string &in, uint32_t *out);
 
 public:
-	std::string m_architecture;
+	//Mask of UVD_STRING_ENCODING_BIT()
+	uint32_t m_encodings;
+	uint32_t m_minLength;
 };
 
+extern UVDStringsConfig *g_stringsConfig;
+
 #endif
 
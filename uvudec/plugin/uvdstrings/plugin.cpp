@@ -10,8 +10,11 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvdstrings/plugin.h"
 #include "uvdstrings/strings.h"
 
+UVDStringsPlugin *g_stringsPlugin = NULL;
+
 UVDStringsPlugin::UVDStringsPlugin()
 {
+	g_stringsPlugin = this;
 }
 
 UVDStringsPlugin::~UVDStringsPlugin()
@@ -21,6 +24,7 @@ UVDStringsPlugin::~UVDStringsPlugin()
 uv_err_t UVDStringsPlugin::init(UVDConfig *config)
 {
 	uv_assert_err_ret(UVDPlugin::init(config));
+	uv_assert_err_ret(m_config.init(config));
 	return UV_ERR_OK;
 }
 
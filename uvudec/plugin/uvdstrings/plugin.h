@@ -9,6 +9,7 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 
 #include "uvd/plugin/plugin.h"
 #include "uvd/util/types.h"
+#include "uvdstrings/config.h"
 
 class UVDStringsPlugin : public UVDPlugin
 {
@@ -24,7 +25,10 @@ public:
 	virtual uv_err_t getStringsAnalyzer(UVDStringsAnalyzer **out);
 
 public:
+	UVDStringsConfig m_config;
 };
 
+extern UVDStringsPlugin *g_stringsPlugin;
+
 #endif
 
@@ -0,0 +1,444 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include "uvd/util/debug.h"
+#include "uvd/util/error.h"
+#include "uvd/util/profile.h"
+#include "uvdstrings/scanner.h"
+#include <algorithm>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define UVD_STRING_SCANNER_PRINTABLE_FIRST		0x20
+#define UVD_STRING_SCANNER_PRINTABLE_LAST		0x7E
+
+/*
+Bitmap of the byte k positions after each byte
+next is the word following word
+*/
+static inline uint64_t shiftDown(uint64_t word, uint64_t next, unsigned int k)
+{
+	return (word >> k) | (next << (64 - k));
+}
+
+static unsigned int getStride(UVDStringEncoding encoding)
+{
+	return UVDString::getCharacterSize(encoding);
+}
+
+#ifdef __SSE2__
+//Bit per byte in [first, last], compared as unsigned
+static inline uint32_t rangeMask(__m128i bytes, uint8_t first, uint8_t last)
+{
+	//x in range iff x - first <= last - first
+	__m128i offset = _mm_sub_epi8(bytes, _mm_set1_epi8((char)first));
+	__m128i span = _mm_set1_epi8((char)(last - first));
+
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(offset, span), offset));
+}
+#endif
+
+/*
+UVDStringScanner::Match
+*/
+
+UVDStringScanner::Match::Match()
+{
+	m_offset = 0;
+	m_size = 0;
+	m_encoding = UVD_STRING_ENCODING_UNKNOWN;
+}
+
+UVDStringScanner::Match::Match(uint32_t offset, uint32_t size, UVDStringEncoding encoding)
+{
+	m_offset = offset;
+	m_size = size;
+	m_encoding = encoding;
+}
+
+bool UVDStringScanner::Match::operator<(const Match &other) const
+{
+	if( m_offset != other.m_offset )
+	{
+		return m_offset < other.m_offset;
+	}
+	return m_size > other.m_size;
+}
+
+/*
+UVDStringScanner
+*/
+
+UVDStringScanner::UVDStringScanner()
+{
+	m_encodings = UVD_STRING_ENCODINGS_ALL;
+	m_minLength = 3;
+	m_words = 0;
+	memset(m_classes, 0, sizeof(m_classes));
+}
+
+UVDStringScanner::~UVDStringScanner()
+{
+}
+
+uv_err_t UVDStringScanner::init(uint32_t encodings, uint32_t minLength)
+{
+	m_encodings = encodings;
+	m_minLength = minLength;
+
+	memset(m_classes, 0, sizeof(m_classes));
+	for( unsigned int c = UVD_STRING_SCANNER_PRINTABLE_FIRST; c <= UVD_STRING_SCANNER_PRINTABLE_LAST; ++c )
+	{
+		m_classes[c] |= UVD_STRING_SCANNER_CLASS_PRINTABLE;
+	}
+	m_classes[0] |= UVD_STRING_SCANNER_CLASS_ZERO;
+	for( unsigned int c = 0x80; c < 0x100; ++c )
+	{
+		m_classes[c] |= UVD_STRING_SCANNER_CLASS_HIGH;
+	}
+	for( unsigned int c = 0; c < 0x100; ++c )
+	{
+		if( UVDEBCDICToASCII(c) )
+		{
+			m_classes[c] |= UVD_STRING_SCANNER_CLASS_EBCDIC;
+		}
+	}
+
+	return UV_ERR_OK;
+}
+
+void UVDStringScanner::classify(const uint8_t *buffer, uint32_t size)
+{
+	//Plus one trailing zero word for looking ahead
+	m_words = (size + 63) / 64;
+	m_printable.assign(m_words + 1, 0);
+	m_zero.assign(m_words + 1, 0);
+	m_high.assign(m_words + 1, 0);
+	m_ebcdic.assign(m_words + 1, 0);
+
+	for( uint32_t word = 0; word < m_words; ++word )
+	{
+		uint32_t offset = word * 64;
+		uint32_t remaining = size - offset;
+		uint64_t printable = 0;
+		uint64_t zero = 0;
+		uint64_t high = 0;
+		uint64_t ebcdic = 0;
+
+#ifdef __SSE2__
+		if( remaining >= 64 )
+		{
+			for( unsigned int block = 0; block < 4; ++block )
+			{
+				__m128i bytes = _mm_loadu_si128((const __m128i *)(buffer + offset + block * 16));
+				uint32_t blockEBCDIC = 0;
+				unsigned int shift = block * 16;
+
+				printable |= (uint64_t)rangeMask(bytes, UVD_STRING_SCANNER_PRINTABLE_FIRST, UVD_STRING_SCANNER_PRINTABLE_LAST) << shift;
+				zero |= (uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_setzero_si128())) << shift;
+				high |= (uint64_t)_mm_movemask_epi8(bytes) << shift;
+				if( m_encodings & UVD_STRING_ENCODING_BIT(UVD_STRING_ENCODING_EBCDIC) )
+				{
+					for( unsigned int i = 0; i < g_ebcdicPrintableRangeCount; ++i )
+					{
+						const UVDEBCDICRange &range = g_ebcdicPrintableRanges[i];
+
+						blockEBCDIC |= rangeMask(bytes, range.m_first, range.m_first + strlen(range.m_ascii) - 1);
+					}
+					ebcdic |= (uint64_t)blockEBCDIC << shift;
+				}
+			}
+		}
+		else
+#endif
+		{
+			uint32_t count = remaining < 64 ? remaining : 64;
+
+			for( uint32_t i = 0; i < count; ++i )
+			{
+				uint8_t classes = m_classes[buffer[offset + i]];
+				uint64_t bit = 1ULL << i;
+
+				if( classes & UVD_STRING_SCANNER_CLASS_PRINTABLE )
+				{
+					printable |= bit;
+				}
+				if( classes & UVD_STRING_SCANNER_CLASS_ZERO )
+				{
+					zero |= bit;
+				}
+				if( classes & UVD_STRING_SCANNER_CLASS_HIGH )
+				{
+					high |= bit;
+				}
+				if( classes & UVD_STRING_SCANNER_CLASS_EBCDIC )
+				{
+					ebcdic |= bit;
+				}
+			}
+		}
+
+		m_printable[word] = printable;
+		m_zero[word] = zero;
+		m_high[word] = high;
+		m_ebcdic[word] = ebcdic;
+	}
+}
+
+uint64_t UVDStringScanner::getCharacterWord(UVDStringEncoding encoding, uint32_t word) const
+{
+	uint64_t printable = 0;
+	uint64_t printableNext = 0;
+	uint64_t zero = 0;
+	uint64_t zeroNext = 0;
+
+	if( word >= m_words )
+	{
+		return 0;
+	}
+	printable = m_printable[word];
+	printableNext = m_printable[word + 1];
+	zero = m_zero[word];
+	zeroNext = m_zero[word + 1];
+
+	switch( encoding )
+	{
+	case UVD_STRING_ENCODING_ASCII:
+		return printable;
+	case UVD_STRING_ENCODING_EBCDIC:
+		return m_ebcdic[word];
+	case UVD_STRING_ENCODING_LITTLE_ENDIAN16:
+		return printable & shiftDown(zero, zeroNext, 1);
+	case UVD_STRING_ENCODING_BIG_ENDIAN16:
+		return zero & shiftDown(printable, printableNext, 1);
+	case UVD_STRING_ENCODING_LITTLE_ENDIAN32:
+		return printable & shiftDown(zero, zeroNext, 1) & shiftDown(zero, zeroNext, 2) & shiftDown(zero, zeroNext, 3);
+	case UVD_STRING_ENCODING_BIG_ENDIAN32:
+		return zero & shiftDown(zero, zeroNext, 1) & shiftDown(zero, zeroNext, 2) & shiftDown(printable, printableNext, 3);
+	default:
+		return 0;
+	}
+}
+
+uint64_t UVDStringScanner::getTerminatorWord(UVDStringEncoding encoding, uint32_t word) const
+{
+	uint64_t zero = 0;
+	uint64_t zeroNext = 0;
+
+	if( word >= m_words )
+	{
+		return 0;
+	}
+	zero = m_zero[word];
+	zeroNext = m_zero[word + 1];
+
+	switch( getStride(encoding) )
+	{
+	case 1:
+		return zero;
+	case 2:
+		return zero & shiftDown(zero, zeroNext, 1);
+	case 4:
+		return zero & shiftDown(zero, zeroNext, 1) & shiftDown(zero, zeroNext, 2) & shiftDown(zero, zeroNext, 3);
+	default:
+		return 0;
+	}
+}
+
+bool UVDStringScanner::isCharacter(UVDStringEncoding encoding, uint32_t position) const
+{
+	return (getCharacterWord(encoding, position / 64) >> (position % 64)) & 1;
+}
+
+bool UVDStringScanner::isTerminator(UVDStringEncoding encoding, uint32_t position) const
+{
+	return (getTerminatorWord(encoding, position / 64) >> (position % 64)) & 1;
+}
+
+bool UVDStringScanner::findCharacter(UVDStringEncoding encoding, uint32_t position, uint32_t *out) const
+{
+	for( uint32_t word = position / 64; word < m_words; ++word )
+	{
+		uint64_t characters = getCharacterWord(encoding, word);
+
+		if( word == position / 64 )
+		{
+			characters &= ~0ULL << (position % 64);
+		}
+		if( characters )
+		{
+			*out = word * 64 + __builtin_ctzll(characters);
+			return true;
+		}
+	}
+	return false;
+}
+
+uint32_t UVDStringScanner::findNonCharacter(UVDStringEncoding encoding, uint32_t position) const
+{
+	for( uint32_t word = position / 64; word < m_words; ++word )
+	{
+		uint64_t nonCharacters = ~getCharacterWord(encoding, word);
+
+		if( word == position / 64 )
+		{
+			nonCharacters &= ~0ULL << (position % 64);
+		}
+		if( nonCharacters )
+		{
+			return word * 64 + __builtin_ctzll(nonCharacters);
+		}
+	}
+	return m_words * 64;
+}
+
+uint32_t UVDStringScanner::countHigh(uint32_t start, uint32_t end) const
+{
+	uint32_t count = 0;
+
+	for( uint32_t word = start / 64; word < m_words && word * 64 < end; ++word )
+	{
+		uint64_t high = m_high[word];
+
+		if( word == start / 64 )
+		{
+			high &= ~0ULL << (start % 64);
+		}
+		if( end < word * 64 + 64 )
+		{
+			high &= ~(~0ULL << (end % 64));
+		}
+		count += __builtin_popcountll(high);
+	}
+	return count;
+}
+
+uv_err_t UVDStringScanner::findStrings(UVDStringEncoding encoding, std::vector<Match> &out)
+{
+	unsigned int stride = getStride(encoding);
+	uint32_t position = 0;
+
+	uv_assert_ret(stride);
+	for( ;; )
+	{
+		uint32_t start = 0;
+		uint32_t end = 0;
+		uint32_t count = 0;
+
+		if( !findCharacter(encoding, position, &start) )
+		{
+			break;
+		}
+
+		if( stride == 1 )
+		{
+			end = findNonCharacter(encoding, start);
+		}
+		else
+		{
+			end = start;
+			while( isCharacter(encoding, end) )
+			{
+				end += stride;
+			}
+		}
+		count = (end - start) / stride;
+
+		if( count > m_minLength && isTerminator(encoding, end) )
+		{
+			//Text in the ASCII range is also mostly printable EBCDIC, real EBCDIC letters are all high
+			if( encoding != UVD_STRING_ENCODING_EBCDIC || countHigh(start, end) * 2 > count )
+			{
+				out.push_back(Match(start, end - start + stride, encoding));
+			}
+		}
+
+		//Start next where we left off
+		position = end + 1;
+	}
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDStringScanner::scan(const uint8_t *buffer, uint32_t size, std::vector<Match> &out)
+{
+	std::vector<Match> matches;
+	uint32_t keptEnd = 0;
+
+	uv_assert_ret(buffer || size == 0);
+
+	g_profileStringBytesScanned.add(size);
+	classify(buffer, size);
+	for( UVDStringEncoding encoding = UVD_STRING_ENCODING_ASCII; encoding <= UVD_STRING_ENCODING_EBCDIC; ++encoding )
+	{
+		if( m_encodings & UVD_STRING_ENCODING_BIT(encoding) )
+		{
+			uv_assert_err_ret(findStrings(encoding, matches));
+		}
+	}
+
+	//Resolve overlaps between encodings
+	std::sort(matches.begin(), matches.end());
+	for( std::vector<Match>::iterator iter = matches.begin(); iter != matches.end(); ++iter )
+	{
+		const Match &match = *iter;
+
+		if( match.m_offset < keptEnd )
+		{
+			continue;
+		}
+		out.push_back(match);
+		keptEnd = match.m_offset + match.m_size;
+	}
+
+	return UV_ERR_OK;
+}
+
+uint32_t UVDStringScanner::findBoundary(const uint8_t *buffer, uint32_t size, uint32_t start, uint32_t end) const
+{
+	if( end > size )
+	{
+		end = size;
+	}
+	if( start == 0 )
+	{
+		return 0;
+	}
+	for( uint32_t position = start; position < end; ++position )
+	{
+		uint8_t previous = buffer[position - 1];
+
+		if( !(m_classes[previous] & (UVD_STRING_SCANNER_CLASS_PRINTABLE | UVD_STRING_SCANNER_CLASS_ZERO | UVD_STRING_SCANNER_CLASS_EBCDIC)) )
+		{
+			return position;
+		}
+		/*
+		Every character has a non-zero byte and is at most 4 bytes
+		so the terminator of a string before can reach at most 7 zeros past its last printable byte
+		and a character after can start at most 3 zeros before its printable byte
+		*/
+		if( previous == 0 && position >= 8 && position + 4 <= size )
+		{
+			unsigned int i = 0;
+
+			for( i = 0; i < 12; ++i )
+			{
+				if( buffer[position - 8 + i] )
+				{
+					break;
+				}
+			}
+			if( i == 12 )
+			{
+				return position;
+			}
+		}
+	}
+	return end;
+}
+
@@ -0,0 +1,104 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVDSTRINGS_SCANNER_H
+#define UVDSTRINGS_SCANNER_H
+
+#include <vector>
+#include "uvd/string/string.h"
+#include "uvd/util/types.h"
+
+/*
+Finds null terminated strings of every enabled encoding in one pass over a buffer
+Bytes are first classified 16 at a time (SSE2, scalar otherwise) into bitmaps with one bit per byte:
+printable ASCII, zero, high bit set and printable EBCDIC
+Character and terminator positions of each encoding are then a few shifts and ands of 64 bit words
+and runs are found by counting bits instead of looking at bytes
+Bitmaps are kept between scans so scanning more buffers doesn't allocate
+
+A string is at least m_minLength + 1 characters followed by a terminator
+its size includes the terminator
+Where strings of different encodings overlap the one starting first (longest on a tie) is kept,
+ex: a UTF-16LE string also looks like a UTF-16BE string starting one byte later
+*/
+
+#define UVD_STRING_ENCODING_BIT(encoding)		(1 << (encoding))
+#define UVD_STRING_ENCODINGS_ALL				(UVD_STRING_ENCODING_BIT(UVD_STRING_ENCODING_ASCII) \
+		| UVD_STRING_ENCODING_BIT(UVD_STRING_ENCODING_BIG_ENDIAN16) \
+		| UVD_STRING_ENCODING_BIT(UVD_STRING_ENCODING_LITTLE_ENDIAN16) \
+		| UVD_STRING_ENCODING_BIT(UVD_STRING_ENCODING_BIG_ENDIAN32) \
+		| UVD_STRING_ENCODING_BIT(UVD_STRING_ENCODING_LITTLE_ENDIAN32) \
+		| UVD_STRING_ENCODING_BIT(UVD_STRING_ENCODING_EBCDIC))
+
+#define UVD_STRING_SCANNER_CLASS_PRINTABLE		0x01
+#define UVD_STRING_SCANNER_CLASS_ZERO			0x02
+#define UVD_STRING_SCANNER_CLASS_HIGH			0x04
+#define UVD_STRING_SCANNER_CLASS_EBCDIC			0x08
+
+class UVDStringScanner
+{
+public:
+	class Match
+	{
+	public:
+		Match();
+		Match(uint32_t offset, uint32_t size, UVDStringEncoding encoding);
+		//Ordered by offset, longest first
+		bool operator<(const Match &other) const;
+
+	public:
+		uint32_t m_offset;
+		uint32_t m_size;
+		UVDStringEncoding m_encoding;
+	};
+
+public:
+	UVDStringScanner();
+	~UVDStringScanner();
+	//encodings is a mask of UVD_STRING_ENCODING_BIT()
+	uv_err_t init(uint32_t encodings, uint32_t minLength);
+
+	//Append strings in buffer ordered by offset
+	uv_err_t scan(const uint8_t *buffer, uint32_t size, std::vector<Match> &out);
+	/*
+	First position in [start, end) that no string of any encoding can span, end if none
+	That is just after a byte that isn't printable, zero or EBCDIC printable
+	or after 8 zero bytes that are followed by 4 more
+	Scanning [0, boundary) and [boundary, size) separately gives the same strings as scanning [0, size)
+	*/
+	uint32_t findBoundary(const uint8_t *buffer, uint32_t size, uint32_t start, uint32_t end) const;
+
+protected:
+	void classify(const uint8_t *buffer, uint32_t size);
+	uv_err_t findStrings(UVDStringEncoding encoding, std::vector<Match> &out);
+	//Bit per byte that starts a character / terminator of encoding
+	uint64_t getCharacterWord(UVDStringEncoding encoding, uint32_t word) const;
+	uint64_t getTerminatorWord(UVDStringEncoding encoding, uint32_t word) const;
+	bool isCharacter(UVDStringEncoding encoding, uint32_t position) const;
+	bool isTerminator(UVDStringEncoding encoding, uint32_t position) const;
+	//First character at or after position, false if none
+	bool findCharacter(UVDStringEncoding encoding, uint32_t position, uint32_t *out) const;
+	//First non-character at or after position
+	uint32_t findNonCharacter(UVDStringEncoding encoding, uint32_t position) const;
+	//Bytes with the high bit set in [start, end)
+	uint32_t countHigh(uint32_t start, uint32_t end) const;
+
+public:
+	uint32_t m_encodings;
+	uint32_t m_minLength;
+	//Words covering the last buffer scanned
+	uint32_t m_words;
+	//Bitmaps of the last buffer, each has a trailing zero word so we can always look at the next word
+	std::vector<uint64_t> m_printable;
+	std::vector<uint64_t> m_zero;
+	std::vector<uint64_t> m_high;
+	std::vector<uint64_t> m_ebcdic;
+	//UVD_STRING_SCANNER_CLASS_* of each byte value, for when we can't use SIMD
+	uint8_t m_classes[256];
+};
+
+#endif
+
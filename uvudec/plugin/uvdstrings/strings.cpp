@@ -4,22 +4,39 @@ Copyright 2010 John McMaster <JohnDMcMaster@gmail.com>
 Licensed under the terms of the LGPL V3 or later, see COPYING for details
 */
 
+#include "uvd/core/analyzer.h"
 #include "uvd/core/runtime.h"
 #include "uvd/core/uvd.h"
+#include "uvd/util/thread.h"
 #include "uvdstrings/plugin.h"
 #include "uvdstrings/strings.h"
-#include <ctype.h>
 
 UVDStringsAnalyzerImpl::UVDStringsAnalyzerImpl(UVDStringsPlugin *plugin)
 {
 	m_plugin = plugin;
-	m_minLength = 3;
+	m_minLength = UVDSTRINGS_MIN_LENGTH_DEFAULT;
+	m_encodings = UVDSTRINGS_ENCODINGS_DEFAULT;
+	//Arguments are parsed before any engine activates us
+	if( plugin )
+	{
+		m_minLength = plugin->m_config.m_minLength;
+		m_encodings = plugin->m_config.m_encodings;
+	}
+	m_chunkSize = UVD_STRINGS_CHUNK_SIZE;
 }
 
 UVDStringsAnalyzerImpl::~UVDStringsAnalyzerImpl()
 {
 }
 
+static uv_err_t scanChunkJob(uint32_t index, uint32_t thread, void *user)
+{
+	UVDStringsAnalyzerImpl *analyzer = (UVDStringsAnalyzerImpl *)user;
+	
+	uv_assert_ret(analyzer);
+	return UV_DEBUG(analyzer->scanChunk(index, thread));
+}
+
 //uv_err_t UVDAnalyzer::analyzeStrings()
 uv_err_t UVDStringsAnalyzerImpl::appendAllStrings(std::vector<UVDString> &out)
 {
@@ -28,23 +45,71 @@ uv_err_t UVDStringsAnalyzerImpl::appendAllStrings(std::vector<UVDString> &out)
 	For some formats like ELF, it is possible to get this string table more directly
 	*/
 	UVDAddressSpaces *addressSpaces = NULL;
+	UVDThreadPool *threadPool = NULL;
+	uv_err_t rc = UV_ERR_OK;
 	
-	addressSpaces = &m_plugin->m_uvd->m_runtime->m_addressSpaces;
+	uv_assert_ret(m_uvd);
+	uv_assert_ret(m_uvd->m_analyzer);
+	addressSpaces = &m_uvd->m_runtime->m_addressSpaces;
+	uv_assert_err_ret(m_uvd->m_analyzer->getThreadPool(&threadPool));
+
+	m_scanners.resize(threadPool->getThreadCount());
+	for( std::vector<UVDStringScanner>::iterator iter = m_scanners.begin(); iter != m_scanners.end(); ++iter )
+	{
+		uv_assert_err_ret((*iter).init(m_encodings, m_minLength));
+	}
 
+	m_chunks.clear();
 	for( std::vector<UVDAddressSpace *>::iterator iter = addressSpaces->m_addressSpaces.begin();
 			iter != addressSpaces->m_addressSpaces.end(); ++iter )
 	{
 		UVDAddressSpace *addressSpace = *iter;
 
-		uv_assert_err_ret(doAppendAllStrings(addressSpace, out));
+		rc = addChunks(addressSpace);
+		if( UV_FAILED(rc) )
+		{
+			break;
+		}
+	}
+	if( UV_SUCCEEDED(rc) )
+	{
+		rc = threadPool->run(m_chunks.size(), scanChunkJob, this);
 	}
 	
-	return UV_ERR_OK;
+	//Chunks are in address order and each string belongs to exactly one
+	if( UV_SUCCEEDED(rc) )
+	{
+		for( std::vector<Chunk>::iterator iter = m_chunks.begin(); iter != m_chunks.end(); ++iter )
+		{
+			const Chunk &chunk = *iter;
+			
+			for( std::vector<UVDStringScanner::Match>::const_iterator matchIter = chunk.m_matches.begin();
+					matchIter != chunk.m_matches.end(); ++matchIter )
+			{
+				const UVDStringScanner::Match &match = *matchIter;
+				
+				//Just insert one reference to each string for now
+				out.push_back(UVDString(UVDAddressRange(match.m_offset, match.m_offset + match.m_size - 1, chunk.m_addressSpace),
+						match.m_encoding));
+			}
+		}
+	}
+	
+	m_chunks.clear();
+	for( std::vector<UVDDataView *>::iterator iter = m_views.begin(); iter != m_views.end(); ++iter )
+	{
+		delete *iter;
+	}
+	m_views.clear();
+	
+	return UV_DEBUG(rc);
 }
 
-uv_err_t UVDStringsAnalyzerImpl::doAppendAllStrings(UVDAddressSpace *addressSpace, std::vector<UVDString> &out)
+uv_err_t UVDStringsAnalyzerImpl::addChunks(UVDAddressSpace *addressSpace)
 {
 	UVDData *data = NULL;
+	UVDDataView *view = NULL;
+	uint32_t dataSize = 0;
 	
 	uv_assert_ret(addressSpace);
 	data = addressSpace->m_data;
@@ -54,50 +119,74 @@ uv_err_t UVDStringsAnalyzerImpl::doAppendAllStrings(UVDAddressSpace *addressSpac
 	{
 		return UV_ERR_OK;
 	}
-	//Do a C/ASCII string table analysis
-	for( unsigned int i = 0; i < data->size(); )
+	//Scan directly over memory instead of a virtual read per byte
+	dataSize = data->size();
+	view = new UVDDataView();
+	uv_assert_ret(view);
+	m_views.push_back(view);
+	uv_assert_err_ret(data->getView(0, dataSize, *view));
+	
+	return UV_DEBUG(addChunks(addressSpace, view->begin(), dataSize));
+}
+
+uv_err_t UVDStringsAnalyzerImpl::addChunks(UVDAddressSpace *addressSpace, const uint8_t *buffer, uint32_t dataSize)
+{
+	uint32_t start = 0;
+	
+	uv_assert_ret(!m_scanners.empty());
+	uv_assert_ret(m_chunkSize);
+	/*
+	Cut at the first boundary after each nominal chunk end
+	If there isn't one before the next nominal end, the chunks are merged
+	*/
+	while( start < dataSize )
 	{
-		unsigned int j = 0;
-		unsigned int nPrintables = 0;
+		Chunk chunk;
+		uint32_t end = dataSize;
 		
-		for( j = i; j <= data->size(); )
+		for( uint32_t nominal = start + m_chunkSize; nominal < dataSize; nominal += m_chunkSize )
 		{
-			char c = 0;
-			
-			uv_assert_err_ret(data->readData(j, &c, sizeof(c)));
-			++j;
-			
-			//null terminator
-			if( c == 0 )
-			{
-				if( nPrintables > m_minLength )
-				{
-					//Add the string
-					uv_addr_t endAddr = j - 1;
-
-					//Just insert one reference to each string for now
-					//A map
-					//m_analyzer->m_stringAddresses[i] = new UVDAnalyzedMemoryRange(i, endAddr);
-					//m_analyzer->m_stringAddresses[i]->insertReference(i, UVD_MEMORY_REFERENCE_CONSTANT | UVD_MEMORY_REFERENCE_STRING);
-					out.push_back(UVDString(UVDAddressRange(i, endAddr, addressSpace)));
-				}
-				
-				break;
-			}
-			else if( isprint(c) )
-			{
-				++nPrintables;
-			}
-			else
+			end = m_scanners[0].findBoundary(buffer, dataSize, nominal, nominal + m_chunkSize);
+			if( end < dataSize && end < nominal + m_chunkSize )
 			{
 				break;
 			}
+			end = dataSize;
 		}
 		
-		//Start next where we left off			
-		i = j;
+		chunk.m_addressSpace = addressSpace;
+		chunk.m_buffer = buffer;
+		chunk.m_start = start;
+		chunk.m_end = end;
+		m_chunks.push_back(chunk);
+		start = end;
 	}
 
 	return UV_ERR_OK;
 }
 
+uv_err_t UVDStringsAnalyzerImpl::scanChunk(uint32_t index, uint32_t thread)
+{
+	Chunk *chunk = NULL;
+	UVDStringScanner *scanner = NULL;
+	std::vector<UVDStringScanner::Match> matches;
+	
+	uv_assert_ret(index < m_chunks.size());
+	uv_assert_ret(thread < m_scanners.size());
+	chunk = &m_chunks[index];
+	scanner = &m_scanners[thread];
+	
+	//No string crosses the chunk ends so they can be scanned on their own
+	uv_assert_err_ret(scanner->scan(chunk->m_buffer + chunk->m_start, chunk->m_end - chunk->m_start, matches));
+	
+	for( std::vector<UVDStringScanner::Match>::iterator iter = matches.begin(); iter != matches.end(); ++iter )
+	{
+		UVDStringScanner::Match match = *iter;
+		
+		match.m_offset += chunk->m_start;
+		chunk->m_matches.push_back(match);
+	}
+	
+	return UV_ERR_OK;
+}
+
@@ -4,15 +4,23 @@ Copyright 2010 John McMaster <JohnDMcMaster@gmail.com>
 Licensed under the terms of the LGPL V3 or later, see COPYING for details
 */
 
-#ifndef UVDSTRINGS_STRINSG_H
+#ifndef UVDSTRINGS_STRINGS_H
 #define UVDSTRINGS_STRINGS_H
 
 #include "uvd/string/analyzer.h"
+#include "uvdstrings/scanner.h"
+
+//Address spaces are split into chunks of about this many bytes, scanned in parallel
+#define UVD_STRINGS_CHUNK_SIZE			0x100000
 
 /*
 Basic strings finder like the UNIX tool "strings"
-Currently looks for C ASCII strings
-In future will have to figure out how to treat different encodings
+Looks for null terminated strings in each of m_encodings, see UVDStringScanner
+
+Large address spaces are split into chunks scanned on the analyzer thread pool
+Chunks are cut at UVDStringScanner::findBoundary() so no string crosses one
+and each string is found by exactly one chunk
+Results are merged in address space then address order
 
 Other ways to find strings
 -Strings table
@@ -30,14 +38,40 @@ public:
 
 	virtual uv_err_t appendAllStrings(std::vector<UVDString> &out);
 
+	//Queue chunks of buffer, the data of addressSpace, for scanning
+	//Needs m_scanners set up
+	uv_err_t addChunks(UVDAddressSpace *addressSpace, const uint8_t *buffer, uint32_t size);
+	//Scan chunk index on the pool thread
+	uv_err_t scanChunk(uint32_t index, uint32_t thread);
+
 protected:
-	uv_err_t doAppendAllStrings(UVDAddressSpace *addressSpace, std::vector<UVDString> &out);
+	uv_err_t addChunks(UVDAddressSpace *addressSpace);
 
 public:
 	UVDStringsPlugin *m_plugin;
 	//Minimum printable length to be considered a string
 	unsigned int m_minLength;
-	//Encoding options?
+	//Mask of UVD_STRING_ENCODING_BIT() to look for
+	uint32_t m_encodings;
+	//Nominal chunk size, UVD_STRINGS_CHUNK_SIZE
+	uint32_t m_chunkSize;
+	//One per pool thread, reused between chunks
+	std::vector<UVDStringScanner> m_scanners;
+
+	class Chunk
+	{
+	public:
+		UVDAddressSpace *m_addressSpace;
+		//Address space data
+		const uint8_t *m_buffer;
+		//Strings starting in [m_start, m_end)
+		uint32_t m_start;
+		uint32_t m_end;
+		std::vector<UVDStringScanner::Match> m_matches;
+	};
+	//Current appendAllStrings() work, in address order
+	std::vector<Chunk> m_chunks;
+	std::vector<UVDDataView *> m_views;
 };
 
 #endif
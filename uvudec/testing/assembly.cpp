@@ -5,9 +5,19 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 */
 
 #include "testing/assembly.h"
+#include "uvd/assembly/function.h"
+#include "uvd/core/analysis.h"
+#include "uvd/core/analyzer.h"
+#include "uvd/core/block.h"
+#include "uvd/core/event.h"
+#include "uvd/core/line_index.h"
+#include "uvd/core/runtime.h"
 #include "uvd/core/uvd.h"
+#include "uvd/event/engine.h"
 #include "uvd/language/language.h"
+#include "uvd/util/profile.h"
 #include <string.h>
+#include <vector>
 
 CPPUNIT_TEST_SUITE_REGISTRATION(UVDAssemblyUnitTest);
 
@@ -97,3 +107,366 @@ void UVDAssemblyUnitTest::reverseDisassembleTest(void)
 	}	
 }
 
+void UVDAssemblyUnitTest::functionSymbolTest(void)
+{
+	UVDAnalyzer *analyzer = NULL;
+	UVDAddressSpace *space = NULL;
+	UVDAnalyzedMemorySpace calledAddresses;
+	uint32_t dataSize = 0;
+	uint32_t expected = 0;
+
+	generalInit();
+	UVCPPUNIT_ASSERT(m_uvd->analyze());
+	analyzer = m_uvd->m_analyzer;
+	CPPUNIT_ASSERT(analyzer != NULL);
+	UVCPPUNIT_ASSERT(m_uvd->m_runtime->getPrimaryExecutableAddressSpace(&space));
+	UVCPPUNIT_ASSERT(space->m_data->size(&dataSize));
+	UVCPPUNIT_ASSERT(analyzer->getCalledAddresses(calledAddresses));
+	for( UVDAnalyzedMemorySpace::iterator iter = calledAddresses.begin(); iter != calledAddresses.end(); ++iter )
+	{
+		if( (*iter).first < dataSize )
+		{
+			++expected;
+		}
+	}
+	CPPUNIT_ASSERT(expected > 0);
+	CPPUNIT_ASSERT_EQUAL(expected, (uint32_t)analyzer->m_functions.size());
+
+	for( std::set<UVDBinaryFunction *>::iterator iter = analyzer->m_functions.begin(); iter != analyzer->m_functions.end(); ++iter )
+	{
+		UVDBinaryFunction *function = *iter;
+		UVDBinarySymbol *symbol = NULL;
+		uv_addr_t address = 0;
+		std::string name;
+		std::string expectedName;
+
+		UVCPPUNIT_ASSERT(function->getSymbolAddress(&address));
+		CPPUNIT_ASSERT(calledAddresses.find(address) != calledAddresses.end());
+		UVCPPUNIT_ASSERT(analyzer->m_symbolManager.analyzedSymbolName(address, UVD__SYMBOL_TYPE__FUNCTION, expectedName));
+		UVCPPUNIT_ASSERT(function->getSymbolName(name));
+		CPPUNIT_ASSERT_EQUAL(expectedName, name);
+		//Resolvable both ways
+		UVCPPUNIT_ASSERT(analyzer->m_symbolManager.findSymbol(name, &symbol));
+		CPPUNIT_ASSERT(symbol == function);
+		UVCPPUNIT_ASSERT(analyzer->m_symbolManager.findSymbolByAddress(address, &symbol));
+		CPPUNIT_ASSERT(symbol == function);
+	}
+
+	UVCPPUNIT_ASSERT(m_uvd->analyze());
+	CPPUNIT_ASSERT_EQUAL(expected, (uint32_t)analyzer->m_functions.size());
+
+	deinit();
+}
+
+void UVDAssemblyUnitTest::instructionRecycleTest(void)
+{
+	UVDInstructionIterator iter;
+	UVDInstructionIterator iterEnd;
+	uint64_t decoded = 0;
+	uint64_t allocated = 0;
+
+	generalInit();
+	m_uvd->m_analyzer->m_instructionCache.invalidate();
+	m_uvd->m_analyzer->m_instructionCache.m_maxInstructions = 0;
+	g_profiler.enable();
+	g_profiler.reset();
+
+	UVCPPUNIT_ASSERT(m_uvd->instructionBegin(iter));
+	UVCPPUNIT_ASSERT(m_uvd->instructionEnd(iterEnd));
+	while( iter != iterEnd )
+	{
+		UVDInstruction *instruction = NULL;
+
+		UVCPPUNIT_ASSERT(iter.get(&instruction));
+		UVCPPUNIT_ASSERT(iter.next());
+	}
+	g_profiler.disable();
+
+	UVCPPUNIT_ASSERT(g_profiler.getCounter("instructions.decoded", &decoded));
+	UVCPPUNIT_ASSERT(g_profiler.getCounter("instructions.allocated", &allocated));
+	CPPUNIT_ASSERT(decoded > 100);
+	//Begin, end and the copies made setting them up may each hold one
+	CPPUNIT_ASSERT(allocated < 8);
+	CPPUNIT_ASSERT(m_uvd->m_analyzer->m_instructionCache.size() == 0);
+
+	deinit();
+}
+
+void UVDAssemblyUnitTest::instructionCacheEvictionTest(void)
+{
+	UVDInstructionIterator held;
+	UVDInstructionIterator iter;
+	UVDInstructionIterator iterEnd;
+	UVDInstruction *instruction = NULL;
+	UVDInstructionCache *cache = NULL;
+	std::vector<std::pair<uint32_t, uint32_t> > expected;
+	uint32_t index = 0;
+	uint64_t evictions = 0;
+
+	generalInit();
+	cache = &m_uvd->m_analyzer->m_instructionCache;
+	//Uncached decode to compare against
+	cache->invalidate();
+	cache->m_maxInstructions = 0;
+	UVCPPUNIT_ASSERT(m_uvd->instructionBegin(iter));
+	UVCPPUNIT_ASSERT(m_uvd->instructionEnd(iterEnd));
+	while( iter != iterEnd )
+	{
+		UVCPPUNIT_ASSERT(iter.get(&instruction));
+		expected.push_back(std::pair<uint32_t, uint32_t>(instruction->m_offset, instruction->m_inst_size));
+		UVCPPUNIT_ASSERT(iter.next());
+	}
+	CPPUNIT_ASSERT(expected.size() > 100);
+
+	cache->m_maxInstructions = 16;
+	g_profiler.enable();
+	g_profiler.reset();
+	UVCPPUNIT_ASSERT(m_uvd->instructionBegin(held));
+	UVCPPUNIT_ASSERT(m_uvd->instructionBegin(iter));
+	while( iter != iterEnd )
+	{
+		UVCPPUNIT_ASSERT(iter.get(&instruction));
+		CPPUNIT_ASSERT(index < expected.size());
+		CPPUNIT_ASSERT(instruction->m_offset == expected[index].first);
+		CPPUNIT_ASSERT(instruction->m_inst_size == expected[index].second);
+		CPPUNIT_ASSERT(cache->size() <= 16);
+		++index;
+		UVCPPUNIT_ASSERT(iter.next());
+	}
+	g_profiler.disable();
+	CPPUNIT_ASSERT(index == expected.size());
+
+	UVCPPUNIT_ASSERT(g_profiler.getCounter("instruction_cache.evictions", &evictions));
+	CPPUNIT_ASSERT(evictions > 0);
+	UVCPPUNIT_ASSERT(held.get(&instruction));
+	CPPUNIT_ASSERT(instruction->m_offset == expected[0].first);
+	CPPUNIT_ASSERT(instruction->m_inst_size == expected[0].second);
+
+	deinit();
+}
+
+void UVDAssemblyUnitTest::getFunctionAddresses(std::set<uv_addr_t> &out)
+{
+	out.clear();
+	for( std::set<UVDBinaryFunction *>::iterator iter = m_uvd->m_analyzer->m_functions.begin(); iter != m_uvd->m_analyzer->m_functions.end(); ++iter )
+	{
+		uv_addr_t address = 0;
+
+		UVCPPUNIT_ASSERT((*iter)->getSymbolAddress(&address));
+		out.insert(address);
+	}
+}
+
+void UVDAssemblyUnitTest::traceFlowAnalysisTest(void)
+{
+	std::set<uv_addr_t> linearInstructions;
+	std::set<uv_addr_t> linearFunctions;
+	std::set<uv_addr_t> traceFunctions;
+	UVDInstructionIterator iter;
+	UVDInstructionIterator iterEnd;
+	UVDAddressSpace *space = NULL;
+	UVDBasicBlockSet blocks;
+	uint32_t dataSize = 0;
+	uint32_t traceInstructions = 0;
+
+	//Default
+	generalInit();
+	CPPUNIT_ASSERT_EQUAL(UVD__FLOW_ANALYSIS__LINEAR, m_uvd->m_config->m_flowAnalysisTechnique);
+	UVCPPUNIT_ASSERT(m_uvd->analyze());
+	getFunctionAddresses(linearFunctions);
+	UVCPPUNIT_ASSERT(m_uvd->instructionBegin(iter));
+	UVCPPUNIT_ASSERT(m_uvd->instructionEnd(iterEnd));
+	while( iter != iterEnd )
+	{
+		UVDAddress address;
+
+		UVCPPUNIT_ASSERT(iter.getAddress(&address));
+		linearInstructions.insert(address.m_addr);
+		UVCPPUNIT_ASSERT(iter.next());
+	}
+	deinit();
+	CPPUNIT_ASSERT(linearInstructions.size() > 100);
+
+	m_args.push_back("--flow-analysis=trace");
+	generalInit();
+	CPPUNIT_ASSERT_EQUAL(UVD__FLOW_ANALYSIS__TRACE, m_uvd->m_config->m_flowAnalysisTechnique);
+	UVCPPUNIT_ASSERT(m_uvd->analyze());
+	getFunctionAddresses(traceFunctions);
+	UVCPPUNIT_ASSERT(m_uvd->m_runtime->getPrimaryExecutableAddressSpace(&space));
+	UVCPPUNIT_ASSERT(space->m_data->size(&dataSize));
+	UVCPPUNIT_ASSERT(m_uvd->m_analyzer->m_basicBlocks.getAtAddresses(UVDAddressRange(0, dataSize - 1, space), &blocks));
+	CPPUNIT_ASSERT(!blocks.empty());
+	CPPUNIT_ASSERT_EQUAL(m_uvd->m_analyzer->m_basicBlocks.size(), (unsigned int)blocks.size());
+
+	for( UVDBasicBlockSet::iterator blockIter = blocks.begin(); blockIter != blocks.end(); ++blockIter )
+	{
+		UVDBasicBlock *block = *blockIter;
+
+		//Starts and ends on an instruction the linear sweep decoded
+		CPPUNIT_ASSERT(block->min() <= block->max());
+		CPPUNIT_ASSERT(linearInstructions.find(block->min()) != linearInstructions.end());
+		CPPUNIT_ASSERT(block->max() + 1 == dataSize || linearInstructions.find(block->max() + 1) != linearInstructions.end());
+		//And so does everything in between
+		for( uv_addr_t address = block->min(); address <= block->max(); ++address )
+		{
+			if( m_uvd->m_analyzer->m_instructionBoundaries.isSet(UVDAddress(address, space)) )
+			{
+				CPPUNIT_ASSERT(linearInstructions.find(address) != linearInstructions.end());
+				++traceInstructions;
+			}
+		}
+	}
+	CPPUNIT_ASSERT(traceInstructions >= blocks.size());
+
+	//Reachable calls are a subset of all of them
+	CPPUNIT_ASSERT(!traceFunctions.empty());
+	for( std::set<uv_addr_t>::iterator addressIter = traceFunctions.begin(); addressIter != traceFunctions.end(); ++addressIter )
+	{
+		CPPUNIT_ASSERT(linearFunctions.find(*addressIter) != linearFunctions.end());
+	}
+
+	deinit();
+}
+
+void UVDAssemblyUnitTest::lineIndexTest(void)
+{
+	UVDPrintLineIndex *lineIndex = NULL;
+	UVDAddressSpace *space = NULL;
+	uv_addr_t minAddress = 0;
+	UVDPrintIterator iter;
+	UVDPrintIterator endIter;
+	//Reference print of the primary space
+	std::vector<std::string> lines;
+	std::vector<uv_addr_t> addresses;
+	//Of each line within its address
+	std::vector<uint32_t> indexes;
+	uint32_t lineCount = 0;
+	uint32_t checkLine = 0;
+	uint32_t middle = 0;
+	uv_addr_t address = 0;
+	uint32_t index = 0;
+	std::string text;
+	UVDEventFunctionChanged functionChangedEvent;
+
+	generalInit();
+	UVCPPUNIT_ASSERT(m_uvd->analyze());
+	UVCPPUNIT_ASSERT(m_uvd->setDestinationLanguage(UVD_LANGUAGE_ASSEMBLY));
+	UVCPPUNIT_ASSERT(m_uvd->m_runtime->getPrimaryExecutableAddressSpace(&space));
+	UVCPPUNIT_ASSERT(space->getMinValidAddress(&minAddress));
+
+	//Same stopping rules as the index
+	UVCPPUNIT_ASSERT(m_uvd->begin(UVDAddress(minAddress, space), iter));
+	UVCPPUNIT_ASSERT(m_uvd->end(endIter));
+	while( iter != endIter )
+	{
+		UVDAddress current;
+
+		UVCPPUNIT_ASSERT(iter.getAddress(&current));
+		if( current.m_space != space
+				|| (!addresses.empty() && current.m_addr < addresses.back()) )
+		{
+			break;
+		}
+		UVCPPUNIT_ASSERT(iter.getCurrent(text));
+		if( !addresses.empty() && addresses.back() == current.m_addr )
+		{
+			indexes.push_back(indexes.back() + 1);
+		}
+		else
+		{
+			indexes.push_back(0);
+		}
+		lines.push_back(text);
+		addresses.push_back(current.m_addr);
+		UVCPPUNIT_ASSERT(iter.next());
+	}
+	//Enough to cross a few extend() chunks and seek around the middle
+	CPPUNIT_ASSERT(lines.size() > 20);
+
+	UVCPPUNIT_ASSERT(m_uvd->m_analyzer->getLineIndex(&lineIndex));
+	CPPUNIT_ASSERT(lineIndex != NULL);
+	UVCPPUNIT_ASSERT(lineIndex->getLineCount(&lineCount));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)lines.size(), lineCount);
+
+	//getPosition() and getLine() are inverses on every line
+	for( uint32_t line = 0; line < lineCount; ++line )
+	{
+		UVCPPUNIT_ASSERT(lineIndex->getPosition(line, &address, &index));
+		CPPUNIT_ASSERT_EQUAL(addresses[line], address);
+		CPPUNIT_ASSERT_EQUAL(indexes[line], index);
+		UVCPPUNIT_ASSERT(lineIndex->getLine(address, index, &checkLine));
+		CPPUNIT_ASSERT_EQUAL(line, checkLine);
+	}
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_DONE, lineIndex->getPosition(lineCount, &address, &index));
+
+	for( uint32_t line = 0; line + 1 < lineCount; ++line )
+	{
+		//Index past the group clamps to its last line
+		if( addresses[line + 1] != addresses[line] )
+		{
+			UVCPPUNIT_ASSERT(lineIndex->getLine(addresses[line], indexes[line] + 100, &checkLine));
+			CPPUNIT_ASSERT_EQUAL(line, checkLine);
+		}
+		//Inside a multi byte instruction is the start of the next group
+		if( addresses[line + 1] > addresses[line] + 1 )
+		{
+			UVCPPUNIT_ASSERT(lineIndex->getLine(addresses[line] + 1, 0, &checkLine));
+			CPPUNIT_ASSERT_EQUAL(line + 1, checkLine);
+		}
+	}
+
+	//Seeking lands on the same text forward iteration printed
+	for( uint32_t line = 0; line < lineCount; line += 37 )
+	{
+		UVCPPUNIT_ASSERT(lineIndex->seek(line, iter));
+		UVCPPUNIT_ASSERT(iter.getCurrent(text));
+		CPPUNIT_ASSERT_EQUAL(lines[line], text);
+	}
+	UVCPPUNIT_ASSERT(lineIndex->seek(lineCount, iter));
+	CPPUNIT_ASSERT(iter == endIter);
+
+	middle = lineCount / 2;
+	UVCPPUNIT_ASSERT(lineIndex->seek(middle, iter));
+	UVCPPUNIT_ASSERT(lineIndex->seekDelta(iter, 5));
+	UVCPPUNIT_ASSERT(iter.getCurrent(text));
+	CPPUNIT_ASSERT_EQUAL(lines[middle + 5], text);
+	UVCPPUNIT_ASSERT(lineIndex->seekDelta(iter, -3));
+	UVCPPUNIT_ASSERT(iter.getCurrent(text));
+	CPPUNIT_ASSERT_EQUAL(lines[middle + 2], text);
+	//Clamped at both ends
+	UVCPPUNIT_ASSERT(lineIndex->seekDelta(iter, -(int)lineCount - 10));
+	UVCPPUNIT_ASSERT(iter.getCurrent(text));
+	CPPUNIT_ASSERT_EQUAL(lines[0], text);
+	UVCPPUNIT_ASSERT(lineIndex->seekDelta(iter, lineCount + 10));
+	CPPUNIT_ASSERT(iter == endIter);
+	UVCPPUNIT_ASSERT(lineIndex->seekDelta(iter, -1));
+	UVCPPUNIT_ASSERT(iter.getCurrent(text));
+	CPPUNIT_ASSERT_EQUAL(lines[lineCount - 1], text);
+
+	//Invalidation drops everything, queries rebuild it
+	lineIndex->invalidate();
+	CPPUNIT_ASSERT(lineIndex->m_groups.empty());
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0, lineIndex->m_lineCount);
+	CPPUNIT_ASSERT(!lineIndex->m_started);
+	CPPUNIT_ASSERT(!lineIndex->m_complete);
+	UVCPPUNIT_ASSERT(lineIndex->getPosition(middle, &address, &index));
+	CPPUNIT_ASSERT_EQUAL(addresses[middle], address);
+	CPPUNIT_ASSERT_EQUAL(indexes[middle], index);
+	CPPUNIT_ASSERT(lineIndex->m_started);
+
+	UVCPPUNIT_ASSERT(m_uvd->m_eventEngine->emitEvent(&functionChangedEvent));
+	CPPUNIT_ASSERT(lineIndex->m_groups.empty());
+	CPPUNIT_ASSERT(!lineIndex->m_started);
+
+	UVCPPUNIT_ASSERT(lineIndex->getLineCount(&checkLine));
+	CPPUNIT_ASSERT(lineIndex->m_complete);
+	UVCPPUNIT_ASSERT(m_uvd->analyze());
+	CPPUNIT_ASSERT(!lineIndex->m_complete);
+	//Nothing about the program changed so neither should the index
+	UVCPPUNIT_ASSERT(lineIndex->getLineCount(&checkLine));
+	CPPUNIT_ASSERT_EQUAL(lineCount, checkLine);
+	UVCPPUNIT_ASSERT(lineIndex->getPosition(lineCount - 1, &address, &index));
+	CPPUNIT_ASSERT_EQUAL(addresses[lineCount - 1], address);
+
+	deinit();
+}
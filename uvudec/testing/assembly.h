@@ -10,11 +10,17 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include <cppunit/TestFixture.h>
 #include <cppunit/extensions/HelperMacros.h>
 #include "testing/framework/common_fixture.h"
+#include <set>
 
 class UVDAssemblyUnitTest : public UVDTestingCommonFixture
 {
 	CPPUNIT_TEST_SUITE(UVDAssemblyUnitTest);
 	CPPUNIT_TEST(reverseDisassembleTest);
+	CPPUNIT_TEST(functionSymbolTest);
+	CPPUNIT_TEST(instructionRecycleTest);
+	CPPUNIT_TEST(instructionCacheEvictionTest);
+	CPPUNIT_TEST(traceFlowAnalysisTest);
+	CPPUNIT_TEST(lineIndexTest);
 	CPPUNIT_TEST_SUITE_END();
 
 protected:
@@ -25,6 +31,33 @@ protected:
 	void reverseDisassembleTest(void);
 	//Start and end inclusive
 	void reverseDisassemble(uv_addr_t start, uv_addr_t end, std::string &out);
+	/*
+	Every called address should become a function with its default symbol name
+	Analyzing again shouldn't add them twice
+	*/
+	void functionSymbolTest(void);
+	/*
+	With the instruction cache off, iterating shouldn't allocate an instruction per decode
+	Each one should go back to the architecture before the next is decoded
+	*/
+	void instructionRecycleTest(void);
+	/*
+	A cache smaller than the program should evict old entries and keep decoding the same thing
+	An instruction an iterator is still on must survive its eviction turn
+	*/
+	void instructionCacheEvictionTest(void);
+	/*
+	--flow-analysis=trace should succeed and cut the same instructions as the default linear sweep into blocks
+	Every function it finds the linear sweep should find too
+	*/
+	void traceFlowAnalysisTest(void);
+	//Start of every function the current engine found
+	void getFunctionAddresses(std::set<uv_addr_t> &out);
+	/*
+	UVDPrintLineIndex should agree with plain forward print iteration line for line
+	Invalidating it, directly or through analysis and function events, should rebuild the same index
+	*/
+	void lineIndexTest(void);
 };
 
 #endif
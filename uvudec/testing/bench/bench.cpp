@@ -0,0 +1,538 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include "testing/bench/bench.h"
+#include "uvd/core/analysis.h"
+#include "uvd/core/init.h"
+#include "uvd/core/uvd.h"
+#include "uvd/data/data.h"
+#include "uvd/language/language.h"
+#include "uvd/string/engine.h"
+#include "uvd/util/benchmark.h"
+#include "uvd/util/output_sink.h"
+#include "uvd/util/profile.h"
+#include "uvd/util/util.h"
+#include "uvdflirt/flirt.h"
+#include "uvdflirt/plugin.h"
+#include "uvdflirt/sig/match.h"
+#include "uvdflirt/sig/sig.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/*
+UVDBenchInput
+*/
+
+UVDBenchInput::UVDBenchInput()
+{
+	m_type = UVD_BENCH_INPUT_IMAGE;
+	m_size = 0;
+}
+
+uv_err_t UVDBenchInput::init(const std::string &file, uint32_t type, const std::string &signatureFile)
+{
+	struct stat fileStat;
+
+	m_file = file;
+	m_type = type;
+	m_signatureFile = signatureFile;
+	if( stat(file.c_str(), &fileStat) )
+	{
+		printf_error("can't stat %s\n", file.c_str());
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	m_size = fileStat.st_size;
+
+	return UV_ERR_OK;
+}
+
+/*
+UVDBenchRun
+*/
+
+UVDBenchRun::UVDBenchRun()
+{
+	m_input = NULL;
+	m_argc = 0;
+	m_argv = NULL;
+	m_uvd = NULL;
+	m_flirt = NULL;
+	m_wasUVDInitCalled = false;
+}
+
+UVDBenchRun::~UVDBenchRun()
+{
+	deinit();
+}
+
+uv_err_t UVDBenchRun::init(const UVDBenchInput *input, const std::vector<std::string> &args)
+{
+	std::vector<std::string> argv;
+
+	uv_assert_ret(input);
+	m_input = input;
+
+	argv.push_back("uvbench");
+	if( input->m_type == UVD_BENCH_INPUT_IMAGE )
+	{
+		//Only plugin with a string analyzer, the strings stage times nothing without it
+		argv.push_back("--plugin=uvdstrings");
+		//Raw binaries are left to the default plugins
+		if( input->m_file.size() >= 3 && input->m_file.compare(input->m_file.size() - 3, 3, ".gb") == 0 )
+		{
+			argv.push_back("--plugin=uvdgb");
+		}
+	}
+	else
+	{
+		argv.push_back("--plugin=uvdflirt");
+	}
+	if( input->m_type == UVD_BENCH_INPUT_SIGNATURE )
+	{
+		argv.push_back("--flirt-sig=" + input->m_signatureFile);
+	}
+	argv.insert(argv.end(), args.begin(), args.end());
+
+	m_argc = argv.size();
+	m_argv = (char **)malloc(sizeof(char *) * m_argc);
+	uv_assert_ret(m_argv);
+	for( int i = 0; i < m_argc; ++i )
+	{
+		m_argv[i] = strdup(argv[i].c_str());
+		uv_assert_ret(m_argv[i]);
+	}
+
+	uv_assert_err_ret(UVDInit());
+	m_wasUVDInitCalled = true;
+	uv_assert_ret(g_config);
+	uv_assert_err_ret(g_config->parseMain(m_argc, m_argv));
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDBenchRun::deinit()
+{
+	//Engine must go before the library
+	delete m_uvd;
+	m_uvd = NULL;
+	delete m_flirt;
+	m_flirt = NULL;
+	m_output.clear();
+
+	if( m_wasUVDInitCalled )
+	{
+		m_wasUVDInitCalled = false;
+		uv_assert_err_ret(UVDDeinit());
+	}
+
+	if( m_argv )
+	{
+		for( int i = 0; i < m_argc; ++i )
+		{
+			free(m_argv[i]);
+		}
+		free(m_argv);
+	}
+	m_argc = 0;
+	m_argv = NULL;
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDBenchRun::load()
+{
+	uv_assert_ret(m_input);
+	uv_assert_err_ret(UVD::getUVDFromFileName(&m_uvd, m_input->m_file));
+	uv_assert_ret(m_uvd);
+	return UV_ERR_OK;
+}
+
+/*
+Stages
+*/
+
+static uv_err_t benchNone(UVDBenchRun *)
+{
+	return UV_ERR_OK;
+}
+
+static uv_err_t benchLoad(UVDBenchRun *run)
+{
+	return UV_DEBUG(run->load());
+}
+
+static uv_err_t benchStringsSetUp(UVDBenchRun *run)
+{
+	uv_assert_err_ret(run->load());
+	uv_assert_ret(run->m_uvd->m_analyzer->m_stringEngine);
+	//Without one the string engine returns immediately and we'd time nothing
+	if( run->m_uvd->m_analyzer->m_stringEngine->m_analyzers.empty() )
+	{
+		printf_error("strings: no string analyzer plugin loaded, nothing to benchmark\n");
+		return UV_DEBUG(UV_ERR_NOTSUPPORTED);
+	}
+	return UV_ERR_OK;
+}
+
+static uv_err_t benchStrings(UVDBenchRun *run)
+{
+	return UV_DEBUG(run->m_uvd->analyzeStrings());
+}
+
+static uv_err_t benchFlowSetUp(UVDBenchRun *run, int technique)
+{
+	uv_assert_err_ret(run->load());
+	run->m_uvd->m_config->m_flowAnalysisTechnique = technique;
+	//Same state analyze() is in when it starts flow analysis
+	uv_assert_err_ret(run->m_uvd->analyzeStrings());
+	return UV_ERR_OK;
+}
+
+static uv_err_t benchFlowLinearSetUp(UVDBenchRun *run)
+{
+	return UV_DEBUG(benchFlowSetUp(run, UVD__FLOW_ANALYSIS__LINEAR));
+}
+
+static uv_err_t benchFlowTraceSetUp(UVDBenchRun *run)
+{
+	return UV_DEBUG(benchFlowSetUp(run, UVD__FLOW_ANALYSIS__TRACE));
+}
+
+static uv_err_t benchFlow(UVDBenchRun *run)
+{
+	return UV_DEBUG(run->m_uvd->analyzeControlFlow());
+}
+
+static uv_err_t benchAnalyzed(UVDBenchRun *run)
+{
+	uv_assert_err_ret(run->load());
+	uv_assert_err_ret(run->m_uvd->analyze());
+	return UV_ERR_OK;
+}
+
+static uv_err_t benchPrint(UVDBenchRun *run)
+{
+	UVDPrintIterator iterBegin;
+	UVDPrintIterator iterEnd;
+	UVDStringOutputSink sink;
+	UVD *uvd = run->m_uvd;
+
+	//What decompile() does after analyze()
+	uv_assert_err_ret(uvd->setDestinationLanguage(UVD_LANGUAGE_ASSEMBLY));
+	uv_assert_err_ret(uvd->begin(iterBegin));
+	uv_assert_err_ret(uvd->end(iterEnd));
+	uv_assert_err_ret(sink.init(&run->m_output));
+	uv_assert_err_ret(uvd->printRangeCore(iterBegin, iterEnd, &sink));
+	return UV_ERR_OK;
+}
+
+static uv_err_t benchEndToEnd(UVDBenchRun *run)
+{
+	uv_assert_err_ret(run->load());
+	uv_assert_err_ret(run->m_uvd->disassemble(run->m_output));
+	return UV_ERR_OK;
+}
+
+static uv_err_t benchObj2pat(UVDBenchRun *run)
+{
+	uv_assert_ret(g_uvdFLIRTPlugin);
+	uv_assert_ret(g_uvdFLIRTPlugin->m_flirt);
+	uv_assert_err_ret(g_uvdFLIRTPlugin->m_flirt->toPat(run->m_output));
+	return UV_ERR_OK;
+}
+
+static uv_err_t benchPat2sigSetUp(UVDBenchRun *run)
+{
+	run->m_flirt = new UVDFLIRT();
+	uv_assert_ret(run->m_flirt);
+	uv_assert_err_ret(run->m_flirt->init());
+	return UV_ERR_OK;
+}
+
+static uv_err_t benchPat2sig(UVDBenchRun *run)
+{
+	std::vector<std::string> patFiles;
+	UVDFLIRTSignatureDB *db = NULL;
+	UVDData *data = NULL;
+
+	patFiles.push_back(run->m_input->m_file);
+	uv_assert_err_ret(run->m_flirt->patFiles2SigDB(patFiles, &db));
+	uv_assert_ret(db);
+	//Everything pat2sig does but the disk write
+	if( UV_FAILED(db->writeToData(&data)) )
+	{
+		delete db;
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	delete data;
+	delete db;
+
+	return UV_ERR_OK;
+}
+
+static uv_err_t benchSignatureMatchSetUp(UVDBenchRun *run)
+{
+	uv_assert_err_ret(benchAnalyzed(run));
+	uv_assert_ret(g_uvdFLIRTPlugin);
+	uv_assert_ret(g_uvdFLIRTPlugin->m_matcher);
+	//identifyFunctions() returns immediately on either of these
+	if( g_uvdFLIRTPlugin->m_matcher->m_dbs.empty() )
+	{
+		printf_error("sig_match: no signature DB loaded from %s\n", run->m_input->m_signatureFile.c_str());
+		return UV_DEBUG(UV_ERR_NOTSUPPORTED);
+	}
+	if( run->m_uvd->m_analyzer->m_functions.empty() )
+	{
+		printf_error("sig_match: analysis found no functions in %s\n", run->m_input->m_file.c_str());
+		return UV_DEBUG(UV_ERR_NOTSUPPORTED);
+	}
+	return UV_ERR_OK;
+}
+
+static uv_err_t benchSignatureMatch(UVDBenchRun *run)
+{
+	//analyze() matched once through the identify event, this is a second pass over the same function bytes
+	uv_assert_err_ret(g_uvdFLIRTPlugin->m_matcher->identifyFunctions(run->m_uvd->m_analyzer));
+	return UV_ERR_OK;
+}
+
+UVDBenchStage g_benchStages[] = {
+	{"load", UVD_BENCH_INPUT_IMAGE, benchNone, benchLoad,
+			"object load and engine init"},
+	{"strings", UVD_BENCH_INPUT_IMAGE, benchStringsSetUp, benchStrings,
+			"string scan"},
+	{"flow_linear", UVD_BENCH_INPUT_IMAGE, benchFlowLinearSetUp, benchFlow,
+			"linear sweep control flow analysis"},
+	{"flow_trace", UVD_BENCH_INPUT_IMAGE, benchFlowTraceSetUp, benchFlow,
+			"recursive descent control flow analysis"},
+	{"print", UVD_BENCH_INPUT_IMAGE, benchAnalyzed, benchPrint,
+			"printing an analyzed image"},
+	{"end_to_end", UVD_BENCH_INPUT_IMAGE, benchNone, benchEndToEnd,
+			"load, analyze and print"},
+	{"obj2pat", UVD_BENCH_INPUT_OBJECT, benchLoad, benchObj2pat,
+			"pattern generation from a loaded object"},
+	{"pat2sig", UVD_BENCH_INPUT_PATTERN, benchPat2sigSetUp, benchPat2sig,
+			"signature DB from a .pat file"},
+	{"sig_match", UVD_BENCH_INPUT_SIGNATURE, benchSignatureMatchSetUp, benchSignatureMatch,
+			"FLIRT matching of analyzed functions"},
+};
+uint32_t g_benchStageCount = sizeof(g_benchStages) / sizeof(g_benchStages[0]);
+
+/*
+UVDBenchResult
+*/
+
+UVDBenchResult::UVDBenchResult()
+{
+	m_bytes = 0;
+	m_instructions = 0;
+	m_rc = UV_ERR_OK;
+}
+
+double UVDBenchResult::getMean() const
+{
+	double sum = 0.0;
+
+	if( m_times.empty() )
+	{
+		return 0.0;
+	}
+	for( std::vector<uint64_t>::const_iterator iter = m_times.begin(); iter != m_times.end(); ++iter )
+	{
+		sum += *iter;
+	}
+	return sum / m_times.size();
+}
+
+double UVDBenchResult::getStandardDeviation() const
+{
+	double mean = getMean();
+	double sum = 0.0;
+
+	if( m_times.size() < 2 )
+	{
+		return 0.0;
+	}
+	for( std::vector<uint64_t>::const_iterator iter = m_times.begin(); iter != m_times.end(); ++iter )
+	{
+		double delta = *iter - mean;
+		sum += delta * delta;
+	}
+	return sqrt(sum / (m_times.size() - 1));
+}
+
+uint64_t UVDBenchResult::getMin() const
+{
+	if( m_times.empty() )
+	{
+		return 0;
+	}
+	return *std::min_element(m_times.begin(), m_times.end());
+}
+
+uint64_t UVDBenchResult::getMax() const
+{
+	if( m_times.empty() )
+	{
+		return 0;
+	}
+	return *std::max_element(m_times.begin(), m_times.end());
+}
+
+uint64_t UVDBenchResult::getMedian() const
+{
+	std::vector<uint64_t> sorted = m_times;
+
+	if( sorted.empty() )
+	{
+		return 0;
+	}
+	std::sort(sorted.begin(), sorted.end());
+	return sorted[sorted.size() / 2];
+}
+
+double UVDBenchResult::getBytesPerSecond() const
+{
+	double mean = getMean();
+
+	if( mean <= 0.0 )
+	{
+		return 0.0;
+	}
+	return m_bytes * 1000000.0 / mean;
+}
+
+double UVDBenchResult::getInstructionsPerSecond() const
+{
+	double mean = getMean();
+
+	if( mean <= 0.0 )
+	{
+		return 0.0;
+	}
+	return m_instructions * 1000000.0 / mean;
+}
+
+uv_err_t UVDBenchResult::toJSON(std::string &out) const
+{
+	char buffer[512];
+
+	out = "{\"stage\": " + UVDBenchJSONString(m_stage);
+	out += ", \"input\": " + UVDBenchJSONString(m_input);
+	snprintf(buffer, sizeof(buffer),
+			", \"ok\": %s, \"bytes\": %llu, \"instructions\": %llu"
+			", \"mean_us\": %.1f, \"stddev_us\": %.1f, \"min_us\": %llu, \"max_us\": %llu, \"median_us\": %llu"
+			", \"bytes_per_second\": %.1f, \"instructions_per_second\": %.1f",
+			UV_SUCCEEDED(m_rc) ? "true" : "false", (unsigned long long)m_bytes, (unsigned long long)m_instructions,
+			getMean(), getStandardDeviation(),
+			(unsigned long long)getMin(), (unsigned long long)getMax(), (unsigned long long)getMedian(),
+			getBytesPerSecond(), getInstructionsPerSecond());
+	out += buffer;
+	out += ", \"times_us\": [";
+	for( std::vector<uint64_t>::size_type i = 0; i < m_times.size(); ++i )
+	{
+		snprintf(buffer, sizeof(buffer), "%s%llu", i ? ", " : "", (unsigned long long)m_times[i]);
+		out += buffer;
+	}
+	out += "]}";
+
+	return UV_ERR_OK;
+}
+
+/*
+Running
+*/
+
+static uv_err_t benchRunOnce(const UVDBenchStage *stage, const UVDBenchInput *input, const std::vector<std::string> &args,
+		uint64_t *timeOut, uint64_t *instructionsOut)
+{
+	UVDBenchRun run;
+	UVDBenchmark benchmark;
+	uv_err_t rc = UV_ERR_GENERAL;
+
+	uv_assert_err_ret(run.init(input, args));
+	uv_assert_err_ret(stage->m_setUp(&run));
+
+	g_profiler.reset();
+	benchmark.start();
+	rc = stage->m_run(&run);
+	benchmark.stop();
+	uv_assert_err_ret(rc);
+
+	*timeOut = benchmark.getDelta();
+	*instructionsOut = g_profileInstructionsDecoded.m_value + g_profileInstructionCacheHits.m_value;
+	uv_assert_err_ret(run.deinit());
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDBenchRunStage(const UVDBenchStage *stage, const UVDBenchInput *input, const std::vector<std::string> &args,
+		uint32_t warmup, uint32_t repetitions, UVDBenchResult *out)
+{
+	uv_assert_ret(stage);
+	uv_assert_ret(input);
+	uv_assert_ret(out);
+
+	*out = UVDBenchResult();
+	out->m_stage = stage->m_name;
+	out->m_input = input->m_file;
+	out->m_bytes = input->m_size;
+
+	//Counters are only kept while profiling
+	g_profiler.enable();
+	for( uint32_t i = 0; i < warmup + repetitions; ++i )
+	{
+		uint64_t time = 0;
+		uint64_t instructions = 0;
+
+		out->m_rc = benchRunOnce(stage, input, args, &time, &instructions);
+		if( UV_FAILED(out->m_rc) )
+		{
+			printf_error("%s failed on %s (rc = %d)\n", stage->m_name, input->m_file.c_str(), out->m_rc);
+			return UV_ERR_OK;
+		}
+		if( i >= warmup )
+		{
+			out->m_times.push_back(time);
+			out->m_instructions = instructions;
+		}
+	}
+
+	return UV_ERR_OK;
+}
+
+std::string UVDBenchJSONString(const std::string &in)
+{
+	std::string ret = "\"";
+
+	for( std::string::const_iterator iter = in.begin(); iter != in.end(); ++iter )
+	{
+		unsigned char c = *iter;
+
+		if( c == '"' || c == '\\' )
+		{
+			ret += '\\';
+			ret += c;
+		}
+		else if( c < 0x20 )
+		{
+			char buffer[8];
+			snprintf(buffer, sizeof(buffer), "\\u%.4X", c);
+			ret += buffer;
+		}
+		else
+		{
+			ret += c;
+		}
+	}
+	ret += '"';
+	return ret;
+}
+
@@ -0,0 +1,135 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVD_TESTING_BENCH_BENCH_H
+#define UVD_TESTING_BENCH_BENCH_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "uvd/util/types.h"
+
+/*
+Throughput of each pipeline stage on its own
+Every repetition of a stage gets a fresh library (UVDInit() through UVDDeinit()) and engine
+Anything the stage needs first (loading, earlier passes) is done untimed in setUp
+so that a stage's time doesn't move when a different stage gets faster
+*/
+
+//Raw ROMs and executables to disassemble
+#define UVD_BENCH_INPUT_IMAGE				0
+//Objects / archives for obj2pat
+#define UVD_BENCH_INPUT_OBJECT				1
+//.pat files for pat2sig
+#define UVD_BENCH_INPUT_PATTERN				2
+//An object and a signature file that should match it
+#define UVD_BENCH_INPUT_SIGNATURE			3
+
+class UVDBenchInput
+{
+public:
+	UVDBenchInput();
+	uv_err_t init(const std::string &file, uint32_t type, const std::string &signatureFile = "");
+
+public:
+	std::string m_file;
+	//UVD_BENCH_INPUT_*
+	uint32_t m_type;
+	//UVD_BENCH_INPUT_SIGNATURE only
+	std::string m_signatureFile;
+	//Bytes, what throughput is reported against
+	uint64_t m_size;
+};
+
+class UVD;
+class UVDFLIRT;
+//State of one repetition of a stage on an input
+class UVDBenchRun
+{
+public:
+	UVDBenchRun();
+	~UVDBenchRun();
+
+	//UVDInit() and parse main with the plugins input needs plus args
+	uv_err_t init(const UVDBenchInput *input, const std::vector<std::string> &args);
+	//Deletes everything and UVDDeinit()
+	uv_err_t deinit();
+	//Engine for m_input
+	uv_err_t load();
+
+public:
+	const UVDBenchInput *m_input;
+	//As passed to parseMain(), must live until UVDDeinit()
+	int m_argc;
+	char **m_argv;
+	UVD *m_uvd;
+	UVDFLIRT *m_flirt;
+	//Printed / generated output, kept so the work can't be skipped
+	std::string m_output;
+	bool m_wasUVDInitCalled;
+};
+
+typedef uv_err_t (*UVDBenchFunction)(UVDBenchRun *run);
+
+class UVDBenchStage
+{
+public:
+	const char *m_name;
+	//UVD_BENCH_INPUT_*
+	uint32_t m_inputType;
+	//Untimed, after run init
+	UVDBenchFunction m_setUp;
+	//Timed
+	UVDBenchFunction m_run;
+	const char *m_description;
+};
+
+extern UVDBenchStage g_benchStages[];
+extern uint32_t g_benchStageCount;
+
+//All repetitions of a stage on an input
+class UVDBenchResult
+{
+public:
+	UVDBenchResult();
+
+	//us
+	double getMean() const;
+	//Sample standard deviation
+	double getStandardDeviation() const;
+	uint64_t getMin() const;
+	uint64_t getMax() const;
+	uint64_t getMedian() const;
+	//0 if nothing was timed
+	double getBytesPerSecond() const;
+	double getInstructionsPerSecond() const;
+
+	uv_err_t toJSON(std::string &out) const;
+
+public:
+	std::string m_stage;
+	std::string m_input;
+	//us per measured repetition
+	std::vector<uint64_t> m_times;
+	uint64_t m_bytes;
+	//Instructions decoded or served from the instruction cache in one repetition
+	uint64_t m_instructions;
+	//Error of the first failed repetition, results are partial then
+	uv_err_t m_rc;
+};
+
+/*
+Time stage on input
+warmup repetitions are run and thrown away first
+args are passed to parseMain() on every repetition
+*/
+uv_err_t UVDBenchRunStage(const UVDBenchStage *stage, const UVDBenchInput *input, const std::vector<std::string> &args,
+		uint32_t warmup, uint32_t repetitions, UVDBenchResult *out);
+
+std::string UVDBenchJSONString(const std::string &in);
+
+#endif
+
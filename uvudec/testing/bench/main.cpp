@@ -0,0 +1,374 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+
+Benchmark entry point
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <set>
+#include "testing/bench/bench.h"
+#include "uvd/config/arg.h"
+#include "uvd/config/arg_property.h"
+#include "uvd/config/arg_util.h"
+#include "uvd/core/uvd.h"
+#include "uvd/util/thread.h"
+#include "uvd/util/util.h"
+
+#define UVD_PROP_BENCH_IMAGE				"bench.image"
+#define UVD_PROP_BENCH_OBJECT				"bench.object"
+#define UVD_PROP_BENCH_PATTERN				"bench.pattern"
+#define UVD_PROP_BENCH_SIGNATURE			"bench.signature"
+#define UVD_PROP_BENCH_STAGE				"bench.stage"
+#define UVD_PROP_BENCH_WARMUP				"bench.warmup"
+#define UVD_PROP_BENCH_WARMUP_DEFAULT		1
+#define UVD_PROP_BENCH_REPETITIONS			"bench.repetitions"
+#define UVD_PROP_BENCH_REPETITIONS_DEFAULT	5
+#define UVD_PROP_BENCH_OUTPUT				"bench.output"
+
+//Passed to libuvudec on every run
+std::vector<std::string> g_extraArgs;
+UVDArgRegistry g_argRegistry;
+UVDArgConfigs *g_configArgs = NULL;
+
+//Given on the command line, bundled testing files otherwise
+std::vector<std::string> g_imageFiles;
+std::vector<std::string> g_objectFiles;
+std::vector<std::string> g_patternFiles;
+//object,signature file
+std::vector<std::pair<std::string, std::string> > g_signatureFiles;
+//Empty for all
+std::set<std::string> g_stageNames;
+uint32_t g_warmup = UVD_PROP_BENCH_WARMUP_DEFAULT;
+uint32_t g_repetitions = UVD_PROP_BENCH_REPETITIONS_DEFAULT;
+std::string g_outputFile;
+
+static uv_err_t argParser(const UVDArgConfig *argConfig, std::vector<std::string> argumentArguments, void *user);
+
+static uv_err_t initArgs()
+{
+	uv_assert_err_ret(g_argRegistry.newArgConfgs(&g_configArgs));
+	uv_assert_err_ret(g_configArgs->registerArgument(UVD_PROP_ACTION_HELP, 'h', "help", "print this message and exit", "", 0, argParser, false, NULL));
+	uv_assert_err_ret(g_configArgs->registerArgument(UVD_PROP_ACTION_VERSION, 0, "version", "print version and exit", "", 0, argParser, false, NULL));
+	uv_assert_err_ret(g_configArgs->registerArgument(UVD_PROP_BENCH_IMAGE, 0, "image", "add a ROM / executable to disassemble (ex: an 8051 ROM)", "", 1, argParser, false, NULL));
+	uv_assert_err_ret(g_configArgs->registerArgument(UVD_PROP_BENCH_OBJECT, 0, "object", "add an object or archive for obj2pat", "", 1, argParser, false, NULL));
+	uv_assert_err_ret(g_configArgs->registerArgument(UVD_PROP_BENCH_PATTERN, 0, "pattern", "add a .pat file for pat2sig", "", 1, argParser, false, NULL));
+	uv_assert_err_ret(g_configArgs->registerArgument(UVD_PROP_BENCH_SIGNATURE, 0, "signature", "add an <object>,<.sig file> pair for sig_match", "", 1, argParser, false, NULL));
+	uv_assert_err_ret(g_configArgs->registerArgument(UVD_PROP_BENCH_STAGE, 0, "stage", "only run given stage, may be repeated", "", 1, argParser, false, NULL));
+	uv_assert_err_ret(g_configArgs->registerArgument(UVD_PROP_BENCH_WARMUP, 0, "warmup", "untimed runs before measuring, default 1", "", 1, argParser, false, NULL));
+	uv_assert_err_ret(g_configArgs->registerArgument(UVD_PROP_BENCH_REPETITIONS, 0, "repetitions", "measured runs, default 5", "", 1, argParser, false, NULL));
+	uv_assert_err_ret(g_configArgs->registerArgument(UVD_PROP_BENCH_OUTPUT, 0, "output", "write results as JSON to given file", "", 1, argParser, false, NULL));
+
+	return UV_ERR_OK;
+}
+
+static uv_err_t printfHelp()
+{
+	const char *program_name = "uvbench";
+
+	printf_help("%s version %s\n", program_name, UVUDEC_VER_STRING);
+	UVDPrintVersion();
+	uv_assert_err_ret(g_argRegistry.printUsage());
+	printf_help("Stages:\n");
+	for( uint32_t i = 0; i < g_benchStageCount; ++i )
+	{
+		printf_help("\t%s: %s\n", g_benchStages[i].m_name, g_benchStages[i].m_description);
+	}
+	printf_help("Everything after --args is passed to libuvudec, ex: --args --analysis-threads=1\n");
+
+	return UV_ERR_OK;
+}
+
+static uv_err_t argParser(const UVDArgConfig *argConfig, std::vector<std::string> argumentArguments, void *)
+{
+	//If present
+	std::string firstArg;
+	uint32_t firstArgNum = 0;
+
+	uv_assert_ret(argConfig);
+
+	if( !argumentArguments.empty() )
+	{
+		firstArg = argumentArguments[0];
+		firstArgNum = strtol(firstArg.c_str(), NULL, 0);
+	}
+
+	if( argConfig->isNakedHandler() )
+	{
+		UVDPrintfError("no undecorated arg support, maybe you need --args\n");
+		printfHelp();
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_ACTION_HELP )
+	{
+		printfHelp();
+		return UV_ERR_DONE;
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_ACTION_VERSION )
+	{
+		UVDPrintVersion();
+		return UV_ERR_DONE;
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_BENCH_IMAGE )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		g_imageFiles.push_back(firstArg);
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_BENCH_OBJECT )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		g_objectFiles.push_back(firstArg);
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_BENCH_PATTERN )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		g_patternFiles.push_back(firstArg);
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_BENCH_SIGNATURE )
+	{
+		std::string::size_type separator = firstArg.find(',');
+
+		uv_assert_ret(!argumentArguments.empty());
+		if( separator == std::string::npos )
+		{
+			printf_error("expected <object>,<.sig file>, got %s\n", firstArg.c_str());
+			return UV_DEBUG(UV_ERR_GENERAL);
+		}
+		g_signatureFiles.push_back(std::pair<std::string, std::string>(firstArg.substr(0, separator), firstArg.substr(separator + 1)));
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_BENCH_STAGE )
+	{
+		bool found = false;
+
+		uv_assert_ret(!argumentArguments.empty());
+		for( uint32_t i = 0; i < g_benchStageCount; ++i )
+		{
+			if( firstArg == g_benchStages[i].m_name )
+			{
+				found = true;
+			}
+		}
+		if( !found )
+		{
+			printf_error("unrecognized stage: %s\n", firstArg.c_str());
+			return UV_DEBUG(UV_ERR_GENERAL);
+		}
+		g_stageNames.insert(firstArg);
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_BENCH_WARMUP )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		g_warmup = firstArgNum;
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_BENCH_REPETITIONS )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		g_repetitions = firstArgNum;
+		uv_assert_ret(g_repetitions > 0);
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_BENCH_OUTPUT )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		g_outputFile = firstArg;
+	}
+	else
+	{
+		printf_error("main: property not recognized in callback: %s\n", argConfig->m_propertyForm.c_str());
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+
+	return UV_ERR_OK;
+}
+
+static uv_err_t getInputs(std::vector<UVDBenchInput> &out)
+{
+	std::string installDir;
+	std::string testingDir;
+
+	//Bundled files, as uvtest finds them
+	uv_assert_err_ret(UVDGetInstallDir(installDir));
+	testingDir = installDir + "/testing";
+	if( g_imageFiles.empty() )
+	{
+		g_imageFiles.push_back(testingDir + "/image/game_boy/Arkaid_Release_02/arkaid.gb");
+		g_imageFiles.push_back(testingDir + "/image/game_boy_advance/GBA_Cards_v0-02/GBACards.gba");
+	}
+	if( g_objectFiles.empty() )
+	{
+		g_objectFiles.push_back(testingDir + "/flirt/ELF/uvtest_main.o");
+		g_objectFiles.push_back(testingDir + "/flirt/ELF/libm.a");
+	}
+	if( g_patternFiles.empty() )
+	{
+		g_patternFiles.push_back(testingDir + "/flirt/ELF/uvtest_main.pat");
+		g_patternFiles.push_back(testingDir + "/flirt/ELF/libm.pat");
+	}
+	if( g_signatureFiles.empty() )
+	{
+		g_signatureFiles.push_back(std::pair<std::string, std::string>(testingDir + "/flirt/ELF/uvtest_main.o", testingDir + "/flirt/ELF/uvtest_main.sig"));
+	}
+
+	out.clear();
+	for( std::vector<std::string>::iterator iter = g_imageFiles.begin(); iter != g_imageFiles.end(); ++iter )
+	{
+		out.push_back(UVDBenchInput());
+		uv_assert_err_ret(out.back().init(*iter, UVD_BENCH_INPUT_IMAGE));
+	}
+	for( std::vector<std::string>::iterator iter = g_objectFiles.begin(); iter != g_objectFiles.end(); ++iter )
+	{
+		out.push_back(UVDBenchInput());
+		uv_assert_err_ret(out.back().init(*iter, UVD_BENCH_INPUT_OBJECT));
+	}
+	for( std::vector<std::string>::iterator iter = g_patternFiles.begin(); iter != g_patternFiles.end(); ++iter )
+	{
+		out.push_back(UVDBenchInput());
+		uv_assert_err_ret(out.back().init(*iter, UVD_BENCH_INPUT_PATTERN));
+	}
+	for( std::vector<std::pair<std::string, std::string> >::iterator iter = g_signatureFiles.begin(); iter != g_signatureFiles.end(); ++iter )
+	{
+		out.push_back(UVDBenchInput());
+		uv_assert_err_ret(out.back().init((*iter).first, UVD_BENCH_INPUT_SIGNATURE, (*iter).second));
+	}
+
+	return UV_ERR_OK;
+}
+
+static void printResult(const UVDBenchResult &result)
+{
+	double mean = result.getMean();
+
+	if( UV_FAILED(result.m_rc) )
+	{
+		printf("%-12s %-24s FAILED (rc = %d)\n", result.m_stage.c_str(), uv_basename(result.m_input).c_str(), result.m_rc);
+		return;
+	}
+	printf("%-12s %-24s %10.3f %7.1f%% %10.3f %10.3f %10.3f %12.1f\n",
+			result.m_stage.c_str(), uv_basename(result.m_input).c_str(),
+			mean / 1000.0, mean > 0.0 ? 100.0 * result.getStandardDeviation() / mean : 0.0,
+			result.getMin() / 1000.0, result.getMax() / 1000.0,
+			result.getBytesPerSecond() / 1000000.0, result.getInstructionsPerSecond() / 1000.0);
+	fflush(stdout);
+}
+
+static uv_err_t writeResults(const std::vector<UVDBenchResult> &results)
+{
+	std::string out;
+	char buffer[256];
+
+	snprintf(buffer, sizeof(buffer), "{\n\"version\": \"%s\",\n\"cpus\": %u,\n\"warmup\": %u,\n\"repetitions\": %u,\n",
+			UVUDEC_VER_STRING, UVDThreadPool::getCPUCount(), g_warmup, g_repetitions);
+	out += buffer;
+	out += "\"args\": [";
+	for( std::vector<std::string>::size_type i = 0; i < g_extraArgs.size(); ++i )
+	{
+		if( i )
+		{
+			out += ", ";
+		}
+		out += UVDBenchJSONString(g_extraArgs[i]);
+	}
+	out += "],\n\"results\": [";
+	for( std::vector<UVDBenchResult>::size_type i = 0; i < results.size(); ++i )
+	{
+		std::string result;
+
+		uv_assert_err_ret(results[i].toJSON(result));
+		out += i ? ",\n\t" : "\n\t";
+		out += result;
+	}
+	out += "\n]\n}\n";
+
+	uv_assert_err_ret(writeFile(g_outputFile, out));
+	return UV_ERR_OK;
+}
+
+uv_err_t uvmain(int argc, char **argv)
+{
+	int parsed_argc = 0;
+	uv_err_t rc = UV_ERR_GENERAL;
+	std::vector<UVDBenchInput> inputs;
+	std::vector<UVDBenchResult> results;
+	uint32_t failed = 0;
+
+	//Everything after --args and remove it
+	for( parsed_argc = 1; parsed_argc < argc; ++parsed_argc )
+	{
+		if( std::string(argv[parsed_argc]) == "--args" )
+		{
+			for( int i = parsed_argc + 1; i < argc; ++i )
+			{
+				g_extraArgs.push_back(argv[i]);
+			}
+			break;
+		}
+	}
+
+	uv_assert_err_ret(initArgs());
+	rc = g_argRegistry.processMain(parsed_argc, argv);
+	if( UV_FAILED(rc) )
+	{
+		printf_error("failed to parse args (rc = %d)\n", rc);
+		printfHelp();
+		return UV_DEBUG(rc);
+	}
+	else if( rc == UV_ERR_DONE )
+	{
+		return UV_ERR_OK;
+	}
+	uv_assert_err_ret(getInputs(inputs));
+
+	printf("%-12s %-24s %10s %8s %10s %10s %10s %12s\n",
+			"stage", "input", "mean ms", "stddev", "min ms", "max ms", "MB/s", "K inst/s");
+	for( uint32_t i = 0; i < g_benchStageCount; ++i )
+	{
+		const UVDBenchStage *stage = &g_benchStages[i];
+
+		if( !g_stageNames.empty() && g_stageNames.find(stage->m_name) == g_stageNames.end() )
+		{
+			continue;
+		}
+		for( std::vector<UVDBenchInput>::iterator iter = inputs.begin(); iter != inputs.end(); ++iter )
+		{
+			UVDBenchResult result;
+
+			if( (*iter).m_type != stage->m_inputType )
+			{
+				continue;
+			}
+			uv_assert_err_ret(UVDBenchRunStage(stage, &*iter, g_extraArgs, g_warmup, g_repetitions, &result));
+			printResult(result);
+			if( UV_FAILED(result.m_rc) )
+			{
+				++failed;
+			}
+			results.push_back(result);
+		}
+	}
+
+	if( !g_outputFile.empty() )
+	{
+		uv_assert_err_ret(writeResults(results));
+	}
+	if( failed )
+	{
+		printf_error("%d benchmarks failed\n", failed);
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+
+	return UV_ERR_OK;
+}
+
+int main(int argc, char **argv)
+{
+	uv_err_t rc = uvmain(argc, argv);
+
+	if( UV_FAILED(rc) )
+	{
+		return 1;
+	}
+	return 0;
+}
+
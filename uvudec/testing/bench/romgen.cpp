@@ -0,0 +1,642 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include <algorithm>
+#include <set>
+#include <string.h>
+#include "testing/bench/romgen.h"
+#include "uvdasm/opcode_table.h"
+#include "uvd/util/debug.h"
+#include "uvd/util/error.h"
+
+//Functions smaller than this many of the longest instruction become data islands
+#define UVD_ROMGEN_FUNCTION_INSTRUCTIONS_MIN	2
+#define UVD_ROMGEN_STRING_LENGTH_MIN			6
+#define UVD_ROMGEN_STRING_LENGTH_MAX			48
+#define UVD_ROMGEN_STRINGS_SIZE_MIN				32
+#define UVD_ROMGEN_STRINGS_SIZE_MAX				512
+#define UVD_ROMGEN_DATA_SIZE_MIN				16
+#define UVD_ROMGEN_DATA_SIZE_MAX				1024
+//Forward only, also the largest positive signed 8 bit displacement
+#define UVD_ROMGEN_RELATIVE_MAX					0x7F
+//Keeps the bank buffer reasonable if an architecture has 32 bit targets
+#define UVD_ROMGEN_TARGET_BITS_MAX				24
+
+static const char *g_romGenWords[] = {
+	"error", "init", "table", "player", "score", "level", "sound", "timer",
+	"ready", "load", "save", "menu", "press", "start", "game", "over",
+	"data", "value", "buffer", "reset", "check", "memory", "battery", "link",
+};
+
+/*
+UVDRomGenRandom
+*/
+
+UVDRomGenRandom::UVDRomGenRandom()
+{
+	seed(0);
+}
+
+void UVDRomGenRandom::seed(uint64_t seed)
+{
+	//State can't be 0, mix so nearby seeds don't start out alike
+	m_state = seed * 0x9E3779B97F4A7C15ULL + 0x2545F4914F6CDD1DULL;
+	if( m_state == 0 )
+	{
+		m_state = 1;
+	}
+}
+
+uint64_t UVDRomGenRandom::next()
+{
+	m_state ^= m_state >> 12;
+	m_state ^= m_state << 25;
+	m_state ^= m_state >> 27;
+	return m_state * 0x2545F4914F6CDD1DULL;
+}
+
+uint32_t UVDRomGenRandom::range(uint32_t n)
+{
+	return (uint32_t)((next() >> 32) % n);
+}
+
+uint32_t UVDRomGenRandom::between(uint32_t low, uint32_t high)
+{
+	if( high <= low )
+	{
+		return low;
+	}
+	return low + range(high - low + 1);
+}
+
+double UVDRomGenRandom::fraction()
+{
+	return (next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*
+UVDRomGenConfig
+*/
+
+UVDRomGenConfig::UVDRomGenConfig()
+{
+	m_size = 0x100000;
+	m_seed = 1;
+	m_callDensity = 0.05;
+	m_jumpDensity = 0.1;
+	m_stringDensity = 0.05;
+	m_dataDensity = 0.05;
+	m_functionSize = 128;
+}
+
+/*
+UVDRomGenInstruction
+*/
+
+UVDRomGenInstruction::UVDRomGenInstruction()
+{
+	m_shared = NULL;
+	m_length = 0;
+	m_targetOffset = 0;
+	m_targetBits = 0;
+}
+
+void UVDRomGenInstruction::encode(UVDRomGenRandom &random, uint8_t *out) const
+{
+	uint32_t i = 0;
+
+	for( ; i < m_opcodes.size(); ++i )
+	{
+		const std::vector<uint8_t> &opcodes = m_opcodes[i];
+
+		out[i] = opcodes[random.range(opcodes.size())];
+	}
+	for( ; i < m_length; ++i )
+	{
+		out[i] = (uint8_t)random.next();
+	}
+}
+
+/*
+UVDRomGenerator
+*/
+
+//Immediates of operands, including those that are function arguments
+static void getImmediates(const std::vector<UVDDisasmOperandShared *> &operands, std::vector<UVDDisasmOperandShared *> &out)
+{
+	for( std::vector<UVDDisasmOperandShared *>::const_iterator iter = operands.begin(); iter != operands.end(); ++iter )
+	{
+		UVDDisasmOperandShared *operand = *iter;
+
+		if( operand->m_type == UV_DISASM_DATA_IMMS || operand->m_type == UV_DISASM_DATA_IMMU )
+		{
+			out.push_back(operand);
+		}
+		else if( operand->m_type == UV_DISASM_DATA_FUNC && operand->m_func )
+		{
+			getImmediates(operand->m_func->m_args, out);
+		}
+	}
+}
+
+static std::string stripSpaces(const std::string &in)
+{
+	std::string ret;
+
+	for( std::string::size_type i = 0; i < in.size(); ++i )
+	{
+		if( in[i] != ' ' && in[i] != '\t' )
+		{
+			ret += in[i];
+		}
+	}
+	return ret;
+}
+
+//Only what we put in the manifest: paths and generated strings
+static std::string jsonString(const std::string &in)
+{
+	std::string ret = "\"";
+
+	for( std::string::size_type i = 0; i < in.size(); ++i )
+	{
+		if( in[i] == '"' || in[i] == '\\' )
+		{
+			ret += '\\';
+		}
+		ret += in[i];
+	}
+	return ret + "\"";
+}
+
+UVDRomGenerator::UVDRomGenerator()
+{
+	m_fillerLengthMin = 0;
+	m_lengthMax = 0;
+	m_bankSize = UVD_ROMGEN_BANK_SIZE_DEFAULT;
+	for( uint32_t i = 0; i < sizeof(m_regionBytes) / sizeof(m_regionBytes[0]); ++i )
+	{
+		m_regionBytes[i] = 0;
+	}
+	m_functionCount = 0;
+	m_stringCount = 0;
+	m_dataCount = 0;
+	m_instructionCount = 0;
+	m_callCount = 0;
+	m_jumpCount = 0;
+	m_firstRegion = true;
+}
+
+uv_err_t UVDRomGenerator::init(UVDDisasmOpcodeLookupTable *table, const UVDRomGenConfig &config)
+{
+	uint32_t targetBits = 0;
+
+	uv_assert_ret(table);
+	m_config = config;
+	m_random.seed(m_config.m_seed);
+	uv_assert_ret(m_config.m_stringDensity >= 0.0 && m_config.m_dataDensity >= 0.0);
+	uv_assert_ret(m_config.m_stringDensity + m_config.m_dataDensity <= 1.0);
+	uv_assert_ret(m_config.m_functionSize);
+
+	//m_instructions is in .op file order so the same file always gives the same picks
+	for( std::vector<UVDDisasmInstructionShared *>::iterator iter = table->m_instructions.begin(); iter != table->m_instructions.end(); ++iter )
+	{
+		uv_assert_err_ret(classify(*iter));
+	}
+	printf_debug_level(UVD_DEBUG_SUMMARY, "romgen: %d filler, %d call, %d jump, %d relative jump, %d return instructions\n",
+			m_filler.size(), m_calls.size(), m_jumps.size(), m_relativeJumps.size(), m_returns.size());
+	if( m_filler.empty() || m_returns.empty() )
+	{
+		printf_error("architecture needs at least one plain instruction and an unconditional return\n");
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+
+	m_fillerLengthMin = m_filler[0].m_length;
+	for( std::vector<UVDRomGenInstruction>::iterator iter = m_filler.begin(); iter != m_filler.end(); ++iter )
+	{
+		m_fillerLengthMin = std::min(m_fillerLengthMin, iter->m_length);
+	}
+	for( std::vector<UVDRomGenInstruction>::iterator iter = m_calls.begin(); iter != m_calls.end(); ++iter )
+	{
+		targetBits = std::max(targetBits, iter->m_targetBits);
+	}
+	for( std::vector<UVDRomGenInstruction>::iterator iter = m_jumps.begin(); iter != m_jumps.end(); ++iter )
+	{
+		targetBits = std::max(targetBits, iter->m_targetBits);
+	}
+	if( targetBits )
+	{
+		m_bankSize = 1 << std::min(targetBits, (uint32_t)UVD_ROMGEN_TARGET_BITS_MAX);
+	}
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDRomGenerator::classify(UVDDisasmInstructionShared *shared)
+{
+	UVDRomGenInstruction instruction;
+	std::vector<UVDDisasmOperandShared *> immediates;
+	UVDDisasmOperandShared *target = NULL;
+	std::string action;
+
+	uv_assert_ret(shared);
+	instruction.m_shared = shared;
+	instruction.m_length = shared->m_total_length;
+	uv_assert_ret(instruction.m_length >= shared->m_opcode_length);
+	for( uint32_t i = 0; i < shared->m_opcode_length; ++i )
+	{
+		std::set<uint8_t> opcodes;
+
+		uv_assert_err_ret(shared->getOpcodes(i, opcodes));
+		uv_assert_ret(!opcodes.empty());
+		instruction.m_opcodes.push_back(std::vector<uint8_t>(opcodes.begin(), opcodes.end()));
+	}
+	m_lengthMax = std::max(m_lengthMax, instruction.m_length);
+	getImmediates(shared->m_operands, immediates);
+
+	//Random immediates are fine as long as they can't change control flow
+	if( !shared->m_isCall && !shared->m_isJump && !shared->m_isReturn )
+	{
+		m_filler.push_back(instruction);
+		return UV_ERR_OK;
+	}
+	if( shared->m_isReturn )
+	{
+		if( !shared->m_isCall && !shared->m_isJump && !shared->m_isConditional && immediates.empty() )
+		{
+			m_returns.push_back(instruction);
+		}
+		return UV_ERR_OK;
+	}
+
+	/*
+	Branches we can aim: one immediate directly after the opcode that is the whole target
+	Skips things like 8051 ACALL (target partly from PC and opcode) and CJNE (two immediates)
+	*/
+	if( immediates.size() != 1 )
+	{
+		return UV_ERR_OK;
+	}
+	target = immediates[0];
+	if( target->m_immediate_size % 8 || shared->m_total_length != shared->m_opcode_length + target->m_immediate_size / 8 )
+	{
+		return UV_ERR_OK;
+	}
+	instruction.m_targetOffset = shared->m_opcode_length;
+	instruction.m_targetBits = target->m_immediate_size;
+	action = stripSpaces(shared->m_action);
+
+	if( instruction.m_targetBits >= 16 && action == "CALL(" + target->m_name + ")" )
+	{
+		m_calls.push_back(instruction);
+	}
+	else if( instruction.m_targetBits >= 16 && (action == "GOTO(" + target->m_name + ")" || action == "GOTO(ROM(" + target->m_name + "))") )
+	{
+		m_jumps.push_back(instruction);
+	}
+	else if( instruction.m_targetBits == 8 && action == "GOTO(%PC+" + target->m_name + ")" )
+	{
+		m_relativeJumps.push_back(instruction);
+	}
+	else
+	{
+		printf_debug("romgen: not using %s, action %s\n", shared->m_memoric.c_str(), shared->m_action.c_str());
+	}
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDRomGenerator::generate(const std::string &romFile, const std::string &manifestFile, const std::string &architecture)
+{
+	uv_err_t rc = UV_ERR_GENERAL;
+	FILE *rom = NULL;
+	FILE *manifest = NULL;
+
+	rom = fopen(romFile.c_str(), "wb");
+	if( !rom )
+	{
+		printf_error("could not open %s\n", romFile.c_str());
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	manifest = fopen(manifestFile.c_str(), "w");
+	if( !manifest )
+	{
+		printf_error("could not open %s\n", manifestFile.c_str());
+		fclose(rom);
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+
+	fprintf(manifest, "{\n\t\"architecture\": %s,\n\t\"seed\": %llu,\n\t\"size\": %llu,\n\t\"bank_size\": %u,\n\t\"regions\": [",
+			jsonString(architecture).c_str(), (unsigned long long)m_config.m_seed, (unsigned long long)m_config.m_size, m_bankSize);
+	//Banks are written as they are made so image size isn't limited by memory
+	for( uint64_t bankAddress = 0; bankAddress < m_config.m_size; bankAddress += m_bankSize )
+	{
+		uint32_t size = (uint32_t)std::min((uint64_t)m_bankSize, m_config.m_size - bankAddress);
+
+		uv_assert_err(generateBank(size));
+		if( fwrite(&m_bank[0], 1, size, rom) != size )
+		{
+			printf_error("could not write %s\n", romFile.c_str());
+			goto error;
+		}
+		uv_assert_err(writeManifestRegions(manifest, bankAddress));
+	}
+	fprintf(manifest, "\n\t],\n\t\"functions\": %llu,\n\t\"strings\": %llu,\n\t\"data\": %llu,\n\t\"instructions\": %llu,\n\t\"calls\": %llu,\n\t\"jumps\": %llu\n}\n",
+			(unsigned long long)m_functionCount, (unsigned long long)m_stringCount, (unsigned long long)m_dataCount,
+			(unsigned long long)m_instructionCount, (unsigned long long)m_callCount, (unsigned long long)m_jumpCount);
+	if( ferror(manifest) )
+	{
+		printf_error("could not write %s\n", manifestFile.c_str());
+		goto error;
+	}
+
+	rc = UV_ERR_OK;
+
+error:
+	//Close errors are write errors too
+	if( fclose(rom) )
+	{
+		rc = UV_ERR_GENERAL;
+	}
+	if( fclose(manifest) )
+	{
+		rc = UV_ERR_GENERAL;
+	}
+	return UV_DEBUG(rc);
+}
+
+uv_err_t UVDRomGenerator::generateBank(uint32_t size)
+{
+	std::vector<std::pair<uint32_t, const UVDRomGenInstruction *> > calls;
+	//m_regions index of each function
+	std::vector<uint32_t> functions;
+	double targets[3];
+	uint32_t address = 0;
+	//Smallest that still has room for something besides the return
+	uint32_t functionSizeMin = m_lengthMax * UVD_ROMGEN_FUNCTION_INSTRUCTIONS_MIN;
+
+	m_bank.assign(size, 0);
+	m_regions.clear();
+	targets[UVD_ROMGEN_REGION_STRINGS] = m_config.m_stringDensity;
+	targets[UVD_ROMGEN_REGION_DATA] = m_config.m_dataDensity;
+	targets[UVD_ROMGEN_REGION_FUNCTION] = 1.0 - m_config.m_stringDensity - m_config.m_dataDensity;
+
+	while( address < size )
+	{
+		UVDRomGenRegion region;
+		uint32_t remaining = size - address;
+		uint64_t total = m_regionBytes[0] + m_regionBytes[1] + m_regionBytes[2];
+		double deficitMax = 0.0;
+
+		//Whichever kind is furthest behind its share of the image so far
+		region.m_type = UVD_ROMGEN_REGION_FUNCTION;
+		region.m_address = address;
+		region.m_called = false;
+		for( uint32_t type = 0; type < 3; ++type )
+		{
+			double deficit = targets[type] * (total + 1) - m_regionBytes[type];
+
+			if( type == 0 || deficit > deficitMax )
+			{
+				region.m_type = type;
+				deficitMax = deficit;
+			}
+		}
+		//Gaps too small for what we picked end up as data
+		if( region.m_type == UVD_ROMGEN_REGION_FUNCTION && remaining < functionSizeMin )
+		{
+			region.m_type = UVD_ROMGEN_REGION_DATA;
+		}
+		if( region.m_type == UVD_ROMGEN_REGION_STRINGS && remaining < UVD_ROMGEN_STRING_LENGTH_MIN + 1 )
+		{
+			region.m_type = UVD_ROMGEN_REGION_DATA;
+		}
+
+		if( region.m_type == UVD_ROMGEN_REGION_FUNCTION )
+		{
+			region.m_size = m_random.between(m_config.m_functionSize / 2, m_config.m_functionSize * 3 / 2);
+			region.m_size = std::min(std::max(region.m_size, functionSizeMin), remaining);
+			uv_assert_err_ret(generateFunction(address, &region.m_size, calls));
+			functions.push_back(m_regions.size());
+		}
+		else if( region.m_type == UVD_ROMGEN_REGION_STRINGS )
+		{
+			region.m_size = std::min(m_random.between(UVD_ROMGEN_STRINGS_SIZE_MIN, UVD_ROMGEN_STRINGS_SIZE_MAX), remaining);
+			generateStrings(address, region.m_size, region);
+		}
+		else
+		{
+			region.m_size = std::min(m_random.between(UVD_ROMGEN_DATA_SIZE_MIN, UVD_ROMGEN_DATA_SIZE_MAX), remaining);
+			generateData(address, region.m_size);
+		}
+		uv_assert_ret(region.m_size);
+		m_regionBytes[region.m_type] += region.m_size;
+		address += region.m_size;
+		m_regions.push_back(region);
+	}
+
+	//Now that every function in the bank is placed calls can go forward too
+	for( std::vector<std::pair<uint32_t, const UVDRomGenInstruction *> >::iterator iter = calls.begin(); iter != calls.end(); ++iter )
+	{
+		UVDRomGenRegion &function = m_regions[functions[m_random.range(functions.size())]];
+
+		writeTarget(iter->first, iter->second, function.m_address);
+		function.m_called = true;
+	}
+
+	return UV_ERR_OK;
+}
+
+uv_err_t UVDRomGenerator::generateFunction(uint32_t address, uint32_t *size, std::vector<std::pair<uint32_t, const UVDRomGenInstruction *> > &calls)
+{
+	std::vector<std::pair<uint32_t, const UVDRomGenInstruction *> > jumps;
+	//Start of every instruction, in order
+	std::vector<uint32_t> boundaries;
+	const UVDRomGenInstruction *ret = NULL;
+	uint32_t jumpCount = m_jumps.size() + m_relativeJumps.size();
+	uint32_t current = address;
+	uint32_t end = 0;
+
+	uv_assert_ret(size);
+	ret = &m_returns[m_random.range(m_returns.size())];
+	uv_assert_ret(*size >= ret->m_length);
+	end = address + *size - ret->m_length;
+
+	while( current < end )
+	{
+		const UVDRomGenInstruction *instruction = NULL;
+		uint32_t remaining = end - current;
+		double pick = m_random.fraction();
+
+		if( pick < m_config.m_callDensity && !m_calls.empty() )
+		{
+			instruction = &m_calls[m_random.range(m_calls.size())];
+		}
+		else if( pick < m_config.m_callDensity + m_config.m_jumpDensity && jumpCount )
+		{
+			uint32_t index = m_random.range(jumpCount);
+
+			if( index < m_jumps.size() )
+			{
+				instruction = &m_jumps[index];
+			}
+			else
+			{
+				instruction = &m_relativeJumps[index - m_jumps.size()];
+			}
+		}
+		else
+		{
+			instruction = &m_filler[m_random.range(m_filler.size())];
+		}
+		//Near the end only filler short enough will do
+		if( instruction->m_length > remaining )
+		{
+			if( m_fillerLengthMin > remaining )
+			{
+				break;
+			}
+			do
+			{
+				instruction = &m_filler[m_random.range(m_filler.size())];
+			} while( instruction->m_length > remaining );
+		}
+
+		instruction->encode(m_random, &m_bank[current]);
+		boundaries.push_back(current);
+		if( instruction->m_shared->m_isCall )
+		{
+			calls.push_back(std::pair<uint32_t, const UVDRomGenInstruction *>(current, instruction));
+			++m_callCount;
+		}
+		else if( instruction->m_targetBits )
+		{
+			jumps.push_back(std::pair<uint32_t, const UVDRomGenInstruction *>(current, instruction));
+			++m_jumpCount;
+		}
+		current += instruction->m_length;
+		++m_instructionCount;
+	}
+	ret->encode(m_random, &m_bank[current]);
+	boundaries.push_back(current);
+	current += ret->m_length;
+	++m_instructionCount;
+	*size = current - address;
+
+	//Jumps stay within the function and land on an instruction
+	for( std::vector<std::pair<uint32_t, const UVDRomGenInstruction *> >::iterator iter = jumps.begin(); iter != jumps.end(); ++iter )
+	{
+		const UVDRomGenInstruction *instruction = iter->second;
+		uint32_t following = iter->first + instruction->m_length;
+
+		if( instruction->m_targetBits == 8 )
+		{
+			//Relative to the following instruction, which is always a valid target
+			std::vector<uint32_t>::iterator first = std::lower_bound(boundaries.begin(), boundaries.end(), following);
+			std::vector<uint32_t>::iterator last = std::upper_bound(first, boundaries.end(), following + UVD_ROMGEN_RELATIVE_MAX);
+
+			uv_assert_ret(first != last);
+			writeTarget(iter->first, instruction, *(first + m_random.range(last - first)) - following);
+		}
+		else
+		{
+			writeTarget(iter->first, instruction, boundaries[m_random.range(boundaries.size())]);
+		}
+	}
+
+	return UV_ERR_OK;
+}
+
+void UVDRomGenerator::generateStrings(uint32_t address, uint32_t size, UVDRomGenRegion &region)
+{
+	uint32_t current = address;
+	uint32_t end = address + size;
+
+	//Leftover too short for a string stays 0
+	while( end - current >= UVD_ROMGEN_STRING_LENGTH_MIN + 1 )
+	{
+		uint32_t length = m_random.between(UVD_ROMGEN_STRING_LENGTH_MIN, std::min((uint32_t)UVD_ROMGEN_STRING_LENGTH_MAX, end - current - 1));
+		std::string text;
+
+		//Words so it looks like text to anything checking, cut to length
+		while( text.size() < length )
+		{
+			if( !text.empty() )
+			{
+				text += ' ';
+			}
+			text += g_romGenWords[m_random.range(sizeof(g_romGenWords) / sizeof(g_romGenWords[0]))];
+		}
+		text.resize(length);
+		//Not ending on a space keeps scanners that trim from disagreeing with us
+		if( text[length - 1] == ' ' )
+		{
+			text[length - 1] = '.';
+		}
+
+		memcpy(&m_bank[current], text.c_str(), length + 1);
+		region.m_strings.push_back(std::pair<uint32_t, std::string>(current, text));
+		current += length + 1;
+	}
+}
+
+void UVDRomGenerator::generateData(uint32_t address, uint32_t size)
+{
+	for( uint32_t i = 0; i < size; ++i )
+	{
+		m_bank[address + i] = (uint8_t)m_random.next();
+	}
+}
+
+void UVDRomGenerator::writeTarget(uint32_t address, const UVDRomGenInstruction *instruction, uint32_t target)
+{
+	uint8_t *out = &m_bank[address + instruction->m_targetOffset];
+
+	//Most significant byte first, as UVDDisasmOperand::parseOperand() reads them
+	for( uint32_t i = instruction->m_targetBits / 8; i > 0; --i )
+	{
+		*out = (uint8_t)(target >> ((i - 1) * 8));
+		++out;
+	}
+}
+
+uv_err_t UVDRomGenerator::writeManifestRegions(FILE *manifest, uint64_t bankAddress)
+{
+	uv_assert_ret(manifest);
+	for( std::vector<UVDRomGenRegion>::iterator iter = m_regions.begin(); iter != m_regions.end(); ++iter )
+	{
+		const UVDRomGenRegion &region = *iter;
+
+		if( region.m_type == UVD_ROMGEN_REGION_FUNCTION )
+		{
+			fprintf(manifest, "%s\n\t\t{\"type\": \"function\", \"address\": %llu, \"size\": %u, \"called\": %s}",
+					m_firstRegion ? "" : ",", (unsigned long long)(bankAddress + region.m_address), region.m_size,
+					region.m_called ? "true" : "false");
+			m_firstRegion = false;
+			++m_functionCount;
+		}
+		else if( region.m_type == UVD_ROMGEN_REGION_STRINGS )
+		{
+			for( std::vector<std::pair<uint32_t, std::string> >::const_iterator stringIter = region.m_strings.begin();
+					stringIter != region.m_strings.end(); ++stringIter )
+			{
+				fprintf(manifest, "%s\n\t\t{\"type\": \"string\", \"address\": %llu, \"value\": %s}",
+						m_firstRegion ? "" : ",", (unsigned long long)(bankAddress + stringIter->first),
+						jsonString(stringIter->second).c_str());
+				m_firstRegion = false;
+				++m_stringCount;
+			}
+		}
+		else
+		{
+			fprintf(manifest, "%s\n\t\t{\"type\": \"data\", \"address\": %llu, \"size\": %u}",
+					m_firstRegion ? "" : ",", (unsigned long long)(bankAddress + region.m_address), region.m_size);
+			m_firstRegion = false;
+			++m_dataCount;
+		}
+	}
+	return UV_ERR_OK;
+}
@@ -0,0 +1,173 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVD_TESTING_BENCH_ROMGEN_H
+#define UVD_TESTING_BENCH_ROMGEN_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "uvd/util/types.h"
+
+/*
+Synthetic ROM images of any size for profiling, built from a uvdasm .op file
+The image is a series of functions, string tables and data islands
+Functions are valid instruction streams ending in a return with calls to other functions and jumps within themselves
+A manifest lists where every region was placed so analysis results can be checked against it
+
+Output depends only on the .op file and the config, the same seed always gives the same image
+
+Absolute targets are as wide as the .op file's widest call/jump immediate (16 bits for 8051 and Game Boy)
+Larger images are built from independent banks of that size, like a banked cartridge
+Calls and jumps only target their own bank and encode the in-bank address
+*/
+
+//Bank size if the architecture has no absolute call or jump
+#define UVD_ROMGEN_BANK_SIZE_DEFAULT		0x10000
+
+#define UVD_ROMGEN_REGION_FUNCTION			0
+#define UVD_ROMGEN_REGION_STRINGS			1
+#define UVD_ROMGEN_REGION_DATA				2
+
+/*
+xorshift64*
+Not rand(): that differs between C libraries and the images wouldn't be reproducible
+*/
+class UVDRomGenRandom
+{
+public:
+	UVDRomGenRandom();
+	void seed(uint64_t seed);
+	uint64_t next();
+	//[0, n), n > 0
+	uint32_t range(uint32_t n);
+	//[low, high]
+	uint32_t between(uint32_t low, uint32_t high);
+	//[0, 1)
+	double fraction();
+
+public:
+	uint64_t m_state;
+};
+
+class UVDRomGenConfig
+{
+public:
+	UVDRomGenConfig();
+
+public:
+	//Image bytes
+	uint64_t m_size;
+	uint64_t m_seed;
+	//Chance each function instruction is a call / a jump
+	double m_callDensity;
+	double m_jumpDensity;
+	//Fraction of image bytes in string tables / data islands, the rest is code
+	double m_stringDensity;
+	double m_dataDensity;
+	//Average function bytes
+	uint32_t m_functionSize;
+};
+
+class UVDDisasmInstructionShared;
+//An .op instruction as the generator uses it
+class UVDRomGenInstruction
+{
+public:
+	UVDRomGenInstruction();
+
+	//Any one of the values each opcode byte can take
+	//Immediate bytes are random unless this is a branch
+	void encode(UVDRomGenRandom &random, uint8_t *out) const;
+
+public:
+	UVDDisasmInstructionShared *m_shared;
+	//Values each opcode byte can have, expanded from ranges and bitmasks
+	std::vector<std::vector<uint8_t> > m_opcodes;
+	uint32_t m_length;
+	//Branches only: where the target immediate starts and its size in bits
+	uint32_t m_targetOffset;
+	uint32_t m_targetBits;
+};
+
+//Generated but not yet written region of the current bank
+class UVDRomGenRegion
+{
+public:
+	//UVD_ROMGEN_REGION_*
+	uint32_t m_type;
+	//In bank
+	uint32_t m_address;
+	uint32_t m_size;
+	//UVD_ROMGEN_REGION_STRINGS: one entry per string, address / text
+	std::vector<std::pair<uint32_t, std::string> > m_strings;
+	//UVD_ROMGEN_REGION_FUNCTION: some call in the bank targets it
+	bool m_called;
+};
+
+class UVDDisasmOpcodeLookupTable;
+class UVDRomGenerator
+{
+public:
+	UVDRomGenerator();
+
+	/*
+	Sort the table's instructions into filler, calls, jumps and returns
+	Instructions we can't place a target in are never emitted
+	*/
+	uv_err_t init(UVDDisasmOpcodeLookupTable *table, const UVDRomGenConfig &config);
+	//Write the image and its manifest, architecture is only recorded in the manifest
+	uv_err_t generate(const std::string &romFile, const std::string &manifestFile, const std::string &architecture);
+
+protected:
+	uv_err_t classify(UVDDisasmInstructionShared *shared);
+	//Fills m_bank[0, size), appending to m_regions
+	uv_err_t generateBank(uint32_t size);
+	//size is what to aim for on input and what was used on output
+	uv_err_t generateFunction(uint32_t address, uint32_t *size, std::vector<std::pair<uint32_t, const UVDRomGenInstruction *> > &calls);
+	void generateStrings(uint32_t address, uint32_t size, UVDRomGenRegion &region);
+	void generateData(uint32_t address, uint32_t size);
+	//Store an in bank address in an instruction at address
+	void writeTarget(uint32_t address, const UVDRomGenInstruction *instruction, uint32_t target);
+	uv_err_t writeManifestRegions(FILE *manifest, uint64_t bankAddress);
+
+public:
+	UVDRomGenConfig m_config;
+	UVDRomGenRandom m_random;
+
+	std::vector<UVDRomGenInstruction> m_filler;
+	//Absolute, any function in the bank
+	std::vector<UVDRomGenInstruction> m_calls;
+	//Absolute, anywhere in the function
+	std::vector<UVDRomGenInstruction> m_jumps;
+	//PC relative 8 bit, forward only so both signed and unsigned displacements decode the same
+	std::vector<UVDRomGenInstruction> m_relativeJumps;
+	//Unconditional without operands
+	std::vector<UVDRomGenInstruction> m_returns;
+	//Shortest filler, closes gaps too small for anything else
+	uint32_t m_fillerLengthMin;
+	uint32_t m_lengthMax;
+	uint32_t m_bankSize;
+
+	//Current bank
+	std::vector<uint8_t> m_bank;
+	std::vector<UVDRomGenRegion> m_regions;
+	//Bytes generated so far of each UVD_ROMGEN_REGION_*
+	uint64_t m_regionBytes[3];
+
+	//Totals for the manifest
+	uint64_t m_functionCount;
+	uint64_t m_stringCount;
+	uint64_t m_dataCount;
+	uint64_t m_instructionCount;
+	uint64_t m_callCount;
+	uint64_t m_jumpCount;
+	bool m_firstRegion;
+};
+
+#endif
+
@@ -0,0 +1,253 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+
+uvromgen entry point
+Generates a synthetic ROM for the architecture given by --arch-file and a manifest of what is in it
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include "testing/bench/romgen.h"
+#include "uvd/config/arg_property.h"
+#include "uvd/config/arg_util.h"
+#include "uvd/core/init.h"
+#include "uvd/core/runtime_hints.h"
+#include "uvd/core/uvd.h"
+#include "uvd/plugin/plugin.h"
+#include "uvd/util/error.h"
+#include "uvd/util/util.h"
+#include "uvdasm/architecture.h"
+
+#define UVD_PROP_ROMGEN_OUTPUT				"romgen.output"
+#define UVD_PROP_ROMGEN_MANIFEST			"romgen.manifest"
+#define UVD_PROP_ROMGEN_SIZE				"romgen.size"
+#define UVD_PROP_ROMGEN_SEED				"romgen.seed"
+#define UVD_PROP_ROMGEN_CALL_DENSITY		"romgen.call_density"
+#define UVD_PROP_ROMGEN_JUMP_DENSITY		"romgen.jump_density"
+#define UVD_PROP_ROMGEN_STRING_DENSITY		"romgen.string_density"
+#define UVD_PROP_ROMGEN_DATA_DENSITY		"romgen.data_density"
+#define UVD_PROP_ROMGEN_FUNCTION_SIZE		"romgen.function_size"
+
+static UVDRomGenConfig g_romGenConfig;
+static std::string g_romGenOutput = "rom.bin";
+//Default is output + ".json"
+static std::string g_romGenManifest;
+
+static uv_err_t versionPrintPrefixThunk();
+
+static const char *GetVersion()
+{
+	return UVUDEC_VER_STRING;
+}
+
+//Number with an optional k, M or G (binary) suffix
+static uv_err_t parseSize(const std::string &in, uint64_t *out)
+{
+	char *end = NULL;
+	uint64_t ret = 0;
+
+	uv_assert_ret(out);
+	ret = strtoull(in.c_str(), &end, 0);
+	uv_assert_ret(end != in.c_str());
+	if( *end == 'k' || *end == 'K' )
+	{
+		ret <<= 10;
+		++end;
+	}
+	else if( *end == 'm' || *end == 'M' )
+	{
+		ret <<= 20;
+		++end;
+	}
+	else if( *end == 'g' || *end == 'G' )
+	{
+		ret <<= 30;
+		++end;
+	}
+	if( *end )
+	{
+		printf_error("bad size: %s\n", in.c_str());
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	*out = ret;
+	return UV_ERR_OK;
+}
+
+static uv_err_t parseDensity(const std::string &in, double *out)
+{
+	uv_assert_ret(out);
+	*out = strtod(in.c_str(), NULL);
+	if( *out < 0.0 || *out > 1.0 )
+	{
+		printf_error("density must be between 0 and 1, got %s\n", in.c_str());
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	return UV_ERR_OK;
+}
+
+static uv_err_t argParser(const UVDArgConfig *argConfig, std::vector<std::string> argumentArguments, void *)
+{
+	//If present
+	std::string firstArg;
+
+	uv_assert_ret(argConfig);
+	if( !argumentArguments.empty() )
+	{
+		firstArg = argumentArguments[0];
+	}
+
+	if( argConfig->m_propertyForm == UVD_PROP_ROMGEN_OUTPUT )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		g_romGenOutput = firstArg;
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_ROMGEN_MANIFEST )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		g_romGenManifest = firstArg;
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_ROMGEN_SIZE )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		uv_assert_err_ret(parseSize(firstArg, &g_romGenConfig.m_size));
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_ROMGEN_SEED )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		g_romGenConfig.m_seed = strtoull(firstArg.c_str(), NULL, 0);
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_ROMGEN_CALL_DENSITY )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		uv_assert_err_ret(parseDensity(firstArg, &g_romGenConfig.m_callDensity));
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_ROMGEN_JUMP_DENSITY )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		uv_assert_err_ret(parseDensity(firstArg, &g_romGenConfig.m_jumpDensity));
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_ROMGEN_STRING_DENSITY )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		uv_assert_err_ret(parseDensity(firstArg, &g_romGenConfig.m_stringDensity));
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_ROMGEN_DATA_DENSITY )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		uv_assert_err_ret(parseDensity(firstArg, &g_romGenConfig.m_dataDensity));
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_ROMGEN_FUNCTION_SIZE )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		g_romGenConfig.m_functionSize = strtol(firstArg.c_str(), NULL, 0);
+	}
+	else
+	{
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+
+	return UV_ERR_OK;
+}
+
+static uv_err_t initProgConfig()
+{
+	//Callbacks
+	g_config->versionPrintPrefixThunk = versionPrintPrefixThunk;
+
+	uv_assert_err_ret(g_config->registerArgument(UVD_PROP_ROMGEN_OUTPUT, 0, "output", "image file", 1, argParser, true));
+	uv_assert_err_ret(g_config->registerArgument(UVD_PROP_ROMGEN_MANIFEST, 0, "manifest", "manifest file (default: output + .json)", 1, argParser, true));
+	uv_assert_err_ret(g_config->registerArgument(UVD_PROP_ROMGEN_SIZE, 0, "size", "image bytes, k/M/G suffix allowed", 1, argParser, true));
+	uv_assert_err_ret(g_config->registerArgument(UVD_PROP_ROMGEN_SEED, 0, "seed", "same seed and options give the same image", 1, argParser, true));
+	uv_assert_err_ret(g_config->registerArgument(UVD_PROP_ROMGEN_CALL_DENSITY, 0, "call-density", "chance a function instruction is a call", 1, argParser, true));
+	uv_assert_err_ret(g_config->registerArgument(UVD_PROP_ROMGEN_JUMP_DENSITY, 0, "jump-density", "chance a function instruction is a jump", 1, argParser, true));
+	uv_assert_err_ret(g_config->registerArgument(UVD_PROP_ROMGEN_STRING_DENSITY, 0, "string-density", "fraction of the image in string tables", 1, argParser, true));
+	uv_assert_err_ret(g_config->registerArgument(UVD_PROP_ROMGEN_DATA_DENSITY, 0, "data-density", "fraction of the image in data islands", 1, argParser, true));
+	uv_assert_err_ret(g_config->registerArgument(UVD_PROP_ROMGEN_FUNCTION_SIZE, 0, "function-size", "average function bytes", 1, argParser, true));
+
+	return UV_ERR_OK;
+}
+
+static uv_err_t versionPrintPrefixThunk()
+{
+	printf_help("%s version %s\n", "uvromgen", GetVersion());
+	return UV_ERR_OK;
+}
+
+uv_err_t uvmain(int argc, char **argv)
+{
+	uv_err_t rc = UV_ERR_GENERAL;
+	uv_err_t parseMainRc = UV_ERR_GENERAL;
+	std::map<std::string, UVDPlugin *>::iterator pluginIter;
+	UVDRuntimeHints hints;
+	UVDArchitecture *architecture = NULL;
+	UVDDisasmArchitecture *disasmArchitecture = NULL;
+	UVDRomGenerator generator;
+
+	if( strcmp(GetVersion(), UVDGetVersion()) )
+	{
+		printf_warn("libuvudec version mismatch (exe: %s, libuvudec: %s)\n", GetVersion(), UVDGetVersion());
+		fflush(stdout);
+	}
+
+	//Early library initialization.  Logging and arg parsing structures
+	uv_assert_err_ret(UVDInit());
+	uv_assert_ret(g_config);
+	uv_assert_err(initProgConfig());
+
+	//--arch-file is uvdasm's
+	parseMainRc = g_config->parseMain(argc, argv);
+	uv_assert_err(parseMainRc);
+	if( parseMainRc == UV_ERR_DONE )
+	{
+		rc = UV_ERR_OK;
+		goto error;
+	}
+	if( g_romGenManifest.empty() )
+	{
+		g_romGenManifest = g_romGenOutput + ".json";
+	}
+
+	//An architecture as a raw image would get, only used for its opcode table
+	uv_assert_err(g_config->m_plugin.m_pluginEngine.ensurePluginActiveByName("uvdasm"));
+	pluginIter = g_config->m_plugin.m_pluginEngine.m_loadedPlugins.find("uvdasm");
+	uv_assert(pluginIter != g_config->m_plugin.m_pluginEngine.m_loadedPlugins.end());
+	uv_assert_err((*pluginIter).second->getArchitecture(NULL, hints, &architecture));
+	uv_assert(architecture);
+	uv_assert_err(architecture->init());
+	disasmArchitecture = (UVDDisasmArchitecture *)architecture;
+	uv_assert(disasmArchitecture->m_opcodeTable);
+
+	uv_assert_err(generator.init(disasmArchitecture->m_opcodeTable, g_romGenConfig));
+	uv_assert_err(generator.generate(g_romGenOutput, g_romGenManifest, disasmArchitecture->m_architectureFileName));
+	printf("%s: %llu bytes, %llu functions, %llu strings, %llu data islands, %llu instructions\n",
+			g_romGenOutput.c_str(), (unsigned long long)g_romGenConfig.m_size,
+			(unsigned long long)generator.m_functionCount, (unsigned long long)generator.m_stringCount,
+			(unsigned long long)generator.m_dataCount, (unsigned long long)generator.m_instructionCount);
+
+	rc = UV_ERR_OK;
+
+error:
+	delete architecture;
+	uv_assert_err_ret(UVDDeinit());
+
+	return UV_DEBUG(rc);
+}
+
+int main(int argc, char **argv)
+{
+	//Simple translation to keep most stuff in the framework
+	uv_err_t rc = uvmain(argc, argv);
+	if( UV_FAILED(rc) )
+	{
+		printf_error("failed\n");
+		return 1;
+	}
+	else
+	{
+		return 0;
+	}
+}
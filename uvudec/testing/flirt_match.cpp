@@ -0,0 +1,230 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include "testing/flirt_match.h"
+#include "uvdflirt/pat/reader.h"
+#include "uvdflirt/sig/match.h"
+#include "uvdflirt/sig/sig.h"
+#include "uvdflirt/sig/tree/tree.h"
+#include "uvd/assembly/function.h"
+#include "uvd/core/analyzer.h"
+#include "uvd/data/data.h"
+#include <string.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UVDFLIRTMatchFixture);
+
+/*
+std::vector<std::string>::begin() as compiled into uvtest_main.o, relocation zeroed
+uvtest_main.pat: crc16 0x8E1E over the 3 bytes after the leading 32, total length 0x23
+*/
+static const uint8_t g_vectorBegin[] =
+{
+	0x55, 0x89, 0xE5, 0x53, 0x83, 0xEC, 0x14, 0x8B, 0x5D, 0x08, 0x8B, 0x45, 0x0C, 0x89, 0x44, 0x24,
+	0x04, 0x89, 0x1C, 0x24, 0xE8, 0x00, 0x00, 0x00, 0x00, 0x89, 0xD8, 0x83, 0xC4, 0x14, 0x5B, 0x5D,
+	0xC2, 0x04, 0x00,
+};
+static const char *g_vectorBeginName = "__ZNSt6vectorISsSaISsEE5beginEv";
+
+/*
+Four modules in uvtest_main.pat share these bytes, ex: std::vector<std::string>::vector()
+Each calls a different helper so only references could tell them apart
+*/
+static const uint8_t g_vectorCtor[] =
+{
+	0x55, 0x89, 0xE5, 0x83, 0xEC, 0x18, 0x8B, 0x45, 0x08, 0x89, 0x04, 0x24, 0xE8, 0x00, 0x00, 0x00,
+	0x00, 0xC9, 0xC3,
+};
+
+void UVDFLIRTMatchFixture::patMatchTest()
+{
+	UVDFLIRTSignatureMatcher matcher;
+	std::vector<UVDFLIRTSignatureTreeBasicNode *> candidates;
+	UVDFLIRTSignatureTreeBasicNode *best = NULL;
+	UVDBinaryFunction function;
+	UVDAnalyzer analyzer;
+	
+	m_args.clear();
+	init();
+	loadMatcher("uvtest_main.pat", matcher);
+	CPPUNIT_ASSERT(matcher.getMaxModuleLength() >= sizeof(g_vectorBegin));
+
+	UVCPPUNIT_ASSERT(matcher.match(g_vectorBegin, sizeof(g_vectorBegin), candidates));
+	CPPUNIT_ASSERT(hasName(candidates, g_vectorBeginName));
+
+	//Nothing to compare references against, the length alone should settle it
+	UVCPPUNIT_ASSERT(function.transferData(new UVDDataMemory((const char *)g_vectorBegin, sizeof(g_vectorBegin))));
+	UVCPPUNIT_ASSERT(matcher.choose(&analyzer, &function, candidates, &best));
+	CPPUNIT_ASSERT(best != NULL);
+	CPPUNIT_ASSERT(!best->m_publicNames.empty());
+	CPPUNIT_ASSERT(best->m_publicNames[0].m_name == g_vectorBeginName);
+
+	UVCPPUNIT_ASSERT(matcher.deinit());
+	deinit();
+}
+
+void UVDFLIRTMatchFixture::sigMatchTest()
+{
+	UVDFLIRTSignatureMatcher matcher;
+	std::vector<UVDFLIRTSignatureTreeBasicNode *> candidates;
+	
+	m_args.clear();
+	init();
+	loadMatcher("uvtest_main.sig", matcher);
+
+	UVCPPUNIT_ASSERT(matcher.match(g_vectorBegin, sizeof(g_vectorBegin), candidates));
+	CPPUNIT_ASSERT(hasName(candidates, g_vectorBeginName));
+
+	UVCPPUNIT_ASSERT(matcher.deinit());
+	deinit();
+}
+
+void UVDFLIRTMatchFixture::crcMismatchTest()
+{
+	UVDFLIRTSignatureMatcher matcher;
+	std::vector<UVDFLIRTSignatureTreeBasicNode *> candidates;
+	uint8_t buffer[sizeof(g_vectorBegin)];
+	
+	m_args.clear();
+	init();
+	loadMatcher("uvtest_main.pat", matcher);
+
+	//ret 4 => ret 5
+	memcpy(buffer, g_vectorBegin, sizeof(buffer));
+	buffer[33] = 0x05;
+	UVCPPUNIT_ASSERT(matcher.match(buffer, sizeof(buffer), candidates));
+	CPPUNIT_ASSERT(!hasName(candidates, g_vectorBeginName));
+
+	//Image ends before the module does
+	UVCPPUNIT_ASSERT(matcher.match(g_vectorBegin, sizeof(g_vectorBegin) - 1, candidates));
+	CPPUNIT_ASSERT(!hasName(candidates, g_vectorBeginName));
+
+	UVCPPUNIT_ASSERT(matcher.deinit());
+	deinit();
+}
+
+void UVDFLIRTMatchFixture::ambiguousTest()
+{
+	UVDFLIRTSignatureMatcher matcher;
+	std::vector<UVDFLIRTSignatureTreeBasicNode *> candidates;
+	UVDFLIRTSignatureTreeBasicNode *best = NULL;
+	UVDBinaryFunction function;
+	UVDAnalyzer analyzer;
+	
+	m_args.clear();
+	init();
+	loadMatcher("uvtest_main.pat", matcher);
+
+	UVCPPUNIT_ASSERT(matcher.match(g_vectorCtor, sizeof(g_vectorCtor), candidates));
+	CPPUNIT_ASSERT(candidates.size() > 1);
+	CPPUNIT_ASSERT(hasName(candidates, "__ZNSt6vectorISsSaISsEEC1Ev"));
+	CPPUNIT_ASSERT(hasName(candidates, "__ZNSaISsED2Ev"));
+
+	UVCPPUNIT_ASSERT(function.transferData(new UVDDataMemory((const char *)g_vectorCtor, sizeof(g_vectorCtor))));
+	CPPUNIT_ASSERT(matcher.choose(&analyzer, &function, candidates, &best) == UV_ERR_NOTFOUND);
+
+	UVCPPUNIT_ASSERT(matcher.deinit());
+	deinit();
+}
+
+/*
+Memory that won't hand out its buffer
+Forces the pat loader onto its chunked read path
+*/
+class UVDTestingUnmappedData : public UVDDataMemory
+{
+public:
+	UVDTestingUnmappedData(const char *buffer, uint32_t bufferSize) : UVDDataMemory(buffer, bufferSize)
+	{
+	}
+
+	const uint8_t *getBuffer(uint32_t, uint32_t) const
+	{
+		return NULL;
+	}
+};
+
+void UVDFLIRTMatchFixture::patChunkTest()
+{
+	//Smaller than a line, a line or so and the default
+	static const uint32_t chunkSizes[] = {1, 7, 100, UVD_FLIRT_PAT_READ_CHUNK_SIZE};
+	std::string patContents;
+	std::string expected;
+	uint32_t expectedModules = 0;
+
+	m_args.clear();
+	init();
+	UVCPPUNIT_ASSERT(readFile(getUnitTestDir() + "/flirt/ELF/uvtest_main.pat", patContents));
+	//Otherwise nothing is split
+	CPPUNIT_ASSERT(patContents.find('\n') > 7);
+
+	{
+		UVDFLIRTSignatureDB db;
+		UVDPatLoaderCore loader(&db);
+
+		UVCPPUNIT_ASSERT(db.init());
+		UVCPPUNIT_ASSERT(loader.fromString(patContents));
+		expectedModules = loader.m_modules;
+		sigToString(&db, expected);
+	}
+	CPPUNIT_ASSERT(expectedModules > 1);
+
+	for( uint32_t i = 0; i < sizeof(chunkSizes) / sizeof(chunkSizes[0]); ++i )
+	{
+		UVDTestingUnmappedData data(patContents.c_str(), patContents.size());
+		UVDFLIRTSignatureDB db;
+		UVDPatLoaderCore loader(&db);
+		std::string actual;
+
+		UVCPPUNIT_ASSERT(db.init());
+		UVCPPUNIT_ASSERT(loader.fromData(&data, chunkSizes[i]));
+		CPPUNIT_ASSERT_EQUAL(expectedModules, loader.m_modules);
+		sigToString(&db, actual);
+		CPPUNIT_ASSERT(expected == actual);
+	}
+
+	deinit();
+}
+
+/*
+Utility
+*/
+
+void UVDFLIRTMatchFixture::loadMatcher(const std::string &fileName, UVDFLIRTSignatureMatcher &matcher)
+{
+	UVCPPUNIT_ASSERT(matcher.init());
+	UVCPPUNIT_ASSERT(matcher.loadFile(getUnitTestDir() + "/flirt/ELF/" + fileName));
+}
+
+void UVDFLIRTMatchFixture::sigToString(UVDFLIRTSignatureDB *db, std::string &out)
+{
+	UVDData *data = NULL;
+	uint32_t dataSize = 0;
+
+	UVCPPUNIT_ASSERT(db->writeToData(&data));
+	CPPUNIT_ASSERT(data != NULL);
+	UVCPPUNIT_ASSERT(data->size(&dataSize));
+	UVCPPUNIT_ASSERT(data->readDataAsString(0, dataSize, out));
+	delete data;
+}
+
+bool UVDFLIRTMatchFixture::hasName(const std::vector<UVDFLIRTSignatureTreeBasicNode *> &candidates, const std::string &name)
+{
+	for( std::vector<UVDFLIRTSignatureTreeBasicNode *>::const_iterator iter = candidates.begin(); iter != candidates.end(); ++iter )
+	{
+		const UVDFLIRTSignatureTreeBasicNode *candidate = *iter;
+
+		for( std::vector<UVDFLIRTPublicName>::const_iterator nameIter = candidate->m_publicNames.begin();
+				nameIter != candidate->m_publicNames.end(); ++nameIter )
+		{
+			if( (*nameIter).m_name == name )
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
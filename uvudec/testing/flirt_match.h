@@ -0,0 +1,51 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVD_TESTING_FLIRT_MATCH_H
+#define UVD_TESTING_FLIRT_MATCH_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "testing/flirt.h"
+#include <string>
+#include <vector>
+
+class UVDFLIRTSignatureDB;
+class UVDFLIRTSignatureMatcher;
+class UVDFLIRTSignatureTreeBasicNode;
+class UVDFLIRTMatchFixture : public UVDTestingFLIRTFixture
+{
+	CPPUNIT_TEST_SUITE(UVDFLIRTMatchFixture);
+	CPPUNIT_TEST(patMatchTest);
+	CPPUNIT_TEST(sigMatchTest);
+	CPPUNIT_TEST(crcMismatchTest);
+	CPPUNIT_TEST(ambiguousTest);
+	CPPUNIT_TEST(patChunkTest);
+	CPPUNIT_TEST_SUITE_END();
+
+protected:
+	//Bytes of a function from uvtest_main.o should be named from its .pat
+	void patMatchTest();
+	//...and the same from the .sig built from it
+	void sigMatchTest();
+	//Leading bytes agree but the crc16 covered tail doesn't
+	void crcMismatchTest();
+	//Identical bodies with different names shouldn't be named
+	void ambiguousTest();
+	//Reading a .pat in chunks smaller than a line should build the same signatures as reading it whole
+	void patChunkTest();
+
+	/*
+	Utility functions
+	*/
+	void loadMatcher(const std::string &fileName, UVDFLIRTSignatureMatcher &matcher);
+	//.sig built from db
+	void sigToString(UVDFLIRTSignatureDB *db, std::string &out);
+	static bool hasName(const std::vector<UVDFLIRTSignatureTreeBasicNode *> &candidates, const std::string &name);
+};
+
+#endif
+
@@ -5,8 +5,20 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 */
 
 #include "testing/libuvudec.h"
+#include "uvd/assembly/instruction.h"
+#include "uvd/core/instruction_boundaries.h"
+#include "uvd/core/instruction_cache.h"
+#include "uvd/config/config.h"
 #include "uvd/core/uvd.h"
+#include "uvd/data/data.h"
+#include "uvd/util/output_sink.h"
+#include "uvd/util/profile.h"
+#include "uvd/util/range_set.h"
+#include "uvd/util/util.h"
+#include <ctype.h>
+#include <limits.h>
 #include <string.h>
+#include <unistd.h>
 
 CPPUNIT_TEST_SUITE_REGISTRATION(UVDLibuvudecUnitTest);
 
@@ -22,4 +34,628 @@ void UVDLibuvudecUnitTest::initDeinitTest(void)
 	deinit();
 }
 
+void UVDLibuvudecUnitTest::dataViewTest(void)
+{
+	const char buffer[] = "\x00\x01\x02\x03\x04\x05\x06\x07";
+	UVDDataMemory data(buffer, 8);
+	UVDDataChunk chunk;
+	UVDDataPlaceholder placeholder;
+	UVDDataView view;
+
+	//Memory is contiguous, should get a pointer straight into it
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, data.getView(2, 4, view));
+	CPPUNIT_ASSERT(view.begin() == (const uint8_t *)data.m_buffer + 2);
+	CPPUNIT_ASSERT(view.m_copy == NULL);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)4, view.size());
+	//Past the end
+	CPPUNIT_ASSERT(data.getBuffer(6, 4) == NULL);
+
+	//Chunks should pass through to their source
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, chunk.init(&data, 4, 8));
+	CPPUNIT_ASSERT(chunk.getBuffer(1, 2) == (const uint8_t *)data.m_buffer + 5);
+	CPPUNIT_ASSERT(chunk.getBuffer(2, 4) == NULL);
+	
+	//Empty range on a source with no buffer takes the copy path
+	CPPUNIT_ASSERT(placeholder.getBuffer(0, 0) == NULL);
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, placeholder.getView(0, 0, view));
+	CPPUNIT_ASSERT(view.m_copy != NULL);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0, view.size());
+}
+
+void UVDLibuvudecUnitTest::mappedFileViewTest(void)
+{
+	const char contents[] = "0123456789abcdef";
+	UVDDataMappedFile data;
+	UVDDataChunk chunk;
+	UVDDataView view;
+	std::string fileName;
+
+	fileName = getTempFileName();
+	UVCPPUNIT_ASSERT(writeFile(fileName, contents, 16));
+	UVCPPUNIT_ASSERT(data.init(fileName));
+	CPPUNIT_ASSERT(data.m_map != NULL);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)16, data.size());
+
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, data.getView(4, 8, view));
+	CPPUNIT_ASSERT(view.begin() == data.m_map + 4);
+	CPPUNIT_ASSERT(view.m_copy == NULL);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)8, view.size());
+	CPPUNIT_ASSERT(memcmp(view.begin(), "456789ab", 8) == 0);
+	//Right up to the end is fine, one past isn't
+	CPPUNIT_ASSERT(data.getBuffer(12, 4) == data.m_map + 12);
+	CPPUNIT_ASSERT(data.getBuffer(12, 5) == NULL);
+	CPPUNIT_ASSERT(data.getBuffer(17, 0) == NULL);
+	CPPUNIT_ASSERT_EQUAL((int)'f', data.read(15));
+	CPPUNIT_ASSERT_EQUAL(-1, data.read(16));
+
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, chunk.init(&data, 8, 16));
+	CPPUNIT_ASSERT(chunk.getBuffer(1, 2) == data.m_map + 9);
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, chunk.getView(0, 8, view));
+	CPPUNIT_ASSERT(view.begin() == data.m_map + 8);
+	CPPUNIT_ASSERT(view.m_copy == NULL);
+	view.reset();
+	data.deinit();
+	CPPUNIT_ASSERT(data.m_map == NULL);
+
+	//Nothing to map, callers fall back to stdio
+	UVCPPUNIT_ASSERT(writeFile(fileName, contents, 0));
+	CPPUNIT_ASSERT(UV_FAILED(data.init(fileName)));
+	CPPUNIT_ASSERT(data.m_map == NULL);
+}
+
+void UVDLibuvudecUnitTest::rangeSetTest(void)
+{
+	UVDUint32RangeSet set;
+	UVDUint32RangePair run;
+
+	//Nothing before the first run
+	set.add(10, 19);
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_DONE, set.last(9, &run));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_DONE, set.last(0, &run));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_NOTFOUND, set.find(9, &run));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, set.next(0, &run));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)10, run.m_min);
+
+	//Touching on either side merges into one run
+	set.add(20, 29);
+	set.add(5, 9);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, set.m_runs.size());
+	CPPUNIT_ASSERT_EQUAL((uint32_t)5, set.m_runs[0].m_min);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)29, set.m_runs[0].m_max);
+	
+	//A gap keeps them apart until something fills it
+	set.add(31, 40);
+	CPPUNIT_ASSERT_EQUAL((size_t)2, set.m_runs.size());
+	CPPUNIT_ASSERT(!set.contains(30));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, set.last(30, &run));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)29, run.m_max);
+	set.add(30, 30);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, set.m_runs.size());
+	CPPUNIT_ASSERT_EQUAL((uint32_t)40, set.m_runs[0].m_max);
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_DONE, set.next(41, &run));
+
+	//Inverting a set that reaches UINT_MAX must not add a run past it
+	set.clear();
+	set.add(0, 0);
+	set.add(100, UINT_MAX);
+	set.invert();
+	CPPUNIT_ASSERT_EQUAL((size_t)1, set.m_runs.size());
+	CPPUNIT_ASSERT_EQUAL((uint32_t)1, set.m_runs[0].m_min);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)99, set.m_runs[0].m_max);
+	set.invert();
+	CPPUNIT_ASSERT_EQUAL((size_t)2, set.m_runs.size());
+	CPPUNIT_ASSERT(set.contains(UINT_MAX));
+	CPPUNIT_ASSERT(set.contains(0));
+	
+	//Everything inverts to nothing and back
+	set.clear();
+	set.add(0, UINT_MAX);
+	set.invert();
+	CPPUNIT_ASSERT(set.empty());
+	set.invert();
+	CPPUNIT_ASSERT_EQUAL((size_t)1, set.m_runs.size());
+	CPPUNIT_ASSERT_EQUAL((uint32_t)UINT_MAX, set.m_runs[0].m_max);
+
+	//Removing from the middle splits a run
+	set.remove(50, 59);
+	CPPUNIT_ASSERT_EQUAL((size_t)2, set.m_runs.size());
+	CPPUNIT_ASSERT_EQUAL((uint32_t)49, set.m_runs[0].m_max);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)60, set.m_runs[1].m_min);
+}
+
+void UVDLibuvudecUnitTest::fileOutputSinkTest(void)
+{
+	UVDFileOutputSink sink;
+	std::string fileName;
+	std::string expected;
+	std::string contents;
+	std::string large(100, 'L');
+
+	fileName = getTempFileName();
+	//Small enough that most of these take the slow path
+	UVCPPUNIT_ASSERT(sink.init(fileName, 8));
+	UVCPPUNIT_ASSERT(sink.write("abc", 3));
+	expected += "abc";
+	//Tops off the buffer then keeps the rest
+	UVCPPUNIT_ASSERT(sink.writeLine("0123456789", 10));
+	expected += "0123456789\n";
+	//Doesn't fit what's left, formatted again after a flush
+	UVCPPUNIT_ASSERT(sink.print("%d-%s", 42, "xyz"));
+	expected += "42-xyz";
+	//Bigger than the whole buffer, goes straight out
+	UVCPPUNIT_ASSERT(sink.write(large));
+	expected += large;
+	UVCPPUNIT_ASSERT(sink.print("%s", large.c_str()));
+	expected += large;
+	CPPUNIT_ASSERT(sink.m_written == expected.size());
+	UVCPPUNIT_ASSERT(sink.deinit());
+
+	UVCPPUNIT_ASSERT(readFile(fileName, contents));
+	CPPUNIT_ASSERT(contents == expected);
+}
+
+void UVDLibuvudecUnitTest::memoryOutputSinkTest(void)
+{
+	UVDMemoryOutputSink sink;
+	char region[16];
+
+	memset(region, 0, sizeof(region));
+	UVCPPUNIT_ASSERT(sink.init(region, sizeof(region)));
+	UVCPPUNIT_ASSERT(sink.write("0123456789", 10));
+	CPPUNIT_ASSERT(sink.m_written == 10);
+
+	//Stored up to the end of the region, the rest is dropped
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_BUFFERSIZE, sink.write("abcdefghij", 10));
+	CPPUNIT_ASSERT(sink.m_written == 16);
+	CPPUNIT_ASSERT(memcmp(region, "0123456789abcdef", 16) == 0);
+
+	//Full, nothing more counts
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_BUFFERSIZE, sink.write("x", 1));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_BUFFERSIZE, sink.writeLine("y", 1));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_BUFFERSIZE, sink.print("%d", 1234));
+	CPPUNIT_ASSERT(sink.m_written == 16);
+	UVCPPUNIT_ASSERT(sink.flush());
+	CPPUNIT_ASSERT(memcmp(region, "0123456789abcdef", 16) == 0);
+}
+
+void UVDLibuvudecUnitTest::stringOutputSinkTest(void)
+{
+	UVDStringOutputSink sink;
+	std::string out = "existing ";
+
+	UVCPPUNIT_ASSERT(sink.init(&out, 4));
+	UVCPPUNIT_ASSERT(sink.write("ab", 2));
+	//Still buffered
+	CPPUNIT_ASSERT(out == "existing ");
+	UVCPPUNIT_ASSERT(sink.writeLine("cdefgh", 6));
+	UVCPPUNIT_ASSERT(sink.print("%s=%d", "n", 10));
+	UVCPPUNIT_ASSERT(sink.flush());
+	CPPUNIT_ASSERT(out == "existing abcdefgh\nn=10");
+	CPPUNIT_ASSERT(sink.m_written == strlen("abcdefgh\nn=10"));
+	//Nothing left to hand over
+	UVCPPUNIT_ASSERT(sink.flush());
+	CPPUNIT_ASSERT(out == "existing abcdefgh\nn=10");
+}
+
+static void jsonSkipSpace(const std::string &in, std::string::size_type &pos)
+{
+	while( pos < in.size() && isspace((unsigned char)in[pos]) )
+	{
+		++pos;
+	}
+}
+
+static bool jsonSkipString(const std::string &in, std::string::size_type &pos)
+{
+	if( pos >= in.size() || in[pos] != '"' )
+	{
+		return false;
+	}
+	for( ++pos; pos < in.size(); ++pos )
+	{
+		unsigned char c = in[pos];
+		
+		if( c == '"' )
+		{
+			++pos;
+			return true;
+		}
+		if( c < 0x20 )
+		{
+			return false;
+		}
+		if( c == '\\' )
+		{
+			++pos;
+			if( pos >= in.size() || !strchr("\"\\/bfnrtu", in[pos]) )
+			{
+				return false;
+			}
+		}
+	}
+	return false;
+}
+
+//Just enough of JSON to tell if the profiler output would load
+static bool jsonSkipValue(const std::string &in, std::string::size_type &pos)
+{
+	char open = 0;
+	char close = 0;
+	
+	jsonSkipSpace(in, pos);
+	if( pos >= in.size() )
+	{
+		return false;
+	}
+	open = in[pos];
+	if( open == '"' )
+	{
+		return jsonSkipString(in, pos);
+	}
+	if( isdigit((unsigned char)open) || open == '-' )
+	{
+		++pos;
+		while( pos < in.size() && (isdigit((unsigned char)in[pos]) || strchr(".eE+-", in[pos])) )
+		{
+			++pos;
+		}
+		return true;
+	}
+	if( open != '{' && open != '[' )
+	{
+		return false;
+	}
+	
+	close = open == '{' ? '}' : ']';
+	++pos;
+	jsonSkipSpace(in, pos);
+	if( pos < in.size() && in[pos] == close )
+	{
+		++pos;
+		return true;
+	}
+	for( ;; )
+	{
+		if( open == '{' )
+		{
+			jsonSkipSpace(in, pos);
+			if( !jsonSkipString(in, pos) )
+			{
+				return false;
+			}
+			jsonSkipSpace(in, pos);
+			if( pos >= in.size() || in[pos] != ':' )
+			{
+				return false;
+			}
+			++pos;
+		}
+		if( !jsonSkipValue(in, pos) )
+		{
+			return false;
+		}
+		jsonSkipSpace(in, pos);
+		if( pos >= in.size() )
+		{
+			return false;
+		}
+		if( in[pos] == close )
+		{
+			++pos;
+			return true;
+		}
+		if( in[pos] != ',' )
+		{
+			return false;
+		}
+		++pos;
+	}
+}
+
+static bool isJSON(const std::string &in)
+{
+	std::string::size_type pos = 0;
+	
+	if( !jsonSkipValue(in, pos) )
+	{
+		return false;
+	}
+	jsonSkipSpace(in, pos);
+	return pos == in.size();
+}
 
+void UVDLibuvudecUnitTest::profilerNestingTest(void)
+{
+	std::vector<UVDProfiler::Scope> scopes;
+
+	g_profiler.enable();
+	g_profiler.reset();
+	{
+		UVDProfileScope outer("outer");
+		
+		for( uint32_t i = 0; i < 2; ++i )
+		{
+			UVDProfileScope inner("inner");
+			
+			usleep(2000);
+		}
+		usleep(1000);
+	}
+	g_profiler.disable();
+	{
+		UVDProfileScope ignored("disabled");
+	}
+
+	UVCPPUNIT_ASSERT(g_profiler.getScopes(scopes));
+	CPPUNIT_ASSERT_EQUAL((std::vector<UVDProfiler::Scope>::size_type)2, scopes.size());
+	CPPUNIT_ASSERT_EQUAL(std::string("outer"), scopes[0].m_path);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)1, scopes[0].m_count);
+	CPPUNIT_ASSERT_EQUAL(std::string("outer/inner"), scopes[1].m_path);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)2, scopes[1].m_count);
+	for( uint32_t i = 0; i < scopes.size(); ++i )
+	{
+		CPPUNIT_ASSERT(scopes[i].m_self <= scopes[i].m_total);
+	}
+	CPPUNIT_ASSERT(scopes[1].m_total >= 4000);
+	CPPUNIT_ASSERT(scopes[1].m_total <= scopes[0].m_total);
+	CPPUNIT_ASSERT_EQUAL(scopes[0].m_total - scopes[1].m_total, scopes[0].m_self);
+	//Leaf
+	CPPUNIT_ASSERT_EQUAL(scopes[1].m_total, scopes[1].m_self);
+
+	g_profiler.reset();
+}
+
+void UVDLibuvudecUnitTest::profilerOutputTest(void)
+{
+	std::string json;
+	std::string trace;
+
+	//Empty
+	g_profiler.enable();
+	g_profiler.reset();
+	UVCPPUNIT_ASSERT(g_profiler.toJSON(json));
+	CPPUNIT_ASSERT(isJSON(json));
+	UVCPPUNIT_ASSERT(g_profiler.toChromeTrace(trace));
+	CPPUNIT_ASSERT(isJSON(trace));
+
+	{
+		UVDProfileScope outer("outer");
+		{
+			UVDProfileScope inner("say \"hi\"\\\t");
+		}
+		{
+			UVDProfileScope sibling("sibling");
+		}
+		g_profileInstructionsDecoded.add(3);
+	}
+	{
+		UVDProfileScope root("root");
+	}
+	g_profiler.disable();
+
+	UVCPPUNIT_ASSERT(g_profiler.toJSON(json));
+	CPPUNIT_ASSERT(isJSON(json));
+	CPPUNIT_ASSERT(json.find("\"name\": \"outer\"") != std::string::npos);
+	CPPUNIT_ASSERT(json.find("\"name\": \"say \\\"hi\\\"\\\\\\u0009\"") != std::string::npos);
+	CPPUNIT_ASSERT(json.find("\"instructions.decoded\": 3") != std::string::npos);
+
+	UVCPPUNIT_ASSERT(g_profiler.toChromeTrace(trace));
+	CPPUNIT_ASSERT(isJSON(trace));
+	CPPUNIT_ASSERT(trace.find("\"traceEvents\"") != std::string::npos);
+	CPPUNIT_ASSERT(trace.find("\"name\": \"sibling\", \"cat\": \"uvudec\", \"ph\": \"X\"") != std::string::npos);
+	CPPUNIT_ASSERT(trace.find("\"instructions.decoded\": 3") != std::string::npos);
+
+	//The checker itself
+	CPPUNIT_ASSERT(!isJSON(json.substr(0, json.size() - 3)));
+	CPPUNIT_ASSERT(!isJSON("{\"a\": 1,}"));
+
+	g_profiler.reset();
+}
+
+void UVDLibuvudecUnitTest::instructionBoundariesTest(void)
+{
+	UVDInstructionBoundaries boundaries;
+	UVDAddressSpace space;
+	UVDAddressSpace otherSpace;
+	UVDAddress previous;
+
+	//Nothing set
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_NOTFOUND, boundaries.getPrevious(UVDAddress(100, &space), &previous));
+
+	UVCPPUNIT_ASSERT(boundaries.set(UVDAddress(5, &space)));
+	UVCPPUNIT_ASSERT(boundaries.set(UVDAddress(31, &space)));
+	UVCPPUNIT_ASSERT(boundaries.set(UVDAddress(63, &space)));
+	UVCPPUNIT_ASSERT(boundaries.set(UVDAddress(64, &space)));
+	UVCPPUNIT_ASSERT(boundaries.set(UVDAddress(130, &space)));
+	CPPUNIT_ASSERT_EQUAL((uv_addr_t)0, boundaries.m_spaces[&space].m_base);
+	CPPUNIT_ASSERT_EQUAL((size_t)3, boundaries.m_spaces[&space].m_words.size());
+	CPPUNIT_ASSERT(boundaries.isSet(UVDAddress(64, &space)));
+	CPPUNIT_ASSERT(!boundaries.isSet(UVDAddress(65, &space)));
+	CPPUNIT_ASSERT(!boundaries.isSet(UVDAddress(64, &otherSpace)));
+
+	//Within a word, including across its 32 bit halves
+	UVCPPUNIT_ASSERT(boundaries.getPrevious(UVDAddress(6, &space), &previous));
+	CPPUNIT_ASSERT_EQUAL((uv_addr_t)5, previous.m_addr);
+	CPPUNIT_ASSERT(previous.m_space == &space);
+	UVCPPUNIT_ASSERT(boundaries.getPrevious(UVDAddress(32, &space), &previous));
+	CPPUNIT_ASSERT_EQUAL((uv_addr_t)31, previous.m_addr);
+	UVCPPUNIT_ASSERT(boundaries.getPrevious(UVDAddress(63, &space), &previous));
+	CPPUNIT_ASSERT_EQUAL((uv_addr_t)31, previous.m_addr);
+	//First bit of a word is found in the word before it
+	UVCPPUNIT_ASSERT(boundaries.getPrevious(UVDAddress(64, &space), &previous));
+	CPPUNIT_ASSERT_EQUAL((uv_addr_t)63, previous.m_addr);
+	UVCPPUNIT_ASSERT(boundaries.getPrevious(UVDAddress(65, &space), &previous));
+	CPPUNIT_ASSERT_EQUAL((uv_addr_t)64, previous.m_addr);
+	//Empty part of a word falls through to earlier words
+	UVCPPUNIT_ASSERT(boundaries.getPrevious(UVDAddress(130, &space), &previous));
+	CPPUNIT_ASSERT_EQUAL((uv_addr_t)64, previous.m_addr);
+	UVCPPUNIT_ASSERT(boundaries.getPrevious(UVDAddress(131, &space), &previous));
+	CPPUNIT_ASSERT_EQUAL((uv_addr_t)130, previous.m_addr);
+	//Past the end
+	UVCPPUNIT_ASSERT(boundaries.getPrevious(UVDAddress(192, &space), &previous));
+	CPPUNIT_ASSERT_EQUAL((uv_addr_t)130, previous.m_addr);
+	UVCPPUNIT_ASSERT(boundaries.getPrevious(UVDAddress(100000, &space), &previous));
+	CPPUNIT_ASSERT_EQUAL((uv_addr_t)130, previous.m_addr);
+	//Nothing before the first
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_NOTFOUND, boundaries.getPrevious(UVDAddress(5, &space), &previous));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_NOTFOUND, boundaries.getPrevious(UVDAddress(0, &space), &previous));
+	//Spaces are independent
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_NOTFOUND, boundaries.getPrevious(UVDAddress(100, &otherSpace), &previous));
+
+	//Base not at 0, grown downwards
+	UVCPPUNIT_ASSERT(boundaries.set(UVDAddress(1000, &otherSpace)));
+	UVCPPUNIT_ASSERT(boundaries.set(UVDAddress(200, &otherSpace)));
+	CPPUNIT_ASSERT_EQUAL((uv_addr_t)192, boundaries.m_spaces[&otherSpace].m_base);
+	CPPUNIT_ASSERT(boundaries.isSet(UVDAddress(1000, &otherSpace)));
+	CPPUNIT_ASSERT(!boundaries.isSet(UVDAddress(100, &otherSpace)));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_NOTFOUND, boundaries.getPrevious(UVDAddress(100, &otherSpace), &previous));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_NOTFOUND, boundaries.getPrevious(UVDAddress(192, &otherSpace), &previous));
+	UVCPPUNIT_ASSERT(boundaries.getPrevious(UVDAddress(201, &otherSpace), &previous));
+	CPPUNIT_ASSERT_EQUAL((uv_addr_t)200, previous.m_addr);
+	CPPUNIT_ASSERT(previous.m_space == &otherSpace);
+	UVCPPUNIT_ASSERT(boundaries.getPrevious(UVDAddress(1000, &otherSpace), &previous));
+	CPPUNIT_ASSERT_EQUAL((uv_addr_t)200, previous.m_addr);
+	UVCPPUNIT_ASSERT(boundaries.getPrevious(UVDAddress(1001, &otherSpace), &previous));
+	CPPUNIT_ASSERT_EQUAL((uv_addr_t)1000, previous.m_addr);
+	//A boundary at the base is never before anything at the base
+	UVCPPUNIT_ASSERT(boundaries.set(UVDAddress(192, &otherSpace)));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_NOTFOUND, boundaries.getPrevious(UVDAddress(192, &otherSpace), &previous));
+	UVCPPUNIT_ASSERT(boundaries.getPrevious(UVDAddress(193, &otherSpace), &previous));
+	CPPUNIT_ASSERT_EQUAL((uv_addr_t)192, previous.m_addr);
+
+	boundaries.clear(&space);
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_NOTFOUND, boundaries.getPrevious(UVDAddress(131, &space), &previous));
+	UVCPPUNIT_ASSERT(boundaries.getPrevious(UVDAddress(1001, &otherSpace), &previous));
+	CPPUNIT_ASSERT_EQUAL((uv_addr_t)1000, previous.m_addr);
+}
+
+//Counts its release() instead of just vanishing
+class UVDTestingCountedInstruction : public UVDInstruction
+{
+public:
+	UVDTestingCountedInstruction(uint32_t *released)
+	{
+		m_released = released;
+	}
+
+	uv_err_t print_disasm(std::string &out)
+	{
+		out = "counted";
+		return UV_ERR_OK;
+	}
+
+	uv_err_t analyzeControlFlow(UVDInstructionAnalysis *)
+	{
+		return UV_ERR_OK;
+	}
+
+	void release()
+	{
+		++*m_released;
+		delete this;
+	}
+
+public:
+	uint32_t *m_released;
+};
+
+void UVDLibuvudecUnitTest::instructionCacheInvalidateTest(void)
+{
+	UVDInstructionCache cache;
+	UVDAddressSpace space;
+	UVDAddressSpace otherSpace;
+	UVDInstruction *held = NULL;
+	UVDInstruction *instruction = NULL;
+	std::string disassembly;
+	uint32_t released = 0;
+
+	UVCPPUNIT_ASSERT(cache.init(16));
+	//add() leaves everything pinned
+	held = new UVDTestingCountedInstruction(&released);
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, cache.add(UVDAddress(0, &space), held));
+	instruction = new UVDTestingCountedInstruction(&released);
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, cache.add(UVDAddress(1, &space), instruction));
+	cache.unpin(instruction);
+
+	cache.invalidate();
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0, cache.size());
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_NOTFOUND, cache.get(UVDAddress(0, &space), &instruction));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)1, released);
+	//Still usable by whoever pinned it
+	UVCPPUNIT_ASSERT(held->print_disasm(disassembly));
+	//Nested pins hold it too
+	cache.pin(held);
+	cache.unpin(held);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)1, released);
+	cache.unpin(held);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)2, released);
+	CPPUNIT_ASSERT(cache.m_detached.empty());
+	CPPUNIT_ASSERT(cache.m_pins.empty());
+
+	//Only the given space, its pinned entries held the same way
+	held = new UVDTestingCountedInstruction(&released);
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, cache.add(UVDAddress(0, &space), held));
+	instruction = new UVDTestingCountedInstruction(&released);
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, cache.add(UVDAddress(0, &otherSpace), instruction));
+	cache.unpin(instruction);
+	cache.invalidate(&space);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)1, cache.size());
+	CPPUNIT_ASSERT_EQUAL((uint32_t)2, released);
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, cache.get(UVDAddress(0, &otherSpace), &instruction));
+	cache.unpin(instruction);
+	cache.unpin(held);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)3, released);
+
+	//Tearing down releases everything, pinned or not
+	held = new UVDTestingCountedInstruction(&released);
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, cache.add(UVDAddress(1, &otherSpace), held));
+	UVCPPUNIT_ASSERT(cache.deinit());
+	CPPUNIT_ASSERT_EQUAL((uint32_t)5, released);
+	CPPUNIT_ASSERT(cache.m_detached.empty());
+	CPPUNIT_ASSERT(cache.m_pins.empty());
+}
+
+void UVDLibuvudecUnitTest::debugConfigTest(void)
+{
+	uint32_t savedFlags = g_debugTypeFlags;
+	uint32_t savedLevel = g_debugLevel;
+
+	m_args.clear();
+	m_args.push_back("--verbose=2");
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, configInit());
+	//A level without any types turns on general
+	CPPUNIT_ASSERT_EQUAL((uint32_t)UVD_DEBUG_PASSES, g_debugLevel);
+	CPPUNIT_ASSERT(g_debugTypeFlags & UVD_DEBUG_TYPE_GENERAL);
+	CPPUNIT_ASSERT(UVDDebugEnabled(UVD_DEBUG_PASSES, UVD_DEBUG_TYPE_GENERAL));
+	CPPUNIT_ASSERT(!UVDDebugEnabled(UVD_DEBUG_SUMMARY, UVD_DEBUG_TYPE_GENERAL));
+
+	UVCPPUNIT_ASSERT(g_config->setDebugLevel(UVD_DEBUG_NONE));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)UVD_DEBUG_NONE, g_debugLevel);
+	CPPUNIT_ASSERT(!UVDDebugEnabled(UVD_DEBUG_TEMP, UVD_DEBUG_TYPE_GENERAL));
+	//Only ever raises it
+	UVCPPUNIT_ASSERT(g_config->ensureDebugLevel(UVD_DEBUG_SUMMARY));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)UVD_DEBUG_SUMMARY, g_debugLevel);
+	UVCPPUNIT_ASSERT(g_config->ensureDebugLevel(UVD_DEBUG_TEMP));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)UVD_DEBUG_SUMMARY, g_debugLevel);
+	CPPUNIT_ASSERT_EQUAL(g_config->m_debugLevel, g_debugLevel);
+
+	g_config->clearVerboseAll();
+	CPPUNIT_ASSERT_EQUAL((uint32_t)UVD_DEBUG_TYPE_NONE, g_debugTypeFlags);
+	CPPUNIT_ASSERT(!UVDDebugEnabled(UVD_DEBUG_TEMP, UVD_DEBUG_TYPE_GENERAL));
+	UVCPPUNIT_ASSERT(UVDSetDebugFlag(UVD_DEBUG_TYPE_ITERATOR, true));
+	CPPUNIT_ASSERT(UVDDebugEnabled(UVD_DEBUG_SUMMARY, UVD_DEBUG_TYPE_ITERATOR));
+	CPPUNIT_ASSERT(!UVDDebugEnabled(UVD_DEBUG_SUMMARY, UVD_DEBUG_TYPE_GENERAL));
+	UVCPPUNIT_ASSERT(UVDSetDebugFlag(UVD_DEBUG_TYPE_GENERAL, true));
+	UVCPPUNIT_ASSERT(UVDSetDebugFlag(UVD_DEBUG_TYPE_ITERATOR, false));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)UVD_DEBUG_TYPE_GENERAL, g_debugTypeFlags);
+	g_config->setVerboseAll();
+	CPPUNIT_ASSERT_EQUAL((uint32_t)UVD_DEBUG_TYPE_ALL, g_debugTypeFlags);
+
+	//Don't leave the rest of the run printing
+	g_config->clearVerboseAll();
+	UVCPPUNIT_ASSERT(g_config->setDebugLevel(savedLevel));
+	deinit();
+	UVCPPUNIT_ASSERT(UVDSetDebugFlag(UVD_DEBUG_TYPE_ALL, false));
+	UVCPPUNIT_ASSERT(UVDSetDebugFlag(savedFlags, true));
+	UVCPPUNIT_ASSERT(UVDSetDebugLevel(savedLevel));
+}
@@ -16,6 +16,17 @@ class UVDLibuvudecUnitTest : public UVDTestingCommonFixture
 	CPPUNIT_TEST_SUITE(UVDLibuvudecUnitTest);
 	CPPUNIT_TEST(versionTest);
 	CPPUNIT_TEST(initDeinitTest);
+	CPPUNIT_TEST(dataViewTest);
+	CPPUNIT_TEST(mappedFileViewTest);
+	CPPUNIT_TEST(rangeSetTest);
+	CPPUNIT_TEST(fileOutputSinkTest);
+	CPPUNIT_TEST(memoryOutputSinkTest);
+	CPPUNIT_TEST(stringOutputSinkTest);
+	CPPUNIT_TEST(profilerNestingTest);
+	CPPUNIT_TEST(profilerOutputTest);
+	CPPUNIT_TEST(instructionBoundariesTest);
+	CPPUNIT_TEST(instructionCacheInvalidateTest);
+	CPPUNIT_TEST(debugConfigTest);
 	CPPUNIT_TEST_SUITE_END();
 
 protected:
@@ -30,6 +41,52 @@ protected:
 	Should NOT initialize the actual decompiler engine
 	*/
 	void initDeinitTest(void);
+	/*
+	Zero copy views should point into contiguous sources and copy otherwise
+	*/
+	void dataViewTest(void);
+	/*
+	Mapped files are contiguous too, views and chunks over them shouldn't copy
+	*/
+	void mappedFileViewTest(void);
+	/*
+	Touching and overlapping runs should merge
+	Edges at 0 and UINT_MAX must not wrap
+	*/
+	void rangeSetTest(void);
+	/*
+	Writes smaller than, straddling and larger than the buffer should all come out in order
+	*/
+	void fileOutputSinkTest(void);
+	/*
+	Overflowing the region should fail and only count what fit
+	*/
+	void memoryOutputSinkTest(void);
+	void stringOutputSinkTest(void);
+	/*
+	A scope's self time is its total minus its children, never more than the total
+	Nothing new is recorded once disabled
+	*/
+	void profilerNestingTest(void);
+	/*
+	JSON and Chrome trace output should parse, names included
+	*/
+	void profilerOutputTest(void);
+	/*
+	getPrevious() should scan back across word boundaries and stop at the first word
+	Addresses past the last word search the whole bitmap
+	*/
+	void instructionBoundariesTest(void);
+	/*
+	Invalidating the instruction cache releases unpinned entries right away
+	Pinned ones should live until their last unpin()
+	*/
+	void instructionCacheInvalidateTest(void);
+	/*
+	Debug macros test cached copies of the flags and level
+	Every way of changing the debug config should update them
+	*/
+	void debugConfigTest(void);
 };
 
 #endif
@@ -62,6 +62,22 @@ void UVDObj2patUnitTest::libmTest()
 	verifyObj2Pat("libm.a", "libm.pat");
 }
 
+void UVDObj2patUnitTest::parallelTest()
+{
+	std::string serialPatFileContents;
+	std::string parallelPatFileContents;
+
+	m_args.clear();
+	m_args.push_back("--analysis-threads=1");
+	objectToPat("libm.a", serialPatFileContents);
+	m_args.clear();
+	m_args.push_back("--analysis-threads=4");
+	objectToPat("libm.a", parallelPatFileContents);
+
+	CPPUNIT_ASSERT(!serialPatFileContents.empty());
+	CPPUNIT_ASSERT_EQUAL(serialPatFileContents, parallelPatFileContents);
+}
+
 /*
 Utility
 */
@@ -83,6 +99,14 @@ void UVDObj2patUnitTest::verifyObj2Pat(const std::string &filePrefix)
 	verifyObj2Pat(filePrefix + ".o", filePrefix + ".pat");
 }
 
+void UVDObj2patUnitTest::objectToPat(const std::string &objectFileName, std::string &output)
+{
+	m_uvdInpuFileName = getUnitTestDir() + "/flirt/ELF/" + objectFileName;
+	generalInit();
+	UVCPPUNIT_ASSERT(g_uvdFLIRTPlugin->m_flirt->toPat(output));
+	deinit();
+}
+
 void UVDObj2patUnitTest::verifyObj2Pat(const std::string &objectFileNameIn, const std::string &expectedPatFileNameIn)
 {
 	std::string tempFile;
@@ -91,18 +115,13 @@ void UVDObj2patUnitTest::verifyObj2Pat(const std::string &objectFileNameIn, cons
 	//std::string outputPatFileName = getTempFileName();
 	std::string outputPatFileContents;
 	std::string expectedPatFileContents;
-	std::string objectFileName;
 	std::string expectedPatFileName;
 	
 	unitTestDir = getUnitTestDir();
-	objectFileName = unitTestDir + "/flirt/ELF/" + objectFileNameIn;
 	expectedPatFileName = unitTestDir + "/flirt/ELF/" + expectedPatFileNameIn;
 
 	m_args.clear();
-	m_uvdInpuFileName = objectFileName;
-	generalInit();
-	UVCPPUNIT_ASSERT(g_uvdFLIRTPlugin->m_flirt->toPat(outputPatFileContents));
-	deinit();
+	objectToPat(objectFileNameIn, outputPatFileContents);
 	
 	//UVCPPUNIT_ASSERT(readFile(outputPatFileName, outputPatFileContents));
 	UVCPPUNIT_ASSERT(readFile(expectedPatFileName, expectedPatFileContents));
@@ -29,6 +29,7 @@ class UVDObj2patUnitTest : public UVDTestingCommonFixture
 	CPPUNIT_TEST(shortTest);
 	CPPUNIT_TEST(testingMainTest);
 	CPPUNIT_TEST(libmTest);
+	CPPUNIT_TEST(parallelTest);
 	CPPUNIT_TEST_SUITE_END();
 
 protected:
@@ -74,6 +75,11 @@ protected:
 	A real library
 	*/
 	void libmTest();
+	/*
+	Archive members printed on several threads should come out byte for byte as a single thread prints them
+	libm.a has enough members to take several batches
+	*/
+	void parallelTest();
 
 	/*
 	Utility functions
@@ -81,6 +87,8 @@ protected:
 	//
 	void verifyObj2Pat(const std::string &filePrefix);
 	void verifyObj2Pat(const std::string &objectFileName, const std::string &expectedPatFileName);
+	//.pat of a file in the unit test ELF dir, using the current m_args
+	void objectToPat(const std::string &objectFileName, std::string &output);
 	//void verifyObj2Pat(const std::string &file, const std::string &expectedPatFileContents, bool fixupPaths = false);
 };
 
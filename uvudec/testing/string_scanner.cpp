@@ -0,0 +1,245 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include "testing/string_scanner.h"
+#include "uvdstrings/scanner.h"
+#include "uvdstrings/strings.h"
+#include <string.h>
+#include <vector>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UVDStringsUnitTest);
+
+//Not printable, zero or EBCDIC printable so nothing can run into it
+#define UVD_TESTING_STRINGS_FILLER		0x01
+//Second bitmap word starts at 64
+#define UVD_TESTING_STRINGS_OFFSET		60
+#define UVD_TESTING_STRINGS_SIZE		256
+
+static uint8_t toEBCDIC(char c)
+{
+	for( unsigned int i = 0; i < g_ebcdicPrintableRangeCount; ++i )
+	{
+		const UVDEBCDICRange &range = g_ebcdicPrintableRanges[i];
+		const char *found = strchr(range.m_ascii, c);
+		
+		if( c && found )
+		{
+			return range.m_first + (found - range.m_ascii);
+		}
+	}
+	return 0;
+}
+
+//text and its terminator in encoding
+static void appendEncoded(const char *text, UVDStringEncoding encoding, std::vector<uint8_t> &out)
+{
+	unsigned int size = UVDString::getCharacterSize(encoding);
+	
+	for( const char *cur = text; ; ++cur )
+	{
+		uint8_t c = *cur;
+		
+		if( encoding == UVD_STRING_ENCODING_EBCDIC )
+		{
+			c = toEBCDIC(*cur);
+		}
+		for( unsigned int i = 0; i < size; ++i )
+		{
+			bool isLow = false;
+			
+			if( encoding == UVD_STRING_ENCODING_BIG_ENDIAN16 || encoding == UVD_STRING_ENCODING_BIG_ENDIAN32 )
+			{
+				isLow = i == size - 1;
+			}
+			else
+			{
+				isLow = i == 0;
+			}
+			out.push_back(isLow ? c : 0);
+		}
+		if( !*cur )
+		{
+			break;
+		}
+	}
+}
+
+static void makeBuffer(const char *text, UVDStringEncoding encoding, std::vector<uint8_t> &out)
+{
+	out.assign(UVD_TESTING_STRINGS_OFFSET, UVD_TESTING_STRINGS_FILLER);
+	appendEncoded(text, encoding, out);
+	out.resize(UVD_TESTING_STRINGS_SIZE, UVD_TESTING_STRINGS_FILLER);
+}
+
+void UVDStringsUnitTest::encodingTest(UVDStringEncoding encoding)
+{
+	const char *text = "Hello World";
+	uint32_t expectedSize = (strlen(text) + 1) * UVDString::getCharacterSize(encoding);
+	std::vector<uint8_t> buffer;
+	std::vector<UVDStringScanner::Match> matches;
+	UVDStringScanner scanner;
+	
+	makeBuffer(text, encoding, buffer);
+	
+	//Only this encoding
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, scanner.init(UVD_STRING_ENCODING_BIT(encoding), 3));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, scanner.scan(&buffer[0], buffer.size(), matches));
+	CPPUNIT_ASSERT_EQUAL((size_t)1, matches.size());
+	CPPUNIT_ASSERT_EQUAL((uint32_t)UVD_TESTING_STRINGS_OFFSET, matches[0].m_offset);
+	CPPUNIT_ASSERT_EQUAL(expectedSize, matches[0].m_size);
+	CPPUNIT_ASSERT_EQUAL(encoding, matches[0].m_encoding);
+	
+	//Overlapping matches of other encodings start later and should be dropped
+	matches.clear();
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, scanner.init(UVD_STRING_ENCODINGS_ALL, 3));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, scanner.scan(&buffer[0], buffer.size(), matches));
+	CPPUNIT_ASSERT_EQUAL((size_t)1, matches.size());
+	CPPUNIT_ASSERT_EQUAL((uint32_t)UVD_TESTING_STRINGS_OFFSET, matches[0].m_offset);
+	CPPUNIT_ASSERT_EQUAL(expectedSize, matches[0].m_size);
+	CPPUNIT_ASSERT_EQUAL(encoding, matches[0].m_encoding);
+	
+	//Needs more than the minimum length
+	matches.clear();
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, scanner.init(UVD_STRING_ENCODING_BIT(encoding), strlen(text)));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, scanner.scan(&buffer[0], buffer.size(), matches));
+	CPPUNIT_ASSERT(matches.empty());
+	
+	//And a terminator
+	makeBuffer("", encoding, buffer);
+	buffer.resize(UVD_TESTING_STRINGS_OFFSET);
+	appendEncoded(text, encoding, buffer);
+	buffer.resize(buffer.size() - UVDString::getCharacterSize(encoding));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, scanner.init(UVD_STRING_ENCODING_BIT(encoding), 3));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, scanner.scan(&buffer[0], buffer.size(), matches));
+	CPPUNIT_ASSERT(matches.empty());
+}
+
+void UVDStringsUnitTest::asciiTest(void)
+{
+	encodingTest(UVD_STRING_ENCODING_ASCII);
+}
+
+void UVDStringsUnitTest::bigEndian16Test(void)
+{
+	encodingTest(UVD_STRING_ENCODING_BIG_ENDIAN16);
+}
+
+void UVDStringsUnitTest::littleEndian16Test(void)
+{
+	encodingTest(UVD_STRING_ENCODING_LITTLE_ENDIAN16);
+}
+
+void UVDStringsUnitTest::bigEndian32Test(void)
+{
+	encodingTest(UVD_STRING_ENCODING_BIG_ENDIAN32);
+}
+
+void UVDStringsUnitTest::littleEndian32Test(void)
+{
+	encodingTest(UVD_STRING_ENCODING_LITTLE_ENDIAN32);
+}
+
+void UVDStringsUnitTest::ebcdicTest(void)
+{
+	encodingTest(UVD_STRING_ENCODING_EBCDIC);
+}
+
+void UVDStringsUnitTest::ebcdicHeuristicTest(void)
+{
+	std::vector<uint8_t> buffer;
+	std::vector<UVDStringScanner::Match> matches;
+	UVDStringScanner scanner;
+	
+	//Every byte of this is printable EBCDIC as well
+	makeBuffer("KLMNOPklmnoyz{|}", UVD_STRING_ENCODING_ASCII, buffer);
+	for( uint32_t i = UVD_TESTING_STRINGS_OFFSET; buffer[i]; ++i )
+	{
+		CPPUNIT_ASSERT(UVDEBCDICToASCII(buffer[i]) != 0);
+	}
+	
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, scanner.init(UVD_STRING_ENCODING_BIT(UVD_STRING_ENCODING_EBCDIC), 3));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, scanner.scan(&buffer[0], buffer.size(), matches));
+	CPPUNIT_ASSERT(matches.empty());
+	
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, scanner.init(UVD_STRING_ENCODINGS_ALL, 3));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, scanner.scan(&buffer[0], buffer.size(), matches));
+	CPPUNIT_ASSERT_EQUAL((size_t)1, matches.size());
+	CPPUNIT_ASSERT_EQUAL((UVDStringEncoding)UVD_STRING_ENCODING_ASCII, matches[0].m_encoding);
+}
+
+void UVDStringsUnitTest::chunkingTest(void)
+{
+	const char *texts[] = {"Hello World", "abcd", "xyz", "0123456789ABCDEF", "a b c d e"};
+	const uint32_t chunkSizes[] = {1, 3, 16, 63, 64, 100, 1000};
+	std::vector<uint8_t> buffer;
+	std::vector<UVDStringScanner::Match> expected;
+	UVDStringScanner scanner;
+	uint32_t seed = 1;
+	bool anySplit = false;
+	
+	/*
+	Strings of every encoding packed between zero runs and random bytes
+	Fixed seed so failures reproduce
+	*/
+	while( buffer.size() < 8192 )
+	{
+		seed = seed * 1103515245 + 12345;
+		switch( (seed >> 16) % 4 )
+		{
+		case 0:
+			appendEncoded(texts[(seed >> 8) % 5], UVD_STRING_ENCODING_ASCII + (seed >> 20) % 6, buffer);
+			break;
+		case 1:
+			buffer.insert(buffer.end(), (seed >> 8) % 16, 0);
+			break;
+		case 2:
+			for( uint32_t i = (seed >> 8) % 8; i; --i )
+			{
+				seed = seed * 1103515245 + 12345;
+				buffer.push_back(seed >> 16);
+			}
+			break;
+		default:
+			buffer.push_back(UVD_TESTING_STRINGS_FILLER);
+		}
+	}
+	
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, scanner.init(UVD_STRING_ENCODINGS_ALL, 3));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, scanner.scan(&buffer[0], buffer.size(), expected));
+	CPPUNIT_ASSERT(!expected.empty());
+	
+	for( unsigned int i = 0; i < sizeof(chunkSizes) / sizeof(chunkSizes[0]); ++i )
+	{
+		UVDStringsAnalyzerImpl analyzer(NULL);
+		std::vector<UVDStringScanner::Match> matches;
+		uint32_t end = 0;
+		
+		analyzer.m_chunkSize = chunkSizes[i];
+		analyzer.m_scanners.resize(1);
+		CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, analyzer.m_scanners[0].init(analyzer.m_encodings, analyzer.m_minLength));
+		CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, analyzer.addChunks(NULL, &buffer[0], buffer.size()));
+		for( uint32_t chunk = 0; chunk < analyzer.m_chunks.size(); ++chunk )
+		{
+			//Chunks should tile the buffer
+			CPPUNIT_ASSERT_EQUAL(end, analyzer.m_chunks[chunk].m_start);
+			end = analyzer.m_chunks[chunk].m_end;
+			CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, analyzer.scanChunk(chunk, 0));
+			matches.insert(matches.end(), analyzer.m_chunks[chunk].m_matches.begin(), analyzer.m_chunks[chunk].m_matches.end());
+		}
+		CPPUNIT_ASSERT_EQUAL((uint32_t)buffer.size(), end);
+		anySplit = anySplit || analyzer.m_chunks.size() > 1;
+		
+		CPPUNIT_ASSERT_EQUAL(expected.size(), matches.size());
+		for( std::vector<UVDStringScanner::Match>::size_type match = 0; match < matches.size(); ++match )
+		{
+			CPPUNIT_ASSERT_EQUAL(expected[match].m_offset, matches[match].m_offset);
+			CPPUNIT_ASSERT_EQUAL(expected[match].m_size, matches[match].m_size);
+			CPPUNIT_ASSERT_EQUAL(expected[match].m_encoding, matches[match].m_encoding);
+		}
+	}
+	//Otherwise we haven't tested anything
+	CPPUNIT_ASSERT(anySplit);
+}
@@ -0,0 +1,54 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVD_TESTING_STRING_SCANNER_H
+#define UVD_TESTING_STRING_SCANNER_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "testing/framework/common_fixture.h"
+#include "uvd/string/string.h"
+
+class UVDStringsUnitTest : public UVDTestingCommonFixture
+{
+	CPPUNIT_TEST_SUITE(UVDStringsUnitTest);
+	CPPUNIT_TEST(asciiTest);
+	CPPUNIT_TEST(bigEndian16Test);
+	CPPUNIT_TEST(littleEndian16Test);
+	CPPUNIT_TEST(bigEndian32Test);
+	CPPUNIT_TEST(littleEndian32Test);
+	CPPUNIT_TEST(ebcdicTest);
+	CPPUNIT_TEST(ebcdicHeuristicTest);
+	CPPUNIT_TEST(chunkingTest);
+	CPPUNIT_TEST_SUITE_END();
+
+protected:
+	/*
+	A string in each encoding should be found alone and with every encoding enabled
+	Placed to cross a 64 byte bitmap word
+	*/
+	void asciiTest(void);
+	void bigEndian16Test(void);
+	void littleEndian16Test(void);
+	void bigEndian32Test(void);
+	void littleEndian32Test(void);
+	void ebcdicTest(void);
+	/*
+	Text in the ASCII range is mostly printable EBCDIC too
+	It shouldn't be reported as EBCDIC
+	*/
+	void ebcdicHeuristicTest(void);
+	/*
+	Scanning the chunks the strings analyzer cuts at findBoundary() on their own
+	should give the same strings as scanning the whole buffer at once
+	*/
+	void chunkingTest(void);
+	
+	void encodingTest(UVDStringEncoding encoding);
+};
+
+#endif
+
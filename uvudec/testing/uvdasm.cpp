@@ -0,0 +1,501 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#include "testing/uvdasm.h"
+#include "uvd/core/runtime.h"
+#include "uvd/core/uvd.h"
+#include "uvd/util/util.h"
+#include "uvdasm/architecture.h"
+#include "uvdasm/instruction.h"
+#include "uvdasm/interpreter/builtin.h"
+#include "uvdasm/opcode_cache.h"
+#include "uvdasm/opcode_table.h"
+#include "uvdasm/operand.h"
+#include "uvdasm/plugin_config.h"
+#include <stdlib.h>
+#include <string.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UVDUvdasmUnitTest);
+
+void UVDUvdasmUnitTest::tearDown(void)
+{
+	UVDTestingCommonFixture::tearDown();
+	//Plugin config outlives the engine
+	if( g_asmConfig )
+	{
+		g_asmConfig->m_architectureFileName.clear();
+		g_asmConfig->m_architectureCache = true;
+		g_asmConfig->m_architectureCacheDir.clear();
+	}
+	g_disasmOpcodeTables.deinit();
+}
+
+void UVDUvdasmUnitTest::reloadArchitecture()
+{
+	UVCPPUNIT_ASSERT(g_disasmOpcodeTables.deinit());
+}
+
+void UVDUvdasmUnitTest::archCacheDisassemble(const std::string &cacheArg, std::string &output)
+{
+	m_args.clear();
+	m_args.push_back("--arch-cache=" + cacheArg);
+	reloadArchitecture();
+	generalDisassemble(output);
+}
+
+UVDDisasmArchitecture *UVDUvdasmUnitTest::getArchitecture()
+{
+	CPPUNIT_ASSERT(m_uvd);
+	CPPUNIT_ASSERT(m_uvd->m_runtime);
+	CPPUNIT_ASSERT(m_uvd->m_runtime->m_architecture);
+	return (UVDDisasmArchitecture *)m_uvd->m_runtime->m_architecture;
+}
+
+uv_err_t UVDUvdasmUnitTest::loadArchCache(UVDDisasmOpcodeLookupTable **out)
+{
+	UVDDisasmOpcodeCache cache;
+	std::string architectureFileName;
+	std::string architectureFileData;
+
+	architectureFileName = getArchitecture()->m_architectureFileName;
+	uv_assert_err_ret(readFile(architectureFileName, architectureFileData));
+	uv_assert_err_ret(cache.init(architectureFileName, architectureFileData));
+	return cache.load(out);
+}
+
+std::string UVDUvdasmUnitTest::getArchCacheFileName(const std::string &cacheDir)
+{
+	return cacheDir + "/" + uv_basename(getArchitecture()->m_architectureFileName) + UVD_DISASM_OPCODE_CACHE_EXTENSION;
+}
+
+void UVDUvdasmUnitTest::archCacheRoundTripTest(void)
+{
+	std::string dir;
+	std::string reference;
+	std::string written;
+	std::string loaded;
+	UVDDisasmOpcodeLookupTable *table = NULL;
+
+	dir = getTempDirectoryName();
+	UVCPPUNIT_ASSERT(createDir(dir, true));
+	archCacheDisassemble("none", reference);
+	CPPUNIT_ASSERT(!reference.empty());
+
+	//Parses the text and writes the cache
+	archCacheDisassemble(dir, written);
+	//Loads it
+	archCacheDisassemble(dir, loaded);
+	CPPUNIT_ASSERT(written == reference);
+	CPPUNIT_ASSERT(loaded == reference);
+
+	m_args.clear();
+	m_args.push_back("--arch-cache=" + dir);
+	generalInit();
+	UVCPPUNIT_ASSERT(isRegularFile(getArchCacheFileName(dir)));
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, loadArchCache(&table));
+	CPPUNIT_ASSERT(table);
+	CPPUNIT_ASSERT_EQUAL(getArchitecture()->m_opcodeTable->m_instructions.size(), table->m_instructions.size());
+	delete table;
+	deinit();
+}
+
+void UVDUvdasmUnitTest::archCacheCorruptTest(void)
+{
+	std::string dir;
+	std::string reference;
+	std::string output;
+	std::string cacheFileName;
+	uint8_t *cache = NULL;
+	unsigned int cacheSize = 0;
+	UVDDisasmOpcodeLookupTable *table = NULL;
+
+	dir = getTempDirectoryName();
+	UVCPPUNIT_ASSERT(createDir(dir, true));
+	archCacheDisassemble("none", reference);
+	archCacheDisassemble(dir, output);
+
+	m_args.clear();
+	m_args.push_back("--arch-cache=" + dir);
+	generalInit();
+	cacheFileName = getArchCacheFileName(dir);
+	deinit();
+	UVCPPUNIT_ASSERT(read_file(cacheFileName.c_str(), &cache, &cacheSize));
+	CPPUNIT_ASSERT(cacheSize > 64);
+
+	//Truncated
+	UVCPPUNIT_ASSERT(writeFile(cacheFileName, (const char *)cache, cacheSize / 2));
+	generalInit();
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_NOTFOUND, loadArchCache(&table));
+	deinit();
+	archCacheDisassemble(dir, output);
+	CPPUNIT_ASSERT(output == reference);
+	//The fallback wrote a good one again
+	generalInit();
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_OK, loadArchCache(&table));
+	delete table;
+	table = NULL;
+	deinit();
+
+	//Still the right size and header, but the body doesn't match its checksum
+	cache[cacheSize - 1] ^= 0x01;
+	UVCPPUNIT_ASSERT(writeFile(cacheFileName, (const char *)cache, cacheSize));
+	generalInit();
+	CPPUNIT_ASSERT_EQUAL(UV_ERR_NOTFOUND, loadArchCache(&table));
+	deinit();
+	archCacheDisassemble(dir, output);
+	CPPUNIT_ASSERT(output == reference);
+
+	free(cache);
+}
+
+std::string UVDUvdasmUnitTest::getGameBoyArchitectureFileName()
+{
+	std::string installDir;
+	
+	UVCPPUNIT_ASSERT(UVDGetInstallDir(installDir));
+	return installDir + "/plugin/uvdasm/data/arch/Z80/game_boy.op";
+}
+
+void UVDUvdasmUnitTest::architectureFileInit(const std::string &architectureFileName, const uint8_t *code, uint32_t codeSize)
+{
+	m_uvdInpuFileName = getTempFileName();
+	UVCPPUNIT_ASSERT(writeFile(m_uvdInpuFileName, (const char *)code, codeSize));
+	m_args.clear();
+	m_args.push_back("--arch-file=" + architectureFileName);
+	m_args.push_back("--arch-cache=none");
+	reloadArchitecture();
+	generalInit();
+}
+
+void UVDUvdasmUnitTest::prefixDecodeTest(void)
+{
+	const uint8_t code[] = {0xCB, 0x37, 0xCB, 0x7C, 0xCB, 0x00, 0xCB, 0xFF};
+	const char *expected[] = {"SWAP A", "BIT 0x7, H", "RLC B", "SET 0x7, A"};
+	UVDInstructionIterator iter;
+	UVDInstructionIterator iterEnd;
+	UVDDisasmInstructionShared *element = NULL;
+	UVDDisasmOpcodeLookupTable *subTable = NULL;
+	uint32_t index = 0;
+
+	architectureFileInit(getGameBoyArchitectureFileName(), code, sizeof(code));
+
+	//0xCB is only a prefix and its whole page is defined
+	UVCPPUNIT_ASSERT(getArchitecture()->m_opcodeTable->getElement(0xCB, &element, &subTable));
+	CPPUNIT_ASSERT(element == NULL);
+	CPPUNIT_ASSERT(subTable != NULL);
+	for( uint32_t i = 0; i < 0x100; ++i )
+	{
+		UVDDisasmOpcodeLookupTable *nested = NULL;
+		
+		UVCPPUNIT_ASSERT(subTable->getElement(i, &element, &nested));
+		CPPUNIT_ASSERT(element != NULL);
+		CPPUNIT_ASSERT(nested == NULL);
+		CPPUNIT_ASSERT_EQUAL((uint32_t)2, element->m_opcode_length);
+	}
+
+	UVCPPUNIT_ASSERT(m_uvd->instructionBegin(iter));
+	UVCPPUNIT_ASSERT(m_uvd->instructionEnd(iterEnd));
+	while( iter != iterEnd )
+	{
+		UVDInstruction *instruction = NULL;
+		std::string text;
+
+		CPPUNIT_ASSERT(index < sizeof(expected) / sizeof(expected[0]));
+		UVCPPUNIT_ASSERT(iter.get(&instruction));
+		CPPUNIT_ASSERT(instruction != NULL);
+		CPPUNIT_ASSERT(instruction->m_shared != NULL);
+		CPPUNIT_ASSERT_EQUAL(index * 2, instruction->m_offset);
+		CPPUNIT_ASSERT_EQUAL((uint32_t)2, instruction->m_inst_size);
+		UVCPPUNIT_ASSERT(instruction->print_disasm(text));
+		CPPUNIT_ASSERT_EQUAL(std::string(expected[index]), text);
+		++index;
+		UVCPPUNIT_ASSERT(iter.next());
+	}
+	CPPUNIT_ASSERT_EQUAL((uint32_t)(sizeof(expected) / sizeof(expected[0])), index);
+
+	//Bit number is a constant operand taken from the opcode, not a byte of its own
+	UVCPPUNIT_ASSERT(subTable->getElement(0x7C, &element, &subTable));
+	CPPUNIT_ASSERT(element != NULL);
+	CPPUNIT_ASSERT_EQUAL(std::string("BIT"), element->m_memoric);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)2, element->m_total_length);
+	CPPUNIT_ASSERT_EQUAL((std::vector<UVDDisasmOperandShared *>::size_type)2, element->m_operands.size());
+	CPPUNIT_ASSERT_EQUAL((uint32_t)UV_DISASM_DATA_CONSTANT, (uint32_t)element->m_operands[0]->m_type);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0x7, ((UVDDisasmConstantOperandShared *)element->m_operands[0])->m_value);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)UV_DISASM_DATA_REG, (uint32_t)element->m_operands[1]->m_type);
+	CPPUNIT_ASSERT_EQUAL(std::string("H"), element->m_operands[1]->m_name);
+
+	deinit();
+}
+
+void UVDUvdasmUnitTest::prefixBitmaskTest(void)
+{
+	UVDDisasmOpcodeLookupTable table;
+	UVDDisasmInstructionShared *shared = NULL;
+	UVDDisasmInstructionShared *element = NULL;
+	UVDDisasmOpcodeLookupTable *subTable = NULL;
+
+	//BIT b, r is 0xCB, 01bbbrrr
+	shared = new UVDDisasmInstructionShared();
+	shared->m_memoric = "BIT";
+	shared->m_opcode_length = 2;
+	shared->m_total_length = 2;
+	shared->m_opcode[0] = 0xCB;
+	shared->m_opcode[1] = 0x40;
+	shared->m_bitmask[1] = 0xC0;
+	UVCPPUNIT_ASSERT(table.addInstruction(shared));
+
+	for( uint32_t i = 0; i < 0x100; ++i )
+	{
+		UVCPPUNIT_ASSERT(table.getElement(i, &element, &subTable));
+		CPPUNIT_ASSERT(element == NULL);
+		CPPUNIT_ASSERT((subTable != NULL) == (i == 0xCB));
+	}
+	UVCPPUNIT_ASSERT(table.getElement(0xCB, &element, &subTable));
+	for( uint32_t i = 0; i < 0x100; ++i )
+	{
+		UVDDisasmOpcodeLookupTable *nested = NULL;
+		
+		UVCPPUNIT_ASSERT(subTable->getElement(i, &element, &nested));
+		CPPUNIT_ASSERT(nested == NULL);
+		if( (i & 0xC0) == 0x40 )
+		{
+			CPPUNIT_ASSERT(element == shared);
+		}
+		else
+		{
+			CPPUNIT_ASSERT(element == NULL);
+		}
+	}
+}
+
+void UVDUvdasmUnitTest::prefixUndefinedTest(void)
+{
+	//SET 0x7, A removed, then RST 0x38 and NOP
+	const uint8_t code[] = {0xCB, 0xFF, 0x00};
+	std::string architectureFileData;
+	std::string architectureFileName;
+	std::string::size_type usage = 0;
+	std::string::size_type start = 0;
+	std::string::size_type end = 0;
+	UVDInstructionIterator iter;
+	UVDInstructionIterator iterEnd;
+	UVDInstruction *instruction = NULL;
+	std::string text;
+
+	UVCPPUNIT_ASSERT(readFile(getGameBoyArchitectureFileName(), architectureFileData));
+	usage = architectureFileData.find("USAGE=0xCB,0xFF\n");
+	CPPUNIT_ASSERT(usage != std::string::npos);
+	start = architectureFileData.rfind("\n\n", usage);
+	end = architectureFileData.find("\n\n", usage);
+	CPPUNIT_ASSERT(start != std::string::npos);
+	CPPUNIT_ASSERT(end != std::string::npos);
+	architectureFileData.erase(start, end - start);
+	architectureFileName = getTempDirectoryName();
+	UVCPPUNIT_ASSERT(createDir(architectureFileName, true));
+	architectureFileName += "/game_boy.op";
+	UVCPPUNIT_ASSERT(writeFile(architectureFileName, architectureFileData));
+
+	architectureFileInit(architectureFileName, code, sizeof(code));
+	UVCPPUNIT_ASSERT(m_uvd->instructionBegin(iter));
+	UVCPPUNIT_ASSERT(m_uvd->instructionEnd(iterEnd));
+
+	CPPUNIT_ASSERT(iter != iterEnd);
+	UVCPPUNIT_ASSERT(iter.get(&instruction));
+	CPPUNIT_ASSERT(instruction != NULL);
+	CPPUNIT_ASSERT(instruction->m_shared == NULL);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0, instruction->m_offset);
+	
+	//The byte after the prefix is not skipped
+	UVCPPUNIT_ASSERT(iter.next());
+	CPPUNIT_ASSERT(iter != iterEnd);
+	UVCPPUNIT_ASSERT(iter.get(&instruction));
+	CPPUNIT_ASSERT(instruction->m_shared != NULL);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)1, instruction->m_offset);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)1, instruction->m_inst_size);
+	UVCPPUNIT_ASSERT(instruction->print_disasm(text));
+	CPPUNIT_ASSERT_EQUAL(std::string("RST 0x38"), text);
+
+	UVCPPUNIT_ASSERT(iter.next());
+	CPPUNIT_ASSERT(iter != iterEnd);
+	UVCPPUNIT_ASSERT(iter.get(&instruction));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)2, instruction->m_offset);
+	text.clear();
+	UVCPPUNIT_ASSERT(instruction->print_disasm(text));
+	CPPUNIT_ASSERT_EQUAL(std::string("NOP"), text);
+
+	UVCPPUNIT_ASSERT(iter.next());
+	CPPUNIT_ASSERT(iter == iterEnd);
+
+	deinit();
+}
+
+uv_err_t UVDUvdasmUnitTest::builtinExecute(const std::string &expression, const UVDVariableMap &environment, UVDBuiltinResult *result)
+{
+	UVDBuiltinProgram program;
+	
+	uv_assert_err_ret(program.compile(expression));
+	CPPUNIT_ASSERT(program.isCompiled());
+	return program.execute(environment, result);
+}
+
+uint32_t UVDUvdasmUnitTest::builtinCallTarget(const std::string &expression)
+{
+	UVDVariableMap environment;
+	UVDBuiltinResult result;
+	
+	UVCPPUNIT_ASSERT(builtinExecute(expression, environment, &result));
+	CPPUNIT_ASSERT(result.m_isCall);
+	CPPUNIT_ASSERT(!result.m_isJump);
+	return result.m_callTarget;
+}
+
+void UVDUvdasmUnitTest::builtinPrecedenceTest(void)
+{
+	CPPUNIT_ASSERT_EQUAL((uint32_t)7, builtinCallTarget("CALL(1 + 2 * 3)"));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)9, builtinCallTarget("CALL((1 + 2) * 3)"));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)3, builtinCallTarget("CALL(10 - 4 - 3)"));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)5, builtinCallTarget("CALL(100 / 10 / 2)"));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)6, builtinCallTarget("CALL(-2 * -3)"));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0xFF, builtinCallTarget("CALL(~0 & 0xFF)"));
+	//Shifts below additive
+	CPPUNIT_ASSERT_EQUAL((uint32_t)8, builtinCallTarget("CALL(1 << 2 + 1)"));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0x40, builtinCallTarget("CALL(0x100 >> 4 / 2)"));
+	//& above ^ above |
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0xFF, builtinCallTarget("CALL(0xF0 ^ 0xFF & 0x0F)"));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)3, builtinCallTarget("CALL(1 | 6 & 3)"));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0x0E, builtinCallTarget("CALL(0x0C | 0x06 ^ 0x04)"));
+	//Same number formats as the config file
+	CPPUNIT_ASSERT_EQUAL((uint32_t)8, builtinCallTarget("CALL(010)"));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0x1F00, builtinCallTarget("CALL(0x1F00)"));
+}
+
+void UVDUvdasmUnitTest::builtinVariableTest(void)
+{
+	UVDBuiltinProgram program;
+	UVDVariableMap environment;
+	UVDBuiltinResult result;
+	int64_t variables[2];
+
+	//8051 ACALL
+	UVCPPUNIT_ASSERT(program.compile("CALL(%PC&0x1F00+u8_0+0x0000)"));
+	CPPUNIT_ASSERT_EQUAL((std::vector<std::string>::size_type)2, program.m_variables.size());
+	CPPUNIT_ASSERT_EQUAL(0, program.getVariableIndex("PC"));
+	CPPUNIT_ASSERT_EQUAL(1, program.getVariableIndex("u8_0"));
+	CPPUNIT_ASSERT_EQUAL(-1, program.getVariableIndex("%PC"));
+	variables[0] = 0x1234;
+	variables[1] = 0x10;
+	UVCPPUNIT_ASSERT(program.execute(variables, &result));
+	CPPUNIT_ASSERT(result.m_isCall);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)(0x1234 & (0x1F00 + 0x10)), result.m_callTarget);
+
+	//Same values by name
+	environment["PC"] = UVDVarient((uint32_t)0x1234);
+	environment["u8_0"] = UVDVarient(std::string("0x10"));
+	UVCPPUNIT_ASSERT(program.execute(environment, &result));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0x1210, result.m_callTarget);
+	environment.erase("u8_0");
+	CPPUNIT_ASSERT(UV_FAILED(program.execute(environment, &result)));
+
+	//A variable is only stored once
+	UVCPPUNIT_ASSERT(program.compile("GOTO(%PC + PC + s8_0)"));
+	CPPUNIT_ASSERT_EQUAL((std::vector<std::string>::size_type)2, program.m_variables.size());
+	environment["s8_0"] = UVDVarient((int32_t)-4);
+	UVCPPUNIT_ASSERT(program.execute(environment, &result));
+	CPPUNIT_ASSERT(!result.m_isCall);
+	CPPUNIT_ASSERT(result.m_isJump);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)(0x1234 * 2 - 4), result.m_jumpTarget);
+
+	//Tags are the value of their argument
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0x10, builtinCallTarget("CALL(ROM(0x10))"));
+	environment["u8_0"] = UVDVarient((uint32_t)0x30);
+	UVCPPUNIT_ASSERT(builtinExecute("GOTO(RAM_INT(%u8_0) + 1)", environment, &result));
+	CPPUNIT_ASSERT(result.m_isJump);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0x31, result.m_jumpTarget);
+}
+
+void UVDUvdasmUnitTest::builtinStatementTest(void)
+{
+	UVDBuiltinProgram program;
+	UVDVariableMap environment;
+	UVDBuiltinResult result;
+
+	UVCPPUNIT_ASSERT(program.compile("nop"));
+	CPPUNIT_ASSERT(program.m_code.empty());
+	UVCPPUNIT_ASSERT(program.execute(environment, &result));
+	CPPUNIT_ASSERT(!result.m_isCall);
+	CPPUNIT_ASSERT(!result.m_isJump);
+
+	UVCPPUNIT_ASSERT(program.compile(" RETURN ( ) "));
+	UVCPPUNIT_ASSERT(program.execute(environment, &result));
+	CPPUNIT_ASSERT(!result.m_isCall);
+	CPPUNIT_ASSERT(!result.m_isJump);
+
+	//Every statement is run
+	UVCPPUNIT_ASSERT(builtinExecute("nop; CALL(2); GOTO(3);", environment, &result));
+	CPPUNIT_ASSERT(result.m_isCall);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)2, result.m_callTarget);
+	CPPUNIT_ASSERT(result.m_isJump);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)3, result.m_jumpTarget);
+	UVCPPUNIT_ASSERT(builtinExecute("CALL(4); RETURN()", environment, &result));
+	CPPUNIT_ASSERT(result.m_isCall);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)4, result.m_callTarget);
+	
+	//Results don't carry over between runs
+	UVCPPUNIT_ASSERT(program.compile("GOTO(5)"));
+	UVCPPUNIT_ASSERT(program.execute(environment, &result));
+	CPPUNIT_ASSERT(!result.m_isCall);
+	CPPUNIT_ASSERT(result.m_isJump);
+}
+
+void UVDUvdasmUnitTest::builtinMalformedTest(void)
+{
+	const char *malformed[] = {
+		"",
+		";",
+		"nop nop",
+		"CALL(",
+		"CALL(1",
+		"CALL()",
+		"CALL(1))",
+		"CALL(1, 2)",
+		"ROM(1, 2)",
+		"RETURN(1)",
+		"1 +",
+		"* 2",
+		"(1",
+		"1 2",
+		"1 < 2",
+		"CALL(@)",
+		"CALL(1);;",
+	};
+	UVDBuiltinProgram program;
+	UVDVariableMap environment;
+	UVDBuiltinResult result;
+	std::string deep;
+
+	for( uint32_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); ++i )
+	{
+		printf("malformed: <%s>\n", malformed[i]);
+		UVCPPUNIT_ASSERT(program.compile("CALL(1)"));
+		CPPUNIT_ASSERT(UV_FAILED(program.compile(malformed[i])));
+		CPPUNIT_ASSERT(!program.isCompiled());
+		CPPUNIT_ASSERT(program.m_code.empty());
+		CPPUNIT_ASSERT(program.m_variables.empty());
+		CPPUNIT_ASSERT(UV_FAILED(program.execute(environment, &result)));
+	}
+
+	//Deeper than the evaluation stack
+	for( uint32_t i = 0; i < UVD_BUILTIN_STACK_MAX; ++i )
+	{
+		deep += "1+(";
+	}
+	deep += "1";
+	deep += std::string(UVD_BUILTIN_STACK_MAX, ')');
+	CPPUNIT_ASSERT(UV_FAILED(program.compile(deep)));
+
+	//Well formed but can't be evaluated
+	CPPUNIT_ASSERT(UV_FAILED(builtinExecute("CALL(1 / (2 - 2))", environment, &result)));
+}
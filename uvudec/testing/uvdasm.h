@@ -0,0 +1,92 @@
+/*
+UVNet Universal Decompiler (uvudec)
+Copyright 2012 John McMaster <JohnDMcMaster@gmail.com>
+Licensed under the terms of the LGPL V3 or later, see COPYING for details
+*/
+
+#ifndef UVD_TESTING_UVDASM_H
+#define UVD_TESTING_UVDASM_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "testing/framework/common_fixture.h"
+
+class UVDBuiltinResult;
+class UVDDisasmArchitecture;
+class UVDDisasmOpcodeLookupTable;
+class UVDUvdasmUnitTest : public UVDTestingCommonFixture
+{
+	CPPUNIT_TEST_SUITE(UVDUvdasmUnitTest);
+	CPPUNIT_TEST(archCacheRoundTripTest);
+	CPPUNIT_TEST(archCacheCorruptTest);
+	CPPUNIT_TEST(prefixDecodeTest);
+	CPPUNIT_TEST(prefixBitmaskTest);
+	CPPUNIT_TEST(prefixUndefinedTest);
+	CPPUNIT_TEST(builtinPrecedenceTest);
+	CPPUNIT_TEST(builtinVariableTest);
+	CPPUNIT_TEST(builtinStatementTest);
+	CPPUNIT_TEST(builtinMalformedTest);
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	//Put back the architecture settings we changed
+	virtual void tearDown(void);
+
+protected:
+	/*
+	Disassembly from an architecture loaded out of the cache should match parsing the .op text
+	*/
+	void archCacheRoundTripTest(void);
+	/*
+	A truncated or damaged cache shouldn't load, the text should be parsed instead and the cache rewritten
+	*/
+	void archCacheCorruptTest(void);
+	/*
+	Game Boy 0xCB page instructions decode through the prefix sub table
+	*/
+	void prefixDecodeTest(void);
+	/*
+	A bitmask in a byte after the prefix should be expanded into every matching sub table entry
+	*/
+	void prefixBitmaskTest(void);
+	/*
+	A prefix followed by a byte not in its sub table is a single undefined byte
+	*/
+	void prefixUndefinedTest(void);
+	/*
+	Builtin ACTION evaluator operators should follow C precedence and associativity
+	*/
+	void builtinPrecedenceTest(void);
+	/*
+	%PC and operands are variables looked up by name, address space tags pass their argument through
+	*/
+	void builtinVariableTest(void);
+	/*
+	nop, RETURN() and ; separated statements
+	*/
+	void builtinStatementTest(void);
+	/*
+	Anything outside of the grammar should fail to compile and leave nothing behind
+	*/
+	void builtinMalformedTest(void);
+
+	//Opcode tables are shared between engines in a process, drop them so the next engine loads its own
+	void reloadArchitecture();
+	//generalDisassemble() with --arch-cache=cacheArg and a freshly loaded architecture
+	void archCacheDisassemble(const std::string &cacheArg, std::string &output);
+	//Architecture of the current engine
+	UVDDisasmArchitecture *getArchitecture();
+	//Load the current engine's architecture from cacheDir directly
+	uv_err_t loadArchCache(UVDDisasmOpcodeLookupTable **out);
+	std::string getArchCacheFileName(const std::string &cacheDir);
+	std::string getGameBoyArchitectureFileName();
+	//Engine on code with the given architecture file
+	void architectureFileInit(const std::string &architectureFileName, const uint8_t *code, uint32_t codeSize);
+	//Compile and run expression with the builtin ACTION evaluator
+	uv_err_t builtinExecute(const std::string &expression, const UVDVariableMap &environment, UVDBuiltinResult *result);
+	//Target of the single CALL() in expression
+	uint32_t builtinCallTarget(const std::string &expression);
+};
+
+#endif
+
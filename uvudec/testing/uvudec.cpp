@@ -10,13 +10,53 @@ Licensed under the terms of the LGPL V3 or later, see COPYING for details
 #include "uvd/core/init.h"
 #include "testing/uvudec.h"
 #include "uvd/config.h"
+#include "uvd/architecture/architecture.h"
+#include "uvd/core/analyzer.h"
+#include "uvd/core/runtime.h"
 #include "uvd/util/util.h"
+#include <pthread.h>
 #include <vector>
 #include <string>
 #include <string.h>
 
 CPPUNIT_TEST_SUITE_REGISTRATION(UVDUvudecUnitTest);
 
+#define UVD_TESTING_CONCURRENT_ENGINES		4
+
+//One engine's run in concurrentEnginesTest
+class UVDTestingEngineThread
+{
+public:
+	UVDTestingEngineThread()
+	{
+		m_rc = UV_ERR_GENERAL;
+		m_ownsParts = false;
+	}
+
+public:
+	std::string m_fileName;
+	std::string m_output;
+	uv_err_t m_rc;
+	//Engine's analyzer and architecture point back to it rather than to g_uvd
+	bool m_ownsParts;
+};
+
+static void *engineThread(void *user)
+{
+	UVDTestingEngineThread *job = (UVDTestingEngineThread *)user;
+	UVD *uvd = NULL;
+
+	if( UV_FAILED(UVD::getUVDFromFileName(&uvd, job->m_fileName)) || !uvd )
+	{
+		return NULL;
+	}
+	job->m_ownsParts = uvd->m_analyzer && uvd->m_analyzer->m_uvd == uvd
+			&& uvd->m_runtime && uvd->m_runtime->m_architecture && uvd->m_runtime->m_architecture->m_uvd == uvd;
+	job->m_rc = uvd->disassemble(job->m_output);
+	delete uvd;
+	return NULL;
+}
+
 /*
 Tests
 */
@@ -261,3 +301,67 @@ void UVDUvudecUnitTest::uvudecBasicRunTest(void)
 	UVCPPUNIT_ASSERT(uvudec_uvmain(m_argc, m_argv));
 }
 
+void UVDUvudecUnitTest::batchRerunTest(void)
+{
+	std::string dir;
+	uint8_t *image = NULL;
+	unsigned int imageSize = 0;
+	std::string firstListing;
+	std::string secondListing;
+	std::vector<std::string> files;
+
+	dir = getTempDirectoryName();
+	UVCPPUNIT_ASSERT(createDir(dir, true));
+	UVCPPUNIT_ASSERT(read_file(DEFAULT_DECOMPILE_FILE, &image, &imageSize));
+	UVCPPUNIT_ASSERT(writeFile(dir + "/a.bin", (const char *)image, imageSize));
+	UVCPPUNIT_ASSERT(writeFile(dir + "/b.bin", (const char *)image, imageSize));
+	free(image);
+
+	m_args.push_back("--batch=" + dir);
+	argsToArgv();
+	UVCPPUNIT_ASSERT(uvudec_uvmain(m_argc, m_argv));
+	UVCPPUNIT_ASSERT(readFile(dir + "/a.bin.asm", firstListing));
+	CPPUNIT_ASSERT(!firstListing.empty());
+
+	UVCPPUNIT_ASSERT(uvudec_uvmain(m_argc, m_argv));
+	UVCPPUNIT_ASSERT(readFile(dir + "/a.bin.asm", secondListing));
+	CPPUNIT_ASSERT(firstListing == secondListing);
+
+	//No listings of listings
+	UVCPPUNIT_ASSERT(getDirFiles(dir, files));
+	CPPUNIT_ASSERT_EQUAL((size_t)4, files.size());
+	CPPUNIT_ASSERT(files[0] == dir + "/a.bin");
+	CPPUNIT_ASSERT(files[1] == dir + "/a.bin.asm");
+	CPPUNIT_ASSERT(files[2] == dir + "/b.bin");
+	CPPUNIT_ASSERT(files[3] == dir + "/b.bin.asm");
+}
+
+void UVDUvudecUnitTest::concurrentEnginesTest(void)
+{
+	std::string reference;
+	UVDTestingEngineThread jobs[UVD_TESTING_CONCURRENT_ENGINES];
+	pthread_t threads[UVD_TESTING_CONCURRENT_ENGINES];
+
+	generalDisassemble(reference);
+	CPPUNIT_ASSERT(!reference.empty());
+
+	UVCPPUNIT_ASSERT(configInit());
+	for( int i = 0; i < UVD_TESTING_CONCURRENT_ENGINES; ++i )
+	{
+		jobs[i].m_fileName = m_uvdInpuFileName;
+		CPPUNIT_ASSERT(pthread_create(&threads[i], NULL, engineThread, &jobs[i]) == 0);
+	}
+	for( int i = 0; i < UVD_TESTING_CONCURRENT_ENGINES; ++i )
+	{
+		CPPUNIT_ASSERT(pthread_join(threads[i], NULL) == 0);
+	}
+
+	for( int i = 0; i < UVD_TESTING_CONCURRENT_ENGINES; ++i )
+	{
+		UVCPPUNIT_ASSERT(jobs[i].m_rc);
+		CPPUNIT_ASSERT(jobs[i].m_ownsParts);
+		CPPUNIT_ASSERT(jobs[i].m_output == reference);
+	}
+	deinit();
+}
+
@@ -24,6 +24,8 @@ class UVDUvudecUnitTest : public UVDTestingCommonFixture
 	CPPUNIT_TEST(disassembleRangeTestDefaultEquivilenceTest);
 	CPPUNIT_TEST(disassembleRangeTestComplexTest);
 	CPPUNIT_TEST(uvudecBasicRunTest);
+	CPPUNIT_TEST(batchRerunTest);
+	CPPUNIT_TEST(concurrentEnginesTest);
 	CPPUNIT_TEST_SUITE_END();
 
 protected:
@@ -63,6 +65,15 @@ protected:
 	Does a basic test where as most of hte thorough test test libuvudec rather than what the uvudec exe can do
 	*/
 	void uvudecBasicRunTest(void);
+	/*
+	Running a directory batch again shouldn't pick up the listings the first run wrote
+	*/
+	void batchRerunTest(void);
+	/*
+	Engines on separate threads should each use their own analyzer and architecture, not g_uvd's
+	and print the same as one engine on its own
+	*/
+	void concurrentEnginesTest(void);
 };
 
 #endif
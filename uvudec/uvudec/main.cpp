@@ -10,9 +10,11 @@ uvudec entry point
 #include <stdio.h>
 #include <string.h>
 #include <string>
+#include <vector>
 #include "uvd/config/arg_property.h"
 #include "uvd/config/arg_util.h"
 #include "uvd/util/error.h"
+#include "uvd/util/output_sink.h"
 #include "uvd/core/init.h"
 #include "uvd/util/util.h"
 #include "uvd/core/uvd.h"
@@ -32,11 +34,20 @@ Seems a solid architecture, should stick with it
 
 #define UVD_PROP_INIT_ONLY			"uvudec.debug.init_only"
 #define UVD_PROP_INIT_ONLY_DEFAULT	false
+//Directory of binaries or a file listing one binary per line
+#define UVD_PROP_BATCH				"uvudec.batch"
+//Where batch outputs go, next to each input if not given
+#define UVD_PROP_BATCH_OUTPUT		"uvudec.batch.output"
+#define UVD_BATCH_OUTPUT_EXTENSION	".asm"
 
 static std::string g_outputFile;
 static FILE *g_pOutputFile = NULL;
 //UVD_PROP_INIT_ONLY
 static uvd_bool_t g_initOnly = UVD_PROP_INIT_ONLY_DEFAULT;
+//UVD_PROP_BATCH
+static std::string g_batch;
+//UVD_PROP_BATCH_OUTPUT
+static std::string g_batchOutput;
 
 uv_err_t versionPrintPrefixThunk();
 
@@ -46,6 +57,7 @@ static uv_err_t runTasks()
 	std::string output;
 	UVD *uvd = NULL;
 	UVDData *data = NULL;
+	UVDFileOutputSink outputSink;
 
 	printf_debug_level(UVD_DEBUG_PASSES, "main: initializing data streams\n");
 
@@ -54,7 +66,7 @@ static uv_err_t runTasks()
 	{
 		printf_error("Target file not specified\n");
 		g_config->printHelp();
-		uv_assert(UV_ERR_GENERAL);
+		uv_assert_err(UV_ERR_GENERAL);
 	}
 
 	//Select input
@@ -87,7 +99,10 @@ static uv_err_t runTasks()
 		{
 			//Get string output
 			printf_debug_level(UVD_DEBUG_SUMMARY, "Disassembling...\n");
-			rc = uvd->disassembleByCallback(UVDPrintToFileStringCallback, g_pOutputFile);
+			//Anything already written through stdio goes first
+			fflush(g_pOutputFile);
+			uv_assert_err(outputSink.init(fileno(g_pOutputFile)));
+			rc = uvd->disassemble(&outputSink);
 			if( UV_FAILED(rc) )
 			{
 				printf_error("Failed to runTasks!\n");
@@ -104,6 +119,168 @@ error:
 	return rc;
 }
 
+/*
+Batch mode
+Each input gets its own engine, but plugins, config and the parsed architecture tables
+are loaded once and shared, so per file cost is only the analysis itself
+*/
+/*
+Outputs of an earlier run in the same directory aren't inputs
+Otherwise each rerun would disassemble the last one's listings
+*/
+static uv_err_t isBatchOutput(const std::string &file, bool *out)
+{
+	std::string extension = UVD_BATCH_OUTPUT_EXTENSION;
+	std::string fileCannonical;
+	std::string outputCannonical;
+
+	uv_assert_ret(out);
+	*out = false;
+	if( file.size() >= extension.size()
+			&& file.compare(file.size() - extension.size(), extension.size(), extension) == 0 )
+	{
+		*out = true;
+		return UV_ERR_OK;
+	}
+	if( !g_batchOutput.empty() )
+	{
+		uv_assert_err_ret(getCannonicalFileName(file, fileCannonical));
+		uv_assert_err_ret(getCannonicalFileName(g_batchOutput, outputCannonical));
+		outputCannonical += "/";
+		*out = fileCannonical.compare(0, outputCannonical.size(), outputCannonical) == 0;
+	}
+	return UV_ERR_OK;
+}
+
+static uv_err_t getBatchInputs(std::vector<std::string> &out)
+{
+	std::string listData;
+	std::vector<std::string> lines;
+
+	if( UV_SUCCEEDED(isDir(g_batch)) )
+	{
+		std::vector<std::string> files;
+		
+		uv_assert_err_ret(getDirFiles(g_batch, files));
+		for( std::vector<std::string>::iterator iter = files.begin(); iter != files.end(); ++iter )
+		{
+			bool isOutput = false;
+			
+			uv_assert_err_ret(isBatchOutput(*iter, &isOutput));
+			if( isOutput )
+			{
+				printf_debug_level(UVD_DEBUG_SUMMARY, "batch: skipping output %s\n", (*iter).c_str());
+				continue;
+			}
+			out.push_back(*iter);
+		}
+		return UV_ERR_OK;
+	}
+	
+	uv_assert_err_ret(UVDReadFileByString(g_batch, listData));
+	lines = split(listData, '\n', false);
+	for( std::vector<std::string>::iterator iter = lines.begin(); iter != lines.end(); ++iter )
+	{
+		std::string line = trimString(*iter);
+		
+		if( line.empty() || line[0] == '#' )
+		{
+			continue;
+		}
+		out.push_back(line);
+	}
+	return UV_ERR_OK;
+}
+
+static uv_err_t runBatchFile(const std::string &inputFile)
+{
+	uv_err_t rc = UV_ERR_GENERAL;
+	std::string outputFile;
+	UVDFileOutputSink outputSink;
+	UVD *uvd = NULL;
+	UVDData *data = NULL;
+
+	if( g_batchOutput.empty() )
+	{
+		outputFile = inputFile + UVD_BATCH_OUTPUT_EXTENSION;
+	}
+	else
+	{
+		outputFile = g_batchOutput + "/" + uv_basename(inputFile) + UVD_BATCH_OUTPUT_EXTENSION;
+	}
+
+	printf_debug_level(UVD_DEBUG_SUMMARY, "batch: %s => %s\n", inputFile.c_str(), outputFile.c_str());
+	if( UV_FAILED(UVDDataFile::getUVDDataFile(&data, inputFile)) )
+	{
+		printf_error("Could not read file: %s\n", inputFile.c_str());
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	uv_assert_ret(data);
+	
+	if( UV_FAILED(UVD::getUVDFromData(&uvd, data)) )
+	{
+		printf_error("Failed to initialize engine on %s\n", inputFile.c_str());
+		delete data;
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	uv_assert(uvd);
+	//Owned by the engine's object now
+	data = NULL;
+
+	if( !g_initOnly )
+	{
+		if( g_config->m_analysisOnly )
+		{
+			uv_assert_err(uvd->analyze());
+		}
+		else
+		{
+			uv_assert_err(outputSink.init(outputFile));
+			uv_assert_err(uvd->disassemble(&outputSink));
+			uv_assert_err(outputSink.deinit());
+		}
+	}
+	rc = UV_ERR_OK;
+
+error:
+	delete uvd;
+	delete data;
+	return rc;
+}
+
+static uv_err_t runBatch()
+{
+	std::vector<std::string> inputs;
+	uint32_t failed = 0;
+
+	uv_assert_ret(g_config);
+	if( UV_FAILED(getBatchInputs(inputs)) )
+	{
+		printf_error("Could not get batch inputs from %s\n", g_batch.c_str());
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	if( !g_batchOutput.empty() && UV_FAILED(isDir(g_batchOutput)) )
+	{
+		uv_assert_err_ret(createDir(g_batchOutput, true));
+	}
+
+	for( std::vector<std::string>::iterator iter = inputs.begin(); iter != inputs.end(); ++iter )
+	{
+		if( UV_FAILED(runBatchFile(*iter)) )
+		{
+			printf_error("batch: failed on %s\n", (*iter).c_str());
+			++failed;
+		}
+	}
+	
+	printf_help("batch: %u files, %u failed\n", (uint32_t)inputs.size(), failed);
+	if( failed )
+	{
+		return UV_DEBUG(UV_ERR_GENERAL);
+	}
+	return UV_ERR_OK;
+}
+
 static uv_err_t argParser(const UVDArgConfig *argConfig, std::vector<std::string> argumentArguments, void *user)
 {
 	UVDConfig *config = NULL;
@@ -153,6 +330,16 @@ static uv_err_t argParser(const UVDArgConfig *argConfig, std::vector<std::string
 	{
 		g_initOnly = firstArgBool;
 	}
+	else if( argConfig->m_propertyForm == UVD_PROP_BATCH )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		g_batch = firstArg;
+	}
+	else if( argConfig->m_propertyForm == UVD_PROP_BATCH_OUTPUT )
+	{
+		uv_assert_ret(!argumentArguments.empty());
+		g_batchOutput = firstArg;
+	}
 	else
 	{
 		//return UV_DEBUG(argParserDefault(argConfig, argumentArguments));
@@ -171,6 +358,8 @@ uv_err_t initProgConfig()
 	uv_assert_err_ret(g_config->registerArgument(UVD_PROP_TARGET_FILE, 0, "input", "source file for data", 1, argParser, false));
 	uv_assert_err_ret(g_config->registerArgument(UVD_PROP_OUTPUT_FILE, 0, "output", "output program (default: stdout)", 1, argParser, false));
 	uv_assert_err_ret(g_config->registerArgument(UVD_PROP_INIT_ONLY, 0, "init-only", "only initialize, don't do anything (to debug plugin load selection)", 1, argParser, true));
+	uv_assert_err_ret(g_config->registerArgument(UVD_PROP_BATCH, 0, "batch", "analyze every file in a directory (except earlier outputs) or listed one per line in a file", 1, argParser, false));
+	uv_assert_err_ret(g_config->registerArgument(UVD_PROP_BATCH_OUTPUT, 0, "batch-output", "directory for batch outputs (default: input file name + " UVD_BATCH_OUTPUT_EXTENSION ")", 1, argParser, false));
 
 	//Callbacks
 	g_config->versionPrintPrefixThunk = versionPrintPrefixThunk;
@@ -223,13 +412,21 @@ uv_err_t uvmain(int argc, char **argv)
 	if( UV_FAILED(parseFileOption(g_outputFile, &g_pOutputFile)) )
 	{
 		printf_error("Could not open file: %s\n", g_outputFile.c_str());
-		uv_assert(UV_ERR_GENERAL);
+		uv_assert_err(UV_ERR_GENERAL);
 	}
 
-	if( UV_FAILED(runTasks()) )
+	if( !g_batch.empty() )
+	{
+		if( UV_FAILED(runBatch()) )
+		{
+			printf_error("Batch failed\n");
+			uv_assert_err(UV_ERR_GENERAL);
+		}
+	}
+	else if( UV_FAILED(runTasks()) )
 	{
 		printf_error("Top level runTasks failed\n");
-		uv_assert(UV_ERR_GENERAL);
+		uv_assert_err(UV_ERR_GENERAL);
 	}	
 
 	rc = UV_ERR_OK;